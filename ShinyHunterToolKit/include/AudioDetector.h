@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioSource.h"
+
+// In-place radix-2 complex FFT on split real/imaginary arrays. Butterflies run four
+// at a time with SSE2 once a stage is at least four wide.
+class Fft
+{
+public:
+    Fft(size_t p_Size);
+
+    void Transform(float* p_Real, float* p_Imag) const;
+    size_t GetSize() const { return m_Size; }
+
+private:
+    size_t m_Size;
+    std::vector<uint32_t> m_BitReverse;
+    std::vector<float> m_TwiddleReal;   // stage with half-width h starts at index h - 1
+    std::vector<float> m_TwiddleImag;
+};
+
+enum class AudioMatchAction
+{
+    IncrementCounter,   // e.g. a battle-start jingle counts an encounter
+    HaltMacro           // e.g. the shiny sparkle stops playback and freezes the counter
+};
+
+struct AudioFingerprint
+{
+    std::string m_Name = "Sound";
+    AudioMatchAction m_Action = AudioMatchAction::HaltMacro;
+    float m_Threshold = 0.8f;           // minimum correlation with the pattern
+    int m_CooldownMs = 3000;            // ignore repeats of the same sound inside this window
+    std::vector<float> m_Pattern;       // s_PatternFrames x s_BandCount log band energies, zero mean and unit length
+};
+
+struct AudioDetectorStats
+{
+    uint64_t m_FramesAnalysed = 0;
+    double m_AnalysisMicroseconds = 0.0;    // per hop, exponential moving average
+    float m_LevelDb = -120.0f;
+    std::vector<float> m_Scores;
+    std::string m_LastMatch;
+    uint64_t m_MatchCount = 0;
+};
+
+// Streams PCM from an audio source through a Hann-windowed FFT (50% overlap), reduces
+// each hop to log-spaced band energies and correlates the most recent hops with each
+// fingerprint. Band edges are in Hz, so fingerprints carry across sample rates.
+class AudioDetector
+{
+public:
+    static const size_t s_FftSize = 1024;
+    static const size_t s_HopSize = s_FftSize / 2;
+    static const size_t s_BandCount = 32;
+    static const size_t s_PatternFrames = 8;     // roughly 90 ms at 44.1 kHz
+
+    AudioDetector();
+    ~AudioDetector();
+
+    void SetFingerprints(const std::vector<AudioFingerprint>& p_Fingerprints);
+    std::vector<AudioFingerprint> GetFingerprints() const;
+
+    // Frames quieter than this never match, so silence cannot correlate with a pattern
+    void SetMinimumLevel(float p_LevelDb) { m_MinimumLevelDb = p_LevelDb; }
+
+    bool Start(std::unique_ptr<AudioSource> p_Source, std::function<void(const AudioFingerprint&)> p_OnMatch);
+    void Stop();
+    bool IsRunning() const { return m_IsRunning.load(); }
+
+    // Adds a fingerprint from the loudest sound heard in the last few seconds
+    void RequestFingerprint(const std::string& p_Name, AudioMatchAction p_Action);
+
+    AudioDetectorStats GetStats() const;
+    std::string GetSourceError() const;
+
+    // Fingerprints the loudest part of a recorded clip
+    static bool CreateFingerprint(AudioSource& p_Source, const std::string& p_Name, AudioFingerprint& p_Fingerprint);
+    static float GetSimilarity(const std::vector<float>& p_Pattern, const float* p_Frames);
+
+private:
+    // Turns s_FftSize samples into s_BandCount log energies and returns the RMS level
+    class BandAnalyser
+    {
+    public:
+        BandAnalyser(int p_SampleRate);
+        float Analyse(const float* p_Samples, float* p_Bands);
+
+    private:
+        Fft m_Fft;
+        std::vector<float> m_Window;
+        std::vector<float> m_Real;
+        std::vector<float> m_Imag;
+        std::vector<float> m_Power;
+        size_t m_BandStart[s_BandCount + 1];
+    };
+
+    static std::vector<float> GetPattern(const std::vector<float>& p_Frames, const std::vector<float>& p_Levels, size_t p_FrameCount);
+    static std::vector<float> NormalisePattern(const float* p_Frames);
+    void RunDetection(std::unique_ptr<AudioSource> p_Source, std::function<void(const AudioFingerprint&)> p_OnMatch);
+
+    std::thread m_Thread;
+    std::atomic<bool> m_IsRunning;
+    std::atomic<bool> m_StopDetection;
+    std::atomic<float> m_MinimumLevelDb;
+
+    mutable std::mutex m_FingerprintsMutex;
+    std::vector<AudioFingerprint> m_Fingerprints;
+    std::vector<std::chrono::steady_clock::time_point> m_LastMatches;
+    std::string m_RequestedName;
+    AudioMatchAction m_RequestedAction;
+    bool m_IsFingerprintRequested;
+
+    mutable std::mutex m_StatsMutex;
+    AudioDetectorStats m_Stats;
+    std::string m_SourceError;
+};
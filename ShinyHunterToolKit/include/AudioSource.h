@@ -0,0 +1,84 @@
+#pragma once
+#include <windows.h>
+#include <mmsystem.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Mono PCM as floats in [-1, 1]; multi-channel input is mixed down by the source
+class AudioSource
+{
+public:
+    virtual ~AudioSource() {}
+
+    virtual bool Open() = 0;
+    virtual void Close() {}
+
+    // Appends up to p_Count samples, blocking for live sources until they arrive or p_Cancel
+    // is set. Returns false at the end of the stream or when cancelled.
+    virtual bool Read(std::vector<float>& p_Samples, size_t p_Count, const std::atomic<bool>& p_Cancel) = 0;
+
+    virtual int GetSampleRate() const = 0;
+    virtual std::string GetName() const = 0;
+};
+
+// 8/16/24/32-bit PCM or 32-bit float WAV, or headerless signed 16-bit little-endian
+// mono when p_RawSampleRate is set
+class AudioFileSource : public AudioSource
+{
+public:
+    AudioFileSource(const std::string& p_Path, bool p_Loop = false, int p_RawSampleRate = 0);
+    ~AudioFileSource();
+
+    bool Open() override;
+    void Close() override;
+    bool Read(std::vector<float>& p_Samples, size_t p_Count, const std::atomic<bool>& p_Cancel) override;
+
+    int GetSampleRate() const override { return m_SampleRate; }
+    std::string GetName() const override { return "Audio File (" + m_Path + ")"; }
+
+private:
+    bool ReadWavHeader();
+
+    std::string m_Path;
+    bool m_Loop;
+    int m_RawSampleRate;
+    FILE* m_File;
+
+    int m_SampleRate;
+    int m_Channels;
+    int m_BitsPerSample;
+    bool m_IsFloat;
+    long m_DataStart;
+    uint32_t m_DataSize;
+    uint32_t m_DataRead;
+    std::vector<uint8_t> m_Buffer;
+};
+
+// Local capture through waveIn (the default recording device unless one is given).
+// A ring of buffers stays queued with the driver and Read() collects the filled ones.
+class WaveInAudioSource : public AudioSource
+{
+public:
+    static const int s_BufferCount = 8;
+
+    WaveInAudioSource(int p_SampleRate = 44100, UINT p_Device = WAVE_MAPPER);
+    ~WaveInAudioSource();
+
+    bool Open() override;
+    void Close() override;
+    bool Read(std::vector<float>& p_Samples, size_t p_Count, const std::atomic<bool>& p_Cancel) override;
+
+    int GetSampleRate() const override { return m_SampleRate; }
+    std::string GetName() const override { return "Recording Device"; }
+
+private:
+    int m_SampleRate;
+    UINT m_Device;
+    HWAVEIN m_WaveIn;
+    WAVEHDR m_Headers[s_BufferCount];
+    std::vector<int16_t> m_Buffers[s_BufferCount];
+    int m_NextBuffer;
+};
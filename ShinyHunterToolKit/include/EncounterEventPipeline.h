@@ -0,0 +1,95 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+class ShinyCounter;
+struct HuntJournalEntry;
+struct HuntPhase;
+struct HuntProfile;
+
+enum class EncounterSource
+{
+    ResetCombo,         // reset combo released on the physical controller
+    Manual,             // GUI button, never de-duplicated
+    MacroMarker,        // end of a macro loop marked as one encounter
+    ImageDetector,      // battle-start region seen on screen
+    AudioDetector,      // battle-start sound heard
+    Remote,             // count command from the automation socket, never de-duplicated
+    Count
+};
+
+struct EncounterSourceStats
+{
+    uint64_t m_Received = 0;
+    uint64_t m_Accepted = 0;
+    uint64_t m_Duplicates = 0;  // inside the window of an already counted event
+    uint64_t m_Ignored = 0;     // source disabled or counter frozen
+    std::chrono::steady_clock::time_point m_LastEvent;
+};
+
+// Counter state read in one go, for threads other than the GUI
+struct EncounterCounterSnapshot
+{
+    int m_Encounters = 0;
+    int m_EncountersPerReset = 0;
+    int m_Generation = 0;
+    int m_Method = 0;
+    int m_PhaseCount = 0;
+    size_t m_UndoCount = 0;
+    uint32_t m_HuntId = 0;
+    uint64_t m_TotalAccepted = 0;
+    double m_Probability = 0.0;
+    double m_CumulativeProbability = 0.0;
+};
+
+// Single entry point for everything that can signal an encounter. Events from any source
+// that arrive within the de-duplication window of the last counted one are treated as the
+// same encounter, so a reset seen by both a detector and a macro marker counts once.
+class EncounterEventPipeline
+{
+public:
+    EncounterEventPipeline(ShinyCounter& p_ShinyCounter);
+
+    // Returns true when the event advanced the counter
+    bool Post(EncounterSource p_Source);
+
+    // Counter undo and redo, under the same lock as counting
+    bool Undo(HuntJournalEntry& p_Entry);
+    bool Redo(HuntJournalEntry& p_Entry);
+
+    // Count changes from the GUI, under the same lock so their journal entries record
+    // the count they actually replaced
+    std::string SetCurrentEncounters(int p_CurrentEncounters);
+    HuntPhase EndPhase(const std::string& p_Shiny);
+
+    // Swaps the counter over to another hunt in one step, so no encounter is journalled
+    // into a hunt that is half loaded
+    std::string SwitchHunt(HuntProfile& p_Profile, const std::string& p_JournalPath);
+
+    void SetDeduplicationWindow(std::chrono::milliseconds p_Window);
+    std::chrono::milliseconds GetDeduplicationWindow() const;
+
+    void SetSourceEnabled(EncounterSource p_Source, bool p_IsEnabled);
+    bool IsSourceEnabled(EncounterSource p_Source) const;
+
+    // Taken under the counting lock, so it never shows a count change half applied
+    EncounterCounterSnapshot GetCounterSnapshot() const;
+
+    EncounterSourceStats GetSourceStats(EncounterSource p_Source) const;
+    uint64_t GetTotalAccepted() const;
+    void ResetStats();
+
+    static const char* GetSourceName(EncounterSource p_Source);
+
+private:
+    ShinyCounter& m_ShinyCounter;
+
+    mutable std::mutex m_Mutex;
+    std::chrono::milliseconds m_DeduplicationWindow;
+    std::chrono::steady_clock::time_point m_LastAccepted;
+    bool m_HasAccepted;
+    bool m_IsEnabled[(int)EncounterSource::Count];
+    EncounterSourceStats m_Stats[(int)EncounterSource::Count];
+};
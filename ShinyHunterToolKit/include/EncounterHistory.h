@@ -0,0 +1,70 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct HistoryPoint
+{
+    float m_X;
+    float m_Y;
+};
+
+// One plotted series with x increasing. Appends also update a pyramid of buckets
+// (level k covers 2^k points) holding the lowest and highest point in each, so
+// Downsample picks the level with a few candidates per pixel and runs
+// Largest-Triangle-Three-Buckets over those instead of over every point.
+class HistorySeries
+{
+public:
+    void Append(float p_X, float p_Y);
+    void Clear();
+    // Drops points from the end, rebuilding the pyramid; O(n), for undo only
+    void Truncate(size_t p_Size);
+
+    size_t GetSize() const { return m_Points.size(); }
+    bool IsEmpty() const { return m_Points.empty(); }
+    const HistoryPoint& GetLast() const { return m_Points.back(); }
+
+    // At most p_PointCount points covering [p_MinX, p_MaxX]; O(p_PointCount) whatever the series length
+    void Downsample(float p_MinX, float p_MaxX, size_t p_PointCount, std::vector<HistoryPoint>& p_Output) const;
+
+private:
+    struct Bucket
+    {
+        uint32_t m_MinIndex;
+        uint32_t m_MaxIndex;
+    };
+
+    Bucket MakeBucket(uint32_t p_Index) const;
+    Bucket MergeBuckets(const Bucket& p_First, const Bucket& p_Second) const;
+    static void Lttb(const std::vector<HistoryPoint>& p_Points, size_t p_PointCount, std::vector<HistoryPoint>& p_Output);
+
+    std::vector<HistoryPoint> m_Points;
+    std::vector<std::vector<Bucket>> m_Levels;     // m_Levels[0] is pyramid level 1
+};
+
+// Encounters and cycle times of the current session, in seconds since it started. Ending
+// a phase or switching hunts starts a new session.
+class EncounterHistory
+{
+public:
+    EncounterHistory();
+
+    void RecordReset(int p_CurrentEncounters);
+    // Drops the newest reset if it counted up to p_Encounters (the reset was undone)
+    void RemoveLastReset(int p_Encounters);
+    void Reset();
+
+    float GetSessionSeconds() const;
+    size_t GetResetCount() const;
+    void GetEncounterPlot(float p_MinX, float p_MaxX, size_t p_PointCount, std::vector<HistoryPoint>& p_Output) const;
+    void GetCycleTimePlot(float p_MinX, float p_MaxX, size_t p_PointCount, std::vector<HistoryPoint>& p_Output) const;
+
+private:
+    mutable std::mutex m_Mutex;
+    std::chrono::steady_clock::time_point m_SessionStart;
+    double m_LastResetSeconds;
+    HistorySeries m_Encounters;
+    HistorySeries m_CycleTimes;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+struct EncounterStatsSnapshot
+{
+    static const size_t s_WindowCount = 3;
+    static const size_t s_HistogramBuckets = 40;
+
+    uint64_t m_TotalResets;
+    double m_ResetsPerHour[s_WindowCount];
+    double m_AverageCycleSeconds[s_WindowCount];
+    double m_SessionResetsPerHour;
+    double m_LastCycleSeconds;
+    double m_SecondsSinceLastReset;
+    bool m_IsStalled;
+    float m_Histogram[s_HistogramBuckets];
+};
+
+// Timestamps every counted reset into a fixed ring and keeps rolling rates, a cycle-time
+// histogram and running averages up to date incrementally, so reading a snapshot never
+// rescans the history. Timestamps are milliseconds since the session started.
+class EncounterStats
+{
+public:
+    static const size_t s_RingCapacity = 8192;
+    static const size_t s_WindowCount = EncounterStatsSnapshot::s_WindowCount;
+    static const size_t s_HistogramBuckets = EncounterStatsSnapshot::s_HistogramBuckets;
+
+    EncounterStats();
+
+    void RecordReset();
+    void Reset();
+
+    EncounterStatsSnapshot GetSnapshot();
+
+    static const char* GetWindowName(size_t p_Window);
+    static double GetHistogramBucketSeconds(size_t p_Bucket);
+    static double GetHoursForEncounters(uint64_t p_Encounters, int p_EncountersPerReset, double p_ResetsPerHour);
+
+private:
+    uint32_t GetNowMs() const;
+    void EvictWindows(uint32_t p_NowMs);
+    static size_t GetHistogramBucket(uint32_t p_CycleMs);
+
+    std::mutex m_Mutex;
+    std::chrono::steady_clock::time_point m_SessionStart;
+
+    uint32_t m_Timestamps[s_RingCapacity];
+    uint64_t m_Head;
+    uint64_t m_WindowTail[s_WindowCount];
+
+    uint64_t m_HistogramCounts[s_HistogramBuckets];
+    uint32_t m_LastCycleMs;
+};
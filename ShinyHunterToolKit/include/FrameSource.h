@@ -0,0 +1,104 @@
+#pragma once
+#include <windows.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 32-bit pixels as 0xAARRGGBB (BGRA in memory). A frame may cover only part of the
+// source; m_OriginX/m_OriginY give its top-left corner in source coordinates.
+struct VideoFrame
+{
+    int m_Width = 0;
+    int m_Height = 0;
+    int m_OriginX = 0;
+    int m_OriginY = 0;
+    uint64_t m_Index = 0;
+    std::chrono::steady_clock::time_point m_Time;
+    std::vector<uint32_t> m_Pixels;
+
+    const uint32_t* GetRow(int p_Y) const { return m_Pixels.data() + (size_t)p_Y * m_Width; }
+};
+
+class FrameSource
+{
+public:
+    virtual ~FrameSource() {}
+
+    virtual bool Open() = 0;
+    virtual void Close() {}
+    virtual bool ReadFrame(VideoFrame& p_Frame) = 0;
+    virtual std::string GetName() const = 0;
+
+    // Sources that can crop at capture time only grab this rectangle; others ignore it
+    virtual void SetRegionOfInterest(int /*p_X*/, int /*p_Y*/, int /*p_Width*/, int /*p_Height*/) {}
+};
+
+// Numbered image files, e.g. "frames/frame_%05d.bmp", or one file repeated forever.
+// Reads uncompressed 24/32-bit BMP and binary PPM (P6).
+class ImageSequenceFrameSource : public FrameSource
+{
+public:
+    ImageSequenceFrameSource(const std::string& p_Pattern, int p_FirstIndex = 0, bool p_Loop = false);
+
+    bool Open() override;
+    bool ReadFrame(VideoFrame& p_Frame) override;
+    std::string GetName() const override { return "Image Sequence (" + m_Pattern + ")"; }
+
+    static bool ReadImageFile(const std::string& p_Path, VideoFrame& p_Frame);
+
+private:
+    static bool LoadBmp(FILE* p_File, VideoFrame& p_Frame);
+    static bool LoadPpm(FILE* p_File, VideoFrame& p_Frame);
+    bool ParsePattern();
+    std::string GetPath(int p_Index) const;
+
+    // The pattern split once around its single %d / %0Nd, with %% unescaped
+    std::string m_Pattern;
+    std::string m_Prefix;
+    std::string m_Suffix;
+    int m_Width;
+    char m_PadChar;
+    bool m_IsPatternValid;
+    int m_FirstIndex;
+    int m_NextIndex;
+    bool m_Loop;
+    bool m_IsSingleFile;
+    uint64_t m_FrameCount;
+};
+
+// Captures a window's client area (or the desktop) with GDI into a DIB section whose
+// pixel memory is read in place, so each frame costs one BitBlt and one copy of the
+// region of interest.
+class ScreenCaptureFrameSource : public FrameSource
+{
+public:
+    ScreenCaptureFrameSource(const std::string& p_WindowTitle);
+    ~ScreenCaptureFrameSource();
+
+    bool Open() override;
+    void Close() override;
+    bool ReadFrame(VideoFrame& p_Frame) override;
+    std::string GetName() const override { return m_WindowTitle.empty() ? "Desktop" : "Window (" + m_WindowTitle + ")"; }
+
+    void SetRegionOfInterest(int p_X, int p_Y, int p_Width, int p_Height) override;
+
+private:
+    bool CreateBuffer(int p_Width, int p_Height);
+    void FreeBuffer();
+
+    std::string m_WindowTitle;
+    HWND m_Window;
+    HDC m_SourceDC;
+    HDC m_MemoryDC;
+    HBITMAP m_Bitmap;
+    HGDIOBJ m_PreviousBitmap;
+    uint32_t* m_Bits;
+    int m_BufferWidth;
+    int m_BufferHeight;
+
+    RECT m_RegionOfInterest;
+    bool m_HasRegionOfInterest;
+    uint64_t m_FrameCount;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Macro.h"
+
+// Generation 3 linear congruential generator with O(log n) jump-ahead
+class Gen3Lcrng
+{
+public:
+    static const uint32_t s_Mult = 0x41C64E6Du;
+    static const uint32_t s_Add = 0x00006073u;
+
+    static uint32_t Next(uint32_t p_Seed) { return p_Seed * s_Mult + s_Add; }
+    static uint32_t Jump(uint32_t p_Seed, uint64_t p_Steps);
+
+    // Multiplier and increment that advance the generator 2^p_Bit steps in one go
+    static uint32_t GetJumpMult(int p_Bit);
+    static uint32_t GetJumpAdd(int p_Bit);
+};
+
+enum class Gen3Method
+{
+    Method1,
+    Method2,
+    Method4,
+    WildMethodH1,
+    WildMethodH2,
+    WildMethodH4
+};
+
+struct Gen3SearchSettings
+{
+    uint16_t m_Tid = 0;
+    uint16_t m_Sid = 0;
+    uint32_t m_SeedMin = 0;
+    uint32_t m_SeedMax = 0;
+    uint32_t m_FrameMin = 1;
+    uint32_t m_FrameMax = 100000;
+    Gen3Method m_Method = Gen3Method::Method1;
+    size_t m_MaxResults = 1000;
+};
+
+struct Gen3SearchHit
+{
+    uint32_t m_Seed;
+    uint32_t m_Frame;
+    uint32_t m_Pid;
+    uint8_t m_Nature;
+    uint8_t m_Ivs[6];   // HP, Atk, Def, SpA, SpD, Spe
+    uint8_t m_Slot;     // wild encounter slot, 0 for static methods
+};
+
+// Searches initial seeds and frames for shiny PIDs. Frames are checked eight at a
+// time in structure-of-arrays lanes and initial seeds are shared between threads.
+class Gen3RngSearch
+{
+public:
+    Gen3RngSearch();
+    ~Gen3RngSearch();
+
+    bool Start(const Gen3SearchSettings& p_Settings, unsigned p_ThreadCount = 0);
+    void Stop();
+
+    bool IsRunning() const { return m_IsRunning.load(); }
+    double GetProgress() const;
+    std::vector<Gen3SearchHit> GetResults() const;
+
+    static std::vector<Gen3SearchHit> Search(const Gen3SearchSettings& p_Settings, unsigned p_ThreadCount, const std::atomic<bool>& p_Cancel, std::atomic<uint64_t>& p_SeedsDone);
+    static bool IsShiny(uint32_t p_Pid, uint16_t p_Tid, uint16_t p_Sid);
+    static const char* GetNatureName(uint8_t p_Nature);
+    static const char* GetMethodName(Gen3Method p_Method);
+
+    // Soft reset, then press p_TriggerButtons on the hit's frame (shifted by the calibration offset)
+    static Macro ExportHitToMacro(const Gen3SearchHit& p_Hit, int p_FrameOffset, WORD p_ResetButtons, WORD p_TriggerButtons, uint32_t p_LoopGapFrames = 600);
+
+private:
+    static bool GenerateHit(uint32_t p_Seed, uint32_t p_Frame, const Gen3SearchSettings& p_Settings, Gen3SearchHit& p_Hit);
+    static void SearchSeed(uint32_t p_Seed, const Gen3SearchSettings& p_Settings, std::vector<Gen3SearchHit>& p_Hits);
+    void RunSearch(Gen3SearchSettings p_Settings, unsigned p_ThreadCount);
+
+    std::thread m_Thread;
+    std::atomic<bool> m_IsRunning;
+    std::atomic<bool> m_StopSearch;
+    std::atomic<uint64_t> m_SeedsDone;
+    uint64_t m_SeedsTotal;
+
+    mutable std::mutex m_ResultsMutex;
+    std::vector<Gen3SearchHit> m_Results;
+};
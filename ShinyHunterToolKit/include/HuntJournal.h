@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+enum class HuntJournalEvent : int32_t
+{
+    Reset,          // a counted reset
+    Set,            // the count was typed in
+    PhaseEnd,       // m_Before is the finished phase's total; the count restarts at 0
+    Undo,           // the newest change was reverted (m_Before and m_After are swapped)
+    Redo            // the newest undone change was applied again
+};
+
+struct HuntJournalEntry
+{
+    uint32_t m_Time;            // Unix time
+    int32_t m_Before;
+    int32_t m_After;
+    HuntJournalEvent m_Event;
+};
+
+// Append-only log of one hunt's count changes as fixed 16-byte entries. The newest
+// changes also sit in a bounded undo ring, so each entry is both the persisted record
+// and the undo delta; opening a journal replays its tail to rebuild the ring, which
+// is how undo survives a restart. Phase ends are a barrier undo never crosses.
+class HuntJournal
+{
+public:
+    static const size_t s_UndoDepth = 256;
+
+    HuntJournal();
+
+    bool Open(const std::string& p_Path);
+    void Close();
+    bool IsOpen() const;
+
+    // Reset, Set and PhaseEnd; the ring is kept even while no file is open
+    void Append(HuntJournalEvent p_Event, int p_Before, int p_After);
+
+    // The change to revert or re-apply; logged as an Undo or Redo entry
+    bool Undo(HuntJournalEntry& p_Entry);
+    bool Redo(HuntJournalEntry& p_Entry);
+    size_t GetUndoCount() const;
+    size_t GetRedoCount() const;
+
+    static bool ReadLast(const std::string& p_Path, HuntJournalEntry& p_Entry);
+    static uint64_t GetEntryCount(const std::string& p_Path);
+
+private:
+    void Apply(const HuntJournalEntry& p_Entry);
+    void Write(const HuntJournalEntry& p_Entry);
+    void PushUndo(const HuntJournalEntry& p_Entry);
+
+    mutable std::mutex m_Mutex;
+    std::ofstream m_File;
+
+    std::array<HuntJournalEntry, s_UndoDepth> m_UndoRing;
+    size_t m_UndoHead;          // next slot to write
+    size_t m_UndoCount;
+    std::array<HuntJournalEntry, s_UndoDepth> m_RedoStack;
+    size_t m_RedoCount;
+};
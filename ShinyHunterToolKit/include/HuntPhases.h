@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One stretch of a hunt, ended by a shiny (often not the target)
+struct HuntPhase
+{
+    int64_t m_StartTime = 0;        // Unix time
+    int64_t m_EndTime = 0;
+    int m_Encounters = 0;
+    double m_ExpectedShinies = 0.0; // encounters weighted by the odds they were made at
+    std::string m_Shiny;
+};
+
+// Totals over finished phases. Each phase is added once when it ends, so nothing
+// here ever walks the phase list again.
+class HuntPhaseTotals
+{
+public:
+    void Add(const HuntPhase& p_Phase);
+    void Clear() { *this = HuntPhaseTotals(); }
+
+    int GetPhaseCount() const { return m_PhaseCount; }
+    int64_t GetEncounters() const { return m_Encounters; }
+    double GetExpectedShinies() const { return m_ExpectedShinies; }
+    int GetShortestPhase() const { return m_ShortestPhase; }
+    int GetLongestPhase() const { return m_LongestPhase; }
+    double GetAverageEncounters() const { return m_PhaseCount > 0 ? (double)m_Encounters / m_PhaseCount : 0.0; }
+
+    // Chance of finding at least this many shinies in this many encounters; low means lucky
+    double GetLuck() const { return m_Luck; }
+
+private:
+    int m_PhaseCount = 0;
+    int64_t m_Encounters = 0;
+    double m_ExpectedShinies = 0.0;
+    int m_ShortestPhase = 0;
+    int m_LongestPhase = 0;
+    double m_Luck = 1.0;
+};
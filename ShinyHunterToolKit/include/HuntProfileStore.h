@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "HuntPhases.h"
+
+enum class HuntStatus : uint8_t
+{
+    Hunting,
+    Found,
+    Abandoned
+};
+
+const char* GetHuntStatusName(HuntStatus p_Status);
+
+// What the hunt list shows; kept in memory for every profile in the store
+struct HuntProfileSummary
+{
+    uint32_t m_Id = 0;
+    std::string m_Name;
+    std::string m_Target;
+    int m_Generation = 0;
+    int m_Encounters = 0;
+    HuntStatus m_Status = HuntStatus::Hunting;
+    int64_t m_UpdatedTime = 0;      // Unix time
+};
+
+// The rest of a hunt's state, only read from disk for the profile being switched to
+struct HuntProfile : HuntProfileSummary
+{
+    int m_Method = 0;
+    int m_EncountersPerReset = 1;
+    int64_t m_CreatedTime = 0;
+    std::string m_MacroPath;        // linked macro recording or script
+    std::string m_Notes;
+    int64_t m_PhaseStartTime = 0;
+    std::vector<HuntPhase> m_Phases;
+};
+
+// Every hunt in one append-only file of checksummed records. A save appends the
+// profile's new record and the newest record per id wins, so opening the store is
+// one sequential scan that builds an id -> (offset, summary) index; loading a profile
+// is then a single seek and switching hunts never touches the others. Superseded
+// records are dropped by Compact once they outweigh the live ones. Remove appends a
+// tombstone that drops the id from the index on the next scan.
+class HuntProfileStore
+{
+public:
+    HuntProfileStore();
+
+    bool Open(const std::string& p_Path);
+    bool IsOpen() const { return m_File.is_open(); }
+
+    bool Create(HuntProfile& p_Profile);
+    bool Save(HuntProfile& p_Profile);
+    bool Load(uint32_t p_Id, HuntProfile& p_Profile);
+    bool Remove(uint32_t p_Id);
+
+    uint32_t GetActiveId() const { return m_ActiveId; }
+    bool SetActiveId(uint32_t p_Id);
+
+    size_t GetProfileCount() const { return m_Index.size(); }
+    const HuntProfileSummary* FindSummary(uint32_t p_Id) const;
+
+    // Case-insensitive match on name or target over the in-memory index, most recently updated first
+    void Search(const std::string& p_Query, std::vector<HuntProfileSummary>& p_Results) const;
+
+    std::string GetJournalPath(uint32_t p_Id) const;
+    bool Compact();
+
+    static const uint32_t s_Version = 1;
+
+private:
+    struct IndexEntry
+    {
+        uint64_t m_Offset = 0;
+        uint32_t m_Size = 0;
+        HuntProfileSummary m_Summary;
+    };
+
+    bool Append(const std::vector<uint8_t>& p_Payload, uint64_t& p_Offset);
+    bool WriteHeader(std::ofstream& p_File) const;
+
+    std::string m_Path;
+    std::fstream m_File;
+    uint64_t m_EndOffset;
+    uint64_t m_LiveBytes;
+    uint32_t m_NextId;
+    uint32_t m_ActiveId;
+    std::unordered_map<uint32_t, IndexEntry> m_Index;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct HuntSimulationStage
+{
+    double m_Probability;       // shiny chance per encounter
+    uint64_t m_Encounters;      // encounters spent in this stage before moving on, 0 = rest of the phase
+};
+
+struct HuntSimulationSettings
+{
+    uint64_t m_Trials = 1000000;
+    uint64_t m_Seed = 1;
+    int m_EncountersPerReset = 1;
+    int m_Targets = 1;                  // target shinies needed to finish a hunt
+    double m_TargetChance = 1.0;        // chance a shiny is a target, otherwise a new phase starts at the first stage
+    std::vector<HuntSimulationStage> m_Stages;
+    std::vector<double> m_CycleSeconds; // cycle-time distribution, e.g. from the recorded histogram
+    std::vector<double> m_CycleWeights;
+    uint64_t m_MaxResets = 100000000;   // per hunt, guards against methods that can never succeed
+};
+
+struct HuntSimulationResult
+{
+    static const size_t s_PercentileCount = 5;
+    static constexpr double s_Percentiles[s_PercentileCount] = { 0.1, 0.5, 0.75, 0.9, 0.99 };
+    static const size_t s_HistogramBins = 512;
+
+    uint64_t m_Trials = 0;
+    double m_MeanHours = 0.0;
+    double m_MeanResets = 0.0;
+    double m_MeanPhases = 0.0;
+    double m_PercentileHours[s_PercentileCount] = {};
+    std::vector<uint64_t> m_Histogram;  // time-to-shiny, log-spaced from 0.01 h to 10000 h
+    double m_ElapsedSeconds = 0.0;
+
+    static double GetBinHours(double p_Bin);
+};
+
+// Monte Carlo hunt simulator. Trials are split into fixed chunks that worker threads
+// take from their own range and steal from each other's once empty. Every trial draws
+// from its own counter-based random stream and chunk sums are combined in chunk order,
+// so results depend only on the seed, never on the thread count or scheduling.
+class HuntSimulator
+{
+public:
+    HuntSimulator();
+    ~HuntSimulator();
+
+    bool Start(const std::vector<HuntSimulationSettings>& p_Batch, unsigned p_ThreadCount = 0);
+    void Stop();
+
+    bool IsRunning() const { return m_IsRunning.load(); }
+    double GetProgress() const;
+    std::vector<HuntSimulationResult> GetResults() const;
+
+    static HuntSimulationResult Run(const HuntSimulationSettings& p_Settings, unsigned p_ThreadCount, const std::atomic<bool>& p_Cancel, std::atomic<uint64_t>& p_TrialsDone);
+
+private:
+    void RunBatch(std::vector<HuntSimulationSettings> p_Batch, unsigned p_ThreadCount);
+
+    std::thread m_Thread;
+    std::atomic<bool> m_IsRunning;
+    std::atomic<bool> m_StopSimulation;
+    std::atomic<uint64_t> m_TrialsDone;
+    uint64_t m_TrialsTotal;
+
+    mutable std::mutex m_ResultsMutex;
+    std::vector<HuntSimulationResult> m_Results;
+};
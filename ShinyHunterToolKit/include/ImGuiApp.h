@@ -3,10 +3,23 @@
 #include <glfw3.h>
 #include <thread>
 #include <functional>
+#include <filesystem>
 #include "../ImGui/imgui.h"
 #include "ShinyCounter.h"
 #include "PhysicalControllerManager.h"
 #include "ViGEmManager.h"
+#include "MacroOptimiser.h"
+#include "HuntSimulator.h"
+#include "Gen3RngSearch.h"
+#include "SeedSearch.h"
+#include "ShinyDetector.h"
+#include "AudioDetector.h"
+#include "HuntProfileStore.h"
+#include "MacroCompiler.h"
+#include "MacroTimeline.h"
+#include "IpcServer.h"
+#include "SharedStatusWriter.h"
+#include "OverlayServer.h"
 
 class ImGuiApp
 {
@@ -30,6 +43,9 @@ public:
 	void SetIsPlaybackMacroButtonActived(bool p_IsPlaybackMacroButtonActived);
 	void HandleImGuiPlaybackThreadStop();
 
+	int m_InputGeneration;
+	std::string m_GenerationResult;
+
 	int m_InputEncountersPerReset;
 
 	int m_InputCurrentEncounters;
@@ -40,9 +56,137 @@ public:
 	bool m_IsAutomaticButtonActivated;
 	std::atomic<bool> m_IsRepeatedButtonThreadRunning;
 
+	float m_InputTurboFrequency;
+	float m_InputTurboDutyCycle;
+	float m_InputTurboFrameRate;
+	int m_InputTurboAlternateButton;
+
+	int m_InputSimulationTrials;
+	int m_InputSimulationTargets;
+	int m_InputSimulationTargetChance;
+	int m_InputSimulationStageEncounters;
+	int m_InputSimulationStageMethod;
+	int m_InputSimulationMaxInstances;
+	int m_InputSimulationInstanceOverhead;
+	int m_InputSimulationCycleSeconds;
+
+	int m_InputRngTid;
+	int m_InputRngSid;
+	uint32_t m_InputRngSeedMin;
+	uint32_t m_InputRngSeedMax;
+	int m_InputRngFrameMin;
+	int m_InputRngFrameMax;
+	int m_InputRngMethod;
+	int m_InputRngFrameOffset;
+	std::string m_RngSearchResult;
+
+	int m_InputSeedYear;
+	int m_InputSeedMonth;
+	int m_InputSeedDay;
+	int m_InputSeedHourMin;
+	int m_InputSeedHourMax;
+	int m_InputSeedFrameMin;
+	int m_InputSeedFrameMax;
+	int m_InputSeedGen4Method;
+	int m_InputSeedDelayMin;
+	int m_InputSeedDelayMax;
+	int m_InputSeedPreferredDelay;
+	int m_InputSeedProfile;
+	Gen5Profile m_InputSeedGen5Profile;
+	uint64_t m_InputSeedMac;
+	bool m_InputSeedKeys[12];
+	int m_InputSeedMaxKeys;
+	int m_InputSeedFrameOffset;
+	int m_SeedSearchGeneration;
+
+	int m_InputHistoryRange;
+	std::vector<HistoryPoint> m_HistoryPoints;
+
+	int m_InputDetectionSource;
+	char m_InputDetectionWindowTitle[256];
+	char m_InputDetectionPattern[260];
+	int m_InputDetectionMaxFps;
+	std::vector<DetectionRegion> m_DetectionRegions;
+
+	int m_InputAudioSource;
+	char m_InputAudioPath[260];
+	char m_InputAudioClipPath[260];
+	char m_InputAudioFingerprintName[64];
+	int m_InputAudioAction;
+	int m_InputAudioMinimumLevel;
+	std::vector<AudioFingerprint> m_AudioFingerprints;
+	std::string m_AudioDetectionResult;
+
 	bool m_IsRecordMacroButtonActivated;
 	bool m_IsPlaybackMacroButtonActivated;
 	std::atomic<bool> m_IsPlaybackButtonThreadRunning;
+	uint32_t m_SeenMacroStopCount;
+
+	int m_InputMacroTimeUnit;
+	int m_InputMacroFrameRate;
+	float m_InputMacroSpeedMultiplier;
+
+	int m_InputOptimiserMinHold;
+	int m_InputOptimiserMinRelease;
+	int m_InputOptimiserMinIdle;
+	std::vector<MacroIdleGap> m_OptimiserIdleGaps;
+	std::vector<int> m_InputOptimiserSafeIdle;
+	Macro m_UnoptimisedMacro;
+	std::string m_OptimiserResult;
+	ImVec4 m_OptimiserResultColour;
+
+	std::vector<TimedPress> m_TimedPresses;
+
+	bool m_IsMacroTimelineOpen;
+	double m_TimelineViewStart;
+	double m_TimelineViewSpan;
+	int m_TimelineSelectFirst;
+	int m_TimelineSelectLast;
+	bool m_IsTimelineSelecting;
+	double m_TimelineSelectAnchor;
+	bool m_IsTimelineListScrollPending;
+	int m_InputTimelineNudge;
+	float m_InputTimelineScale;
+
+	bool m_IsMacroRecordingStreamed;
+	char m_InputMacroFilePath[260];
+	std::string m_MacroFileResult;
+	ImVec4 m_MacroFileResultColour;
+
+	int m_InputReplaySeconds;
+	std::string m_ReplayResult;
+	ImVec4 m_ReplayResultColour;
+
+	std::vector<char> m_InputMacroScript;
+	char m_InputMacroScriptPath[260];
+	bool m_IsMacroScriptWatched;
+	bool m_IsMacroScriptDisassemblyShown;
+	std::filesystem::file_time_type m_MacroScriptWriteTime;
+	MacroProgram m_MacroScriptProgram;
+	bool m_IsMacroScriptCompiled;
+	double m_MacroScriptCompileMs;
+	std::string m_MacroScriptResult;
+
+	HuntProfile m_ActiveHunt;
+	char m_InputHuntName[64];
+	char m_InputHuntTarget[64];
+	char m_InputHuntNotes[1024];
+	char m_InputHuntNewName[64];
+	char m_InputHuntSearch[64];
+	std::vector<HuntProfileSummary> m_HuntSearchResults;
+	bool m_IsHuntSearchDirty;
+	uint32_t m_HuntDeleteId;          // hunt whose Delete button is waiting for a second click
+	std::string m_HuntResult;
+	ImVec4 m_HuntResultColour;
+	double m_HuntSaveTime;
+
+	char m_InputPhaseShiny[64];
+	std::string m_PhaseResult;
+
+	char m_InputIpcPath[260];
+	SharedStatusData m_SharedStatus;
+	double m_SharedStatusRateTime;
+	int m_InputOverlayPort;
 
 
 private:
@@ -52,17 +196,63 @@ private:
 	void CenteredButton(const char* label, std::function<void()> onClick);
 	void CenteredCombo(const char* label, int* currentItem, const char* const items[], int itemsCount);
 	void CenteredInputInt(const char* label, int* value);
+	void CenteredSliderFloat(const char* label, float* value, float min, float max, const char* format);
 
 	void GetGenerationInput();
+	void GetMethodInput();
 	void GetEncountersPerResetInput();
 	void GetCurrentEncountersInput();
+	void HuntProfiles();
+	void CaptureActiveHunt();
+	bool IsActiveHuntChanged() const;
+	bool SaveActiveHunt();
+	void ApplyActiveHunt();
+	void SwitchHunt(uint32_t p_Id);
+	void Phases();
 	void IncrementEncounters();
 	void DisplayEncounters();
+	void EncounterSources();
+	void DisplayThroughput();
+	void EncounterHistoryPlot();
+	void DrawHistoryPlot(const char* p_Label, const char* p_Format, float p_MinX, float p_MaxX, ImU32 p_Colour);
+	void SimulateHunt();
+	void RngSearch();
+	void SeedSearchInput();
+	void ShinyDetection();
+	void AudioDetection();
 	void DisplayControllerStates();
 	void RepeatedButtonPress();
+	void TurboSettingsInput();
 	void Macros();
+	void SyncMacroPlayback();
+	void AutomationSocket();
+	void PublishSharedStatus();
+	void StreamOverlay();
+	void MacroTimebaseInput();
+	void MacroOptimiserInput();
+	void TimedResetInput();
+	void MacroScriptInput();
+	void InstantReplayInput();
+	void MacroFileInput();
+	void MacroTimelineWindow();
+	void MacroTimelineCanvas(const Macro& p_Macro);
+	void MacroTimelineEventList(const Macro& p_Macro);
+	void CutReplayToMacro(WORD p_TrimButtons);
+	bool LoadMacroScript();
+	void CompileMacroScript();
 
     ShinyCounter m_ShinyCounter;
+	HuntSimulator m_HuntSimulator;
+	Gen3RngSearch m_Gen3RngSearch;
+	SeedSearch m_SeedSearch;
+	ShinyDetector m_ShinyDetector;
+	AudioDetector m_AudioDetector;
+	MacroCompiler m_MacroCompiler;
+	MacroTimeline m_MacroTimeline;
+	HuntProfileStore m_HuntProfileStore;
+	IpcServer m_IpcServer;
+	SharedStatusWriter m_SharedStatusWriter;
+	OverlayServer m_OverlayServer;
 	PhysicalControllerManager* m_PhysicalControllerManager;
 	ViGEmManager m_ViGEmManager;
 	GLFWwindow* m_Window;
@@ -0,0 +1,51 @@
+#pragma once
+#include <windows.h>
+#include <ViGEm/Client.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Macro.h"
+
+struct InputSnapshot
+{
+    int64_t m_Time;         // steady_clock ticks
+    XUSB_REPORT m_Report;
+};
+
+// Always-on record of the physical pad for cutting the last few seconds into a macro.
+// The controller poll thread is the only writer: a push is one slot store and one
+// release store of the head into a preallocated power-of-two ring. Readers copy
+// backwards from the head and then drop anything the writer lapped during the copy.
+class InputReplayBuffer
+{
+public:
+    static const size_t s_Capacity = 1 << 18;   // about four minutes at the 1 ms poll rate
+
+    InputReplayBuffer();
+
+    InputReplayBuffer(const InputReplayBuffer&) = delete;
+    InputReplayBuffer& operator=(const InputReplayBuffer&) = delete;
+
+    void Push(std::chrono::steady_clock::time_point p_Time, const XUSB_REPORT& p_Report)
+    {
+        uint64_t head = m_Head.load(std::memory_order_relaxed);
+        m_Ring[head & (s_Capacity - 1)] = { p_Time.time_since_epoch().count(), p_Report };
+        m_Head.store(head + 1, std::memory_order_release);
+    }
+
+    uint64_t GetPushCount() const { return m_Head.load(std::memory_order_acquire); }
+    std::chrono::nanoseconds GetCoveredDuration() const;
+
+    // Oldest first; never more than p_Duration before the newest snapshot
+    std::vector<InputSnapshot> CopyLast(std::chrono::nanoseconds p_Duration) const;
+
+    // Cuts the last p_Duration of button input into a macro. Idle time before the first
+    // press and after the last release is trimmed, as is a trailing hold of any of
+    // p_TrimButtons (the gesture that asked for the cut).
+    bool CutToMacro(std::chrono::nanoseconds p_Duration, WORD p_TrimButtons, const MacroTimebase& p_Timebase, Macro& p_Macro) const;
+
+private:
+    std::vector<InputSnapshot> m_Ring;
+    std::atomic<uint64_t> m_Head;   // snapshots pushed since start
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Frames in both directions: u16 payload length, u8 opcode, u8 tag, then the payload
+// (all little-endian). Each reply echoes the request's tag with opcode | 0x80 and
+// starts with an IpcResult byte; a subscriber also gets StatusPush frames (tag 0)
+// whenever the status changes.
+enum class IpcCommand : uint8_t
+{
+    Ping = 0x01,
+    GetStatus = 0x02,
+    Count = 0x03,
+    StartPlayback = 0x04,      // queued: Ok means accepted, the status shows when it takes effect
+    StopPlayback = 0x05,
+    Undo = 0x06,
+    Redo = 0x07,
+    Subscribe = 0x08,
+    Unsubscribe = 0x09,
+    StatusPush = 0x40
+};
+
+enum class IpcResult : uint8_t
+{
+    Ok,
+    Rejected,           // valid command the app could not act on now
+    UnknownCommand,
+    BadLength
+};
+
+enum IpcStatusFlags : uint8_t
+{
+    IpcStatusFrozen = 1 << 0,
+    IpcStatusMacroRunning = 1 << 1,
+    IpcStatusRecording = 1 << 2,
+    IpcStatusControllerConnected = 1 << 3
+};
+
+// Sent as s_StatusSize bytes in this field order
+struct IpcStatus
+{
+    uint32_t m_Encounters;
+    uint32_t m_EncountersPerReset;
+    uint8_t m_Generation;
+    uint8_t m_Method;
+    uint8_t m_Flags;
+    uint32_t m_PhaseCount;
+    uint32_t m_UndoCount;
+    uint32_t m_HuntId;
+    uint64_t m_TotalAccepted;
+    double m_Probability;
+    double m_CumulativeProbability;
+
+    static const size_t s_StatusSize = 4 + 4 + 1 + 1 + 1 + 4 + 4 + 4 + 8 + 8 + 8;
+};
+
+// Command and telemetry server on a Unix-domain socket, for scripts driving many
+// instances. One thread polls every client; receive and send buffers are fixed per
+// client slot and allocated once in Start, so handling a command allocates nothing.
+class IpcServer
+{
+public:
+    static const size_t s_MaxClients = 32;
+    static const size_t s_BufferSize = 4096;
+    static const int s_PollMs = 5;      // also how often subscribers' status is compared
+
+    IpcServer();
+    ~IpcServer();
+
+    // Commands other than Ping, GetStatus and the subscriptions; runs on the server thread
+    void SetCommandHandler(std::function<IpcResult(IpcCommand)> p_Handler);
+    void SetStatusProvider(std::function<void(IpcStatus&)> p_Provider);
+
+    bool Start(const std::string& p_Path);
+    void Stop();
+    bool IsRunning() const { return m_IsRunning.load(); }
+
+    std::string GetPath() const;
+    std::string GetError() const;
+    size_t GetClientCount() const { return m_ClientCount.load(); }
+    uint64_t GetCommandCount() const { return m_CommandCount.load(); }
+    double GetAverageHandleMicroseconds() const;
+
+    static std::string GetDefaultPath();
+
+private:
+    // SOCKET values; winsock stays out of this header so it can follow windows.h
+    static const uintptr_t s_InvalidSocket = ~(uintptr_t)0;
+
+    struct Client
+    {
+        uintptr_t m_Socket = s_InvalidSocket;
+        uint8_t m_Receive[s_BufferSize];
+        size_t m_ReceiveSize = 0;
+        uint8_t m_Send[s_BufferSize];
+        size_t m_SendSize = 0;
+        bool m_IsSubscribed = false;
+        bool m_IsPushPending = false;
+    };
+
+    void Run();
+    void Accept();
+    void Receive(Client& p_Client);
+    void Pump(Client& p_Client);
+    void ProcessFrames(Client& p_Client);
+    void HandleFrame(Client& p_Client, uint8_t p_Opcode, uint8_t p_Tag, size_t p_Length);
+    bool QueueStatus(Client& p_Client, uint8_t p_Opcode, uint8_t p_Tag, IpcResult p_Result, const uint8_t* p_Status);
+    void Flush(Client& p_Client);
+    void Disconnect(Client& p_Client);
+    void SetError(const std::string& p_Error);
+
+    std::function<IpcResult(IpcCommand)> m_CommandHandler;
+    std::function<void(IpcStatus&)> m_StatusProvider;
+
+    uintptr_t m_ListenSocket;
+    std::vector<Client> m_Clients;
+    uint8_t m_Status[IpcStatus::s_StatusSize];
+    uint8_t m_PushedStatus[IpcStatus::s_StatusSize];
+
+    std::thread m_Thread;
+    std::atomic<bool> m_IsRunning;
+    std::atomic<size_t> m_ClientCount;
+    std::atomic<uint64_t> m_CommandCount;
+    std::atomic<uint64_t> m_HandleNanoseconds;
+
+    mutable std::mutex m_Mutex;
+    std::string m_Path;
+    std::string m_Error;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// One fixed-size binary record: the format string's address is its id, and the
+// arguments are packed after it as tagged values (strings are copied, truncated to fit)
+struct LogRecord
+{
+    static const size_t s_ArgBytes = 104;
+
+    int64_t m_Time;             // microseconds since the Unix epoch
+    const char* m_Format;       // a string literal, so it outlives the record
+    uint32_t m_ThreadId;
+    LogLevel m_Level;
+    uint8_t m_ArgCount;
+    uint8_t m_ArgSize;
+    uint8_t m_Reserved;
+    uint8_t m_Args[s_ArgBytes];
+};
+
+// Asynchronous logger. Each thread writes records into its own lock-free ring and
+// never waits: a full ring drops the record and counts it. A background thread merges
+// the rings in time order, replaces each "{}" in the format with the next argument,
+// rate-limits repeated messages and writes them to the console and a rotating file.
+class Logger
+{
+public:
+    static const size_t s_RingCapacity = 512;
+    static const size_t s_MaxFileSize = 4 * 1024 * 1024;
+    static const int s_FileCount = 3;           // the live file plus this many rotated ones
+    static const int s_FlushMs = 25;
+    static const int s_RateBurst = 10;          // lines per format per window before suppression
+    static const int s_RateWindowSeconds = 10;
+
+    // Records logged before Start are kept and written once it runs
+    static bool Start(const std::string& p_Path);
+    static void Stop();
+
+    template <typename... Args>
+    static void Log(LogLevel p_Level, const char* p_Format, const Args&... p_Args)
+    {
+        LogRecord* record = BeginRecord(p_Level, p_Format);
+        if (record == nullptr)
+        {
+            return;
+        }
+        (EncodeArg(*record, p_Args), ...);
+        CommitRecord();
+    }
+
+    template <typename... Args>
+    static void Info(const char* p_Format, const Args&... p_Args) { Log(LogLevel::Info, p_Format, p_Args...); }
+
+    template <typename... Args>
+    static void Warning(const char* p_Format, const Args&... p_Args) { Log(LogLevel::Warning, p_Format, p_Args...); }
+
+    template <typename... Args>
+    static void Error(const char* p_Format, const Args&... p_Args) { Log(LogLevel::Error, p_Format, p_Args...); }
+
+    static uint64_t GetDroppedCount();
+    static uint64_t GetSuppressedCount();
+
+private:
+    static LogRecord* BeginRecord(LogLevel p_Level, const char* p_Format);
+    static void CommitRecord();
+
+    static void EncodeInteger(LogRecord& p_Record, int64_t p_Value);
+    static void EncodeUnsigned(LogRecord& p_Record, uint64_t p_Value);
+    static void EncodeDouble(LogRecord& p_Record, double p_Value);
+    static void EncodeString(LogRecord& p_Record, std::string_view p_Value);
+
+    template <typename T>
+    static void EncodeArg(LogRecord& p_Record, const T& p_Value)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            EncodeString(p_Record, p_Value ? "true" : "false");
+        }
+        else if constexpr (std::is_enum_v<T> || (std::is_integral_v<T> && std::is_signed_v<T>))
+        {
+            EncodeInteger(p_Record, (int64_t)p_Value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            EncodeUnsigned(p_Record, (uint64_t)p_Value);
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            EncodeDouble(p_Record, (double)p_Value);
+        }
+        else
+        {
+            EncodeString(p_Record, std::string_view(p_Value));
+        }
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <windows.h>
+#include <ViGEm/Client.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class MacroTimeUnit
+{
+    Milliseconds,
+    Frames
+};
+
+// Converts between wall-clock time and macro ticks. Frame ticks are scaled by the
+// emulator frame rate and fast-forward multiplier, so a macro recorded at one
+// speed plays back correctly at any other. Millisecond ticks are never scaled.
+struct MacroTimebase
+{
+    MacroTimeUnit m_Unit = MacroTimeUnit::Milliseconds;    // unit new recordings are stored in
+    double m_FrameRate = 59.7275;
+    double m_SpeedMultiplier = 1.0;
+
+    uint64_t ToTicks(MacroTimeUnit p_Unit, std::chrono::nanoseconds p_Elapsed) const;
+    std::chrono::nanoseconds ToDuration(MacroTimeUnit p_Unit, uint64_t p_Ticks) const;
+};
+
+struct MacroProgram;
+
+struct MacroEvent
+{
+    uint32_t m_Ticks;       // delay since the previous event
+    XUSB_REPORT m_Report;   // pad state applied from this event onward
+};
+
+// Takes a new value whenever the macro holding it is constructed or assigned, so views
+// built from a macro notice it was replaced even when its event storage was reused
+struct MacroRevision
+{
+    MacroRevision() : m_Value(Next()) {}
+    MacroRevision(const MacroRevision&) : m_Value(Next()) {}
+    MacroRevision& operator=(const MacroRevision&) { m_Value = Next(); return *this; }
+
+    void Bump() { m_Value = Next(); }
+
+    uint64_t m_Value;
+
+private:
+    static uint64_t Next();
+};
+
+struct Macro
+{
+    MacroTimeUnit m_Unit = MacroTimeUnit::Milliseconds;
+    std::vector<MacroEvent> m_Events;
+    uint32_t m_LoopGapTicks = 200;  // idle time between the end and the start of the sequence
+    bool m_MarksEncounters = false; // each completed loop posts one encounter (a reset or battle the macro performs)
+    bool m_StopsOnShiny = false;    // checks the detectors after each loop and stops on a shiny
+    bool m_PlaysOnce = false;       // a single pass instead of looping (attempts tied to a clock time)
+
+    // Compiled script played instead of m_Events when set
+    std::shared_ptr<const MacroProgram> m_Program;
+
+    // Bump after editing m_Events in place
+    MacroRevision m_Revision;
+
+    bool IsEmpty() const { return m_Events.empty() && !m_Program; }
+    void Clear() { m_Events.clear(); m_Program.reset(); }
+    uint64_t GetLengthTicks() const;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <windows.h>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "Macro.h"
+#include "MacroVm.h"
+
+struct MacroCompileError
+{
+    std::string m_File;
+    int m_Line;
+    int m_Column;
+    std::string m_Message;
+
+    std::string ToString() const;
+};
+
+enum class MacroStatementType
+{
+    Press,
+    Release,
+    ReleaseAll,
+    Hold,
+    Wait,
+    Repeat,
+    Sub,
+    Call,
+    Label,
+    Goto,
+    If,
+    Encounter,
+    Halt
+};
+
+struct MacroStatement
+{
+    MacroStatementType m_Type;
+    std::string m_File;
+    int m_Line = 0;
+    int m_Column = 0;
+
+    WORD m_Buttons = 0;
+    uint32_t m_Value = 0;       // ticks for waits and holds, count for repeats
+    MacroTimeUnit m_Unit = MacroTimeUnit::Milliseconds;
+    bool m_IsForever = false;
+    std::string m_Name;         // label, sub or goto target
+    MacroCondition m_Condition = MacroCondition::ShinyDetected;
+    bool m_IsNegated = false;
+    std::vector<MacroStatement> m_Body;
+};
+
+// Compiles the text macro language into a MacroProgram for the VM:
+//
+//   # comments run to the end of the line
+//   unit frames                 durations without a suffix are frames (or ms)
+//   const DELAY = 2 * 30        integer constant expressions
+//   hold A+B 8f                 buttons use the names GetButtonName prints
+//   press START / release START / release all
+//   wait DELAY / wait 120ms / wait 2s
+//   repeat 10 ... end           repeat forever ... end
+//   sub name ... end            call name
+//   label: / goto label / if [not] shiny|frozen|encounter goto label
+//   encounter / halt
+//   include "other.macro"       relative to the including file
+//
+// Repeats of zero or one are removed or inlined, directly nested repeats are merged
+// and consecutive waits are combined before code generation.
+class MacroCompiler
+{
+public:
+    static const size_t s_MaxErrors = 20;
+    static const size_t s_MaxIncludeDepth = 16;
+
+    bool Compile(const std::string& p_Source, const std::string& p_Path, MacroProgram& p_Program);
+    bool CompileFile(const std::string& p_Path, MacroProgram& p_Program);
+
+    const std::vector<MacroCompileError>& GetErrors() const { return m_Errors; }
+    size_t GetFoldedCount() const { return m_FoldedCount; }
+
+    static WORD GetButtonMask(const std::string& p_Name);
+
+private:
+    enum class TokenType
+    {
+        Identifier,
+        Number,
+        String,
+        Symbol,
+        Newline,
+        End
+    };
+
+    struct Token
+    {
+        TokenType m_Type;
+        std::string m_Text;
+        int64_t m_Number;
+        int m_Line;
+        int m_Column;
+    };
+
+    struct FileState
+    {
+        std::string m_Path;
+        std::vector<Token> m_Tokens;
+        size_t m_Position = 0;
+        MacroTimeUnit m_Unit = MacroTimeUnit::Milliseconds;
+    };
+
+    bool Tokenize(const std::string& p_Source, FileState& p_File);
+    bool ParseFile(const std::string& p_Source, const std::string& p_Path, std::vector<MacroStatement>& p_Statements, bool p_IsTopLevel);
+    bool ParseBlock(FileState& p_File, std::vector<MacroStatement>& p_Statements, bool p_IsNested, bool p_IsTopLevel);
+    bool ParseStatement(FileState& p_File, std::vector<MacroStatement>& p_Statements, bool p_IsTopLevel);
+    bool ParseButtons(FileState& p_File, WORD& p_Buttons);
+    bool ParseDuration(FileState& p_File, uint32_t& p_Ticks, MacroTimeUnit& p_Unit);
+    bool ParseExpression(FileState& p_File, int64_t& p_Value);
+    bool ParseTerm(FileState& p_File, int64_t& p_Value);
+    bool ParseFactor(FileState& p_File, int64_t& p_Value);
+
+    const Token& Peek(const FileState& p_File) const { return p_File.m_Tokens[p_File.m_Position]; }
+    const Token& Next(FileState& p_File);
+    bool IsSymbol(const FileState& p_File, char p_Symbol) const;
+    bool IsKeyword(const FileState& p_File, const char* p_Keyword) const;
+    bool ExpectEndOfLine(FileState& p_File);
+    void SkipLine(FileState& p_File);
+    bool AddError(const std::string& p_File, int p_Line, int p_Column, const std::string& p_Message);
+    bool AddError(const FileState& p_File, const Token& p_Token, const std::string& p_Message);
+
+    void Fold(std::vector<MacroStatement>& p_Statements);
+    bool Validate(const std::vector<MacroStatement>& p_Statements);
+    // Innermost repeat or sub around a label; a goto may only target labels in its own enclosing scopes
+    typedef std::map<std::string, const MacroStatement*> ScopeMap;
+    void CollectNames(const std::vector<MacroStatement>& p_Statements, const MacroStatement* p_Scope, ScopeMap& p_Labels, ScopeMap& p_Subs);
+    void CheckReferences(const std::vector<MacroStatement>& p_Statements, std::vector<const MacroStatement*>& p_Scopes, const ScopeMap& p_Labels, const ScopeMap& p_Subs);
+    static bool HasWait(const std::vector<MacroStatement>& p_Statements);
+    void Generate(const std::vector<MacroStatement>& p_Statements, MacroProgramBuilder& p_Builder);
+
+    std::vector<MacroCompileError> m_Errors;
+    std::map<std::string, int64_t> m_Constants;
+    std::set<std::string> m_IncludeStack;  // canonical paths of the files being parsed
+    size_t m_FoldedCount = 0;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Macro.h"
+
+// Macro files: a header, then blocks of varint-encoded events each carrying a CRC-32,
+// then a footer with the totals and a CRC over every block. A file cut short by a crash
+// still loads up to its last complete block.
+struct MacroFileInfo
+{
+    bool m_IsComplete = false;      // footer present and valid
+    uint32_t m_BlockCount = 0;
+    uint64_t m_EventCount = 0;
+    std::string m_Status;
+};
+
+class MacroFile
+{
+public:
+    static const uint32_t s_Version = 1;
+
+    static bool Load(const std::string& p_Path, Macro& p_Macro, MacroFileInfo& p_Info);
+    static uint32_t Crc32(uint32_t p_Crc, const uint8_t* p_Data, size_t p_Size);
+};
+
+// Streams a recording to disk with flat memory use. The recording thread encodes into the
+// active block; full or stale blocks are swapped with the pending one and written by a
+// background thread, so a slow disk only stalls the recorder if both blocks are full.
+class MacroFileWriter
+{
+public:
+    static const size_t s_BlockSize = 64 * 1024;
+    static const int s_MaxBlockAgeMs = 2000;       // at most this much input is lost on a crash
+
+    MacroFileWriter();
+    ~MacroFileWriter();
+
+    bool Open(const std::string& p_Path, MacroTimeUnit p_Unit, uint32_t p_LoopGapTicks);
+    void Append(const MacroEvent& p_Event);
+    bool Finish();
+
+    bool IsOpen() const { return m_IsOpen.load(); }
+    uint64_t GetEventCount() const { return m_EventCount.load(); }
+    uint64_t GetBytesWritten() const { return m_BytesWritten.load(); }
+    std::string GetPath() const;
+    std::string GetError() const;
+
+private:
+    void RunFlush();
+    bool WriteBlock(const std::vector<uint8_t>& p_Payload, uint32_t p_EventCount);
+    void SetError(const std::string& p_Error);
+
+    std::ofstream m_File;
+    std::string m_Path;
+    std::thread m_Thread;
+    std::atomic<bool> m_IsOpen;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::vector<uint8_t> m_ActiveBlock;
+    std::vector<uint8_t> m_PendingBlock;
+    uint32_t m_ActiveEvents;
+    uint32_t m_PendingEvents;
+    bool m_HasPendingBlock;
+    bool m_IsFinishing;
+    std::chrono::steady_clock::time_point m_ActiveBlockStart;
+    std::string m_Error;
+
+    // Flush thread only
+    uint32_t m_BlockCount;
+    uint32_t m_FileCrc;
+
+    std::atomic<uint64_t> m_EventCount;
+    std::atomic<uint64_t> m_BytesWritten;
+};
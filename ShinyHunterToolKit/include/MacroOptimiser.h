@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Macro.h"
+
+struct MacroOptimiserSettings
+{
+    uint32_t m_MinHoldTicks = 0;        // shortest press the game reliably registers
+    uint32_t m_MinReleaseTicks = 0;     // shortest release the game reliably registers between presses
+    uint32_t m_MinIdleTicks = 0;        // default safe delay for idle gaps and the loop gap
+    std::vector<uint32_t> m_SafeIdleTicks;  // per idle gap overrides, indexed like FindIdleGaps()
+};
+
+struct MacroIdleGap
+{
+    size_t m_EventIndex;    // event that ends the gap
+    uint32_t m_Ticks;
+};
+
+// Indices into the trace's state sequence (see Verify) of a state too short for the
+// game to register and of the change that returned from it; Clean drops both
+struct MacroMergedPair
+{
+    size_t m_FirstState;
+    size_t m_SecondState;
+};
+
+struct MacroOptimiserReport
+{
+    size_t m_DroppedEvents = 0;
+    std::vector<MacroMergedPair> m_MergedPairs;
+    size_t m_ShrunkGaps = 0;
+    uint64_t m_CycleTicksBefore = 0;
+    uint64_t m_CycleTicksAfter = 0;
+};
+
+// Offline tightening of recorded macros: drops events that do not change the pad
+// state, merges press/release pairs too short for the game to see, and shrinks
+// idle gaps (nothing held) down to the user's safe minimum delays.
+class MacroOptimiser
+{
+public:
+    static Macro Clean(const Macro& p_Macro, const MacroOptimiserSettings& p_Settings, MacroOptimiserReport* p_Report = nullptr);
+    static std::vector<MacroIdleGap> FindIdleGaps(const Macro& p_Macro);
+    static Macro Optimise(const Macro& p_Macro, const MacroOptimiserSettings& p_Settings, MacroOptimiserReport& p_Report);
+
+    static uint64_t GetCycleTicks(const Macro& p_Macro) { return p_Macro.GetLengthTicks() + p_Macro.m_LoopGapTicks; }
+
+    // Checks the optimised macro against the recording it was made from: its button states,
+    // in order, must be the recording's raw ones less the report's merged pairs, every merge
+    // must really be shorter than the minimum in the recording, and every press and release
+    // must last at least the minimum. Returns an empty string on success.
+    static std::string Verify(const Macro& p_Optimised, const Macro& p_Trace, const MacroOptimiserSettings& p_Settings,
+        const MacroOptimiserReport& p_Report);
+
+private:
+    struct MacroState
+    {
+        XUSB_REPORT m_Report;
+        uint64_t m_Time;    // ticks from the start of the macro
+    };
+
+    static bool IsSameReport(const XUSB_REPORT& p_A, const XUSB_REPORT& p_B);
+    static std::vector<MacroState> GetStateSequence(const Macro& p_Macro);
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <windows.h>
+#include <cstdint>
+#include <vector>
+#include "Macro.h"
+
+// Pad state over a span of the timeline: every button held at some point in it and
+// the range each analog axis covered. Sticks keep only their high byte for drawing.
+struct MacroTimelineSample
+{
+    WORD m_Buttons;
+    uint8_t m_TriggerMin[2];
+    uint8_t m_TriggerMax[2];
+    int8_t m_ThumbMin[4];       // LX, LY, RX, RY
+    int8_t m_ThumbMax[4];
+
+    bool IsEmpty() const { return m_TriggerMin[0] > m_TriggerMax[0]; }
+    void Merge(const MacroTimelineSample& p_Other);
+    static MacroTimelineSample Empty();
+};
+
+// View model for the timeline editor. Build is O(n) and runs only when the macro changes:
+// it stores absolute event times and a pyramid of merged samples (level k covers 2^k
+// events), so any pixel column is answered in O(log n) and a frame only costs
+// O(columns log n) however long the recording is.
+class MacroTimeline
+{
+public:
+    MacroTimeline();
+
+    void Build(const Macro& p_Macro);
+    bool IsBuiltFor(const Macro& p_Macro) const;
+
+    size_t GetEventCount() const { return m_Times.size(); }
+    uint64_t GetEventTime(size_t p_Index) const { return m_Times[p_Index]; }
+    uint64_t GetEventEnd(size_t p_Index) const { return p_Index + 1 < m_Times.size() ? m_Times[p_Index + 1] : m_Length; }
+    uint64_t GetLength() const { return m_Length; }
+    bool HasAnalog() const { return m_HasAnalog; }
+
+    // Event in effect at p_Ticks
+    size_t FindEvent(uint64_t p_Ticks) const;
+    // First event starting at or after p_Ticks (GetEventCount() if none)
+    size_t FindEventAfter(uint64_t p_Ticks) const;
+
+    // One sample per column over [p_Start, p_End); repeated calls for the same view are free
+    const std::vector<MacroTimelineSample>& Sample(uint64_t p_Start, uint64_t p_End, int p_Columns);
+
+    // Edits on an inclusive event range; they bump the macro's revision, so IsBuiltFor turns false
+    static void Cut(Macro& p_Macro, size_t p_First, size_t p_Last);
+    static int64_t Nudge(Macro& p_Macro, size_t p_First, size_t p_Last, int64_t p_Ticks);
+    static void Scale(Macro& p_Macro, size_t p_First, size_t p_Last, double p_Factor);
+
+private:
+    MacroTimelineSample Query(size_t p_First, size_t p_Last) const;
+
+    uint64_t m_SourceRevision;
+    size_t m_SourceSize;
+
+    std::vector<uint64_t> m_Times;
+    uint64_t m_Length;
+    bool m_HasAnalog;
+    std::vector<std::vector<MacroTimelineSample>> m_Levels;
+
+    std::vector<MacroTimelineSample> m_Samples;
+    uint64_t m_SampleStart;
+    uint64_t m_SampleEnd;
+    int m_SampleColumns;
+};
@@ -0,0 +1,146 @@
+#pragma once
+#include <windows.h>
+#include <ViGEm/Client.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Macro.h"
+
+class ViGEmManager;
+
+enum class MacroOpcode : uint8_t
+{
+    Halt,
+    Press,          // m_Buttons added to the pad
+    Release,        // m_Buttons removed from the pad
+    ReleaseAll,
+    SetReport,      // pad set to m_Reports[m_Operand] (recorded macros keep triggers and sticks)
+    Hold,           // press m_Buttons, wait m_Operand ticks, release them
+    Wait,           // m_Operand ticks in the unit given by m_Mode
+    Loop,           // m_Operand iterations (0 repeats forever), matching EndLoop at m_Target
+    EndLoop,        // back to m_Target while iterations remain
+    Jump,           // to m_Target
+    JumpIf,         // to m_Target when condition m_Mode holds
+    JumpIfNot,
+    Call,           // sub-macro at m_Target
+    Return,
+    Encounter       // posts a macro-marker encounter event
+};
+
+enum class MacroCondition : uint8_t
+{
+    ShinyDetected,      // a detector has triggered
+    CounterFrozen,
+    EncounterCounted,   // an encounter was counted since the last check
+    Count
+};
+
+struct MacroInstruction
+{
+    MacroOpcode m_Opcode;
+    uint8_t m_Mode;         // MacroTimeUnit for Wait/Hold, MacroCondition for JumpIf/JumpIfNot
+    WORD m_Buttons;
+    uint32_t m_Operand;
+    uint32_t m_Target;
+};
+
+struct MacroProgram
+{
+    std::vector<MacroInstruction> m_Code;
+    std::vector<XUSB_REPORT> m_Reports;
+    std::vector<std::pair<std::string, uint32_t>> m_Labels;    // for disassembly only
+
+    bool IsEmpty() const { return m_Code.empty(); }
+    std::string Disassemble() const;
+
+    // A recorded macro as a program that repeats forever, timed exactly like the flat player
+    static MacroProgram FromMacro(const Macro& p_Macro);
+
+    static const char* GetOpcodeName(MacroOpcode p_Opcode);
+    static const char* GetConditionName(MacroCondition p_Condition);
+};
+
+// Emits instructions and resolves labels, loops and calls into jump targets
+class MacroProgramBuilder
+{
+public:
+    void Press(WORD p_Buttons);
+    void Release(WORD p_Buttons);
+    void ReleaseAll();
+    void SetReport(const XUSB_REPORT& p_Report);
+    void Hold(WORD p_Buttons, uint32_t p_Ticks, MacroTimeUnit p_Unit);
+    void Wait(uint32_t p_Ticks, MacroTimeUnit p_Unit);
+    void Loop(uint32_t p_Count);
+    bool EndLoop();
+    bool Label(const std::string& p_Name);
+    void Jump(const std::string& p_Label);
+    void JumpIf(MacroCondition p_Condition, const std::string& p_Label, bool p_IsNegated = false);
+    void Call(const std::string& p_Label);
+    void Return();
+    void Encounter();
+    void Halt();
+
+    size_t GetSize() const { return m_Program.m_Code.size(); }
+    bool HasLabel(const std::string& p_Name) const;
+    const std::string& GetError() const { return m_Error; }
+
+    bool Build(MacroProgram& p_Program);
+
+private:
+    struct Fixup
+    {
+        size_t m_Instruction;
+        std::string m_Label;
+    };
+
+    void Emit(MacroOpcode p_Opcode, uint8_t p_Mode = 0, WORD p_Buttons = 0, uint32_t p_Operand = 0, uint32_t p_Target = 0);
+
+    MacroProgram m_Program;
+    std::vector<Fixup> m_Fixups;
+    std::vector<uint32_t> m_OpenLoops;
+    std::string m_Error;
+};
+
+// Runs a MacroProgram on the virtual controller. Loop and call frames live in a fixed
+// stack and deadlines are absolute, so execution never allocates and sleep overshoot
+// never accumulates.
+class MacroVm
+{
+public:
+    static const size_t s_StackDepth = 64;
+    static const uint32_t s_MaxStepsWithoutWait = 1000000;  // guards against loops with no wait in them
+
+    MacroVm(ViGEmManager& p_ViGEmManager);
+
+    // Returns the current value of a condition: non-zero for true, the encounter total for EncounterCounted
+    void SetConditionHandler(std::function<uint64_t(MacroCondition)> p_Handler) { m_ConditionHandler = p_Handler; }
+
+    // Runs until the program halts, p_Stop is raised or an error occurs (returns false)
+    bool Run(const MacroProgram& p_Program, const std::atomic<bool>& p_Stop);
+    const std::string& GetError() const { return m_Error; }
+
+private:
+    struct Frame
+    {
+        uint32_t m_Start;       // loop body start, or return address for calls
+        uint32_t m_End;         // EndLoop position
+        uint32_t m_Remaining;   // 0 repeats forever
+        bool m_IsCall;
+    };
+
+    bool CheckCondition(MacroCondition p_Condition);
+    bool Fail(const char* p_Error, uint32_t p_Pc);
+    void Unwind(uint32_t p_Target);
+
+    ViGEmManager& m_ViGEmManager;
+    std::function<uint64_t(MacroCondition)> m_ConditionHandler;
+    std::array<Frame, s_StackDepth> m_Stack;
+    size_t m_StackSize;
+    uint64_t m_LastEncounterCount;
+    std::string m_Error;
+};
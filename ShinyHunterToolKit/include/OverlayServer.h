@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SharedStatus.h"
+
+// Localhost HTTP and WebSocket server for OBS browser sources. "/" serves a built-in
+// overlay page, "/status.json" a full snapshot and "/ws" a WebSocket that gets the full
+// status as JSON on connect, then only the fields that changed.
+//
+// The GUI hands over each frame's status with Update; the server thread formats the
+// delta once and sends the same bytes to every client, so idle clients cost nothing
+// but a poll slot and never touch the counter or controller threads.
+class OverlayServer
+{
+public:
+    static const size_t s_MaxClients = 64;
+    static const size_t s_ReceiveSize = 2048;
+    static const size_t s_SendSize = 8192;
+    static const int s_PollMs = 25;     // also the longest delay before a change goes out
+    static const int s_DefaultPort = 8765;
+
+    OverlayServer();
+    ~OverlayServer();
+
+    bool Start(int p_Port);
+    void Stop();
+    bool IsRunning() const { return m_IsRunning.load(); }
+
+    // Cheap when nothing changed: one compare under a lock the server holds only to copy
+    void Update(const SharedStatusData& p_Status);
+
+    int GetPort() const { return m_Port; }
+    std::string GetError() const;
+    size_t GetClientCount() const { return m_ClientCount.load(); }
+    size_t GetSocketClientCount() const { return m_SocketClientCount.load(); }
+    uint64_t GetDeltaCount() const { return m_DeltaCount.load(); }
+
+private:
+    // SOCKET values; winsock stays out of this header so it can follow windows.h
+    static const uintptr_t s_InvalidSocket = ~(uintptr_t)0;
+
+    static const size_t s_FieldCount = 20;
+    static const size_t s_FieldSize = 144;     // a 63-character name with every character escaped, plus quotes
+
+    enum class ClientState
+    {
+        Http,
+        WebSocket,
+        Closing         // disconnect once the send buffer drains
+    };
+
+    struct Client
+    {
+        uintptr_t m_Socket = s_InvalidSocket;
+        ClientState m_State = ClientState::Http;
+        char m_Receive[s_ReceiveSize];
+        size_t m_ReceiveSize = 0;
+        char m_Send[s_SendSize];
+        size_t m_SendSize = 0;
+        bool m_IsSnapshotPending = false;   // a delta did not fit, so the next update sends everything
+    };
+
+    void Run();
+    void Accept();
+    void Receive(Client& p_Client);
+    void HandleRequest(Client& p_Client, size_t p_HeaderSize);
+    void HandleFrames(Client& p_Client);
+    void SendResponse(Client& p_Client, const char* p_Status, const char* p_ContentType, const char* p_Body, size_t p_BodySize);
+    bool QueueFrame(Client& p_Client, uint8_t p_Opcode, const char* p_Data, size_t p_Size);
+    void Broadcast();
+    void Flush(Client& p_Client);
+    void Disconnect(Client& p_Client);
+    void SetError(const std::string& p_Error);
+
+    void FormatFields(const SharedStatusData& p_Status);
+    size_t BuildJson(char* p_Buffer, size_t p_Size, bool p_IsDelta);
+
+    uintptr_t m_ListenSocket;
+    std::vector<Client> m_Clients;
+    int m_Port;
+
+    // Written by Update, copied out by the server thread when the version moves
+    std::mutex m_StatusMutex;
+    SharedStatusData m_Status;
+    std::atomic<uint64_t> m_StatusVersion;
+    uint64_t m_SentVersion;
+
+    // Server thread only: each field's JSON value as last formatted and as last sent
+    char m_Fields[s_FieldCount][s_FieldSize];
+    char m_SentFields[s_FieldCount][s_FieldSize];
+    char m_Delta[s_SendSize / 2];
+    char m_Snapshot[s_SendSize / 2];
+
+    std::thread m_Thread;
+    std::atomic<bool> m_IsRunning;
+    std::atomic<size_t> m_ClientCount;
+    std::atomic<size_t> m_SocketClientCount;
+    std::atomic<uint64_t> m_DeltaCount;
+
+    mutable std::mutex m_ErrorMutex;
+    std::string m_Error;
+};
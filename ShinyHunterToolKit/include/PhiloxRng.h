@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Counter-based Philox4x32-10 generator. Every value is a pure function of
+// (seed, stream, position), so a stream gives the same numbers no matter which
+// thread draws it or when. Blocks are generated s_Lanes at a time in
+// structure-of-arrays form so the rounds vectorise.
+class PhiloxRng
+{
+public:
+    static const size_t s_Lanes = 8;
+
+    PhiloxRng(uint64_t p_Seed, uint64_t p_Stream);
+
+    uint32_t NextUInt32();
+    double NextUniform();       // (0, 1), never exactly 0 or 1
+    double NextNormal();        // standard normal
+
+private:
+    void Refill();
+
+    uint32_t m_Key[2];
+    uint32_t m_Stream[2];
+    uint32_t m_NextBlock;
+
+    uint32_t m_Buffer[4 * s_Lanes];
+    size_t m_Used;
+};
@@ -6,6 +6,9 @@
 #include <mutex>
 #include <condition_variable>
 #include <vector>
+#include "Macro.h"
+#include "InputReplayBuffer.h"
+#include "MacroFile.h"
 
 class ShinyCounter;
 class ViGEmManager;
@@ -28,9 +31,16 @@ public:
 	void CheckResetCombo(const XINPUT_STATE& p_ControllerState);
     void CheckRecordCombo(const XINPUT_STATE& p_ControllerState);
     void CheckPlayCombo(const XINPUT_STATE& p_ControllerState);
+    void CheckReplayCombo(const XINPUT_STATE& p_ControllerState);
+    void CheckUndoCombo(const XINPUT_STATE& p_ControllerState);
 
     void SendInputToVirtualController();
 
+    // Safe from any thread (detectors, IPC): the polling thread, which owns playback, acts on
+    // them on its next poll. A stop also tells the VM at once and wins over a pending start.
+    void RequestMacroStart();
+    void RequestMacroStop();
+
     void Update();
 
 	bool IsRunning() const { return m_IsRunning; }
@@ -44,10 +54,11 @@ public:
 
     bool IsPlayComboPressed(const XINPUT_STATE& p_ControllerState);
     void WaitForUserButtonSequence();
-    void StartMacroButtonSequence(const std::vector<std::pair<WORD, std::chrono::milliseconds>>& buttonSequence);
+    void StartMacroButtonSequence(const Macro& p_Macro);
 	void StopMacroButtonSequence();
 	void HandleRecordMacroThread();
 	void HandlePlaybackMacroThread();
+    void UpdateMacroPlayback();
 
 	void StartUpdateThread();
 	void StopUpdateThread();
@@ -61,10 +72,28 @@ public:
     int m_RecordComboDelay = 1;
     bool m_controllerInitialEnagage = false;
     std::atomic<bool> m_IsMacroThreadRunning;
+    std::atomic<bool> m_IsMacroStartRequested = false;
+    std::atomic<bool> m_IsMacroStopRequested = false;
+    std::atomic<bool> m_IsMacroThreadFinished = false;  // set by the macro thread when its program returns
+    std::atomic<uint32_t> m_MacroStopCount = 0;     // lets the GUI notice stops made on other threads
     std::atomic<bool> m_WaitingForUserInputSequence = false;
-    std::vector<std::pair<WORD, std::chrono::milliseconds>> m_ButtonSequence;
+    Macro m_ButtonSequence;
+
+    // Empty records into m_ButtonSequence; otherwise events stream to this file instead
+    void SetRecordingPath(const std::string& p_Path);
+    std::string GetRecordingPath() const;
+    MacroFileWriter m_RecordingWriter;
+
+    // Every poll lands here; BACK + R3 asks the GUI to cut the last seconds into a macro
+    InputReplayBuffer m_ReplayBuffer;
+    std::atomic<bool> m_IsReplayCutRequested = false;
+    static const WORD s_ReplayCombo = XINPUT_GAMEPAD_BACK | XINPUT_GAMEPAD_RIGHT_THUMB;
 
-    bool m_IsControllerConnected;
+    // BACK + L3 undoes the last count change and START + L3 redoes it
+    static const WORD s_UndoCombo = XINPUT_GAMEPAD_BACK | XINPUT_GAMEPAD_LEFT_THUMB;
+    static const WORD s_RedoCombo = XINPUT_GAMEPAD_START | XINPUT_GAMEPAD_LEFT_THUMB;
+
+    std::atomic<bool> m_IsControllerConnected;    // read by the GUI and IPC threads
     XINPUT_STATE m_ControllerState;
 
     std::condition_variable m_ExitCondition;
@@ -81,9 +110,20 @@ private:
 	std::thread m_UpdateThread;
     std::chrono::steady_clock::time_point m_RecordComboStartTime;
     std::thread m_MacroThread;
+    std::mutex m_MacroMutex;    // start and stop come from the GUI and polling threads
+    void StopMacroThread();     // m_MacroMutex held
 
     bool m_IsRunning = false;
 	bool m_IsUpdateThreadRunning = false;
     bool m_WasRecordComboPressed;
     bool m_WasResetComboPressed;
+    bool m_WasReplayComboPressed;
+    bool m_WasUndoComboPressed;
+    bool m_WasRedoComboPressed;
+
+    mutable std::mutex m_RecordingPathMutex;
+    std::string m_RecordingPath;
+
+    XUSB_REPORT m_LastForwardedReport;
+    std::chrono::steady_clock::time_point m_LastForwardTime;
 };
\ No newline at end of file
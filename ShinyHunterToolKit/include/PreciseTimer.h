@@ -0,0 +1,22 @@
+#pragma once
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+
+// Raises the system timer resolution to 1 ms for as long as an instance is alive
+// and provides deadline waits that finish with a short busy-wait, so scheduled
+// inputs land within a fraction of a millisecond instead of the default 15.6 ms tick.
+class PreciseTimer
+{
+public:
+    PreciseTimer();
+    ~PreciseTimer();
+
+    PreciseTimer(const PreciseTimer&) = delete;
+    PreciseTimer& operator=(const PreciseTimer&) = delete;
+
+    static void SleepUntil(std::chrono::steady_clock::time_point p_Deadline, std::chrono::microseconds p_SpinTail = std::chrono::microseconds(1500));
+
+    // Returns false if p_Cancel was raised before the deadline was reached
+    static bool SleepUntil(std::chrono::steady_clock::time_point p_Deadline, const std::atomic<bool>& p_Cancel, std::chrono::microseconds p_SpinTail = std::chrono::microseconds(1500));
+};
@@ -0,0 +1,139 @@
+#pragma once
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Macro.h"
+
+enum class Gen4SeedMethod
+{
+    EggPid,         // MT19937 output, one per frame
+    Method1         // static encounters, LCRNG from the initial seed
+};
+
+// Console/game constants that feed the Gen 5 SHA-1 message, as shown by common RNG tools
+struct Gen5Profile
+{
+    const char* m_Name;
+    uint32_t m_Nazo[5];
+    uint16_t m_VCount;
+    uint16_t m_Timer0Min;
+    uint16_t m_Timer0Max;
+    uint8_t m_VFrame;
+    uint32_t m_GxStat;
+    bool m_Is3ds;
+};
+
+static const Gen5Profile s_Gen5Profiles[] =
+{
+    { "Black (ENG, DS Lite)", { 0x022160B0, 0x022161AC, 0x022161AC, 0x022161F8, 0x022161F8 }, 0x60, 0xC79, 0xC7A, 5, 6, false },
+    { "White (ENG, DS Lite)", { 0x022160D0, 0x022161CC, 0x022161CC, 0x02216218, 0x02216218 }, 0x5F, 0xC68, 0xC69, 5, 6, false },
+    { "Custom", { 0, 0, 0, 0, 0 }, 0, 0, 0, 0, 6, false }
+};
+
+// DS key bits as they appear in the Gen 5 keypress register
+enum Gen5Key : uint16_t
+{
+    GEN5_KEY_A = 1 << 0,
+    GEN5_KEY_B = 1 << 1,
+    GEN5_KEY_SELECT = 1 << 2,
+    GEN5_KEY_START = 1 << 3,
+    GEN5_KEY_RIGHT = 1 << 4,
+    GEN5_KEY_LEFT = 1 << 5,
+    GEN5_KEY_UP = 1 << 6,
+    GEN5_KEY_DOWN = 1 << 7,
+    GEN5_KEY_R = 1 << 8,
+    GEN5_KEY_L = 1 << 9,
+    GEN5_KEY_X = 1 << 10,
+    GEN5_KEY_Y = 1 << 11
+};
+
+struct SeedSearchSettings
+{
+    int m_Generation = 4;
+    uint16_t m_Tid = 0;
+    uint16_t m_Sid = 0;
+    int m_Year = 2000;
+    int m_Month = 1;
+    int m_Day = 1;
+    int m_HourMin = 0;
+    int m_HourMax = 23;
+    uint32_t m_FrameMin = 1;
+    uint32_t m_FrameMax = 20;
+    size_t m_MaxResults = 500;
+
+    // Gen 4
+    Gen4SeedMethod m_Gen4Method = Gen4SeedMethod::EggPid;
+    uint32_t m_DelayMin = 600;
+    uint32_t m_DelayMax = 1200;
+    uint32_t m_PreferredDelay = 700;
+
+    // Gen 5
+    Gen5Profile m_Profile = s_Gen5Profiles[0];
+    uint64_t m_Mac = 0;
+    uint16_t m_AllowedKeys = 0;
+    int m_MaxKeys = 0;
+};
+
+struct SeedSearchTarget
+{
+    uint64_t m_Seed;
+    uint32_t m_Frame;
+    uint32_t m_Pid;
+    int m_Hour;
+    int m_Minute;
+    int m_Second;
+    uint32_t m_Delay;       // Gen 4 only
+    uint16_t m_Timer0;      // Gen 5 only
+    uint16_t m_Keys;        // Gen 5 only, Gen5Key bits held at boot
+};
+
+// Initial-seed searches for Gen 4 (date/time/delay into MT19937 or the LCRNG) and
+// Gen 5 (SHA-1 of the boot message). Candidate seeds are processed eight at a time
+// in structure-of-arrays lanes and the search space is shared between threads.
+class SeedSearch
+{
+public:
+    static const uint32_t s_MaxGen4EggFrame = 227;  // frames reachable without a second MT twist
+
+    SeedSearch();
+    ~SeedSearch();
+
+    bool Start(const SeedSearchSettings& p_Settings, unsigned p_ThreadCount = 0);
+    void Stop();
+
+    bool IsRunning() const { return m_IsRunning.load(); }
+    double GetProgress() const;
+    std::vector<SeedSearchTarget> GetResults() const;
+
+    static std::vector<SeedSearchTarget> Search(const SeedSearchSettings& p_Settings, unsigned p_ThreadCount, const std::atomic<bool>& p_Cancel, std::atomic<uint64_t>& p_ItemsDone);
+    static uint64_t GetWorkItemCount(const SeedSearchSettings& p_Settings);
+
+    static uint32_t GetGen4Seed(int p_Year, int p_Month, int p_Day, int p_Hour, int p_Minute, int p_Second, uint32_t p_Delay);
+    static uint64_t GetGen5Seed(const SeedSearchSettings& p_Settings, uint16_t p_Timer0, uint16_t p_Keys, int p_Hour, int p_Minute, int p_Second);
+    static std::vector<uint16_t> GetGen5KeyCombinations(uint16_t p_AllowedKeys, int p_MaxKeys);
+    static std::string GetGen5KeyName(uint16_t p_Keys);
+
+    // Gen 4: soft reset, then continue with A after the target delay plus p_FrameOffset.
+    // Gen 5: soft reset with the target keys held through boot for p_FrameOffset frames,
+    // played once. The macro cannot see the DS clock, so the user must start it so the
+    // reset lands on the target's second; a retry needs the clock set back first.
+    static Macro ExportTargetToMacro(const SeedSearchTarget& p_Target, int p_Generation, int p_FrameOffset, uint32_t p_LoopGapFrames = 600);
+
+private:
+    static void SearchGen4(const SeedSearchSettings& p_Settings, uint64_t p_Item, std::vector<SeedSearchTarget>& p_Targets);
+    static void SearchGen5(const SeedSearchSettings& p_Settings, const std::vector<uint16_t>& p_KeyCombinations, uint64_t p_Item, std::vector<SeedSearchTarget>& p_Targets);
+    void RunSearch(SeedSearchSettings p_Settings, unsigned p_ThreadCount);
+
+    std::thread m_Thread;
+    std::atomic<bool> m_IsRunning;
+    std::atomic<bool> m_StopSearch;
+    std::atomic<uint64_t> m_ItemsDone;
+    uint64_t m_ItemsTotal;
+
+    mutable std::mutex m_ResultsMutex;
+    std::vector<SeedSearchTarget> m_Results;
+};
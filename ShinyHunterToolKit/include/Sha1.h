@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// SHA-1, as a plain byte hash and as a lane-batched compressor for single-block
+// messages. The batched form keeps each message word in structure-of-arrays
+// layout so every round runs across all lanes at once.
+class Sha1
+{
+public:
+    static const size_t s_Lanes = 8;
+
+    static void Hash(const uint8_t* p_Data, size_t p_Size, uint8_t p_Digest[20]);
+
+    // p_Words holds s_Lanes already padded 64-byte blocks as big-endian words.
+    // p_Digest receives the final hash words (initial state added) for each lane.
+    static void HashBlockLanes(const uint32_t p_Words[16][s_Lanes], uint32_t p_Digest[5][s_Lanes]);
+
+private:
+    static void Compress(uint32_t p_State[5], const uint8_t p_Block[64]);
+};
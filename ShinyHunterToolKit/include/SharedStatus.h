@@ -0,0 +1,146 @@
+#pragma once
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Live status published in a named shared memory block for overlays and monitors.
+// This header is the whole reader library: it needs only windows.h and the standard
+// library, so other tools can copy it as is.
+//
+// The writer bumps m_Sequence to an odd value, copies m_Data and bumps it to the next
+// even value. A reader copies m_Data between two loads of m_Sequence and retries when
+// they differ or the first was odd, so reads never block the app and never tear.
+
+static const char* const s_SharedStatusName = "Local\\ShinyHunterToolKitStatus";
+static const uint32_t s_SharedStatusMagic = 0x53544853;     // "SHTS"
+static const uint32_t s_SharedStatusVersion = 1;
+
+enum SharedStatusFlags : uint32_t
+{
+    SharedStatusFrozen = 1 << 0,
+    SharedStatusMacroRunning = 1 << 1,
+    SharedStatusRecording = 1 << 2,
+    SharedStatusControllerConnected = 1 << 3,
+    SharedStatusStalled = 1 << 4
+};
+
+struct SharedStatusData
+{
+    uint64_t m_UpdatedTime;                 // Unix milliseconds of the last change
+    uint64_t m_TotalAccepted;               // encounters counted this session, from every source
+    uint32_t m_Encounters;
+    uint32_t m_EncountersPerReset;
+    uint32_t m_Generation;
+    uint32_t m_Method;
+    uint32_t m_Flags;
+    uint32_t m_PhaseCount;
+    uint32_t m_HuntId;
+    uint32_t m_EncountersFor90;             // total encounters for a 90% chance of a shiny
+    double m_Probability;
+    double m_CumulativeProbability;
+    double m_ResetsPerHour;                 // over the last 10 minutes, refreshed once a second
+    double m_SessionResetsPerHour;
+    double m_LastCycleSeconds;
+    char m_HuntName[64];
+    char m_Target[64];
+    char m_MethodName[64];
+};
+
+struct SharedStatusBlock
+{
+    uint32_t m_Magic;
+    uint32_t m_Version;
+    uint32_t m_Size;                        // sizeof(SharedStatusBlock) as written
+    std::atomic<uint32_t> m_Sequence;       // odd while m_Data is being written, 0 before the first write
+    std::atomic<uint64_t> m_HeartbeatTime;  // Unix milliseconds, stored once a second while the app runs
+    SharedStatusData m_Data;
+};
+
+// Polls the block another process publishes; Read costs one copy and no system call
+class SharedStatusReader
+{
+public:
+    SharedStatusReader() : m_Mapping(nullptr), m_Block(nullptr) {}
+    ~SharedStatusReader() { Close(); }
+
+    SharedStatusReader(const SharedStatusReader&) = delete;
+    SharedStatusReader& operator=(const SharedStatusReader&) = delete;
+
+    bool Open(const std::string& p_Name = s_SharedStatusName)
+    {
+        Close();
+
+        m_Mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, p_Name.c_str());
+        if (m_Mapping == nullptr)
+        {
+            return false;
+        }
+
+        m_Block = (const SharedStatusBlock*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, sizeof(SharedStatusBlock));
+        if (m_Block == nullptr || m_Block->m_Magic != s_SharedStatusMagic || m_Block->m_Version != s_SharedStatusVersion ||
+            m_Block->m_Size < sizeof(SharedStatusBlock))
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_Block != nullptr)
+        {
+            UnmapViewOfFile(m_Block);
+            m_Block = nullptr;
+        }
+        if (m_Mapping != nullptr)
+        {
+            CloseHandle(m_Mapping);
+            m_Mapping = nullptr;
+        }
+    }
+
+    bool IsOpen() const { return m_Block != nullptr; }
+
+    // False until the app has published once, or if the writer kept it busy for every try
+    bool Read(SharedStatusData& p_Data, int p_MaxTries = 64) const
+    {
+        if (m_Block == nullptr)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < p_MaxTries; ++i)
+        {
+            uint32_t before = m_Block->m_Sequence.load(std::memory_order_acquire);
+            if (before == 0)
+            {
+                return false;
+            }
+            if (before & 1)
+            {
+                YieldProcessor();
+                continue;
+            }
+
+            std::memcpy(&p_Data, (const void*)&m_Block->m_Data, sizeof(p_Data));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (m_Block->m_Sequence.load(std::memory_order_relaxed) == before)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Changes whenever the data does, so a poller can skip Read until it moves
+    uint32_t GetSequence() const { return m_Block != nullptr ? m_Block->m_Sequence.load(std::memory_order_acquire) : 0; }
+    uint64_t GetHeartbeatTime() const { return m_Block != nullptr ? m_Block->m_HeartbeatTime.load(std::memory_order_relaxed) : 0; }
+
+private:
+    HANDLE m_Mapping;
+    const SharedStatusBlock* m_Block;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include "SharedStatus.h"
+
+// Owns the shared memory block and publishes into it under the seqlock. The first
+// instance takes the plain name; later ones append their process id.
+class SharedStatusWriter
+{
+public:
+    SharedStatusWriter();
+    ~SharedStatusWriter();
+
+    bool Open();
+    void Close();
+    bool IsOpen() const { return m_Block != nullptr; }
+    const std::string& GetName() const { return m_Name; }
+
+    // Writes only when p_Data differs from the last publish; stamps m_UpdatedTime
+    bool Publish(const SharedStatusData& p_Data);
+    void Heartbeat();
+
+    uint64_t GetPublishCount() const { return m_PublishCount; }
+
+private:
+    HANDLE m_Mapping;
+    SharedStatusBlock* m_Block;
+    std::string m_Name;
+    SharedStatusData m_Last;
+    uint64_t m_PublishCount;
+};
@@ -1,7 +1,16 @@
 #pragma once
+#include <atomic>
 #include <string>
+#include <vector>
+#include "EncounterEventPipeline.h"
+#include "EncounterHistory.h"
+#include "EncounterStats.h"
+#include "HuntJournal.h"
+#include "HuntPhases.h"
+#include "ShinyOdds.h"
 
 class ImGuiApp;
+struct HuntProfile;
 
 class ShinyCounter
 {
@@ -10,15 +19,63 @@ public:
 
     std::string SetGeneration(int p_Generation);
     std::string SetEncountersPerReset(int p_EncountersPerReset);
+    // Journalled like Counter; call through the pipeline so counting threads are held off
     std::string SetCurrentEncounters(int p_CurrentEncounters);
 
+    // Sets the count without an undo record (loading a hunt, undo itself)
+    void RestoreCurrentEncounters(int p_CurrentEncounters);
+    std::string SetMethod(int p_Method);
+
     void Counter();
 
+    // Revert or re-apply the newest count change; call through the pipeline so counting threads are held off
+    bool Undo(HuntJournalEntry& p_Entry);
+    bool Redo(HuntJournalEntry& p_Entry);
+
+    // Closes the current phase with the shiny that ended it and restarts the count from zero;
+    // call through the pipeline as well
+    HuntPhase EndPhase(const std::string& p_Shiny);
+    void SetPhases(const std::vector<HuntPhase>& p_Phases, int64_t p_PhaseStartTime);
+    const std::vector<HuntPhase>& GetPhases() const { return m_Phases; }
+    const HuntPhaseTotals& GetPhaseTotals() const { return m_PhaseTotals; }
+    int64_t GetPhaseStartTime() const { return m_PhaseStartTime; }
+
+    // Loads a hunt's count, phases and settings and opens its journal, taking the count from
+    // the journal if it changed after the profile was saved; call through the pipeline.
+    // Returns the generation result, empty if the profile has none.
+    std::string SwitchHunt(HuntProfile& p_Profile, const std::string& p_JournalPath);
+    uint32_t GetHuntId() const { return m_HuntId; }
+
+    // While frozen, resets are not counted (e.g. after a shiny has been detected)
+    void SetFrozen(bool p_IsFrozen) { m_IsFrozen = p_IsFrozen; }
+    bool IsFrozen() const { return m_IsFrozen.load(); }
+
     int GetCurrentEncounters() const { return m_CurrentEncounters; }
+    double GetShinyProbability() const { return m_OddsEngine.GetProbability(); }
+    const ShinyMethod& GetMethod() const { return GetShinyMethod(m_Generation, m_Method); }
+
+    EncounterStats& GetEncounterStats() { return m_EncounterStats; }
+    const EncounterHistory& GetEncounterHistory() const { return m_EncounterHistory; }
+    EncounterEventPipeline& GetEncounterPipeline() { return m_EncounterPipeline; }
+    const ShinyOddsEngine& GetOddsEngine() const { return m_OddsEngine; }
+    HuntJournal& GetHuntJournal() { return m_HuntJournal; }
 
     int m_Generation;
     int m_EncountersPerReset;
     int m_CurrentEncounters;
+    int m_Method;
 
     ImGuiApp* m_ImGuiApp;
+
+private:
+    EncounterStats m_EncounterStats;
+    EncounterHistory m_EncounterHistory;
+    ShinyOddsEngine m_OddsEngine;
+    EncounterEventPipeline m_EncounterPipeline;
+    HuntJournal m_HuntJournal;
+    std::vector<HuntPhase> m_Phases;
+    HuntPhaseTotals m_PhaseTotals;
+    int64_t m_PhaseStartTime;
+    uint32_t m_HuntId;
+    std::atomic<bool> m_IsFrozen;
 };
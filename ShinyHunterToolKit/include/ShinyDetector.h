@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FrameSource.h"
+
+enum class DetectionMode
+{
+    Palette,        // fraction of pixels close to any reference colour
+    Histogram       // colour histogram similarity to a captured reference
+};
+
+struct DetectionRegion
+{
+    static const size_t s_HistogramBins = 64;  // 4 levels per channel
+
+    std::string m_Name = "Region";
+    int m_X = 0;
+    int m_Y = 0;
+    int m_Width = 32;
+    int m_Height = 32;
+    DetectionMode m_Mode = DetectionMode::Palette;
+
+    std::vector<uint32_t> m_Palette;    // 0xRRGGBB
+    int m_Tolerance = 16;               // per channel
+    float m_Threshold = 0.1f;           // palette: matching fraction, histogram: similarity
+    bool m_MatchWhenDifferent = false;  // histogram: match when similarity falls below the threshold instead
+    int m_ConsecutiveFrames = 3;        // frames in a row before a match counts
+    bool m_CountsEncounters = false;    // battle-start region: reported once per appearance instead of latching
+
+    std::vector<float> m_Reference;     // normalised histogram, empty until captured
+};
+
+struct RegionScore
+{
+    float m_Score;
+    bool m_IsMatch;
+    bool m_IsNewMatch;  // first frame the match has held for the required frames
+};
+
+struct ShinyDetectorStats
+{
+    uint64_t m_FramesAnalysed = 0;
+    double m_FramesPerSecond = 0.0;
+    double m_CaptureMicroseconds = 0.0;     // exponential moving averages
+    double m_AnalysisMicroseconds = 0.0;
+    std::vector<RegionScore> m_Scores;
+    std::string m_MatchedRegion;            // empty until triggered
+    uint64_t m_EncountersDetected = 0;
+};
+
+// Samples user-defined regions of each frame and compares them with reference
+// palettes or histograms using SSE2 kernels (scalar fallback elsewhere). Runs a
+// frame source on its own thread and latches on the first shiny match until re-armed;
+// encounter regions report every new appearance without latching.
+class ShinyDetector
+{
+public:
+    ShinyDetector();
+    ~ShinyDetector();
+
+    void SetRegions(const std::vector<DetectionRegion>& p_Regions);
+    std::vector<DetectionRegion> GetRegions() const;
+
+    bool Start(std::unique_ptr<FrameSource> p_Source, double p_MaxFps, std::function<void(const DetectionRegion&)> p_OnMatch);
+    void Stop();
+    bool IsRunning() const { return m_IsRunning.load(); }
+
+    void Rearm();
+    bool IsTriggered() const { return m_IsTriggered.load(); }
+
+    // Stores the region's histogram from the next analysed frame as its reference
+    void RequestReference(size_t p_Region);
+
+    ShinyDetectorStats GetStats() const;
+    std::string GetSourceError() const;
+
+    static float GetPaletteScore(const VideoFrame& p_Frame, const DetectionRegion& p_Region);
+    static void GetHistogram(const VideoFrame& p_Frame, const DetectionRegion& p_Region, float* p_Histogram);
+    static float GetHistogramSimilarity(const float* p_First, const float* p_Second);
+
+private:
+    void RunDetection(std::unique_ptr<FrameSource> p_Source, double p_MaxFps, std::function<void(const DetectionRegion&)> p_OnMatch);
+    std::vector<RegionScore> Analyse(const VideoFrame& p_Frame);
+
+    std::thread m_Thread;
+    std::atomic<bool> m_IsRunning;
+    std::atomic<bool> m_StopDetection;
+    std::atomic<bool> m_IsTriggered;
+    std::atomic<int> m_ReferenceRequest;
+
+    mutable std::mutex m_RegionsMutex;
+    std::vector<DetectionRegion> m_Regions;
+    std::vector<int> m_MatchStreaks;
+
+    mutable std::mutex m_StatsMutex;
+    ShinyDetectorStats m_Stats;
+    std::string m_SourceError;
+};
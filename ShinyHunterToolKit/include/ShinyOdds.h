@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct ShinyMethod
+{
+    int m_Generation;
+    const char* m_Name;
+    uint32_t m_BaseDenominator;     // odds of a single shiny roll
+    uint32_t m_Rolls;               // shiny rolls per encounter (charm, Masuda and chain bonuses)
+};
+
+// Base odds per generation and hunting method. Bonus methods are expressed as extra
+// rolls against the generation's base odds, matching how the games implement them.
+constexpr ShinyMethod s_ShinyMethods[] =
+{
+    { 1, "Full Odds (DV transfer)", 8192, 1 },
+    { 2, "Full Odds", 8192, 1 },
+    { 2, "Shiny Parent Breeding", 64, 1 },
+    { 3, "Full Odds", 8192, 1 },
+    { 4, "Full Odds", 8192, 1 },
+    { 4, "Masuda Method", 8192, 5 },
+    { 4, "Poke Radar Chain 40", 8192, 41 },
+    { 5, "Full Odds", 8192, 1 },
+    { 5, "Shiny Charm", 8192, 3 },
+    { 5, "Masuda Method", 8192, 6 },
+    { 5, "Masuda Method + Shiny Charm", 8192, 8 },
+    { 6, "Full Odds", 4096, 1 },
+    { 6, "Shiny Charm", 4096, 3 },
+    { 6, "Masuda Method", 4096, 6 },
+    { 6, "Masuda Method + Shiny Charm", 4096, 8 },
+    { 6, "Chain Fishing 20+", 4096, 41 },
+    { 7, "Full Odds", 4096, 1 },
+    { 7, "Shiny Charm", 4096, 3 },
+    { 7, "Masuda Method", 4096, 6 },
+    { 7, "Masuda Method + Shiny Charm", 4096, 8 },
+    { 7, "SOS Chain 31+", 4096, 13 },
+    { 7, "SOS Chain 31+ + Shiny Charm", 4096, 15 },
+};
+
+constexpr size_t s_ShinyMethodCount = sizeof(s_ShinyMethods) / sizeof(s_ShinyMethods[0]);
+
+constexpr size_t GetShinyMethodCount(int p_Generation)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < s_ShinyMethodCount; ++i)
+    {
+        if (s_ShinyMethods[i].m_Generation == p_Generation) ++count;
+    }
+    return count;
+}
+
+// Returns the p_Index'th method of a generation, or the first table entry if out of range
+constexpr const ShinyMethod& GetShinyMethod(int p_Generation, size_t p_Index)
+{
+    for (size_t i = 0; i < s_ShinyMethodCount; ++i)
+    {
+        if (s_ShinyMethods[i].m_Generation == p_Generation)
+        {
+            if (p_Index == 0) return s_ShinyMethods[i];
+            --p_Index;
+        }
+    }
+    return s_ShinyMethods[0];
+}
+
+static_assert(GetShinyMethodCount(1) > 0 && GetShinyMethodCount(7) > 0, "every generation needs at least full odds");
+
+// Tracks the probability of having seen at least one shiny. The log of the chance of
+// no shiny so far is accumulated per encounter, so a method change mid-hunt keeps the
+// earlier encounters at their own odds, each increment is O(1), and the result stays
+// accurate for any number of encounters.
+class ShinyOddsEngine
+{
+public:
+    static const size_t s_MilestoneCount = 5;
+    static constexpr double s_Milestones[s_MilestoneCount] = { 0.5, 0.75, 0.9, 0.95, 0.99 };
+
+    ShinyOddsEngine();
+
+    static double GetProbability(const ShinyMethod& p_Method);
+
+    void SetProbability(double p_Probability);
+    void Reset(uint64_t p_Encounters);
+    void AddEncounters(uint64_t p_Encounters);
+
+    double GetProbability() const { return m_Probability; }
+    uint64_t GetEncounters() const { return m_Encounters; }
+    double GetCumulativeProbability() const;
+
+    // Mean number of shinies over the encounters so far (the Poisson rate matching the cumulative probability)
+    double GetExpectedShinies() const { return -m_LogNoShiny; }
+
+    // Encounters (from zero) at which the cumulative probability reaches p_Target at the current rate
+    uint64_t GetEncountersForProbability(double p_Target) const;
+
+private:
+    double m_Probability;
+    double m_LogMissRate;       // log(1 - p) per encounter
+    double m_LogNoShiny;        // log P(no shiny so far)
+    uint64_t m_Encounters;
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <windows.h>
+#include <ViGEm/Client.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Macro.h"
+
+class ViGEmManager;
+
+struct TimedPress
+{
+    std::string m_Name;
+    WORD m_Buttons;
+    double m_OffsetMs;      // from the reset anchor
+    double m_HoldMs;
+};
+
+struct TimedPressResult
+{
+    std::string m_Name;
+    double m_TargetMs;
+    double m_AchievedMs;    // when the report reached the driver, relative to the anchor
+    double m_ErrorMs;
+};
+
+// Plays a handful of critical presses (reset, boot, continue, encounter...) at exact
+// offsets from a reset anchor. The worker pins itself to one core at time-critical
+// priority and finishes every wait with a busy-spin, then logs the offset each press
+// actually achieved so the calibration can be nudged after a miss.
+class TimedResetExecutor
+{
+public:
+    TimedResetExecutor(ViGEmManager& p_ViGEmManager);
+    ~TimedResetExecutor();
+
+    bool Start(const std::vector<TimedPress>& p_Presses);
+    void Stop();
+    bool IsRunning() const { return m_IsRunning.load(); }
+
+    // Shifts every press after the anchor; positive values press later
+    void NudgeCalibration(double p_Ms);
+    void SetCalibration(double p_Ms) { m_CalibrationMs = p_Ms; }
+    double GetCalibration() const { return m_CalibrationMs.load(); }
+
+    std::vector<TimedPressResult> GetLog() const;
+    double GetMeanError() const;
+
+    // Each non-neutral macro event becomes a press held until the next event
+    static std::vector<TimedPress> GetPressesFromMacro(const Macro& p_Macro, const MacroTimebase& p_Timebase);
+
+private:
+    void Execute(std::vector<TimedPress> p_Presses);
+
+    ViGEmManager& m_ViGEmManager;
+
+    std::thread m_Thread;
+    std::atomic<bool> m_IsRunning;
+    std::atomic<bool> m_StopExecutor;
+    std::atomic<double> m_CalibrationMs;
+
+    mutable std::mutex m_LogMutex;
+    std::vector<TimedPressResult> m_Log;
+};
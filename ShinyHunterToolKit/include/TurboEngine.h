@@ -0,0 +1,50 @@
+#pragma once
+#include <windows.h>
+#include <ViGEm/Client.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+class ViGEmManager;
+
+struct TurboSettings
+{
+    double m_FrequencyHz = 10.0;    // taps per second
+    double m_DutyCycle = 0.5;       // fraction of each period the buttons are held down
+    double m_FrameRate = 60.0;      // game frame rate, a tap needs one frame down and one frame up
+    WORD m_AlternateButtons = 0;    // when set, every other tap presses these buttons instead
+};
+
+class TurboEngine
+{
+public:
+    TurboEngine(ViGEmManager& p_ViGEmManager);
+
+    void SetSettings(const TurboSettings& p_Settings);
+    TurboSettings GetSettings() const;
+
+    void Run(WORD p_Buttons);
+    void Stop();
+
+    double GetAchievedRate() const { return m_AchievedRate.load(); }
+
+    // Two frames make the slowest tap of 1 press/s, the lowest rate the engine runs at
+    static constexpr double s_MinFrameRate = 2.0;
+    static double GetMaxFrequency(double p_FrameRate) { return p_FrameRate * 0.5; }
+
+private:
+    static const size_t s_RateWindow = 32;
+
+    void RecordTap(std::chrono::steady_clock::time_point p_TapTime);
+
+    ViGEmManager& m_ViGEmManager;
+
+    mutable std::mutex m_SettingsMutex;
+    TurboSettings m_Settings;
+
+    std::atomic<bool> m_StopTurbo;
+    std::atomic<double> m_AchievedRate;
+
+    std::chrono::steady_clock::time_point m_TapTimes[s_RateWindow];
+    size_t m_TapCount;
+};
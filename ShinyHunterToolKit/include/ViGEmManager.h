@@ -6,6 +6,12 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <mutex>
+#include "TurboEngine.h"
+#include "TimedResetExecutor.h"
+#include "Macro.h"
+#include "EncounterEventPipeline.h"
+#include "MacroVm.h"
 
 class ViGEmManager
 {
@@ -27,10 +33,24 @@ public:
 
     void PressUserButtonRepeatedly(WORD p_Button);
     void StopPressingUserButton();
+    TurboEngine& GetTurboEngine() { return m_TurboEngine; }
+    TimedResetExecutor& GetTimedResetExecutor() { return m_TimedResetExecutor; }
 
-    void PressUserMacroRepeatedly(const std::vector<std::pair<WORD, std::chrono::milliseconds>>& buttonSequence);
+    void PressUserMacroRepeatedly(const Macro& p_Macro);
+    void RunMacroProgram(const MacroProgram& p_Program);
+    std::string GetMacroError() const;
 	void StopUserMacro();
 
+    // Receives the encounter markers of macros that are played back
+    void SetEncounterPipeline(EncounterEventPipeline* p_Pipeline) { m_EncounterPipeline = p_Pipeline; }
+    void PostEncounterMarker();
+
+    // Answers the branch conditions of macro programs (detector and counter state)
+    void SetMacroConditionHandler(std::function<uint64_t(MacroCondition)> p_Handler) { m_MacroConditionHandler = p_Handler; }
+
+    void SetMacroTimebase(const MacroTimebase& p_Timebase);
+    MacroTimebase GetMacroTimebase() const;
+
     bool m_IsVirtualControllerConnected;
 
     std::string GetButtonName(WORD p_Button)
@@ -52,10 +72,32 @@ public:
         default: return "NULL";
         }
     }
+
+    std::string GetChordName(WORD p_Buttons)
+    {
+        std::string name;
+        for (WORD bit = 1; bit != 0; bit <<= 1)
+        {
+            if ((p_Buttons & bit) && GetButtonName(bit) != "NULL")
+            {
+                name += name.empty() ? GetButtonName(bit) : " + " + GetButtonName(bit);
+            }
+        }
+        return name.empty() ? "NULL" : name;
+    }
 private:
     PVIGEM_CLIENT m_Client;
     PVIGEM_TARGET m_VirtualController;
     WORD m_PreviousButtonState;
-    std::atomic<bool> m_StopPressingUserButton;
+    TurboEngine m_TurboEngine;
+    TimedResetExecutor m_TimedResetExecutor;
     std::atomic<bool> m_StopUserMacro;
+    EncounterEventPipeline* m_EncounterPipeline;
+    std::function<uint64_t(MacroCondition)> m_MacroConditionHandler;
+
+    mutable std::mutex m_MacroErrorMutex;
+    std::string m_MacroError;
+
+    mutable std::mutex m_TimebaseMutex;
+    MacroTimebase m_MacroTimebase;
 };
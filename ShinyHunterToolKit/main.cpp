@@ -6,19 +6,28 @@
 
 #include <glfw3.h>
 #include "include/ImGuiApp.h"
+#include "include/Logger.h"
 
 #ifdef _WIN32
 int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nCmdShow)
 {
-    ImGuiApp app;
-    app.Run();
+    Logger::Start("shtk.log");
+    {
+        ImGuiApp app;
+        app.Run();
+    }
+    Logger::Stop();
     return 0;
 }
 #endif
 
 int main()
 {
-    ImGuiApp app;
-    app.Run();
+    Logger::Start("shtk.log");
+    {
+        ImGuiApp app;
+        app.Run();
+    }
+    Logger::Stop();
     return 0;
 }
\ No newline at end of file
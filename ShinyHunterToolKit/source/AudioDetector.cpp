@@ -0,0 +1,506 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "../include/AudioDetector.h"
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_DETECTOR_SSE2
+#endif
+
+static const double s_Pi = 3.14159265358979323846;
+static const float s_LowestBandHz = 150.0f;
+static const float s_HighestBandHz = 11000.0f;
+static const size_t s_HistoryFrames = 256;     // about 3 seconds of hops at 44.1 kHz
+static const float s_DynamicRange = 3.0f;      // 30 dB, in log10 units
+
+// FFT --------------------------------------------------------------------------
+
+Fft::Fft(size_t p_Size)
+    : m_Size(p_Size), m_BitReverse(p_Size), m_TwiddleReal(p_Size > 1 ? p_Size - 1 : 0), m_TwiddleImag(p_Size > 1 ? p_Size - 1 : 0)
+{
+    if (p_Size < 2 || (p_Size & (p_Size - 1)) != 0)
+    {
+        throw std::runtime_error("FFT size must be a power of two");
+    }
+
+    int bits = 0;
+    while (((size_t)1 << bits) < p_Size)
+    {
+        ++bits;
+    }
+
+    for (size_t i = 0; i < p_Size; ++i)
+    {
+        uint32_t reversed = 0;
+        for (int bit = 0; bit < bits; ++bit)
+        {
+            reversed |= (uint32_t)((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        m_BitReverse[i] = reversed;
+    }
+
+    for (size_t half = 1; half < p_Size; half <<= 1)
+    {
+        for (size_t j = 0; j < half; ++j)
+        {
+            double angle = -s_Pi * (double)j / (double)half;
+            m_TwiddleReal[half - 1 + j] = (float)std::cos(angle);
+            m_TwiddleImag[half - 1 + j] = (float)std::sin(angle);
+        }
+    }
+}
+
+void Fft::Transform(float* p_Real, float* p_Imag) const
+{
+    for (size_t i = 0; i < m_Size; ++i)
+    {
+        size_t j = m_BitReverse[i];
+        if (j > i)
+        {
+            std::swap(p_Real[i], p_Real[j]);
+            std::swap(p_Imag[i], p_Imag[j]);
+        }
+    }
+
+    for (size_t half = 1; half < m_Size; half <<= 1)
+    {
+        const float* twiddleReal = m_TwiddleReal.data() + half - 1;
+        const float* twiddleImag = m_TwiddleImag.data() + half - 1;
+
+        for (size_t group = 0; group < m_Size; group += half * 2)
+        {
+            float* aReal = p_Real + group;
+            float* aImag = p_Imag + group;
+            float* bReal = aReal + half;
+            float* bImag = aImag + half;
+            size_t j = 0;
+
+#ifdef AUDIO_DETECTOR_SSE2
+            for (; j + 4 <= half; j += 4)
+            {
+                __m128 wr = _mm_loadu_ps(twiddleReal + j);
+                __m128 wi = _mm_loadu_ps(twiddleImag + j);
+                __m128 br = _mm_loadu_ps(bReal + j);
+                __m128 bi = _mm_loadu_ps(bImag + j);
+                __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+                __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+                __m128 ar = _mm_loadu_ps(aReal + j);
+                __m128 ai = _mm_loadu_ps(aImag + j);
+                _mm_storeu_ps(aReal + j, _mm_add_ps(ar, tr));
+                _mm_storeu_ps(aImag + j, _mm_add_ps(ai, ti));
+                _mm_storeu_ps(bReal + j, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(bImag + j, _mm_sub_ps(ai, ti));
+            }
+#endif
+
+            for (; j < half; ++j)
+            {
+                float tr = bReal[j] * twiddleReal[j] - bImag[j] * twiddleImag[j];
+                float ti = bReal[j] * twiddleImag[j] + bImag[j] * twiddleReal[j];
+                bReal[j] = aReal[j] - tr;
+                bImag[j] = aImag[j] - ti;
+                aReal[j] += tr;
+                aImag[j] += ti;
+            }
+        }
+    }
+}
+
+// Band Analyser ----------------------------------------------------------------
+
+AudioDetector::BandAnalyser::BandAnalyser(int p_SampleRate)
+    : m_Fft(s_FftSize), m_Window(s_FftSize), m_Real(s_FftSize), m_Imag(s_FftSize), m_Power(s_FftSize / 2 + 1)
+{
+    for (size_t i = 0; i < s_FftSize; ++i)
+    {
+        m_Window[i] = (float)(0.5 - 0.5 * std::cos(2.0 * s_Pi * (double)i / (double)s_FftSize));
+    }
+
+    // Log-spaced band edges, each band at least one bin wide
+    float highest = std::min(s_HighestBandHz, p_SampleRate * 0.5f);
+    float binHz = (float)p_SampleRate / s_FftSize;
+    size_t maxBin = s_FftSize / 2;
+    for (size_t band = 0; band <= s_BandCount; ++band)
+    {
+        float edgeHz = s_LowestBandHz * std::pow(highest / s_LowestBandHz, (float)band / s_BandCount);
+        size_t bin = (size_t)std::lround(edgeHz / binHz);
+        if (band > 0)
+        {
+            bin = std::max(bin, m_BandStart[band - 1] + 1);
+        }
+        m_BandStart[band] = std::min(bin, maxBin - (s_BandCount - band));
+    }
+}
+
+float AudioDetector::BandAnalyser::Analyse(const float* p_Samples, float* p_Bands)
+{
+    float sumSquares = 0.0f;
+    for (size_t i = 0; i < s_FftSize; ++i)
+    {
+        sumSquares += p_Samples[i] * p_Samples[i];
+        m_Real[i] = p_Samples[i] * m_Window[i];
+    }
+    std::fill(m_Imag.begin(), m_Imag.end(), 0.0f);
+
+    m_Fft.Transform(m_Real.data(), m_Imag.data());
+
+    size_t bins = m_Power.size();
+    size_t i = 0;
+#ifdef AUDIO_DETECTOR_SSE2
+    for (; i + 4 <= bins; i += 4)
+    {
+        __m128 real = _mm_loadu_ps(m_Real.data() + i);
+        __m128 imag = _mm_loadu_ps(m_Imag.data() + i);
+        _mm_storeu_ps(m_Power.data() + i, _mm_add_ps(_mm_mul_ps(real, real), _mm_mul_ps(imag, imag)));
+    }
+#endif
+    for (; i < bins; ++i)
+    {
+        m_Power[i] = m_Real[i] * m_Real[i] + m_Imag[i] * m_Imag[i];
+    }
+
+    for (size_t band = 0; band < s_BandCount; ++band)
+    {
+        float energy = 0.0f;
+        for (size_t bin = m_BandStart[band]; bin < m_BandStart[band + 1]; ++bin)
+        {
+            energy += m_Power[bin];
+        }
+        p_Bands[band] = std::log10(energy / (m_BandStart[band + 1] - m_BandStart[band]) + 1e-10f);
+    }
+
+    return std::sqrt(sumSquares / s_FftSize);
+}
+
+// Fingerprints -----------------------------------------------------------------
+
+std::vector<float> AudioDetector::NormalisePattern(const float* p_Frames)
+{
+    const size_t size = s_PatternFrames * s_BandCount;
+    std::vector<float> pattern(p_Frames, p_Frames + size);
+
+    // Bands more than s_DynamicRange below the loudest are noise floor; flattening them
+    // stops a clean clip and the same sound over background noise looking different
+    float loudest = *std::max_element(pattern.begin(), pattern.end());
+    float mean = 0.0f;
+    for (float& value : pattern)
+    {
+        value = std::max(value, loudest - s_DynamicRange);
+        mean += value;
+    }
+    mean /= size;
+
+    float length = 0.0f;
+    for (float& value : pattern)
+    {
+        value -= mean;
+        length += value * value;
+    }
+
+    length = std::sqrt(length);
+    for (float& value : pattern)
+    {
+        value = length > 0.0f ? value / length : 0.0f;
+    }
+
+    return pattern;
+}
+
+std::vector<float> AudioDetector::GetPattern(const std::vector<float>& p_Frames, const std::vector<float>& p_Levels, size_t p_FrameCount)
+{
+    if (p_FrameCount < s_PatternFrames)
+    {
+        return {};
+    }
+
+    // The window with the most energy is the sound itself rather than the silence around it
+    float windowLevel = 0.0f;
+    for (size_t i = 0; i < s_PatternFrames; ++i)
+    {
+        windowLevel += p_Levels[i];
+    }
+
+    float bestLevel = windowLevel;
+    size_t bestStart = 0;
+    for (size_t start = 1; start + s_PatternFrames <= p_FrameCount; ++start)
+    {
+        windowLevel += p_Levels[start + s_PatternFrames - 1] - p_Levels[start - 1];
+        if (windowLevel > bestLevel)
+        {
+            bestLevel = windowLevel;
+            bestStart = start;
+        }
+    }
+
+    return NormalisePattern(p_Frames.data() + bestStart * s_BandCount);
+}
+
+bool AudioDetector::CreateFingerprint(AudioSource& p_Source, const std::string& p_Name, AudioFingerprint& p_Fingerprint)
+{
+    if (!p_Source.Open())
+    {
+        return false;
+    }
+
+    std::vector<float> samples;
+    std::atomic<bool> isCancelled(false);
+    while (p_Source.Read(samples, 65536, isCancelled))
+    {
+    }
+
+    BandAnalyser analyser(p_Source.GetSampleRate());
+    p_Source.Close();
+
+    std::vector<float> frames;
+    std::vector<float> levels;
+    float bands[s_BandCount];
+    for (size_t offset = 0; offset + s_FftSize <= samples.size(); offset += s_HopSize)
+    {
+        levels.push_back(analyser.Analyse(samples.data() + offset, bands));
+        frames.insert(frames.end(), bands, bands + s_BandCount);
+    }
+
+    std::vector<float> pattern = GetPattern(frames, levels, levels.size());
+    if (pattern.empty())
+    {
+        return false;
+    }
+
+    p_Fingerprint.m_Name = p_Name;
+    p_Fingerprint.m_Pattern = pattern;
+    return true;
+}
+
+float AudioDetector::GetSimilarity(const std::vector<float>& p_Pattern, const float* p_Frames)
+{
+    if (p_Pattern.size() != s_PatternFrames * s_BandCount)
+    {
+        return 0.0f;
+    }
+
+    std::vector<float> frames = NormalisePattern(p_Frames);
+    float similarity = 0.0f;
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        similarity += frames[i] * p_Pattern[i];
+    }
+    return similarity;
+}
+
+// Detector ---------------------------------------------------------------------
+
+AudioDetector::AudioDetector()
+    : m_IsRunning(false), m_StopDetection(false), m_MinimumLevelDb(-50.0f),
+    m_RequestedAction(AudioMatchAction::HaltMacro), m_IsFingerprintRequested(false)
+{
+}
+
+AudioDetector::~AudioDetector()
+{
+    Stop();
+}
+
+void AudioDetector::SetFingerprints(const std::vector<AudioFingerprint>& p_Fingerprints)
+{
+    std::lock_guard<std::mutex> lock(m_FingerprintsMutex);
+    m_Fingerprints = p_Fingerprints;
+    m_LastMatches.assign(m_Fingerprints.size(), std::chrono::steady_clock::time_point());
+}
+
+std::vector<AudioFingerprint> AudioDetector::GetFingerprints() const
+{
+    std::lock_guard<std::mutex> lock(m_FingerprintsMutex);
+    return m_Fingerprints;
+}
+
+void AudioDetector::RequestFingerprint(const std::string& p_Name, AudioMatchAction p_Action)
+{
+    std::lock_guard<std::mutex> lock(m_FingerprintsMutex);
+    m_RequestedName = p_Name;
+    m_RequestedAction = p_Action;
+    m_IsFingerprintRequested = true;
+}
+
+AudioDetectorStats AudioDetector::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    return m_Stats;
+}
+
+std::string AudioDetector::GetSourceError() const
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    return m_SourceError;
+}
+
+bool AudioDetector::Start(std::unique_ptr<AudioSource> p_Source, std::function<void(const AudioFingerprint&)> p_OnMatch)
+{
+    if (m_IsRunning.load() || !p_Source)
+    {
+        return false;
+    }
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_StatsMutex);
+        m_Stats = AudioDetectorStats();
+        m_SourceError.clear();
+    }
+
+    m_StopDetection = false;
+    m_IsRunning = true;
+    m_Thread = std::thread(&AudioDetector::RunDetection, this, std::move(p_Source), p_OnMatch);
+    return true;
+}
+
+void AudioDetector::Stop()
+{
+    m_StopDetection = true;
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+}
+
+void AudioDetector::RunDetection(std::unique_ptr<AudioSource> p_Source, std::function<void(const AudioFingerprint&)> p_OnMatch)
+{
+    using namespace std::chrono;
+
+    if (!p_Source->Open())
+    {
+        std::lock_guard<std::mutex> lock(m_StatsMutex);
+        m_SourceError = "Failed to open " + p_Source->GetName() + ".";
+        m_IsRunning = false;
+        return;
+    }
+
+    BandAnalyser analyser(p_Source->GetSampleRate());
+    std::vector<float> samples;
+    size_t offset = 0;
+
+    // Recent band frames, oldest first, for matching and for capturing new fingerprints
+    std::vector<float> history;
+    std::vector<float> levels;
+    float bands[s_BandCount];
+
+    while (!m_StopDetection)
+    {
+        if (!p_Source->Read(samples, s_HopSize, m_StopDetection))
+        {
+            if (!m_StopDetection)
+            {
+                std::lock_guard<std::mutex> lock(m_StatsMutex);
+                m_SourceError = p_Source->GetName() + " has no more audio.";
+            }
+            break;
+        }
+
+        while (samples.size() - offset >= s_FftSize && !m_StopDetection)
+        {
+            auto analysisStart = steady_clock::now();
+
+            float level = analyser.Analyse(samples.data() + offset, bands);
+            offset += s_HopSize;
+
+            history.insert(history.end(), bands, bands + s_BandCount);
+            levels.push_back(level);
+            if (levels.size() > s_HistoryFrames)
+            {
+                history.erase(history.begin(), history.begin() + s_BandCount);
+                levels.erase(levels.begin());
+            }
+
+            float recentLevel = 0.0f;
+            size_t recentFrames = std::min(levels.size(), s_PatternFrames);
+            for (size_t i = levels.size() - recentFrames; i < levels.size(); ++i)
+            {
+                recentLevel = std::max(recentLevel, levels[i]);
+            }
+            float levelDb = 20.0f * std::log10(recentLevel + 1e-6f);
+
+            std::vector<float> recent;
+            if (levels.size() >= s_PatternFrames)
+            {
+                recent = NormalisePattern(history.data() + (levels.size() - s_PatternFrames) * s_BandCount);
+            }
+
+            std::vector<float> scores;
+            std::vector<AudioFingerprint> matches;
+            {
+                std::lock_guard<std::mutex> lock(m_FingerprintsMutex);
+
+                if (m_IsFingerprintRequested)
+                {
+                    AudioFingerprint fingerprint;
+                    fingerprint.m_Name = m_RequestedName;
+                    fingerprint.m_Action = m_RequestedAction;
+                    fingerprint.m_Pattern = GetPattern(history, levels, levels.size());
+                    if (!fingerprint.m_Pattern.empty())
+                    {
+                        m_Fingerprints.push_back(fingerprint);
+                        m_LastMatches.push_back(steady_clock::now());
+                    }
+                    m_IsFingerprintRequested = false;
+                }
+
+                auto now = steady_clock::now();
+                for (size_t i = 0; i < m_Fingerprints.size(); ++i)
+                {
+                    const AudioFingerprint& fingerprint = m_Fingerprints[i];
+                    float score = 0.0f;
+                    if (!recent.empty() && fingerprint.m_Pattern.size() == recent.size())
+                    {
+                        for (size_t j = 0; j < recent.size(); ++j)
+                        {
+                            score += recent[j] * fingerprint.m_Pattern[j];
+                        }
+                    }
+                    scores.push_back(score);
+
+                    if (score >= fingerprint.m_Threshold && levelDb >= m_MinimumLevelDb.load() &&
+                        now - m_LastMatches[i] >= milliseconds(fingerprint.m_CooldownMs))
+                    {
+                        m_LastMatches[i] = now;
+                        matches.push_back(fingerprint);
+                    }
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_StatsMutex);
+                double analysisMicroseconds = duration<double, std::micro>(steady_clock::now() - analysisStart).count();
+                m_Stats.m_AnalysisMicroseconds = m_Stats.m_FramesAnalysed == 0 ? analysisMicroseconds : m_Stats.m_AnalysisMicroseconds + (analysisMicroseconds - m_Stats.m_AnalysisMicroseconds) * 0.05;
+                ++m_Stats.m_FramesAnalysed;
+                m_Stats.m_LevelDb = levelDb;
+                m_Stats.m_Scores = scores;
+                for (const AudioFingerprint& match : matches)
+                {
+                    m_Stats.m_LastMatch = match.m_Name;
+                    ++m_Stats.m_MatchCount;
+                }
+            }
+
+            for (const AudioFingerprint& match : matches)
+            {
+                if (p_OnMatch)
+                {
+                    p_OnMatch(match);
+                }
+            }
+        }
+
+        // Drop consumed samples once enough have built up to make the move worthwhile
+        if (offset >= s_FftSize * 4)
+        {
+            samples.erase(samples.begin(), samples.begin() + offset);
+            offset = 0;
+        }
+    }
+
+    p_Source->Close();
+    m_IsRunning = false;
+}
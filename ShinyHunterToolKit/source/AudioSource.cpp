@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "../include/AudioSource.h"
+#include "../include/Logger.h"
+
+#pragma comment(lib, "winmm.lib")
+
+// Audio File -------------------------------------------------------------------
+
+AudioFileSource::AudioFileSource(const std::string& p_Path, bool p_Loop, int p_RawSampleRate)
+    : m_Path(p_Path), m_Loop(p_Loop), m_RawSampleRate(p_RawSampleRate), m_File(nullptr),
+    m_SampleRate(0), m_Channels(0), m_BitsPerSample(0), m_IsFloat(false), m_DataStart(0), m_DataSize(0), m_DataRead(0)
+{
+}
+
+AudioFileSource::~AudioFileSource()
+{
+    Close();
+}
+
+bool AudioFileSource::Open()
+{
+    Close();
+
+    m_File = fopen(m_Path.c_str(), "rb");
+    if (m_File == nullptr)
+    {
+        Logger::Error("Failed to open audio file {}", m_Path);
+        return false;
+    }
+
+    if (m_RawSampleRate > 0)
+    {
+        fseek(m_File, 0, SEEK_END);
+        m_DataSize = (uint32_t)ftell(m_File);
+        fseek(m_File, 0, SEEK_SET);
+
+        m_SampleRate = m_RawSampleRate;
+        m_Channels = 1;
+        m_BitsPerSample = 16;
+        m_IsFloat = false;
+        m_DataStart = 0;
+    }
+    else if (!ReadWavHeader())
+    {
+        Logger::Error("Unsupported or corrupt WAV file {}", m_Path);
+        Close();
+        return false;
+    }
+
+    m_DataRead = 0;
+    return true;
+}
+
+void AudioFileSource::Close()
+{
+    if (m_File != nullptr)
+    {
+        fclose(m_File);
+        m_File = nullptr;
+    }
+}
+
+bool AudioFileSource::ReadWavHeader()
+{
+    uint8_t riff[12];
+    if (fread(riff, 1, 12, m_File) != 12 || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0)
+    {
+        return false;
+    }
+
+    bool hasFormat = false;
+    uint8_t chunkHeader[8];
+    while (fread(chunkHeader, 1, 8, m_File) == 8)
+    {
+        uint32_t chunkSize;
+        memcpy(&chunkSize, chunkHeader + 4, 4);
+
+        if (memcmp(chunkHeader, "fmt ", 4) == 0)
+        {
+            uint8_t format[40] = {};
+            size_t formatSize = std::min<size_t>(chunkSize, sizeof(format));
+            if (chunkSize < 16 || fread(format, 1, formatSize, m_File) != formatSize)
+            {
+                return false;
+            }
+
+            uint16_t formatTag, channels, bitsPerSample;
+            uint32_t sampleRate;
+            memcpy(&formatTag, format, 2);
+            memcpy(&channels, format + 2, 2);
+            memcpy(&sampleRate, format + 4, 4);
+            memcpy(&bitsPerSample, format + 14, 2);
+
+            // WAVE_FORMAT_EXTENSIBLE keeps the real format tag at the start of the sub-format GUID
+            if (formatTag == 0xFFFE && formatSize >= 26)
+            {
+                memcpy(&formatTag, format + 24, 2);
+            }
+
+            m_IsFloat = formatTag == 3;
+            if ((formatTag != 1 && !m_IsFloat) || channels == 0 || sampleRate == 0 ||
+                (m_IsFloat ? bitsPerSample != 32 : (bitsPerSample != 8 && bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32)))
+            {
+                return false;
+            }
+
+            m_Channels = channels;
+            m_SampleRate = (int)sampleRate;
+            m_BitsPerSample = bitsPerSample;
+            hasFormat = true;
+            fseek(m_File, (long)(chunkSize - formatSize + (chunkSize & 1)), SEEK_CUR);
+        }
+        else if (memcmp(chunkHeader, "data", 4) == 0)
+        {
+            m_DataStart = ftell(m_File);
+            m_DataSize = chunkSize;
+            return hasFormat;
+        }
+        else
+        {
+            // Chunks are word aligned
+            fseek(m_File, (long)(chunkSize + (chunkSize & 1)), SEEK_CUR);
+        }
+    }
+
+    return false;
+}
+
+bool AudioFileSource::Read(std::vector<float>& p_Samples, size_t p_Count, const std::atomic<bool>& /*p_Cancel*/)
+{
+    if (m_File == nullptr)
+    {
+        return false;
+    }
+
+    size_t bytesPerFrame = (size_t)m_Channels * (m_BitsPerSample / 8);
+    size_t samplesRead = 0;
+
+    while (samplesRead < p_Count)
+    {
+        if (m_DataRead + bytesPerFrame > m_DataSize)
+        {
+            if (!m_Loop || m_DataSize < bytesPerFrame)
+            {
+                break;
+            }
+            fseek(m_File, m_DataStart, SEEK_SET);
+            m_DataRead = 0;
+        }
+
+        size_t framesWanted = std::min(p_Count - samplesRead, (size_t)(m_DataSize - m_DataRead) / bytesPerFrame);
+        m_Buffer.resize(framesWanted * bytesPerFrame);
+        size_t framesGot = fread(m_Buffer.data(), bytesPerFrame, framesWanted, m_File);
+        if (framesGot == 0)
+        {
+            m_DataRead = m_DataSize;
+            continue;
+        }
+        m_DataRead += (uint32_t)(framesGot * bytesPerFrame);
+
+        const uint8_t* bytes = m_Buffer.data();
+        for (size_t frame = 0; frame < framesGot; ++frame)
+        {
+            float sum = 0.0f;
+            for (int channel = 0; channel < m_Channels; ++channel, bytes += m_BitsPerSample / 8)
+            {
+                switch (m_BitsPerSample)
+                {
+                case 8:
+                    sum += (bytes[0] - 128) / 128.0f;
+                    break;
+                case 16:
+                {
+                    int16_t value;
+                    memcpy(&value, bytes, 2);
+                    sum += value / 32768.0f;
+                    break;
+                }
+                case 24:
+                {
+                    int32_t value = (int32_t)((uint32_t)bytes[0] << 8 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 24) >> 8;
+                    sum += value / 8388608.0f;
+                    break;
+                }
+                default:
+                    if (m_IsFloat)
+                    {
+                        float value;
+                        memcpy(&value, bytes, 4);
+                        sum += value;
+                    }
+                    else
+                    {
+                        int32_t value;
+                        memcpy(&value, bytes, 4);
+                        sum += value / 2147483648.0f;
+                    }
+                    break;
+                }
+            }
+            p_Samples.push_back(sum / m_Channels);
+        }
+        samplesRead += framesGot;
+    }
+
+    return samplesRead > 0;
+}
+
+// Wave In ----------------------------------------------------------------------
+
+WaveInAudioSource::WaveInAudioSource(int p_SampleRate, UINT p_Device)
+    : m_SampleRate(p_SampleRate), m_Device(p_Device), m_WaveIn(nullptr), m_Headers(), m_NextBuffer(0)
+{
+}
+
+WaveInAudioSource::~WaveInAudioSource()
+{
+    Close();
+}
+
+bool WaveInAudioSource::Open()
+{
+    Close();
+
+    WAVEFORMATEX format = {};
+    format.wFormatTag = WAVE_FORMAT_PCM;
+    format.nChannels = 1;
+    format.nSamplesPerSec = (DWORD)m_SampleRate;
+    format.wBitsPerSample = 16;
+    format.nBlockAlign = 2;
+    format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+
+    if (waveInOpen(&m_WaveIn, m_Device, &format, 0, 0, CALLBACK_NULL) != MMSYSERR_NOERROR)
+    {
+        Logger::Error("Failed to open recording device");
+        m_WaveIn = nullptr;
+        return false;
+    }
+
+    // About 20 ms per buffer keeps latency low while leaving the driver plenty queued
+    size_t bufferSamples = std::max(m_SampleRate / 50, 256);
+    for (int i = 0; i < s_BufferCount; ++i)
+    {
+        m_Buffers[i].assign(bufferSamples, 0);
+        m_Headers[i] = WAVEHDR();
+        m_Headers[i].lpData = (LPSTR)m_Buffers[i].data();
+        m_Headers[i].dwBufferLength = (DWORD)(bufferSamples * sizeof(int16_t));
+        waveInPrepareHeader(m_WaveIn, &m_Headers[i], sizeof(WAVEHDR));
+        waveInAddBuffer(m_WaveIn, &m_Headers[i], sizeof(WAVEHDR));
+    }
+
+    m_NextBuffer = 0;
+    if (waveInStart(m_WaveIn) != MMSYSERR_NOERROR)
+    {
+        Logger::Error("Failed to start recording");
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void WaveInAudioSource::Close()
+{
+    if (m_WaveIn == nullptr)
+    {
+        return;
+    }
+
+    waveInReset(m_WaveIn);
+    for (int i = 0; i < s_BufferCount; ++i)
+    {
+        waveInUnprepareHeader(m_WaveIn, &m_Headers[i], sizeof(WAVEHDR));
+    }
+    waveInClose(m_WaveIn);
+    m_WaveIn = nullptr;
+}
+
+bool WaveInAudioSource::Read(std::vector<float>& p_Samples, size_t p_Count, const std::atomic<bool>& p_Cancel)
+{
+    if (m_WaveIn == nullptr)
+    {
+        return false;
+    }
+
+    size_t samplesRead = 0;
+    while (samplesRead < p_Count)
+    {
+        WAVEHDR& header = m_Headers[m_NextBuffer];
+        if (!(header.dwFlags & WHDR_DONE))
+        {
+            // A stalled or unplugged device never completes the buffer, so Stop must not wait on it
+            if (p_Cancel.load())
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        const int16_t* samples = m_Buffers[m_NextBuffer].data();
+        size_t count = header.dwBytesRecorded / sizeof(int16_t);
+        for (size_t i = 0; i < count; ++i)
+        {
+            p_Samples.push_back(samples[i] / 32768.0f);
+        }
+        samplesRead += count;
+
+        // Hand the buffer straight back to the driver
+        header.dwFlags &= ~WHDR_DONE;
+        waveInAddBuffer(m_WaveIn, &header, sizeof(WAVEHDR));
+        m_NextBuffer = (m_NextBuffer + 1) % s_BufferCount;
+    }
+
+    return true;
+}
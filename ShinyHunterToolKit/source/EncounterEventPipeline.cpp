@@ -0,0 +1,163 @@
+#include "../include/EncounterEventPipeline.h"
+#include "../include/ShinyCounter.h"
+
+EncounterEventPipeline::EncounterEventPipeline(ShinyCounter& p_ShinyCounter)
+    : m_ShinyCounter(p_ShinyCounter), m_DeduplicationWindow(2000), m_HasAccepted(false)
+{
+    for (bool& isEnabled : m_IsEnabled)
+    {
+        isEnabled = true;
+    }
+}
+
+bool EncounterEventPipeline::Post(EncounterSource p_Source)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto now = std::chrono::steady_clock::now();
+    EncounterSourceStats& stats = m_Stats[(int)p_Source];
+    ++stats.m_Received;
+    stats.m_LastEvent = now;
+
+    if (!m_IsEnabled[(int)p_Source] || m_ShinyCounter.IsFrozen())
+    {
+        ++stats.m_Ignored;
+        return false;
+    }
+
+    bool isExplicit = p_Source == EncounterSource::Manual || p_Source == EncounterSource::Remote;
+    if (!isExplicit && m_HasAccepted && now - m_LastAccepted < m_DeduplicationWindow)
+    {
+        ++stats.m_Duplicates;
+        return false;
+    }
+
+    // Counting under the lock also serialises the detector, macro and controller threads
+    m_ShinyCounter.Counter();
+    ++stats.m_Accepted;
+    m_LastAccepted = now;
+    m_HasAccepted = true;
+    return true;
+}
+
+bool EncounterEventPipeline::Undo(HuntJournalEntry& p_Entry)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ShinyCounter.Undo(p_Entry);
+}
+
+bool EncounterEventPipeline::Redo(HuntJournalEntry& p_Entry)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ShinyCounter.Redo(p_Entry);
+}
+
+std::string EncounterEventPipeline::SetCurrentEncounters(int p_CurrentEncounters)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ShinyCounter.SetCurrentEncounters(p_CurrentEncounters);
+}
+
+HuntPhase EncounterEventPipeline::EndPhase(const std::string& p_Shiny)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ShinyCounter.EndPhase(p_Shiny);
+}
+
+std::string EncounterEventPipeline::SwitchHunt(HuntProfile& p_Profile, const std::string& p_JournalPath)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ShinyCounter.SwitchHunt(p_Profile, p_JournalPath);
+}
+
+void EncounterEventPipeline::SetDeduplicationWindow(std::chrono::milliseconds p_Window)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_DeduplicationWindow = p_Window;
+}
+
+std::chrono::milliseconds EncounterEventPipeline::GetDeduplicationWindow() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_DeduplicationWindow;
+}
+
+void EncounterEventPipeline::SetSourceEnabled(EncounterSource p_Source, bool p_IsEnabled)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_IsEnabled[(int)p_Source] = p_IsEnabled;
+}
+
+bool EncounterEventPipeline::IsSourceEnabled(EncounterSource p_Source) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_IsEnabled[(int)p_Source];
+}
+
+EncounterCounterSnapshot EncounterEventPipeline::GetCounterSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    EncounterCounterSnapshot snapshot;
+    snapshot.m_Encounters = m_ShinyCounter.GetCurrentEncounters();
+    snapshot.m_EncountersPerReset = m_ShinyCounter.m_EncountersPerReset;
+    snapshot.m_Generation = m_ShinyCounter.m_Generation;
+    snapshot.m_Method = m_ShinyCounter.m_Method;
+    snapshot.m_PhaseCount = m_ShinyCounter.GetPhaseTotals().GetPhaseCount();
+    snapshot.m_UndoCount = m_ShinyCounter.GetHuntJournal().GetUndoCount();
+    snapshot.m_HuntId = m_ShinyCounter.GetHuntId();
+    snapshot.m_Probability = m_ShinyCounter.GetOddsEngine().GetProbability();
+    snapshot.m_CumulativeProbability = m_ShinyCounter.GetOddsEngine().GetCumulativeProbability();
+    for (const EncounterSourceStats& stats : m_Stats)
+    {
+        snapshot.m_TotalAccepted += stats.m_Accepted;
+    }
+    return snapshot;
+}
+
+EncounterSourceStats EncounterEventPipeline::GetSourceStats(EncounterSource p_Source) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats[(int)p_Source];
+}
+
+uint64_t EncounterEventPipeline::GetTotalAccepted() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    uint64_t total = 0;
+    for (const EncounterSourceStats& stats : m_Stats)
+    {
+        total += stats.m_Accepted;
+    }
+    return total;
+}
+
+void EncounterEventPipeline::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (EncounterSourceStats& stats : m_Stats)
+    {
+        stats = EncounterSourceStats();
+    }
+}
+
+const char* EncounterEventPipeline::GetSourceName(EncounterSource p_Source)
+{
+    switch (p_Source)
+    {
+    case EncounterSource::ResetCombo:
+        return "Reset Combo";
+    case EncounterSource::Manual:
+        return "Manual";
+    case EncounterSource::MacroMarker:
+        return "Macro Marker";
+    case EncounterSource::ImageDetector:
+        return "Image Detector";
+    case EncounterSource::AudioDetector:
+        return "Audio Detector";
+    case EncounterSource::Remote:
+        return "Remote Command";
+    default:
+        return "Unknown";
+    }
+}
@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/EncounterHistory.h"
+
+// Candidates per output point when downsampling through the pyramid
+static const size_t s_CandidatesPerPoint = 4;
+
+// Series -----------------------------------------------------------------------
+
+void HistorySeries::Append(float p_X, float p_Y)
+{
+    uint32_t index = (uint32_t)m_Points.size();
+    m_Points.push_back({ p_X, p_Y });
+    if (index == 0)
+    {
+        return;
+    }
+
+    // Only the buckets containing the new point change, so an append is O(log n).
+    // The top level always holds a single bucket covering every point.
+    for (size_t level = 0; ; ++level)
+    {
+        if (level == m_Levels.size())
+        {
+            Bucket top = level == 0 ? MergeBuckets(MakeBucket(0), MakeBucket(1)) : MergeBuckets(m_Levels[level - 1][0], m_Levels[level - 1][1]);
+            m_Levels.emplace_back(1, top);
+            break;
+        }
+
+        std::vector<Bucket>& buckets = m_Levels[level];
+        size_t bucketIndex = index >> (level + 1);
+        if (bucketIndex == buckets.size())
+        {
+            buckets.push_back(MakeBucket(index));
+        }
+        else
+        {
+            buckets[bucketIndex] = MergeBuckets(buckets[bucketIndex], MakeBucket(index));
+        }
+
+        if (buckets.size() == 1)
+        {
+            break;
+        }
+    }
+}
+
+HistorySeries::Bucket HistorySeries::MakeBucket(uint32_t p_Index) const
+{
+    return { p_Index, p_Index };
+}
+
+HistorySeries::Bucket HistorySeries::MergeBuckets(const Bucket& p_First, const Bucket& p_Second) const
+{
+    Bucket bucket;
+    bucket.m_MinIndex = m_Points[p_Second.m_MinIndex].m_Y < m_Points[p_First.m_MinIndex].m_Y ? p_Second.m_MinIndex : p_First.m_MinIndex;
+    bucket.m_MaxIndex = m_Points[p_Second.m_MaxIndex].m_Y > m_Points[p_First.m_MaxIndex].m_Y ? p_Second.m_MaxIndex : p_First.m_MaxIndex;
+    return bucket;
+}
+
+void HistorySeries::Clear()
+{
+    m_Points.clear();
+    m_Levels.clear();
+}
+
+void HistorySeries::Truncate(size_t p_Size)
+{
+    if (p_Size >= m_Points.size())
+    {
+        return;
+    }
+
+    std::vector<HistoryPoint> points(m_Points.begin(), m_Points.begin() + p_Size);
+    Clear();
+    for (const HistoryPoint& point : points)
+    {
+        Append(point.m_X, point.m_Y);
+    }
+}
+
+void HistorySeries::Lttb(const std::vector<HistoryPoint>& p_Points, size_t p_PointCount, std::vector<HistoryPoint>& p_Output)
+{
+    size_t count = p_Points.size();
+    if (count <= p_PointCount || p_PointCount < 3)
+    {
+        p_Output.insert(p_Output.end(), p_Points.begin(), p_Points.end());
+        return;
+    }
+
+    // First and last points are kept; the rest are split into p_PointCount - 2 buckets
+    double bucketSize = (double)(count - 2) / (p_PointCount - 2);
+    size_t selected = 0;
+    p_Output.push_back(p_Points[0]);
+
+    for (size_t bucket = 0; bucket < p_PointCount - 2; ++bucket)
+    {
+        size_t start = (size_t)(bucket * bucketSize) + 1;
+        size_t end = std::min((size_t)((bucket + 1) * bucketSize) + 1, count - 1);
+
+        // Average of the next bucket (just the last point for the final bucket)
+        size_t nextStart = end;
+        size_t nextEnd = std::min((size_t)((bucket + 2) * bucketSize) + 1, count);
+        double averageX = 0.0;
+        double averageY = 0.0;
+        for (size_t i = nextStart; i < nextEnd; ++i)
+        {
+            averageX += p_Points[i].m_X;
+            averageY += p_Points[i].m_Y;
+        }
+        averageX /= std::max<size_t>(nextEnd - nextStart, 1);
+        averageY /= std::max<size_t>(nextEnd - nextStart, 1);
+
+        // Keep the point forming the largest triangle with the last kept point and that average
+        const HistoryPoint& previous = p_Points[selected];
+        double bestArea = -1.0;
+        size_t best = start;
+        for (size_t i = start; i < end; ++i)
+        {
+            double area = std::fabs((previous.m_X - averageX) * (p_Points[i].m_Y - previous.m_Y) -
+                (previous.m_X - p_Points[i].m_X) * (averageY - previous.m_Y));
+            if (area > bestArea)
+            {
+                bestArea = area;
+                best = i;
+            }
+        }
+
+        p_Output.push_back(p_Points[best]);
+        selected = best;
+    }
+
+    p_Output.push_back(p_Points[count - 1]);
+}
+
+void HistorySeries::Downsample(float p_MinX, float p_MaxX, size_t p_PointCount, std::vector<HistoryPoint>& p_Output) const
+{
+    p_Output.clear();
+
+    auto byX = [](const HistoryPoint& p_Point, float p_X) { return p_Point.m_X < p_X; };
+    size_t first = std::lower_bound(m_Points.begin(), m_Points.end(), p_MinX, byX) - m_Points.begin();
+    size_t last = std::lower_bound(m_Points.begin(), m_Points.end(), p_MaxX, byX) - m_Points.begin();
+
+    // One point either side so the line runs to the plot edges
+    first = first > 0 ? first - 1 : 0;
+    last = std::min(last + 1, m_Points.size());
+    if (first >= last)
+    {
+        return;
+    }
+
+    size_t count = last - first;
+    size_t candidateLimit = std::max<size_t>(p_PointCount, 3) * s_CandidatesPerPoint;
+    if (count <= candidateLimit)
+    {
+        std::vector<HistoryPoint> points(m_Points.begin() + first, m_Points.begin() + last);
+        Lttb(points, p_PointCount, p_Output);
+        return;
+    }
+
+    // Coarsest level that still gives each output point a few buckets' worth of candidates
+    size_t level = 0;
+    while (level + 1 < m_Levels.size() && (count >> (level + 2)) * 2 >= candidateLimit)
+    {
+        ++level;
+    }
+
+    const std::vector<Bucket>& buckets = m_Levels[level];
+    size_t firstBucket = first >> (level + 1);
+    size_t lastBucket = std::min((last - 1) >> (level + 1), buckets.size() - 1);
+
+    // Each bucket offers its extremes in order; LTTB then chooses among them
+    std::vector<HistoryPoint> candidates;
+    candidates.reserve((lastBucket - firstBucket + 1) * 2 + 2);
+    candidates.push_back(m_Points[first]);
+    for (size_t i = firstBucket; i <= lastBucket; ++i)
+    {
+        uint32_t low = std::min(buckets[i].m_MinIndex, buckets[i].m_MaxIndex);
+        uint32_t high = std::max(buckets[i].m_MinIndex, buckets[i].m_MaxIndex);
+        candidates.push_back(m_Points[low]);
+        if (high != low)
+        {
+            candidates.push_back(m_Points[high]);
+        }
+    }
+    candidates.push_back(m_Points[last - 1]);
+
+    Lttb(candidates, p_PointCount, p_Output);
+}
+
+// History ----------------------------------------------------------------------
+
+EncounterHistory::EncounterHistory()
+{
+    Reset();
+}
+
+void EncounterHistory::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_SessionStart = std::chrono::steady_clock::now();
+    m_LastResetSeconds = 0.0;
+    m_Encounters.Clear();
+    m_CycleTimes.Clear();
+}
+
+void EncounterHistory::RecordReset(int p_CurrentEncounters)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_SessionStart).count();
+    if (!m_Encounters.IsEmpty())
+    {
+        m_CycleTimes.Append((float)seconds, (float)(seconds - m_LastResetSeconds));
+    }
+    m_Encounters.Append((float)seconds, (float)p_CurrentEncounters);
+    m_LastResetSeconds = seconds;
+}
+
+void EncounterHistory::RemoveLastReset(int p_Encounters)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (m_Encounters.IsEmpty() || m_Encounters.GetLast().m_Y != (float)p_Encounters)
+    {
+        return;
+    }
+
+    // Every reset after the first also added a cycle time
+    m_Encounters.Truncate(m_Encounters.GetSize() - 1);
+    m_CycleTimes.Truncate(m_Encounters.IsEmpty() ? 0 : m_Encounters.GetSize() - 1);
+    m_LastResetSeconds = m_Encounters.IsEmpty() ? 0.0 : m_Encounters.GetLast().m_X;
+}
+
+float EncounterHistory::GetSessionSeconds() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - m_SessionStart).count();
+}
+
+size_t EncounterHistory::GetResetCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Encounters.GetSize();
+}
+
+void EncounterHistory::GetEncounterPlot(float p_MinX, float p_MaxX, size_t p_PointCount, std::vector<HistoryPoint>& p_Output) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Encounters.Downsample(p_MinX, p_MaxX, p_PointCount, p_Output);
+}
+
+void EncounterHistory::GetCycleTimePlot(float p_MinX, float p_MaxX, size_t p_PointCount, std::vector<HistoryPoint>& p_Output) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_CycleTimes.Downsample(p_MinX, p_MaxX, p_PointCount, p_Output);
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "../include/EncounterStats.h"
+
+static const uint32_t s_WindowMs[EncounterStats::s_WindowCount] = { 60u * 1000u, 10u * 60u * 1000u, 60u * 60u * 1000u };
+static const char* s_WindowNames[EncounterStats::s_WindowCount] = { "1 min", "10 min", "60 min" };
+
+// Histogram buckets grow by a quarter octave from 250 ms, covering up to ~4 minutes
+static const double s_HistogramBaseMs = 250.0;
+static const double s_HistogramBucketsPerOctave = 4.0;
+
+EncounterStats::EncounterStats()
+{
+    Reset();
+}
+
+void EncounterStats::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_SessionStart = std::chrono::steady_clock::now();
+    m_Head = 0;
+    m_LastCycleMs = 0;
+    std::memset(m_Timestamps, 0, sizeof(m_Timestamps));
+    std::memset(m_WindowTail, 0, sizeof(m_WindowTail));
+    std::memset(m_HistogramCounts, 0, sizeof(m_HistogramCounts));
+}
+
+uint32_t EncounterStats::GetNowMs() const
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_SessionStart).count();
+}
+
+void EncounterStats::RecordReset()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    uint32_t nowMs = GetNowMs();
+
+    if (m_Head > 0)
+    {
+        m_LastCycleMs = nowMs - m_Timestamps[(m_Head - 1) % s_RingCapacity];
+        ++m_HistogramCounts[GetHistogramBucket(m_LastCycleMs)];
+    }
+
+    m_Timestamps[m_Head % s_RingCapacity] = nowMs;
+    ++m_Head;
+
+    EvictWindows(nowMs);
+}
+
+void EncounterStats::EvictWindows(uint32_t p_NowMs)
+{
+    // Each tail only ever moves forward, so eviction is amortised O(1) per reset
+    for (size_t w = 0; w < s_WindowCount; ++w)
+    {
+        uint64_t& tail = m_WindowTail[w];
+
+        // Entries overwritten by the ring are no longer available to the window
+        if (m_Head - tail > s_RingCapacity)
+        {
+            tail = m_Head - s_RingCapacity;
+        }
+
+        while (tail < m_Head && p_NowMs - m_Timestamps[tail % s_RingCapacity] > s_WindowMs[w])
+        {
+            ++tail;
+        }
+    }
+}
+
+EncounterStatsSnapshot EncounterStats::GetSnapshot()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    uint32_t nowMs = GetNowMs();
+    EvictWindows(nowMs);
+
+    EncounterStatsSnapshot snapshot = {};
+    snapshot.m_TotalResets = m_Head;
+    snapshot.m_LastCycleSeconds = m_LastCycleMs / 1000.0;
+    snapshot.m_SecondsSinceLastReset = (m_Head > 0) ? (nowMs - m_Timestamps[(m_Head - 1) % s_RingCapacity]) / 1000.0 : 0.0;
+
+    double sessionHours = nowMs / 3600000.0;
+    snapshot.m_SessionResetsPerHour = (sessionHours > 0.0) ? m_Head / sessionHours : 0.0;
+
+    for (size_t w = 0; w < s_WindowCount; ++w)
+    {
+        uint64_t count = m_Head - m_WindowTail[w];
+
+        // Until the session is as long as the window, rate over the time actually elapsed
+        double spanHours = std::min(nowMs, s_WindowMs[w]) / 3600000.0;
+        snapshot.m_ResetsPerHour[w] = (spanHours > 0.0) ? count / spanHours : 0.0;
+
+        if (count >= 2)
+        {
+            uint32_t first = m_Timestamps[m_WindowTail[w] % s_RingCapacity];
+            uint32_t last = m_Timestamps[(m_Head - 1) % s_RingCapacity];
+            snapshot.m_AverageCycleSeconds[w] = (last - first) / 1000.0 / (count - 1);
+        }
+    }
+
+    // The loop is considered stalled once the current cycle takes three times the recent average
+    double recentCycle = snapshot.m_AverageCycleSeconds[1];
+    snapshot.m_IsStalled = recentCycle > 0.0 && snapshot.m_SecondsSinceLastReset > std::max(recentCycle * 3.0, 5.0);
+
+    for (size_t b = 0; b < s_HistogramBuckets; ++b)
+    {
+        snapshot.m_Histogram[b] = (float)m_HistogramCounts[b];
+    }
+
+    return snapshot;
+}
+
+size_t EncounterStats::GetHistogramBucket(uint32_t p_CycleMs)
+{
+    if (p_CycleMs <= s_HistogramBaseMs)
+    {
+        return 0;
+    }
+
+    double bucket = std::log2(p_CycleMs / s_HistogramBaseMs) * s_HistogramBucketsPerOctave;
+    return std::min((size_t)bucket, s_HistogramBuckets - 1);
+}
+
+const char* EncounterStats::GetWindowName(size_t p_Window)
+{
+    return s_WindowNames[p_Window];
+}
+
+double EncounterStats::GetHistogramBucketSeconds(size_t p_Bucket)
+{
+    return s_HistogramBaseMs * std::pow(2.0, p_Bucket / s_HistogramBucketsPerOctave) / 1000.0;
+}
+
+double EncounterStats::GetHoursForEncounters(uint64_t p_Encounters, int p_EncountersPerReset, double p_ResetsPerHour)
+{
+    if (p_Encounters == 0)
+    {
+        return 0.0;
+    }
+
+    if (p_ResetsPerHour <= 0.0 || p_EncountersPerReset <= 0)
+    {
+        return -1.0;
+    }
+
+    return std::ceil((double)p_Encounters / p_EncountersPerReset) / p_ResetsPerHour;
+}
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include "../include/FrameSource.h"
+#include "../include/Logger.h"
+
+#pragma comment(lib, "gdi32.lib")
+#pragma comment(lib, "user32.lib")
+
+// Image Sequence ---------------------------------------------------------------
+
+ImageSequenceFrameSource::ImageSequenceFrameSource(const std::string& p_Pattern, int p_FirstIndex, bool p_Loop)
+    : m_Pattern(p_Pattern), m_Width(0), m_PadChar(' '), m_IsPatternValid(false), m_FirstIndex(p_FirstIndex), m_NextIndex(p_FirstIndex), m_Loop(p_Loop),
+    m_IsSingleFile(true), m_FrameCount(0)
+{
+    m_IsPatternValid = ParsePattern();
+}
+
+// The pattern is never used as a format string: it may hold one %d, %Nd or %0Nd for the
+// frame index and %% for a literal percent sign, and anything else is rejected
+bool ImageSequenceFrameSource::ParsePattern()
+{
+    std::string* part = &m_Prefix;
+    for (size_t i = 0; i < m_Pattern.size(); ++i)
+    {
+        if (m_Pattern[i] != '%')
+        {
+            *part += m_Pattern[i];
+            continue;
+        }
+
+        if (i + 1 < m_Pattern.size() && m_Pattern[i + 1] == '%')
+        {
+            *part += '%';
+            ++i;
+            continue;
+        }
+
+        if (!m_IsSingleFile)
+        {
+            return false;
+        }
+
+        size_t end = i + 1;
+        if (end < m_Pattern.size() && m_Pattern[end] == '0')
+        {
+            m_PadChar = '0';
+            ++end;
+        }
+        size_t digits = end;
+        while (end < m_Pattern.size() && std::isdigit((unsigned char)m_Pattern[end]) && end - digits < 3)
+        {
+            ++end;
+        }
+        if (end >= m_Pattern.size() || m_Pattern[end] != 'd')
+        {
+            return false;
+        }
+
+        m_Width = end > digits ? std::atoi(m_Pattern.substr(digits, end - digits).c_str()) : 0;
+        m_IsSingleFile = false;
+        part = &m_Suffix;
+        i = end;
+    }
+    return true;
+}
+
+std::string ImageSequenceFrameSource::GetPath(int p_Index) const
+{
+    if (m_IsSingleFile)
+    {
+        return m_Prefix;
+    }
+
+    std::string number = std::to_string(p_Index);
+    if ((int)number.size() < m_Width)
+    {
+        number.insert(p_Index < 0 && m_PadChar == '0' ? 1 : 0, m_Width - number.size(), m_PadChar);
+    }
+    return m_Prefix + number + m_Suffix;
+}
+
+bool ImageSequenceFrameSource::Open()
+{
+    m_NextIndex = m_FirstIndex;
+    m_FrameCount = 0;
+
+    if (!m_IsPatternValid)
+    {
+        Logger::Error("Image sequence pattern {} must contain at most one %d or %0Nd, with other percent signs written as %%", m_Pattern);
+        return false;
+    }
+
+    FILE* file = fopen(GetPath(m_NextIndex).c_str(), "rb");
+    if (file == nullptr)
+    {
+        Logger::Error("Failed to open image sequence at {}", GetPath(m_NextIndex));
+        return false;
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool ImageSequenceFrameSource::ReadFrame(VideoFrame& p_Frame)
+{
+    if (!ReadImageFile(GetPath(m_NextIndex), p_Frame))
+    {
+        // End of the sequence: start over when looping, otherwise the source is exhausted
+        if (!m_Loop || m_IsSingleFile || m_NextIndex == m_FirstIndex)
+        {
+            return false;
+        }
+
+        m_NextIndex = m_FirstIndex;
+        if (!ReadImageFile(GetPath(m_NextIndex), p_Frame))
+        {
+            return false;
+        }
+    }
+
+    if (!m_IsSingleFile)
+    {
+        ++m_NextIndex;
+    }
+
+    p_Frame.m_Index = m_FrameCount++;
+    p_Frame.m_Time = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool ImageSequenceFrameSource::ReadImageFile(const std::string& p_Path, VideoFrame& p_Frame)
+{
+    FILE* file = fopen(p_Path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char magic[2] = {};
+    bool isRead = fread(magic, 1, 2, file) == 2;
+    bool result = false;
+
+    if (isRead && magic[0] == 'B' && magic[1] == 'M')
+    {
+        result = LoadBmp(file, p_Frame);
+    }
+    else if (isRead && magic[0] == 'P' && magic[1] == '6')
+    {
+        result = LoadPpm(file, p_Frame);
+    }
+
+    fclose(file);
+
+    p_Frame.m_OriginX = 0;
+    p_Frame.m_OriginY = 0;
+    return result;
+}
+
+static uint32_t ReadLittleEndian(const uint8_t* p_Data, int p_Bytes)
+{
+    uint32_t value = 0;
+    for (int i = p_Bytes - 1; i >= 0; --i)
+    {
+        value = value << 8 | p_Data[i];
+    }
+    return value;
+}
+
+bool ImageSequenceFrameSource::LoadBmp(FILE* p_File, VideoFrame& p_Frame)
+{
+    // File header (after the magic) then the BITMAPINFOHEADER
+    uint8_t header[52];
+    if (fread(header, 1, sizeof(header), p_File) != sizeof(header))
+    {
+        return false;
+    }
+
+    uint32_t pixelOffset = ReadLittleEndian(header + 8, 4);
+    int32_t width = (int32_t)ReadLittleEndian(header + 16, 4);
+    int32_t height = (int32_t)ReadLittleEndian(header + 20, 4);
+    uint32_t bitCount = ReadLittleEndian(header + 26, 2);
+    uint32_t compression = ReadLittleEndian(header + 28, 4);
+
+    // BI_RGB, or BI_BITFIELDS with the usual BGRA masks for 32-bit files
+    if (width <= 0 || height == 0 || (bitCount != 24 && bitCount != 32) || (compression != 0 && compression != 3))
+    {
+        return false;
+    }
+
+    bool isTopDown = height < 0;
+    height = std::abs(height);
+    size_t rowBytes = ((size_t)width * (bitCount / 8) + 3) & ~(size_t)3;
+
+    std::vector<uint8_t> row(rowBytes);
+    p_Frame.m_Width = width;
+    p_Frame.m_Height = height;
+    p_Frame.m_Pixels.resize((size_t)width * height);
+
+    if (fseek(p_File, (long)pixelOffset, SEEK_SET) != 0)
+    {
+        return false;
+    }
+
+    for (int32_t y = 0; y < height; ++y)
+    {
+        if (fread(row.data(), 1, rowBytes, p_File) != rowBytes)
+        {
+            return false;
+        }
+
+        uint32_t* destination = p_Frame.m_Pixels.data() + (size_t)(isTopDown ? y : height - 1 - y) * width;
+        if (bitCount == 32)
+        {
+            memcpy(destination, row.data(), (size_t)width * 4);
+        }
+        else
+        {
+            for (int32_t x = 0; x < width; ++x)
+            {
+                const uint8_t* pixel = row.data() + x * 3;
+                destination[x] = 0xFF000000u | (uint32_t)pixel[2] << 16 | (uint32_t)pixel[1] << 8 | pixel[0];
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ImageSequenceFrameSource::LoadPpm(FILE* p_File, VideoFrame& p_Frame)
+{
+    // Width, height and maximum value, each possibly preceded by whitespace or comments
+    int values[3] = {};
+    for (int i = 0; i < 3; ++i)
+    {
+        int character = fgetc(p_File);
+        while (character == '#' || isspace(character))
+        {
+            if (character == '#')
+            {
+                while (character != '\n' && character != EOF)
+                {
+                    character = fgetc(p_File);
+                }
+            }
+            character = fgetc(p_File);
+        }
+
+        while (isdigit(character))
+        {
+            values[i] = values[i] * 10 + (character - '0');
+            character = fgetc(p_File);
+        }
+    }
+
+    int width = values[0];
+    int height = values[1];
+    if (width <= 0 || height <= 0 || values[2] != 255)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> data((size_t)width * height * 3);
+    if (fread(data.data(), 1, data.size(), p_File) != data.size())
+    {
+        return false;
+    }
+
+    p_Frame.m_Width = width;
+    p_Frame.m_Height = height;
+    p_Frame.m_Pixels.resize((size_t)width * height);
+    for (size_t i = 0; i < p_Frame.m_Pixels.size(); ++i)
+    {
+        p_Frame.m_Pixels[i] = 0xFF000000u | (uint32_t)data[i * 3] << 16 | (uint32_t)data[i * 3 + 1] << 8 | data[i * 3 + 2];
+    }
+
+    return true;
+}
+
+// Screen Capture ---------------------------------------------------------------
+
+ScreenCaptureFrameSource::ScreenCaptureFrameSource(const std::string& p_WindowTitle)
+    : m_WindowTitle(p_WindowTitle), m_Window(nullptr), m_SourceDC(nullptr), m_MemoryDC(nullptr), m_Bitmap(nullptr),
+    m_PreviousBitmap(nullptr), m_Bits(nullptr), m_BufferWidth(0), m_BufferHeight(0), m_RegionOfInterest(),
+    m_HasRegionOfInterest(false), m_FrameCount(0)
+{
+}
+
+ScreenCaptureFrameSource::~ScreenCaptureFrameSource()
+{
+    Close();
+}
+
+bool ScreenCaptureFrameSource::Open()
+{
+    Close();
+
+    if (!m_WindowTitle.empty())
+    {
+        m_Window = FindWindowA(nullptr, m_WindowTitle.c_str());
+        if (m_Window == nullptr)
+        {
+            Logger::Error("Failed to find window: {}", m_WindowTitle);
+            return false;
+        }
+    }
+
+    m_SourceDC = GetDC(m_Window);
+    m_MemoryDC = m_SourceDC ? CreateCompatibleDC(m_SourceDC) : nullptr;
+    if (m_MemoryDC == nullptr)
+    {
+        Logger::Error("Failed to create capture device context.");
+        Close();
+        return false;
+    }
+
+    m_FrameCount = 0;
+    return true;
+}
+
+void ScreenCaptureFrameSource::Close()
+{
+    FreeBuffer();
+
+    if (m_MemoryDC)
+    {
+        DeleteDC(m_MemoryDC);
+        m_MemoryDC = nullptr;
+    }
+
+    if (m_SourceDC)
+    {
+        ReleaseDC(m_Window, m_SourceDC);
+        m_SourceDC = nullptr;
+    }
+
+    m_Window = nullptr;
+}
+
+void ScreenCaptureFrameSource::SetRegionOfInterest(int p_X, int p_Y, int p_Width, int p_Height)
+{
+    m_RegionOfInterest = { p_X, p_Y, p_X + p_Width, p_Y + p_Height };
+    m_HasRegionOfInterest = p_Width > 0 && p_Height > 0;
+}
+
+bool ScreenCaptureFrameSource::CreateBuffer(int p_Width, int p_Height)
+{
+    if (m_Bitmap && p_Width == m_BufferWidth && p_Height == m_BufferHeight)
+    {
+        return true;
+    }
+
+    FreeBuffer();
+
+    // Negative height gives a top-down DIB so rows come out in screen order
+    BITMAPINFO info = {};
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = p_Width;
+    info.bmiHeader.biHeight = -p_Height;
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    void* bits = nullptr;
+    m_Bitmap = CreateDIBSection(m_MemoryDC, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (m_Bitmap == nullptr)
+    {
+        return false;
+    }
+
+    m_PreviousBitmap = SelectObject(m_MemoryDC, m_Bitmap);
+    m_Bits = (uint32_t*)bits;
+    m_BufferWidth = p_Width;
+    m_BufferHeight = p_Height;
+    return true;
+}
+
+void ScreenCaptureFrameSource::FreeBuffer()
+{
+    if (m_Bitmap)
+    {
+        SelectObject(m_MemoryDC, m_PreviousBitmap);
+        DeleteObject(m_Bitmap);
+        m_Bitmap = nullptr;
+    }
+
+    m_Bits = nullptr;
+    m_BufferWidth = 0;
+    m_BufferHeight = 0;
+}
+
+bool ScreenCaptureFrameSource::ReadFrame(VideoFrame& p_Frame)
+{
+    if (m_MemoryDC == nullptr || (m_Window != nullptr && !IsWindow(m_Window)))
+    {
+        return false;
+    }
+
+    RECT bounds = { 0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN) };
+    if (m_Window != nullptr)
+    {
+        GetClientRect(m_Window, &bounds);
+    }
+
+    // Only the region of interest is copied out of the window
+    RECT capture = bounds;
+    if (m_HasRegionOfInterest)
+    {
+        capture.left = std::clamp(m_RegionOfInterest.left, bounds.left, bounds.right);
+        capture.top = std::clamp(m_RegionOfInterest.top, bounds.top, bounds.bottom);
+        capture.right = std::clamp(m_RegionOfInterest.right, capture.left, bounds.right);
+        capture.bottom = std::clamp(m_RegionOfInterest.bottom, capture.top, bounds.bottom);
+    }
+
+    int width = capture.right - capture.left;
+    int height = capture.bottom - capture.top;
+    if (width <= 0 || height <= 0 || !CreateBuffer(width, height))
+    {
+        return false;
+    }
+
+    if (!BitBlt(m_MemoryDC, 0, 0, width, height, m_SourceDC, capture.left, capture.top, SRCCOPY | CAPTUREBLT))
+    {
+        return false;
+    }
+    GdiFlush();
+
+    p_Frame.m_Width = width;
+    p_Frame.m_Height = height;
+    p_Frame.m_OriginX = capture.left;
+    p_Frame.m_OriginY = capture.top;
+    p_Frame.m_Pixels.assign(m_Bits, m_Bits + (size_t)width * height);
+    p_Frame.m_Index = m_FrameCount++;
+    p_Frame.m_Time = std::chrono::steady_clock::now();
+    return true;
+}
@@ -0,0 +1,394 @@
+#include <algorithm>
+#include "../include/Gen3RngSearch.h"
+
+static const size_t s_FrameLanes = 8;
+static const int s_JumpBits = 32;
+
+static const char* s_NatureNames[25] =
+{
+    "Hardy", "Lonely", "Brave", "Adamant", "Naughty",
+    "Bold", "Docile", "Relaxed", "Impish", "Lax",
+    "Timid", "Hasty", "Serious", "Jolly", "Naive",
+    "Modest", "Mild", "Quiet", "Bashful", "Rash",
+    "Calm", "Gentle", "Sassy", "Careful", "Quirky"
+};
+
+// Cumulative encounter slot rates for grass and cave tables
+static const uint8_t s_WildSlotThresholds[12] = { 20, 40, 50, 60, 70, 80, 85, 90, 94, 98, 99, 100 };
+
+// Jump table ------------------------------------------------------------------
+
+struct Gen3JumpTable
+{
+    uint32_t m_Mult[s_JumpBits];
+    uint32_t m_Add[s_JumpBits];
+
+    Gen3JumpTable()
+    {
+        // Applying (m, a) twice gives (m * m, a * (m + 1)), so each entry squares the previous
+        m_Mult[0] = Gen3Lcrng::s_Mult;
+        m_Add[0] = Gen3Lcrng::s_Add;
+        for (int bit = 1; bit < s_JumpBits; ++bit)
+        {
+            m_Mult[bit] = m_Mult[bit - 1] * m_Mult[bit - 1];
+            m_Add[bit] = m_Add[bit - 1] * (m_Mult[bit - 1] + 1);
+        }
+    }
+};
+
+static const Gen3JumpTable& GetJumpTable()
+{
+    static const Gen3JumpTable table;
+    return table;
+}
+
+uint32_t Gen3Lcrng::GetJumpMult(int p_Bit)
+{
+    return GetJumpTable().m_Mult[p_Bit & (s_JumpBits - 1)];
+}
+
+uint32_t Gen3Lcrng::GetJumpAdd(int p_Bit)
+{
+    return GetJumpTable().m_Add[p_Bit & (s_JumpBits - 1)];
+}
+
+uint32_t Gen3Lcrng::Jump(uint32_t p_Seed, uint64_t p_Steps)
+{
+    // The generator has period 2^32, so only the low 32 bits of the step count matter
+    const Gen3JumpTable& table = GetJumpTable();
+    for (int bit = 0; bit < s_JumpBits; ++bit)
+    {
+        if (p_Steps & (1ull << bit))
+        {
+            p_Seed = p_Seed * table.m_Mult[bit] + table.m_Add[bit];
+        }
+    }
+    return p_Seed;
+}
+
+// Generation ------------------------------------------------------------------
+
+bool Gen3RngSearch::IsShiny(uint32_t p_Pid, uint16_t p_Tid, uint16_t p_Sid)
+{
+    return ((p_Pid >> 16) ^ (p_Pid & 0xFFFF) ^ p_Tid ^ p_Sid) < 8;
+}
+
+const char* Gen3RngSearch::GetNatureName(uint8_t p_Nature)
+{
+    return p_Nature < 25 ? s_NatureNames[p_Nature] : "?";
+}
+
+const char* Gen3RngSearch::GetMethodName(Gen3Method p_Method)
+{
+    switch (p_Method)
+    {
+    case Gen3Method::Method1: return "Method 1";
+    case Gen3Method::Method2: return "Method 2";
+    case Gen3Method::Method4: return "Method 4";
+    case Gen3Method::WildMethodH1: return "Wild (H-1)";
+    case Gen3Method::WildMethodH2: return "Wild (H-2)";
+    case Gen3Method::WildMethodH4: return "Wild (H-4)";
+    }
+    return "Unknown";
+}
+
+static bool IsWildMethod(Gen3Method p_Method)
+{
+    return p_Method == Gen3Method::WildMethodH1 || p_Method == Gen3Method::WildMethodH2 || p_Method == Gen3Method::WildMethodH4;
+}
+
+static void SetIvs(uint32_t p_First, uint32_t p_Second, uint8_t* p_Ivs)
+{
+    uint32_t first = p_First >> 16;
+    uint32_t second = p_Second >> 16;
+
+    p_Ivs[0] = first & 31;
+    p_Ivs[1] = (first >> 5) & 31;
+    p_Ivs[2] = (first >> 10) & 31;
+    p_Ivs[3] = (second >> 5) & 31;
+    p_Ivs[4] = (second >> 10) & 31;
+    p_Ivs[5] = second & 31;
+}
+
+bool Gen3RngSearch::GenerateHit(uint32_t p_Seed, uint32_t p_Frame, const Gen3SearchSettings& p_Settings, Gen3SearchHit& p_Hit)
+{
+    uint32_t state = Gen3Lcrng::Jump(p_Seed, (uint64_t)p_Frame - 1);
+
+    p_Hit.m_Seed = p_Seed;
+    p_Hit.m_Frame = p_Frame;
+    p_Hit.m_Slot = 0;
+
+    if (IsWildMethod(p_Settings.m_Method))
+    {
+        state = Gen3Lcrng::Next(state);
+        uint32_t slotRoll = (state >> 16) % 100;
+        while (p_Hit.m_Slot < 11 && slotRoll >= s_WildSlotThresholds[p_Hit.m_Slot])
+        {
+            ++p_Hit.m_Slot;
+        }
+
+        state = Gen3Lcrng::Next(state);     // level
+        state = Gen3Lcrng::Next(state);
+        p_Hit.m_Nature = (uint8_t)((state >> 16) % 25);
+
+        // The PID is rerolled until it matches the nature picked above
+        do
+        {
+            uint32_t low = Gen3Lcrng::Next(state);
+            state = Gen3Lcrng::Next(low);
+            p_Hit.m_Pid = (state & 0xFFFF0000u) | (low >> 16);
+        } while (p_Hit.m_Pid % 25 != p_Hit.m_Nature);
+    }
+    else
+    {
+        uint32_t low = Gen3Lcrng::Next(state);
+        state = Gen3Lcrng::Next(low);
+        p_Hit.m_Pid = (state & 0xFFFF0000u) | (low >> 16);
+        p_Hit.m_Nature = (uint8_t)(p_Hit.m_Pid % 25);
+    }
+
+    if (!IsShiny(p_Hit.m_Pid, p_Settings.m_Tid, p_Settings.m_Sid))
+    {
+        return false;
+    }
+
+    // Methods 2 and 4 insert a discarded call before the first or second IV word
+    uint32_t first = Gen3Lcrng::Next(state);
+    if (p_Settings.m_Method == Gen3Method::Method2 || p_Settings.m_Method == Gen3Method::WildMethodH2)
+    {
+        first = Gen3Lcrng::Next(first);
+    }
+
+    uint32_t second = Gen3Lcrng::Next(first);
+    if (p_Settings.m_Method == Gen3Method::Method4 || p_Settings.m_Method == Gen3Method::WildMethodH4)
+    {
+        second = Gen3Lcrng::Next(second);
+    }
+
+    SetIvs(first, second, p_Hit.m_Ivs);
+    return true;
+}
+
+void Gen3RngSearch::SearchSeed(uint32_t p_Seed, const Gen3SearchSettings& p_Settings, std::vector<Gen3SearchHit>& p_Hits)
+{
+    uint64_t frameMin = std::max<uint32_t>(p_Settings.m_FrameMin, 1);
+    uint64_t frameMax = p_Settings.m_FrameMax;
+    Gen3SearchHit hit;
+
+    // Wild PIDs depend on a variable number of rerolls, so each frame is generated in full
+    if (IsWildMethod(p_Settings.m_Method))
+    {
+        for (uint64_t frame = frameMin; frame <= frameMax; ++frame)
+        {
+            if (GenerateHit(p_Seed, (uint32_t)frame, p_Settings, hit))
+            {
+                p_Hits.push_back(hit);
+            }
+        }
+        return;
+    }
+
+    // Static PIDs are the first two calls after the frame's state, so eight consecutive
+    // frames are checked per step with every lane advanced by a single 8-frame jump
+    uint32_t tsv = (uint32_t)(p_Settings.m_Tid ^ p_Settings.m_Sid);
+    uint32_t jumpMult = Gen3Lcrng::GetJumpMult(3);
+    uint32_t jumpAdd = Gen3Lcrng::GetJumpAdd(3);
+
+    uint32_t lanes[s_FrameLanes];
+    lanes[0] = Gen3Lcrng::Jump(p_Seed, frameMin - 1);
+    for (size_t lane = 1; lane < s_FrameLanes; ++lane)
+    {
+        lanes[lane] = Gen3Lcrng::Next(lanes[lane - 1]);
+    }
+
+    for (uint64_t frame = frameMin; frame <= frameMax; frame += s_FrameLanes)
+    {
+        uint32_t shinyMask = 0;
+        for (size_t lane = 0; lane < s_FrameLanes; ++lane)
+        {
+            uint32_t low = lanes[lane] * Gen3Lcrng::s_Mult + Gen3Lcrng::s_Add;
+            uint32_t high = low * Gen3Lcrng::s_Mult + Gen3Lcrng::s_Add;
+            uint32_t value = (low >> 16) ^ (high >> 16) ^ tsv;
+            shinyMask |= (uint32_t)(value < 8) << lane;
+        }
+
+        while (shinyMask != 0)
+        {
+            size_t lane = 0;
+            while (!(shinyMask & (1u << lane)))
+            {
+                ++lane;
+            }
+            shinyMask &= ~(1u << lane);
+
+            if (frame + lane <= frameMax && GenerateHit(p_Seed, (uint32_t)(frame + lane), p_Settings, hit))
+            {
+                p_Hits.push_back(hit);
+            }
+        }
+
+        for (size_t lane = 0; lane < s_FrameLanes; ++lane)
+        {
+            lanes[lane] = lanes[lane] * jumpMult + jumpAdd;
+        }
+    }
+}
+
+// Search ----------------------------------------------------------------------
+
+std::vector<Gen3SearchHit> Gen3RngSearch::Search(const Gen3SearchSettings& p_Settings, unsigned p_ThreadCount, const std::atomic<bool>& p_Cancel, std::atomic<uint64_t>& p_SeedsDone)
+{
+    std::vector<Gen3SearchHit> hits;
+    if (p_Settings.m_SeedMax < p_Settings.m_SeedMin || p_Settings.m_FrameMax < p_Settings.m_FrameMin)
+    {
+        return hits;
+    }
+
+    uint64_t seedCount = (uint64_t)p_Settings.m_SeedMax - p_Settings.m_SeedMin + 1;
+    unsigned threadCount = p_ThreadCount > 0 ? p_ThreadCount : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (unsigned)std::min<uint64_t>(threadCount, seedCount);
+
+    // Seeds are handed out one at a time; each one is a full frame range of work
+    std::atomic<uint64_t> nextSeed(0);
+    std::vector<std::vector<Gen3SearchHit>> workerHits(threadCount);
+
+    auto worker = [&](unsigned p_Worker)
+        {
+            std::vector<Gen3SearchHit>& found = workerHits[p_Worker];
+
+            while (!p_Cancel.load())
+            {
+                uint64_t index = nextSeed.fetch_add(1);
+                if (index >= seedCount)
+                {
+                    break;
+                }
+
+                SearchSeed((uint32_t)(p_Settings.m_SeedMin + index), p_Settings, found);
+                ++p_SeedsDone;
+            }
+        };
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < threadCount; ++w)
+    {
+        threads.emplace_back(worker, w);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const std::vector<Gen3SearchHit>& found : workerHits)
+    {
+        hits.insert(hits.end(), found.begin(), found.end());
+    }
+
+    std::sort(hits.begin(), hits.end(), [](const Gen3SearchHit& a, const Gen3SearchHit& b)
+        {
+            return a.m_Seed != b.m_Seed ? a.m_Seed < b.m_Seed : a.m_Frame < b.m_Frame;
+        });
+
+    if (hits.size() > p_Settings.m_MaxResults)
+    {
+        hits.resize(p_Settings.m_MaxResults);
+    }
+
+    return hits;
+}
+
+Gen3RngSearch::Gen3RngSearch()
+    : m_IsRunning(false), m_StopSearch(false), m_SeedsDone(0), m_SeedsTotal(0)
+{
+}
+
+Gen3RngSearch::~Gen3RngSearch()
+{
+    Stop();
+}
+
+bool Gen3RngSearch::Start(const Gen3SearchSettings& p_Settings, unsigned p_ThreadCount)
+{
+    if (m_IsRunning.load())
+    {
+        return false;
+    }
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    m_SeedsTotal = p_Settings.m_SeedMax >= p_Settings.m_SeedMin ? (uint64_t)p_Settings.m_SeedMax - p_Settings.m_SeedMin + 1 : 0;
+    m_StopSearch = false;
+    m_SeedsDone = 0;
+    m_IsRunning = true;
+    m_Thread = std::thread(&Gen3RngSearch::RunSearch, this, p_Settings, p_ThreadCount);
+    return true;
+}
+
+void Gen3RngSearch::Stop()
+{
+    m_StopSearch = true;
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+}
+
+double Gen3RngSearch::GetProgress() const
+{
+    return m_SeedsTotal > 0 ? (double)m_SeedsDone.load() / m_SeedsTotal : 0.0;
+}
+
+std::vector<Gen3SearchHit> Gen3RngSearch::GetResults() const
+{
+    std::lock_guard<std::mutex> lock(m_ResultsMutex);
+    return m_Results;
+}
+
+void Gen3RngSearch::RunSearch(Gen3SearchSettings p_Settings, unsigned p_ThreadCount)
+{
+    std::vector<Gen3SearchHit> hits = Search(p_Settings, p_ThreadCount, m_StopSearch, m_SeedsDone);
+
+    if (!m_StopSearch.load())
+    {
+        std::lock_guard<std::mutex> lock(m_ResultsMutex);
+        m_Results = hits;
+    }
+
+    m_IsRunning = false;
+}
+
+// Macro export ----------------------------------------------------------------
+
+Macro Gen3RngSearch::ExportHitToMacro(const Gen3SearchHit& p_Hit, int p_FrameOffset, WORD p_ResetButtons, WORD p_TriggerButtons, uint32_t p_LoopGapFrames)
+{
+    const uint32_t holdFrames = 3;
+
+    Macro macro;
+    macro.m_Unit = MacroTimeUnit::Frames;
+    macro.m_LoopGapTicks = p_LoopGapFrames;
+
+    MacroEvent event = {};
+
+    // Frame counting starts when the reset combination is released
+    event.m_Ticks = 0;
+    event.m_Report.wButtons = p_ResetButtons;
+    macro.m_Events.push_back(event);
+
+    event.m_Ticks = holdFrames;
+    event.m_Report.wButtons = 0;
+    macro.m_Events.push_back(event);
+
+    int64_t triggerFrame = (int64_t)p_Hit.m_Frame + p_FrameOffset;
+    event.m_Ticks = (uint32_t)std::max<int64_t>(triggerFrame, 1);
+    event.m_Report.wButtons = p_TriggerButtons;
+    macro.m_Events.push_back(event);
+
+    event.m_Ticks = holdFrames;
+    event.m_Report.wButtons = 0;
+    macro.m_Events.push_back(event);
+
+    return macro;
+}
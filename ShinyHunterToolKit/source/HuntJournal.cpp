@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+#include "../include/HuntJournal.h"
+
+static_assert(sizeof(HuntJournalEntry) == 16, "journal entries are written as raw 16-byte records");
+
+// How far back Open replays; deeper than the ring so undos near the start of the tail still find their change
+static const size_t s_ReplayEntries = HuntJournal::s_UndoDepth * 4;
+
+static uint32_t GetUnixTime()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+HuntJournal::HuntJournal()
+    : m_UndoRing(),
+    m_UndoHead(0),
+    m_UndoCount(0),
+    m_RedoStack(),
+    m_RedoCount(0)
+{
+}
+
+bool HuntJournal::Open(const std::string& p_Path)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (m_File.is_open())
+    {
+        m_File.close();
+    }
+
+    m_UndoHead = 0;
+    m_UndoCount = 0;
+    m_RedoCount = 0;
+
+    // Drop a torn entry left by a crash so every entry stays aligned
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(p_Path, error);
+    if (!error && size % sizeof(HuntJournalEntry) != 0)
+    {
+        size -= size % sizeof(HuntJournalEntry);
+        std::filesystem::resize_file(p_Path, size, error);
+    }
+
+    // One seek and read of the tail rebuilds the undo and redo state
+    if (!error && size > 0)
+    {
+        uint64_t count = std::min<uint64_t>(size / sizeof(HuntJournalEntry), s_ReplayEntries);
+        std::vector<HuntJournalEntry> tail((size_t)count);
+        std::ifstream input(p_Path, std::ios::binary);
+        input.seekg((std::streamoff)(size - count * sizeof(HuntJournalEntry)));
+        if (input.read((char*)tail.data(), count * sizeof(HuntJournalEntry)))
+        {
+            for (const HuntJournalEntry& entry : tail)
+            {
+                Apply(entry);
+            }
+        }
+    }
+
+    m_File.open(p_Path, std::ios::binary | std::ios::app);
+    return m_File.is_open();
+}
+
+void HuntJournal::Close()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_File.close();
+}
+
+bool HuntJournal::IsOpen() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_File.is_open();
+}
+
+void HuntJournal::PushUndo(const HuntJournalEntry& p_Entry)
+{
+    // A full ring overwrites its oldest change
+    m_UndoRing[m_UndoHead] = p_Entry;
+    m_UndoHead = (m_UndoHead + 1) % s_UndoDepth;
+    m_UndoCount = std::min(m_UndoCount + 1, s_UndoDepth);
+}
+
+void HuntJournal::Apply(const HuntJournalEntry& p_Entry)
+{
+    switch (p_Entry.m_Event)
+    {
+    case HuntJournalEvent::Reset:
+    case HuntJournalEvent::Set:
+        PushUndo(p_Entry);
+        m_RedoCount = 0;
+        break;
+    case HuntJournalEvent::PhaseEnd:
+        m_UndoCount = 0;
+        m_RedoCount = 0;
+        break;
+    case HuntJournalEvent::Undo:
+        if (m_UndoCount > 0)
+        {
+            m_UndoHead = (m_UndoHead + s_UndoDepth - 1) % s_UndoDepth;
+            m_UndoCount--;
+            m_RedoStack[m_RedoCount++] = m_UndoRing[m_UndoHead];
+        }
+        break;
+    case HuntJournalEvent::Redo:
+        if (m_RedoCount > 0)
+        {
+            PushUndo(m_RedoStack[--m_RedoCount]);
+        }
+        break;
+    }
+}
+
+void HuntJournal::Write(const HuntJournalEntry& p_Entry)
+{
+    if (m_File.is_open())
+    {
+        m_File.write((const char*)&p_Entry, sizeof(p_Entry));
+        m_File.flush();
+    }
+}
+
+void HuntJournal::Append(HuntJournalEvent p_Event, int p_Before, int p_After)
+{
+    HuntJournalEntry entry;
+    entry.m_Time = GetUnixTime();
+    entry.m_Before = p_Before;
+    entry.m_After = p_After;
+    entry.m_Event = p_Event;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Write(entry);
+    Apply(entry);
+}
+
+bool HuntJournal::Undo(HuntJournalEntry& p_Entry)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_UndoCount == 0)
+    {
+        return false;
+    }
+
+    p_Entry = m_UndoRing[(m_UndoHead + s_UndoDepth - 1) % s_UndoDepth];
+
+    HuntJournalEntry entry = p_Entry;
+    entry.m_Time = GetUnixTime();
+    entry.m_Before = p_Entry.m_After;
+    entry.m_After = p_Entry.m_Before;
+    entry.m_Event = HuntJournalEvent::Undo;
+    Write(entry);
+    Apply(entry);
+    return true;
+}
+
+bool HuntJournal::Redo(HuntJournalEntry& p_Entry)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_RedoCount == 0)
+    {
+        return false;
+    }
+
+    p_Entry = m_RedoStack[m_RedoCount - 1];
+
+    HuntJournalEntry entry = p_Entry;
+    entry.m_Time = GetUnixTime();
+    entry.m_Event = HuntJournalEvent::Redo;
+    Write(entry);
+    Apply(entry);
+    return true;
+}
+
+size_t HuntJournal::GetUndoCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_UndoCount;
+}
+
+size_t HuntJournal::GetRedoCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_RedoCount;
+}
+
+bool HuntJournal::ReadLast(const std::string& p_Path, HuntJournalEntry& p_Entry)
+{
+    std::ifstream file(p_Path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::streamoff size = file.tellg();
+    std::streamoff last = size - size % (std::streamoff)sizeof(HuntJournalEntry) - (std::streamoff)sizeof(HuntJournalEntry);
+    if (last < 0)
+    {
+        return false;
+    }
+
+    file.seekg(last);
+    return (bool)file.read((char*)&p_Entry, sizeof(p_Entry));
+}
+
+uint64_t HuntJournal::GetEntryCount(const std::string& p_Path)
+{
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(p_Path, error);
+    return error ? 0 : size / sizeof(HuntJournalEntry);
+}
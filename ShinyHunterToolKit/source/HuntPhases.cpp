@@ -0,0 +1,30 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/HuntPhases.h"
+
+void HuntPhaseTotals::Add(const HuntPhase& p_Phase)
+{
+    m_ShortestPhase = m_PhaseCount == 0 ? p_Phase.m_Encounters : std::min(m_ShortestPhase, p_Phase.m_Encounters);
+    m_LongestPhase = std::max(m_LongestPhase, p_Phase.m_Encounters);
+    m_PhaseCount++;
+    m_Encounters += p_Phase.m_Encounters;
+    m_ExpectedShinies += p_Phase.m_ExpectedShinies;
+
+    // Shinies found in a run of encounters are Poisson with mean m_ExpectedShinies, so
+    // P(at least k) = 1 - sum of P(i) for i < k. Terms are built in the log domain.
+    double lambda = m_ExpectedShinies;
+    if (lambda <= 0.0)
+    {
+        m_Luck = 1.0;
+        return;
+    }
+
+    double below = 0.0;
+    double logTerm = -lambda;
+    for (int i = 0; i < m_PhaseCount; ++i)
+    {
+        below += std::exp(logTerm);
+        logTerm += std::log(lambda) - std::log((double)(i + 1));
+    }
+    m_Luck = std::clamp(1.0 - below, 0.0, 1.0);
+}
@@ -0,0 +1,632 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include "../include/HuntProfileStore.h"
+#include "../include/MacroFile.h"
+#include "../include/Logger.h"
+
+static const char s_FileMagic[8] = { 'S', 'H', 'T', 'K', 'H', 'U', 'N', 'T' };
+static const uint32_t s_RecordMagic = 0x31525048;  // "HPR1"
+static const size_t s_HeaderSize = 8 + 4;
+static const size_t s_RecordHeaderSize = 4 * 3;
+static const uint32_t s_MaxRecordSize = 1024 * 1024;
+static const uint64_t s_CompactSlack = 64 * 1024;
+
+enum RecordType : uint8_t
+{
+    RecordProfile = 1,
+    RecordActive = 2,
+    RecordRemoved = 3
+};
+
+const char* GetHuntStatusName(HuntStatus p_Status)
+{
+    switch (p_Status)
+    {
+    case HuntStatus::Hunting: return "Hunting";
+    case HuntStatus::Found: return "Found";
+    case HuntStatus::Abandoned: return "Abandoned";
+    }
+    return "Unknown";
+}
+
+static int64_t GetUnixTime()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Encoding --------------------------------------------------------------------
+
+static void PutU8(std::vector<uint8_t>& p_Buffer, uint8_t p_Value)
+{
+    p_Buffer.push_back(p_Value);
+}
+
+static void PutU32(std::vector<uint8_t>& p_Buffer, uint32_t p_Value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        p_Buffer.push_back((uint8_t)(p_Value >> (i * 8)));
+    }
+}
+
+static void PutU64(std::vector<uint8_t>& p_Buffer, uint64_t p_Value)
+{
+    PutU32(p_Buffer, (uint32_t)p_Value);
+    PutU32(p_Buffer, (uint32_t)(p_Value >> 32));
+}
+
+static void PutString(std::vector<uint8_t>& p_Buffer, const std::string& p_Value)
+{
+    size_t size = std::min<size_t>(p_Value.size(), 0xFFFF);
+    p_Buffer.push_back((uint8_t)size);
+    p_Buffer.push_back((uint8_t)(size >> 8));
+    p_Buffer.insert(p_Buffer.end(), p_Value.begin(), p_Value.begin() + size);
+}
+
+static void PutDouble(std::vector<uint8_t>& p_Buffer, double p_Value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &p_Value, sizeof(bits));
+    PutU64(p_Buffer, bits);
+}
+
+static uint32_t GetU32(const uint8_t* p_Data)
+{
+    return (uint32_t)p_Data[0] | ((uint32_t)p_Data[1] << 8) | ((uint32_t)p_Data[2] << 16) | ((uint32_t)p_Data[3] << 24);
+}
+
+// Bounds-checked reads over one record's payload; any overrun marks the record invalid
+struct PayloadReader
+{
+    const uint8_t* m_Data;
+    const uint8_t* m_End;
+    bool m_IsValid;
+
+    bool Has(size_t p_Size)
+    {
+        m_IsValid = m_IsValid && (size_t)(m_End - m_Data) >= p_Size;
+        return m_IsValid;
+    }
+
+    uint8_t U8()
+    {
+        return Has(1) ? *m_Data++ : 0;
+    }
+
+    uint32_t U32()
+    {
+        if (!Has(4))
+        {
+            return 0;
+        }
+        uint32_t value = GetU32(m_Data);
+        m_Data += 4;
+        return value;
+    }
+
+    uint64_t U64()
+    {
+        uint64_t low = U32();
+        return low | ((uint64_t)U32() << 32);
+    }
+
+    double Double()
+    {
+        uint64_t bits = U64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    bool IsAtEnd() const
+    {
+        return m_Data == m_End;
+    }
+
+    std::string String()
+    {
+        if (!Has(2))
+        {
+            return {};
+        }
+        size_t size = m_Data[0] | (m_Data[1] << 8);
+        m_Data += 2;
+        if (!Has(size))
+        {
+            return {};
+        }
+        std::string value((const char*)m_Data, size);
+        m_Data += size;
+        return value;
+    }
+};
+
+// Summary fields come first so building the index never decodes the rest
+static void EncodeProfile(std::vector<uint8_t>& p_Buffer, const HuntProfile& p_Profile)
+{
+    PutU8(p_Buffer, RecordProfile);
+    PutU32(p_Buffer, p_Profile.m_Id);
+    PutString(p_Buffer, p_Profile.m_Name);
+    PutString(p_Buffer, p_Profile.m_Target);
+    PutU8(p_Buffer, (uint8_t)p_Profile.m_Generation);
+    PutU32(p_Buffer, (uint32_t)p_Profile.m_Encounters);
+    PutU8(p_Buffer, (uint8_t)p_Profile.m_Status);
+    PutU64(p_Buffer, (uint64_t)p_Profile.m_UpdatedTime);
+
+    PutU8(p_Buffer, (uint8_t)p_Profile.m_Method);
+    PutU32(p_Buffer, (uint32_t)p_Profile.m_EncountersPerReset);
+    PutU64(p_Buffer, (uint64_t)p_Profile.m_CreatedTime);
+    PutString(p_Buffer, p_Profile.m_MacroPath);
+    PutString(p_Buffer, p_Profile.m_Notes);
+
+    PutU64(p_Buffer, (uint64_t)p_Profile.m_PhaseStartTime);
+    PutU32(p_Buffer, (uint32_t)p_Profile.m_Phases.size());
+    for (const HuntPhase& phase : p_Profile.m_Phases)
+    {
+        PutU64(p_Buffer, (uint64_t)phase.m_StartTime);
+        PutU64(p_Buffer, (uint64_t)phase.m_EndTime);
+        PutU32(p_Buffer, (uint32_t)phase.m_Encounters);
+        PutDouble(p_Buffer, phase.m_ExpectedShinies);
+        PutString(p_Buffer, phase.m_Shiny);
+    }
+}
+
+static bool DecodeSummary(PayloadReader& p_Reader, HuntProfileSummary& p_Summary)
+{
+    p_Summary.m_Id = p_Reader.U32();
+    p_Summary.m_Name = p_Reader.String();
+    p_Summary.m_Target = p_Reader.String();
+    p_Summary.m_Generation = p_Reader.U8();
+    p_Summary.m_Encounters = (int)p_Reader.U32();
+    p_Summary.m_Status = (HuntStatus)std::min<uint8_t>(p_Reader.U8(), (uint8_t)HuntStatus::Abandoned);
+    p_Summary.m_UpdatedTime = (int64_t)p_Reader.U64();
+    return p_Reader.m_IsValid;
+}
+
+static bool DecodeProfile(PayloadReader& p_Reader, HuntProfile& p_Profile)
+{
+    if (!DecodeSummary(p_Reader, p_Profile))
+    {
+        return false;
+    }
+
+    p_Profile.m_Method = p_Reader.U8();
+    p_Profile.m_EncountersPerReset = (int)p_Reader.U32();
+    p_Profile.m_CreatedTime = (int64_t)p_Reader.U64();
+    p_Profile.m_MacroPath = p_Reader.String();
+    p_Profile.m_Notes = p_Reader.String();
+
+    // Profiles saved before phases existed end here
+    p_Profile.m_PhaseStartTime = p_Profile.m_CreatedTime;
+    p_Profile.m_Phases.clear();
+    if (!p_Reader.m_IsValid || p_Reader.IsAtEnd())
+    {
+        return p_Reader.m_IsValid;
+    }
+
+    p_Profile.m_PhaseStartTime = (int64_t)p_Reader.U64();
+    uint32_t phaseCount = p_Reader.U32();
+    for (uint32_t i = 0; i < phaseCount && p_Reader.m_IsValid; ++i)
+    {
+        HuntPhase phase;
+        phase.m_StartTime = (int64_t)p_Reader.U64();
+        phase.m_EndTime = (int64_t)p_Reader.U64();
+        phase.m_Encounters = (int)p_Reader.U32();
+        phase.m_ExpectedShinies = p_Reader.Double();
+        phase.m_Shiny = p_Reader.String();
+        p_Profile.m_Phases.push_back(std::move(phase));
+    }
+    return p_Reader.m_IsValid;
+}
+
+static void MakeRecord(std::vector<uint8_t>& p_Record, const std::vector<uint8_t>& p_Payload)
+{
+    p_Record.clear();
+    PutU32(p_Record, s_RecordMagic);
+    PutU32(p_Record, (uint32_t)p_Payload.size());
+    PutU32(p_Record, MacroFile::Crc32(0, p_Payload.data(), p_Payload.size()));
+    p_Record.insert(p_Record.end(), p_Payload.begin(), p_Payload.end());
+}
+
+static bool IsValidRecord(const std::vector<uint8_t>& p_Data, uint64_t p_Offset)
+{
+    if (p_Offset + s_RecordHeaderSize > p_Data.size())
+    {
+        return false;
+    }
+
+    const uint8_t* record = p_Data.data() + p_Offset;
+    uint32_t size = GetU32(record + 4);
+    return GetU32(record) == s_RecordMagic && size != 0 && size <= s_MaxRecordSize && p_Offset + s_RecordHeaderSize + size <= p_Data.size() &&
+        MacroFile::Crc32(0, record + s_RecordHeaderSize, size) == GetU32(record + 8);
+}
+
+// The next offset after p_Offset where a valid record starts, or the end of the data
+static uint64_t FindNextRecord(const std::vector<uint8_t>& p_Data, uint64_t p_Offset)
+{
+    for (uint64_t offset = p_Offset + 1; offset + s_RecordHeaderSize <= p_Data.size(); ++offset)
+    {
+        if (GetU32(p_Data.data() + offset) == s_RecordMagic && IsValidRecord(p_Data, offset))
+        {
+            return offset;
+        }
+    }
+    return p_Data.size();
+}
+
+// Store -----------------------------------------------------------------------
+
+HuntProfileStore::HuntProfileStore()
+    : m_EndOffset(0),
+    m_LiveBytes(0),
+    m_NextId(1),
+    m_ActiveId(0)
+{
+}
+
+bool HuntProfileStore::WriteHeader(std::ofstream& p_File) const
+{
+    std::vector<uint8_t> header(s_FileMagic, s_FileMagic + 8);
+    PutU32(header, s_Version);
+    p_File.write((const char*)header.data(), header.size());
+    return (bool)p_File;
+}
+
+bool HuntProfileStore::Open(const std::string& p_Path)
+{
+    m_File.close();
+    m_Index.clear();
+    m_Path = p_Path;
+    m_LiveBytes = 0;
+    m_NextId = 1;
+    m_ActiveId = 0;
+
+    std::vector<uint8_t> data;
+    {
+        std::ifstream input(p_Path, std::ios::binary);
+        if (input)
+        {
+            data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        }
+    }
+
+    if (data.empty())
+    {
+        std::ofstream output(p_Path, std::ios::binary | std::ios::trunc);
+        if (!output || !WriteHeader(output))
+        {
+            Logger::Error("Failed to create hunt profile store {}", p_Path);
+            return false;
+        }
+        data.assign(s_HeaderSize, 0);
+    }
+    else if (data.size() < s_HeaderSize || std::memcmp(data.data(), s_FileMagic, 8) != 0 || GetU32(data.data() + 8) != s_Version)
+    {
+        Logger::Error("{} is not a hunt profile store", p_Path);
+        return false;
+    }
+
+    // Replay every record. A damaged record with valid ones after it is skipped and the
+    // file rewritten without it; only a tail with nothing valid after it (a crash
+    // mid-save) is cut off.
+    uint64_t offset = s_HeaderSize;
+    bool isDamaged = false;
+    while (offset + s_RecordHeaderSize <= data.size())
+    {
+        if (!IsValidRecord(data, offset))
+        {
+            uint64_t next = FindNextRecord(data, offset);
+            if (next == data.size())
+            {
+                break;
+            }
+
+            Logger::Warning("Skipped {} damaged bytes at offset {} in {}", next - offset, offset, p_Path);
+            isDamaged = true;
+            offset = next;
+            continue;
+        }
+
+        const uint8_t* record = data.data() + offset;
+        uint32_t size = GetU32(record + 4);
+        PayloadReader reader = { record + s_RecordHeaderSize, record + s_RecordHeaderSize + size, true };
+        uint8_t type = reader.U8();
+        if (type == RecordProfile)
+        {
+            IndexEntry entry = { offset, size, {} };
+            if (DecodeSummary(reader, entry.m_Summary))
+            {
+                auto existing = m_Index.find(entry.m_Summary.m_Id);
+                if (existing != m_Index.end())
+                {
+                    m_LiveBytes -= s_RecordHeaderSize + existing->second.m_Size;
+                }
+                m_LiveBytes += s_RecordHeaderSize + size;
+                m_NextId = std::max(m_NextId, entry.m_Summary.m_Id + 1);
+                m_Index[entry.m_Summary.m_Id] = std::move(entry);
+            }
+        }
+        else if (type == RecordActive)
+        {
+            m_ActiveId = reader.U32();
+        }
+        else if (type == RecordRemoved)
+        {
+            auto removed = m_Index.find(reader.U32());
+            if (removed != m_Index.end())
+            {
+                m_LiveBytes -= s_RecordHeaderSize + removed->second.m_Size;
+                m_Index.erase(removed);
+            }
+        }
+
+        offset += s_RecordHeaderSize + size;
+    }
+
+    if (offset < data.size())
+    {
+        Logger::Warning("Discarded {} unreadable bytes at the end of {}", data.size() - offset, p_Path);
+        std::error_code error;
+        std::filesystem::resize_file(p_Path, offset, error);
+    }
+
+    if (m_Index.find(m_ActiveId) == m_Index.end())
+    {
+        m_ActiveId = 0;
+    }
+
+    m_EndOffset = offset;
+    m_File.open(p_Path, std::ios::binary | std::ios::in | std::ios::out);
+    if (isDamaged && m_File.is_open())
+    {
+        Compact();
+    }
+    return m_File.is_open();
+}
+
+bool HuntProfileStore::Append(const std::vector<uint8_t>& p_Payload, uint64_t& p_Offset)
+{
+    if (!m_File.is_open())
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> record;
+    MakeRecord(record, p_Payload);
+
+    m_File.clear();
+    m_File.seekp((std::streamoff)m_EndOffset);
+    m_File.write((const char*)record.data(), record.size());
+    m_File.flush();
+    if (!m_File)
+    {
+        Logger::Error("Failed to write hunt profile store {}", m_Path);
+        return false;
+    }
+
+    p_Offset = m_EndOffset;
+    m_EndOffset += record.size();
+    return true;
+}
+
+bool HuntProfileStore::Create(HuntProfile& p_Profile)
+{
+    p_Profile.m_Id = m_NextId++;
+    p_Profile.m_CreatedTime = GetUnixTime();
+    p_Profile.m_PhaseStartTime = p_Profile.m_CreatedTime;
+    return Save(p_Profile);
+}
+
+bool HuntProfileStore::Save(HuntProfile& p_Profile)
+{
+    if (p_Profile.m_Id == 0)
+    {
+        return false;
+    }
+
+    p_Profile.m_UpdatedTime = GetUnixTime();
+
+    std::vector<uint8_t> payload;
+    EncodeProfile(payload, p_Profile);
+    if (payload.size() > s_MaxRecordSize)
+    {
+        Logger::Error("Hunt profile {} is too large to save", p_Profile.m_Name);
+        return false;
+    }
+
+    uint64_t offset = 0;
+    if (!Append(payload, offset))
+    {
+        return false;
+    }
+
+    IndexEntry& entry = m_Index[p_Profile.m_Id];
+    if (entry.m_Size != 0)
+    {
+        m_LiveBytes -= s_RecordHeaderSize + entry.m_Size;
+    }
+    entry.m_Offset = offset;
+    entry.m_Size = (uint32_t)payload.size();
+    entry.m_Summary = p_Profile;
+    m_LiveBytes += s_RecordHeaderSize + entry.m_Size;
+
+    if (m_EndOffset - s_HeaderSize > m_LiveBytes * 2 + s_CompactSlack)
+    {
+        Compact();
+    }
+    return true;
+}
+
+bool HuntProfileStore::Load(uint32_t p_Id, HuntProfile& p_Profile)
+{
+    auto found = m_Index.find(p_Id);
+    if (found == m_Index.end() || !m_File.is_open())
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> payload(found->second.m_Size);
+    m_File.clear();
+    m_File.seekg((std::streamoff)(found->second.m_Offset + s_RecordHeaderSize));
+    if (!m_File.read((char*)payload.data(), payload.size()))
+    {
+        return false;
+    }
+
+    PayloadReader reader = { payload.data(), payload.data() + payload.size(), true };
+    return reader.U8() == RecordProfile && DecodeProfile(reader, p_Profile);
+}
+
+bool HuntProfileStore::Remove(uint32_t p_Id)
+{
+    auto found = m_Index.find(p_Id);
+    if (found == m_Index.end())
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> payload;
+    PutU8(payload, RecordRemoved);
+    PutU32(payload, p_Id);
+
+    uint64_t offset = 0;
+    if (!Append(payload, offset))
+    {
+        return false;
+    }
+
+    m_LiveBytes -= s_RecordHeaderSize + found->second.m_Size;
+    m_Index.erase(found);
+    if (m_ActiveId == p_Id)
+    {
+        SetActiveId(0);
+    }
+
+    // Compact can hand the id out again, so its journal must not outlive it
+    std::error_code error;
+    std::filesystem::remove(GetJournalPath(p_Id), error);
+
+    if (m_EndOffset - s_HeaderSize > m_LiveBytes * 2 + s_CompactSlack)
+    {
+        Compact();
+    }
+    return true;
+}
+
+bool HuntProfileStore::SetActiveId(uint32_t p_Id)
+{
+    if (p_Id == m_ActiveId)
+    {
+        return true;
+    }
+
+    std::vector<uint8_t> payload;
+    PutU8(payload, RecordActive);
+    PutU32(payload, p_Id);
+
+    uint64_t offset = 0;
+    if (!Append(payload, offset))
+    {
+        return false;
+    }
+    m_ActiveId = p_Id;
+    return true;
+}
+
+const HuntProfileSummary* HuntProfileStore::FindSummary(uint32_t p_Id) const
+{
+    auto found = m_Index.find(p_Id);
+    return found == m_Index.end() ? nullptr : &found->second.m_Summary;
+}
+
+void HuntProfileStore::Search(const std::string& p_Query, std::vector<HuntProfileSummary>& p_Results) const
+{
+    auto lower = [](std::string p_Text)
+    {
+        std::transform(p_Text.begin(), p_Text.end(), p_Text.begin(), [](unsigned char p_Char) { return (char)std::tolower(p_Char); });
+        return p_Text;
+    };
+
+    std::string query = lower(p_Query);
+    p_Results.clear();
+    for (const auto& [id, entry] : m_Index)
+    {
+        if (query.empty() || lower(entry.m_Summary.m_Name).find(query) != std::string::npos ||
+            lower(entry.m_Summary.m_Target).find(query) != std::string::npos)
+        {
+            p_Results.push_back(entry.m_Summary);
+        }
+    }
+
+    std::sort(p_Results.begin(), p_Results.end(), [](const HuntProfileSummary& p_First, const HuntProfileSummary& p_Second)
+    {
+        return p_First.m_UpdatedTime != p_Second.m_UpdatedTime ? p_First.m_UpdatedTime > p_Second.m_UpdatedTime : p_First.m_Id > p_Second.m_Id;
+    });
+}
+
+std::string HuntProfileStore::GetJournalPath(uint32_t p_Id) const
+{
+    std::filesystem::path path(m_Path);
+    path.replace_filename(path.stem().string() + "_" + std::to_string(p_Id) + ".journal");
+    return path.string();
+}
+
+bool HuntProfileStore::Compact()
+{
+    if (!m_File.is_open())
+    {
+        return false;
+    }
+
+    // Copy the live records verbatim into a fresh file, then swap it in
+    std::string compactPath = m_Path + ".tmp";
+    {
+        std::ofstream output(compactPath, std::ios::binary | std::ios::trunc);
+        if (!output || !WriteHeader(output))
+        {
+            return false;
+        }
+
+        std::vector<uint8_t> record;
+        for (const auto& [id, entry] : m_Index)
+        {
+            record.resize(s_RecordHeaderSize + entry.m_Size);
+            m_File.clear();
+            m_File.seekg((std::streamoff)entry.m_Offset);
+            if (!m_File.read((char*)record.data(), record.size()))
+            {
+                return false;
+            }
+            output.write((const char*)record.data(), record.size());
+        }
+
+        if (m_ActiveId != 0)
+        {
+            std::vector<uint8_t> payload;
+            PutU8(payload, RecordActive);
+            PutU32(payload, m_ActiveId);
+            MakeRecord(record, payload);
+            output.write((const char*)record.data(), record.size());
+        }
+
+        if (!output.flush())
+        {
+            return false;
+        }
+    }
+
+    m_File.close();
+    std::error_code error;
+    std::filesystem::rename(compactPath, m_Path, error);
+    if (error)
+    {
+        // The old file is untouched, so the index still matches it
+        Logger::Error("Failed to compact hunt profile store {}: {}", m_Path, error.message());
+        m_File.open(m_Path, std::ios::binary | std::ios::in | std::ios::out);
+        return false;
+    }
+    return Open(m_Path);
+}
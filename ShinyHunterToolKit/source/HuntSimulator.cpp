@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include "../include/HuntSimulator.h"
+#include "../include/PhiloxRng.h"
+
+static const uint64_t s_ChunkTrials = 4096;
+static const uint64_t s_ExactCycleSamples = 16;
+static const double s_HistogramMinLog10 = -2.0;
+static const double s_HistogramMaxLog10 = 4.0;
+
+double HuntSimulationResult::GetBinHours(double p_Bin)
+{
+    return std::pow(10.0, s_HistogramMinLog10 + p_Bin * (s_HistogramMaxLog10 - s_HistogramMinLog10) / s_HistogramBins);
+}
+
+static size_t GetHistogramBin(double p_Hours)
+{
+    if (p_Hours <= 0.0)
+    {
+        return 0;
+    }
+
+    double bin = (std::log10(p_Hours) - s_HistogramMinLog10) / (s_HistogramMaxLog10 - s_HistogramMinLog10) * HuntSimulationResult::s_HistogramBins;
+    return (size_t)std::clamp(bin, 0.0, (double)(HuntSimulationResult::s_HistogramBins - 1));
+}
+
+// Cycle-time distribution with inverse-CDF sampling for short runs and a normal
+// approximation for long runs, where summing each reset would dominate the cost
+class CycleSampler
+{
+public:
+    CycleSampler(const HuntSimulationSettings& p_Settings)
+        : m_Mean(1.0), m_Deviation(0.0), m_Min(1.0)
+    {
+        double totalWeight = 0.0;
+        for (size_t i = 0; i < p_Settings.m_CycleSeconds.size() && i < p_Settings.m_CycleWeights.size(); ++i)
+        {
+            if (p_Settings.m_CycleWeights[i] <= 0.0) continue;
+
+            totalWeight += p_Settings.m_CycleWeights[i];
+            m_Seconds.push_back(p_Settings.m_CycleSeconds[i]);
+            m_Cumulative.push_back(totalWeight);
+        }
+
+        if (m_Seconds.empty())
+        {
+            m_Seconds.push_back(1.0);
+            m_Cumulative.push_back(1.0);
+            totalWeight = 1.0;
+        }
+
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        double previous = 0.0;
+        for (size_t i = 0; i < m_Seconds.size(); ++i)
+        {
+            double weight = (m_Cumulative[i] - previous) / totalWeight;
+            previous = m_Cumulative[i];
+            m_Cumulative[i] /= totalWeight;
+
+            sum += weight * m_Seconds[i];
+            sumSquares += weight * m_Seconds[i] * m_Seconds[i];
+        }
+
+        m_Mean = sum;
+        m_Deviation = std::sqrt(std::max(sumSquares - sum * sum, 0.0));
+        m_Min = *std::min_element(m_Seconds.begin(), m_Seconds.end());
+    }
+
+    double SampleSeconds(uint64_t p_Resets, PhiloxRng& p_Rng) const
+    {
+        if (p_Resets <= s_ExactCycleSamples)
+        {
+            double seconds = 0.0;
+            for (uint64_t i = 0; i < p_Resets; ++i)
+            {
+                double u = p_Rng.NextUniform();
+                size_t index = std::lower_bound(m_Cumulative.begin(), m_Cumulative.end(), u) - m_Cumulative.begin();
+                seconds += m_Seconds[std::min(index, m_Seconds.size() - 1)];
+            }
+            return seconds;
+        }
+
+        double seconds = p_Resets * m_Mean + std::sqrt((double)p_Resets) * m_Deviation * p_Rng.NextNormal();
+        return std::max(seconds, p_Resets * m_Min);
+    }
+
+private:
+    std::vector<double> m_Seconds;
+    std::vector<double> m_Cumulative;
+    double m_Mean;
+    double m_Deviation;
+    double m_Min;
+};
+
+struct SimulationTrial
+{
+    double m_Hours;
+    uint64_t m_Resets;
+    uint64_t m_Phases;
+};
+
+static SimulationTrial SimulateTrial(const HuntSimulationSettings& p_Settings, const std::vector<double>& p_StageLogMiss,
+    const std::vector<uint64_t>& p_StageResets, const CycleSampler& p_Cycles, PhiloxRng& p_Rng)
+{
+    SimulationTrial trial = { 0.0, 0, 0 };
+    int targetsFound = 0;
+    size_t stage = 0;
+    double seconds = 0.0;
+
+    while (targetsFound < p_Settings.m_Targets && trial.m_Resets < p_Settings.m_MaxResets)
+    {
+        // Resets until the next shiny are geometric at this stage's per-reset odds
+        double logMiss = p_StageLogMiss[stage];
+        uint64_t untilShiny = std::numeric_limits<uint64_t>::max();
+        if (logMiss < 0.0)
+        {
+            untilShiny = (uint64_t)std::min(std::floor(std::log(p_Rng.NextUniform()) / logMiss) + 1.0, 1e18);
+        }
+
+        uint64_t budget = p_Settings.m_MaxResets - trial.m_Resets;
+        bool hasNextStage = stage + 1 < p_StageLogMiss.size();
+        uint64_t stageResets = p_StageResets[stage];
+
+        if (hasNextStage && stageResets != 0 && untilShiny > stageResets)
+        {
+            uint64_t spent = std::min(stageResets, budget);
+            seconds += p_Cycles.SampleSeconds(spent, p_Rng);
+            trial.m_Resets += spent;
+            ++stage;
+            continue;
+        }
+
+        if (untilShiny > budget)
+        {
+            seconds += p_Cycles.SampleSeconds(budget, p_Rng);
+            trial.m_Resets += budget;
+            break;
+        }
+
+        seconds += p_Cycles.SampleSeconds(untilShiny, p_Rng);
+        trial.m_Resets += untilShiny;
+
+        if (p_Rng.NextUniform() < p_Settings.m_TargetChance)
+        {
+            ++targetsFound;
+        }
+        else
+        {
+            ++trial.m_Phases;
+        }
+
+        // Chains and stages start over after every shiny
+        stage = 0;
+    }
+
+    trial.m_Hours = seconds / 3600.0;
+    return trial;
+}
+
+struct StealQueue
+{
+    std::atomic<uint64_t> m_Next;
+    uint64_t m_End;
+};
+
+HuntSimulationResult HuntSimulator::Run(const HuntSimulationSettings& p_Settings, unsigned p_ThreadCount, const std::atomic<bool>& p_Cancel, std::atomic<uint64_t>& p_TrialsDone)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    HuntSimulationResult result;
+    result.m_Histogram.assign(HuntSimulationResult::s_HistogramBins, 0);
+
+    if (p_Settings.m_Trials == 0 || p_Settings.m_Stages.empty())
+    {
+        return result;
+    }
+
+    int encountersPerReset = std::max(p_Settings.m_EncountersPerReset, 1);
+    std::vector<double> stageLogMiss;
+    std::vector<uint64_t> stageResets;
+    for (const HuntSimulationStage& stage : p_Settings.m_Stages)
+    {
+        stageLogMiss.push_back(encountersPerReset * std::log1p(-std::clamp(stage.m_Probability, 0.0, 1.0 - 1e-12)));
+        stageResets.push_back((stage.m_Encounters + encountersPerReset - 1) / encountersPerReset);
+    }
+
+    CycleSampler cycles(p_Settings);
+
+    uint64_t chunkCount = (p_Settings.m_Trials + s_ChunkTrials - 1) / s_ChunkTrials;
+    unsigned threadCount = p_ThreadCount != 0 ? p_ThreadCount : std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = (unsigned)std::min<uint64_t>(threadCount, chunkCount);
+
+    // Each worker starts with an even share of the chunks
+    std::vector<std::unique_ptr<StealQueue>> queues;
+    for (unsigned w = 0; w < threadCount; ++w)
+    {
+        queues.push_back(std::make_unique<StealQueue>());
+        queues[w]->m_Next = chunkCount * w / threadCount;
+        queues[w]->m_End = chunkCount * (w + 1) / threadCount;
+    }
+
+    // Floating point sums are kept per chunk and added in chunk order at the end
+    std::vector<double> chunkHours(chunkCount, 0.0);
+    std::vector<double> chunkResets(chunkCount, 0.0);
+    std::vector<double> chunkPhases(chunkCount, 0.0);
+    std::vector<std::vector<uint64_t>> workerHistograms(threadCount, std::vector<uint64_t>(HuntSimulationResult::s_HistogramBins, 0));
+
+    auto worker = [&](unsigned p_Worker)
+        {
+            std::vector<uint64_t>& histogram = workerHistograms[p_Worker];
+
+            while (!p_Cancel.load())
+            {
+                // Own range first, then steal from the others in turn
+                uint64_t chunk = chunkCount;
+                for (unsigned offset = 0; offset < threadCount && chunk == chunkCount; ++offset)
+                {
+                    StealQueue& queue = *queues[(p_Worker + offset) % threadCount];
+                    if (queue.m_Next.load(std::memory_order_relaxed) >= queue.m_End)
+                    {
+                        continue;
+                    }
+
+                    uint64_t taken = queue.m_Next.fetch_add(1);
+                    if (taken < queue.m_End)
+                    {
+                        chunk = taken;
+                    }
+                }
+
+                if (chunk == chunkCount)
+                {
+                    break;
+                }
+
+                uint64_t first = chunk * s_ChunkTrials;
+                uint64_t last = std::min(first + s_ChunkTrials, p_Settings.m_Trials);
+
+                double hours = 0.0, resets = 0.0, phases = 0.0;
+                for (uint64_t trialIndex = first; trialIndex < last; ++trialIndex)
+                {
+                    PhiloxRng rng(p_Settings.m_Seed, trialIndex);
+                    SimulationTrial trial = SimulateTrial(p_Settings, stageLogMiss, stageResets, cycles, rng);
+
+                    hours += trial.m_Hours;
+                    resets += (double)trial.m_Resets;
+                    phases += (double)trial.m_Phases;
+                    ++histogram[GetHistogramBin(trial.m_Hours)];
+                }
+
+                chunkHours[chunk] = hours;
+                chunkResets[chunk] = resets;
+                chunkPhases[chunk] = phases;
+                p_TrialsDone += last - first;
+            }
+        };
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < threadCount; ++w)
+    {
+        threads.emplace_back(worker, w);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (p_Cancel.load())
+    {
+        return result;
+    }
+
+    for (uint64_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        result.m_MeanHours += chunkHours[chunk];
+        result.m_MeanResets += chunkResets[chunk];
+        result.m_MeanPhases += chunkPhases[chunk];
+    }
+
+    result.m_Trials = p_Settings.m_Trials;
+    result.m_MeanHours /= result.m_Trials;
+    result.m_MeanResets /= result.m_Trials;
+    result.m_MeanPhases /= result.m_Trials;
+
+    for (const std::vector<uint64_t>& histogram : workerHistograms)
+    {
+        for (size_t bin = 0; bin < HuntSimulationResult::s_HistogramBins; ++bin)
+        {
+            result.m_Histogram[bin] += histogram[bin];
+        }
+    }
+
+    // Percentiles interpolate within the log-spaced bin they fall in
+    for (size_t p = 0; p < HuntSimulationResult::s_PercentileCount; ++p)
+    {
+        double wanted = HuntSimulationResult::s_Percentiles[p] * result.m_Trials;
+        double cumulative = 0.0;
+
+        for (size_t bin = 0; bin < HuntSimulationResult::s_HistogramBins; ++bin)
+        {
+            double count = (double)result.m_Histogram[bin];
+            if (cumulative + count >= wanted && count > 0.0)
+            {
+                result.m_PercentileHours[p] = HuntSimulationResult::GetBinHours(bin + (wanted - cumulative) / count);
+                break;
+            }
+            cumulative += count;
+        }
+    }
+
+    result.m_ElapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+HuntSimulator::HuntSimulator()
+    : m_IsRunning(false), m_StopSimulation(false), m_TrialsDone(0), m_TrialsTotal(0)
+{
+}
+
+HuntSimulator::~HuntSimulator()
+{
+    Stop();
+}
+
+bool HuntSimulator::Start(const std::vector<HuntSimulationSettings>& p_Batch, unsigned p_ThreadCount)
+{
+    if (m_IsRunning.load())
+    {
+        return false;
+    }
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    m_TrialsTotal = 0;
+    for (const HuntSimulationSettings& settings : p_Batch)
+    {
+        m_TrialsTotal += settings.m_Trials;
+    }
+
+    m_StopSimulation = false;
+    m_TrialsDone = 0;
+    m_IsRunning = true;
+    m_Thread = std::thread(&HuntSimulator::RunBatch, this, p_Batch, p_ThreadCount);
+    return true;
+}
+
+void HuntSimulator::Stop()
+{
+    m_StopSimulation = true;
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+}
+
+double HuntSimulator::GetProgress() const
+{
+    return m_TrialsTotal > 0 ? (double)m_TrialsDone.load() / m_TrialsTotal : 0.0;
+}
+
+std::vector<HuntSimulationResult> HuntSimulator::GetResults() const
+{
+    std::lock_guard<std::mutex> lock(m_ResultsMutex);
+    return m_Results;
+}
+
+void HuntSimulator::RunBatch(std::vector<HuntSimulationSettings> p_Batch, unsigned p_ThreadCount)
+{
+    std::vector<HuntSimulationResult> results;
+
+    for (const HuntSimulationSettings& settings : p_Batch)
+    {
+        results.push_back(Run(settings, p_ThreadCount, m_StopSimulation, m_TrialsDone));
+        if (m_StopSimulation.load())
+        {
+            break;
+        }
+    }
+
+    if (!m_StopSimulation.load())
+    {
+        std::lock_guard<std::mutex> lock(m_ResultsMutex);
+        m_Results = results;
+    }
+
+    m_IsRunning = false;
+}
@@ -1,7 +1,11 @@
 #include <glew.h>
 #include <glfw3.h>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 #include "../Include/ImGuiApp.h"
+#include "../include/Logger.h"
 #include "../ImGui/imgui.h"
 #include "../ImGui/imgui.h"
 #include "../ImGui/imgui_impl_glfw.h"
@@ -14,11 +18,104 @@ ImGuiApp::ImGuiApp()
     m_TextColorYellow(1.0f, 1.0f, 0.0f, 1.0f),
 	m_ShinyCounter(this), 
     m_IsFirstInstance(true), 
+    m_InputGeneration(0),
     m_InputCurrentEncounters(0), 
     m_ResultCurrentEncounters(""), 
     m_InputEncountersPerReset(1), 
     m_ResultsCurrentEncountersColour(1.0f, 1.0f, 1.0f, 1.0f), 
-    m_IsAutomaticButtonActivated(false)
+    m_IsAutomaticButtonActivated(false),
+    m_InputTurboFrequency(10.0f),
+    m_InputTurboDutyCycle(50.0f),
+    m_InputTurboFrameRate(60.0f),
+    m_InputTurboAlternateButton(0),
+    m_InputSimulationTrials(1000),
+    m_InputSimulationTargets(1),
+    m_InputSimulationTargetChance(100),
+    m_InputSimulationStageEncounters(0),
+    m_InputSimulationStageMethod(0),
+    m_InputSimulationMaxInstances(4),
+    m_InputSimulationInstanceOverhead(10),
+    m_InputSimulationCycleSeconds(20),
+    m_InputRngTid(0),
+    m_InputRngSid(0),
+    m_InputRngSeedMin(0),
+    m_InputRngSeedMax(0xFFFF),
+    m_InputRngFrameMin(1),
+    m_InputRngFrameMax(100000),
+    m_InputRngMethod(0),
+    m_InputRngFrameOffset(0),
+    m_InputSeedYear(2010),
+    m_InputSeedMonth(1),
+    m_InputSeedDay(1),
+    m_InputSeedHourMin(0),
+    m_InputSeedHourMax(23),
+    m_InputSeedFrameMin(1),
+    m_InputSeedFrameMax(20),
+    m_InputSeedGen4Method(0),
+    m_InputSeedDelayMin(600),
+    m_InputSeedDelayMax(1200),
+    m_InputSeedPreferredDelay(700),
+    m_InputSeedProfile(0),
+    m_InputSeedGen5Profile(s_Gen5Profiles[0]),
+    m_InputSeedMac(0),
+    m_InputSeedKeys(),
+    m_InputSeedMaxKeys(0),
+    m_InputSeedFrameOffset(0),
+    m_SeedSearchGeneration(0),
+    m_InputHistoryRange(0),
+    m_InputDetectionSource(0),
+    m_InputDetectionWindowTitle(),
+    m_InputDetectionPattern(),
+    m_InputDetectionMaxFps(30),
+    m_InputAudioSource(0),
+    m_InputAudioPath(),
+    m_InputAudioClipPath(),
+    m_InputAudioFingerprintName("Shiny Sparkle"),
+    m_InputAudioAction(1),
+    m_InputAudioMinimumLevel(-50),
+    m_InputMacroTimeUnit(0),
+    m_InputMacroFrameRate(0),
+    m_SeenMacroStopCount(0),
+    m_InputMacroSpeedMultiplier(1.0f),
+    m_InputOptimiserMinHold(2),
+    m_InputOptimiserMinRelease(2),
+    m_InputOptimiserMinIdle(10),
+    m_OptimiserResultColour(1.0f, 1.0f, 1.0f, 1.0f),
+    m_IsMacroTimelineOpen(false),
+    m_TimelineViewStart(0.0),
+    m_TimelineViewSpan(0.0),
+    m_TimelineSelectFirst(-1),
+    m_TimelineSelectLast(-1),
+    m_IsTimelineSelecting(false),
+    m_TimelineSelectAnchor(0.0),
+    m_IsTimelineListScrollPending(false),
+    m_InputTimelineNudge(1),
+    m_InputTimelineScale(100.0f),
+    m_IsMacroRecordingStreamed(false),
+    m_InputMacroFilePath("recording.shm"),
+    m_MacroFileResultColour(1.0f, 1.0f, 1.0f, 1.0f),
+    m_InputReplaySeconds(30),
+    m_ReplayResultColour(1.0f, 1.0f, 1.0f, 1.0f),
+    m_InputMacroScript(64 * 1024, '\0'),
+    m_InputMacroScriptPath(),
+    m_IsMacroScriptWatched(false),
+    m_IsMacroScriptDisassemblyShown(false),
+    m_IsMacroScriptCompiled(false),
+    m_MacroScriptCompileMs(0.0),
+    m_InputHuntName(),
+    m_InputHuntTarget(),
+    m_InputHuntNotes(),
+    m_InputHuntNewName(),
+    m_InputHuntSearch(),
+    m_IsHuntSearchDirty(true),
+    m_HuntDeleteId(0),
+    m_HuntResultColour(1.0f, 1.0f, 1.0f, 1.0f),
+    m_HuntSaveTime(0.0),
+    m_InputPhaseShiny(),
+    m_InputIpcPath(),
+    m_SharedStatus(),
+    m_SharedStatusRateTime(-1.0),
+    m_InputOverlayPort(OverlayServer::s_DefaultPort)
 {
     Init();
 
@@ -27,11 +124,109 @@ ImGuiApp::ImGuiApp()
         throw std::runtime_error("Failed to initialize ViGEm client");
     }
 
+    m_ViGEmManager.SetEncounterPipeline(&m_ShinyCounter.GetEncounterPipeline());
+    m_ViGEmManager.SetMacroConditionHandler([this](MacroCondition p_Condition) -> uint64_t
+        {
+            switch (p_Condition)
+            {
+            case MacroCondition::ShinyDetected:
+                return m_ShinyDetector.IsTriggered() || m_ShinyCounter.IsFrozen();
+            case MacroCondition::CounterFrozen:
+                return m_ShinyCounter.IsFrozen();
+            case MacroCondition::EncounterCounted:
+                return m_ShinyCounter.GetEncounterPipeline().GetTotalAccepted();
+            default:
+                return 0;
+            }
+        });
+
     m_PhysicalControllerManager = new PhysicalControllerManager(m_ViGEmManager, m_ShinyCounter, *this);
     if (!m_PhysicalControllerManager->Init())
     {
         throw std::runtime_error("Failed to initialize Physical Controller Manager");
     }
+
+    if (m_HuntProfileStore.Open("hunts.shp") && m_HuntProfileStore.GetActiveId() != 0)
+    {
+        SwitchHunt(m_HuntProfileStore.GetActiveId());
+    }
+
+    // Runs on the server thread, so the counter is only read through a locked snapshot
+    m_IpcServer.SetStatusProvider([this](IpcStatus& p_Status)
+        {
+            EncounterCounterSnapshot snapshot = m_ShinyCounter.GetEncounterPipeline().GetCounterSnapshot();
+            p_Status.m_Encounters = (uint32_t)snapshot.m_Encounters;
+            p_Status.m_EncountersPerReset = (uint32_t)snapshot.m_EncountersPerReset;
+            p_Status.m_Generation = (uint8_t)snapshot.m_Generation;
+            p_Status.m_Method = (uint8_t)snapshot.m_Method;
+            p_Status.m_Flags = (m_ShinyCounter.IsFrozen() ? IpcStatusFrozen : 0) |
+                (m_PhysicalControllerManager->m_IsMacroThreadRunning.load() ? IpcStatusMacroRunning : 0) |
+                (m_PhysicalControllerManager->m_WaitingForUserInputSequence.load() ? IpcStatusRecording : 0) |
+                (m_PhysicalControllerManager->m_IsControllerConnected.load() ? IpcStatusControllerConnected : 0);
+            p_Status.m_PhaseCount = (uint32_t)snapshot.m_PhaseCount;
+            p_Status.m_UndoCount = (uint32_t)snapshot.m_UndoCount;
+            p_Status.m_HuntId = snapshot.m_HuntId;
+            p_Status.m_TotalAccepted = snapshot.m_TotalAccepted;
+            p_Status.m_Probability = snapshot.m_Probability;
+            p_Status.m_CumulativeProbability = snapshot.m_CumulativeProbability;
+        });
+
+    // Commands run on the server thread; playback is only queued here, since the polling
+    // thread owns it and re-checks these conditions before acting
+    m_IpcServer.SetCommandHandler([this](IpcCommand p_Command) -> IpcResult
+        {
+            HuntJournalEntry entry;
+            switch (p_Command)
+            {
+            case IpcCommand::Count:
+                return m_ShinyCounter.GetEncounterPipeline().Post(EncounterSource::Remote) ? IpcResult::Ok : IpcResult::Rejected;
+            case IpcCommand::StartPlayback:
+                if (m_PhysicalControllerManager->m_IsMacroThreadRunning.load() || m_PhysicalControllerManager->m_ButtonSequence.IsEmpty() ||
+                    m_PhysicalControllerManager->m_WaitingForUserInputSequence.load() || !m_PhysicalControllerManager->m_IsControllerConnected)
+                {
+                    return IpcResult::Rejected;
+                }
+                m_PhysicalControllerManager->RequestMacroStart();
+                return IpcResult::Ok;
+            case IpcCommand::StopPlayback:
+                if (!m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
+                {
+                    return IpcResult::Rejected;
+                }
+                m_PhysicalControllerManager->RequestMacroStop();
+                return IpcResult::Ok;
+            case IpcCommand::Undo:
+                return m_ShinyCounter.GetEncounterPipeline().Undo(entry) ? IpcResult::Ok : IpcResult::Rejected;
+            case IpcCommand::Redo:
+                return m_ShinyCounter.GetEncounterPipeline().Redo(entry) ? IpcResult::Ok : IpcResult::Rejected;
+            default:
+                return IpcResult::UnknownCommand;
+            }
+        });
+
+    // SHTK_IPC_SOCKET starts the socket with the app; left empty it uses the default path
+    char ipcPath[260] = {};
+    DWORD ipcPathLength = GetEnvironmentVariableA("SHTK_IPC_SOCKET", ipcPath, sizeof(ipcPath));
+    bool isIpcRequested = ipcPathLength < sizeof(ipcPath) && (ipcPathLength > 0 || GetLastError() != ERROR_ENVVAR_NOT_FOUND);
+    snprintf(m_InputIpcPath, sizeof(m_InputIpcPath), "%s", ipcPathLength > 0 && ipcPathLength < sizeof(ipcPath) ? ipcPath : IpcServer::GetDefaultPath().c_str());
+    if (isIpcRequested)
+    {
+        m_IpcServer.Start(m_InputIpcPath);
+    }
+
+    if (!m_SharedStatusWriter.Open())
+    {
+        Logger::Error("Failed to create the shared status block.");
+    }
+
+    // SHTK_OVERLAY_PORT starts the overlay server with the app
+    char overlayPort[16] = {};
+    DWORD overlayPortLength = GetEnvironmentVariableA("SHTK_OVERLAY_PORT", overlayPort, sizeof(overlayPort));
+    if (overlayPortLength > 0 && overlayPortLength < sizeof(overlayPort))
+    {
+        m_InputOverlayPort = std::atoi(overlayPort);
+        m_OverlayServer.Start(m_InputOverlayPort);
+    }
 }
 
 ImGuiApp::~ImGuiApp()
@@ -274,12 +469,27 @@ void ImGuiApp::CenteredInputInt(const char* label, int* value)
     }
     ImGui::PopID();
 }
+
+void ImGuiApp::CenteredSliderFloat(const char* label, float* value, float min, float max, const char* format)
+{
+    ImVec2 windowSize = ImGui::GetWindowSize();
+
+    float sliderWidth = 250.0f;
+
+    float sliderPosX = (windowSize.x - sliderWidth) * 0.5f;
+    if (sliderPosX < 0.0f)
+        sliderPosX = 0.0f;
+
+    ImGui::SetCursorPosX(sliderPosX);
+
+    ImGui::PushItemWidth(sliderWidth);
+    ImGui::SliderFloat(label, value, min, max, format, ImGuiSliderFlags_AlwaysClamp);
+    ImGui::PopItemWidth();
+}
 // Shiny Counter GUI Functions ------------------------------------------------
 
 void ImGuiApp::GetGenerationInput()
 {
-    static int selectedGeneration = 0;
-    static std::string result;
     const char* generations[] = { "Generation 1 (RBY)",
         "Generation 2 (GSC)",
         "Generation 3 (RSE/FRLG)",
@@ -288,9 +498,9 @@ void ImGuiApp::GetGenerationInput()
         "Generation 6 (XY/ORAS)",
         "Generation 7 (SM/USUM)" };
 
-    if (selectedGeneration + 1 != m_ShinyCounter.m_Generation)
+    if (m_InputGeneration + 1 != m_ShinyCounter.m_Generation)
     {
-        result = m_ShinyCounter.SetGeneration(selectedGeneration + 1);
+        m_GenerationResult = m_ShinyCounter.SetGeneration(m_InputGeneration + 1);
     }
 
     ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[5]);
@@ -299,17 +509,49 @@ void ImGuiApp::GetGenerationInput()
 
 	ImGui::Spacing();
 
-    CenteredCombo("##generationCombo", &selectedGeneration, generations, IM_ARRAYSIZE(generations));
+    CenteredCombo("##generationCombo", &m_InputGeneration, generations, IM_ARRAYSIZE(generations));
 
     ImGui::Spacing();
 
     ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
-    CenteredText(result);
+    CenteredText(m_GenerationResult);
     ImGui::PopStyleColor();
+
+    ImGui::Spacing();
+
+    GetMethodInput();
     
     ImGui::Spacing();
 }
 
+void ImGuiApp::GetMethodInput()
+{
+    int generation = m_ShinyCounter.m_Generation;
+    size_t methodCount = GetShinyMethodCount(generation);
+
+    std::vector<std::string> labels;
+    std::vector<const char*> items;
+    for (size_t i = 0; i < methodCount; ++i)
+    {
+        const ShinyMethod& method = GetShinyMethod(generation, i);
+        int denominator = (int)(1.0 / ShinyOddsEngine::GetProbability(method) + 0.5);
+        labels.push_back(std::string(method.m_Name) + " (1/" + std::to_string(denominator) + ")");
+    }
+    for (const std::string& label : labels)
+    {
+        items.push_back(label.c_str());
+    }
+
+    // The counter resets the method whenever the generation changes
+    int selectedMethod = m_ShinyCounter.m_Method;
+    CenteredCombo("##methodCombo", &selectedMethod, items.data(), (int)items.size());
+
+    if (selectedMethod != m_ShinyCounter.m_Method)
+    {
+        m_ShinyCounter.SetMethod(selectedMethod);
+    }
+}
+
 void ImGuiApp::GetEncountersPerResetInput()
 {
     static std::string result;
@@ -370,7 +612,7 @@ void ImGuiApp::GetCurrentEncountersInput()
     }
 
     CenteredButton("Set Current Encounters", [this]() {
-        m_ResultCurrentEncounters = m_ShinyCounter.SetCurrentEncounters(m_InputCurrentEncounters);
+        m_ResultCurrentEncounters = m_ShinyCounter.GetEncounterPipeline().SetCurrentEncounters(m_InputCurrentEncounters);
 
         if (m_InputCurrentEncounters < 0)
         {
@@ -383,6 +625,47 @@ void ImGuiApp::GetCurrentEncountersInput()
 
         });
 
+    // Every count change is journalled, so a misclick or a double-counted reset can be taken back
+    HuntJournal& journal = m_ShinyCounter.GetHuntJournal();
+    auto describe = [](const HuntJournalEntry& p_Entry)
+    {
+        return std::string(p_Entry.m_Event == HuntJournalEvent::Reset ? "reset" : "set") + " " +
+            std::to_string(p_Entry.m_Before) + " -> " + std::to_string(p_Entry.m_After);
+    };
+
+    std::string undoLabel = "Undo (" + std::to_string(journal.GetUndoCount()) + ")###counterUndo";
+    ImGui::BeginDisabled(journal.GetUndoCount() == 0);
+    CenteredButton(undoLabel.c_str(), [this, &describe]() {
+        HuntJournalEntry entry;
+        if (m_ShinyCounter.GetEncounterPipeline().Undo(entry))
+        {
+            m_InputCurrentEncounters = m_ShinyCounter.GetCurrentEncounters();
+            m_ResultCurrentEncounters = "Undid " + describe(entry) + ".";
+            m_ResultsCurrentEncountersColour = m_TextColorYellow;
+        }
+        });
+    ImGui::EndDisabled();
+
+    std::string redoLabel = "Redo (" + std::to_string(journal.GetRedoCount()) + ")###counterRedo";
+    ImGui::BeginDisabled(journal.GetRedoCount() == 0);
+    CenteredButton(redoLabel.c_str(), [this, &describe]() {
+        HuntJournalEntry entry;
+        if (m_ShinyCounter.GetEncounterPipeline().Redo(entry))
+        {
+            m_InputCurrentEncounters = m_ShinyCounter.GetCurrentEncounters();
+            m_ResultCurrentEncounters = "Redid " + describe(entry) + ".";
+            m_ResultsCurrentEncountersColour = m_TextColorYellow;
+        }
+        });
+    ImGui::EndDisabled();
+
+    if (m_PhysicalControllerManager->m_IsControllerConnected)
+    {
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText("(BACK + L3 undoes and START + L3 redoes from the controller)");
+        ImGui::PopFont();
+    }
+
     ImGui::Spacing();
 
     ImGui::PushStyleColor(ImGuiCol_Text, m_ResultsCurrentEncountersColour);
@@ -392,6 +675,385 @@ void ImGuiApp::GetCurrentEncountersInput()
     ImGui::Spacing();
 }
 
+void ImGuiApp::CaptureActiveHunt()
+{
+    m_ActiveHunt.m_Generation = m_ShinyCounter.m_Generation;
+    m_ActiveHunt.m_Method = m_ShinyCounter.m_Method;
+    m_ActiveHunt.m_EncountersPerReset = m_ShinyCounter.m_EncountersPerReset;
+    m_ActiveHunt.m_Encounters = m_ShinyCounter.GetCurrentEncounters();
+    m_ActiveHunt.m_PhaseStartTime = m_ShinyCounter.GetPhaseStartTime();
+    m_ActiveHunt.m_Phases = m_ShinyCounter.GetPhases();
+}
+
+bool ImGuiApp::IsActiveHuntChanged() const
+{
+    return m_ActiveHunt.m_Generation != m_ShinyCounter.m_Generation || m_ActiveHunt.m_Method != m_ShinyCounter.m_Method ||
+        m_ActiveHunt.m_EncountersPerReset != m_ShinyCounter.m_EncountersPerReset || m_ActiveHunt.m_Encounters != m_ShinyCounter.GetCurrentEncounters() ||
+        m_ActiveHunt.m_Phases.size() != m_ShinyCounter.GetPhases().size();
+}
+
+bool ImGuiApp::SaveActiveHunt()
+{
+    if (m_ActiveHunt.m_Id == 0)
+    {
+        return false;
+    }
+
+    CaptureActiveHunt();
+    m_HuntSaveTime = ImGui::GetTime();
+    m_IsHuntSearchDirty = true;
+    return m_HuntProfileStore.Save(m_ActiveHunt);
+}
+
+void ImGuiApp::ApplyActiveHunt()
+{
+    std::string generationResult = m_ShinyCounter.GetEncounterPipeline().SwitchHunt(m_ActiveHunt, m_HuntProfileStore.GetJournalPath(m_ActiveHunt.m_Id));
+    if (!generationResult.empty())
+    {
+        m_InputGeneration = m_ActiveHunt.m_Generation - 1;
+        m_GenerationResult = generationResult;
+    }
+
+    m_InputEncountersPerReset = m_ShinyCounter.m_EncountersPerReset;
+    m_InputCurrentEncounters = m_ShinyCounter.GetCurrentEncounters();
+    m_ResultCurrentEncounters = "The shiny counter has been set to " + std::to_string(m_InputCurrentEncounters) + ".";
+    m_ResultsCurrentEncountersColour = m_TextColorGreen;
+
+    snprintf(m_InputHuntName, sizeof(m_InputHuntName), "%s", m_ActiveHunt.m_Name.c_str());
+    snprintf(m_InputHuntTarget, sizeof(m_InputHuntTarget), "%s", m_ActiveHunt.m_Target.c_str());
+    snprintf(m_InputHuntNotes, sizeof(m_InputHuntNotes), "%s", m_ActiveHunt.m_Notes.c_str());
+    if (!m_ActiveHunt.m_MacroPath.empty())
+    {
+        snprintf(m_InputMacroFilePath, sizeof(m_InputMacroFilePath), "%s", m_ActiveHunt.m_MacroPath.c_str());
+    }
+
+    m_HuntSaveTime = ImGui::GetTime();
+}
+
+void ImGuiApp::SwitchHunt(uint32_t p_Id)
+{
+    SaveActiveHunt();
+
+    HuntProfile profile;
+    if (!m_HuntProfileStore.Load(p_Id, profile))
+    {
+        m_HuntResult = "Failed to load the hunt.";
+        m_HuntResultColour = m_TextColorRed;
+        return;
+    }
+
+    m_ActiveHunt = profile;
+    m_HuntProfileStore.SetActiveId(p_Id);
+    ApplyActiveHunt();
+
+    m_HuntResult = "Switched to " + m_ActiveHunt.m_Name + ".";
+    m_HuntResultColour = m_TextColorGreen;
+}
+
+void ImGuiApp::HuntProfiles()
+{
+    // The journal has every reset, so the profile record itself only needs saving now and then
+    if (m_ActiveHunt.m_Id != 0 && ImGui::GetTime() - m_HuntSaveTime > 30.0 && IsActiveHuntChanged())
+    {
+        SaveActiveHunt();
+    }
+
+    if (!ImGui::CollapsingHeader("Hunt Profiles"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Every hunt is kept in one indexed file; switching only loads the chosen hunt)");
+    ImGui::PopFont();
+
+    if (!m_HuntProfileStore.IsOpen())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText("The hunt profile store could not be opened.");
+        ImGui::PopStyleColor();
+        return;
+    }
+
+    ImGui::Spacing();
+
+    if (m_ActiveHunt.m_Id != 0)
+    {
+        CenteredText("Active Hunt: " + m_ActiveHunt.m_Name + (m_ActiveHunt.m_Target.empty() ? "" : " (" + m_ActiveHunt.m_Target + ")"));
+
+        ImGui::InputText("Name##huntName", m_InputHuntName, sizeof(m_InputHuntName));
+        ImGui::InputText("Target##huntTarget", m_InputHuntTarget, sizeof(m_InputHuntTarget));
+
+        const char* statuses[] = { "Hunting", "Found", "Abandoned" };
+        int status = (int)m_ActiveHunt.m_Status;
+        if (ImGui::Combo("Status##huntStatus", &status, statuses, IM_ARRAYSIZE(statuses)))
+        {
+            m_ActiveHunt.m_Status = (HuntStatus)status;
+            SaveActiveHunt();
+        }
+
+        ImGui::InputTextMultiline("Notes##huntNotes", m_InputHuntNotes, sizeof(m_InputHuntNotes), ImVec2(0.0f, ImGui::GetTextLineHeight() * 3.0f));
+
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText("Linked macro: " + (m_ActiveHunt.m_MacroPath.empty() ? std::string("none") : m_ActiveHunt.m_MacroPath));
+        CenteredText("Journal: " + std::to_string(HuntJournal::GetEntryCount(m_HuntProfileStore.GetJournalPath(m_ActiveHunt.m_Id))) + " events logged");
+        ImGui::PopFont();
+
+        CenteredButton("Link Current Macro File", [this]()
+            {
+                // The periodic save only looks at the counter, so write the link now
+                m_ActiveHunt.m_MacroPath = m_InputMacroFilePath;
+                bool isSaved = SaveActiveHunt();
+                m_HuntResult = isSaved ? "Linked " + m_ActiveHunt.m_MacroPath + "." : "Failed to save the linked macro.";
+                m_HuntResultColour = isSaved ? m_TextColorGreen : m_TextColorRed;
+            });
+
+        CenteredButton("Save Hunt", [this]()
+            {
+                m_ActiveHunt.m_Name = m_InputHuntName;
+                m_ActiveHunt.m_Target = m_InputHuntTarget;
+                m_ActiveHunt.m_Notes = m_InputHuntNotes;
+                bool isSaved = SaveActiveHunt();
+                m_HuntResult = isSaved ? "Saved " + m_ActiveHunt.m_Name + "." : "Failed to save the hunt.";
+                m_HuntResultColour = isSaved ? m_TextColorGreen : m_TextColorRed;
+            });
+    }
+    else
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
+        CenteredText("No active hunt; the counter is not being saved.");
+        ImGui::PopStyleColor();
+    }
+
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    ImGui::InputText("New Hunt##huntNewName", m_InputHuntNewName, sizeof(m_InputHuntNewName));
+    CenteredButton("Start New Hunt", [this]()
+        {
+            SaveActiveHunt();
+
+            // A new hunt keeps the current generation, method and encounters per reset but starts from zero
+            HuntProfile profile;
+            profile.m_Name = m_InputHuntNewName[0] != '\0' ? m_InputHuntNewName : "Hunt " + std::to_string(m_HuntProfileStore.GetProfileCount() + 1);
+            profile.m_Generation = m_ShinyCounter.m_Generation;
+            profile.m_Method = m_ShinyCounter.m_Method;
+            profile.m_EncountersPerReset = m_ShinyCounter.m_EncountersPerReset;
+            profile.m_Encounters = 0;
+
+            if (!m_HuntProfileStore.Create(profile))
+            {
+                m_HuntResult = "Failed to create the hunt.";
+                m_HuntResultColour = m_TextColorRed;
+                return;
+            }
+
+            m_InputHuntNewName[0] = '\0';
+            m_IsHuntSearchDirty = true;
+            SwitchHunt(profile.m_Id);
+        });
+
+    if (!m_HuntResult.empty())
+    {
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        ImGui::PushStyleColor(ImGuiCol_Text, m_HuntResultColour);
+        CenteredText(m_HuntResult);
+        ImGui::PopStyleColor();
+        ImGui::PopFont();
+    }
+
+    ImGui::Spacing();
+
+    if (ImGui::InputText("Search##huntSearch", m_InputHuntSearch, sizeof(m_InputHuntSearch)))
+    {
+        m_IsHuntSearchDirty = true;
+    }
+
+    if (m_IsHuntSearchDirty)
+    {
+        m_HuntProfileStore.Search(m_InputHuntSearch, m_HuntSearchResults);
+        m_IsHuntSearchDirty = false;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText(std::to_string(m_HuntSearchResults.size()) + " of " + std::to_string(m_HuntProfileStore.GetProfileCount()) + " hunts");
+    ImGui::PopFont();
+
+    if (m_HuntSearchResults.empty())
+    {
+        ImGui::Spacing();
+        return;
+    }
+
+    ImGui::BeginChild("##huntResults", ImVec2(0.0f, 200.0f), ImGuiChildFlags_Border);
+    if (ImGui::BeginTable("##huntResultsTable", 6, ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Name");
+        ImGui::TableSetupColumn("Target");
+        ImGui::TableSetupColumn("Gen");
+        ImGui::TableSetupColumn("Encounters");
+        ImGui::TableSetupColumn("Status");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)m_HuntSearchResults.size());
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+            {
+                const HuntProfileSummary& hunt = m_HuntSearchResults[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(hunt.m_Name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(hunt.m_Target.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", hunt.m_Generation);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", hunt.m_Encounters);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(GetHuntStatusName(hunt.m_Status));
+                ImGui::TableNextColumn();
+
+                ImGui::PushID((int)hunt.m_Id);
+                ImGui::BeginDisabled(hunt.m_Id == m_ActiveHunt.m_Id);
+                if (ImGui::SmallButton("Switch"))
+                {
+                    SwitchHunt(hunt.m_Id);
+                }
+                ImGui::SameLine();
+                if (ImGui::SmallButton(m_HuntDeleteId == hunt.m_Id ? "Confirm" : "Delete"))
+                {
+                    if (m_HuntDeleteId != hunt.m_Id)
+                    {
+                        m_HuntDeleteId = hunt.m_Id;
+                    }
+                    else
+                    {
+                        bool isRemoved = m_HuntProfileStore.Remove(hunt.m_Id);
+                        m_HuntResult = isRemoved ? "Deleted " + hunt.m_Name + "." : "Failed to delete the hunt.";
+                        m_HuntResultColour = isRemoved ? m_TextColorGreen : m_TextColorRed;
+                        m_HuntDeleteId = 0;
+                        m_IsHuntSearchDirty = true;
+                    }
+                }
+                ImGui::EndDisabled();
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::EndChild();
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::Phases()
+{
+    if (!ImGui::CollapsingHeader("Phases"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(End a phase when an off-target shiny appears; the count restarts and the phase is kept)");
+    ImGui::PopFont();
+
+    ImGui::Spacing();
+
+    const std::vector<HuntPhase>& phases = m_ShinyCounter.GetPhases();
+    const HuntPhaseTotals& totals = m_ShinyCounter.GetPhaseTotals();
+    int current = m_ShinyCounter.GetCurrentEncounters();
+
+    CenteredText("Phase " + std::to_string(phases.size() + 1) + ": " + std::to_string(current) + " encounters");
+
+    ImGui::InputText("Shiny Found##phaseShiny", m_InputPhaseShiny, sizeof(m_InputPhaseShiny));
+    ImGui::BeginDisabled(current <= 0);
+    CenteredButton("End Phase", [this]()
+        {
+            HuntPhase phase = m_ShinyCounter.GetEncounterPipeline().EndPhase(m_InputPhaseShiny[0] != '\0' ? m_InputPhaseShiny : "Unknown");
+            m_InputCurrentEncounters = 0;
+            m_ResultCurrentEncounters = "The shiny counter has been set to 0.";
+            m_ResultsCurrentEncountersColour = m_TextColorGreen;
+            m_InputPhaseShiny[0] = '\0';
+
+            // Save straight away so the phase's shiny is never only in the journal
+            SaveActiveHunt();
+
+            m_PhaseResult = "Phase ended after " + std::to_string(phase.m_Encounters) + " encounters (" + phase.m_Shiny + ").";
+        });
+    ImGui::EndDisabled();
+
+    if (!m_PhaseResult.empty())
+    {
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+        CenteredText(m_PhaseResult);
+        ImGui::PopStyleColor();
+        ImGui::PopFont();
+    }
+
+    if (phases.empty())
+    {
+        ImGui::Spacing();
+        return;
+    }
+
+    ImGui::Spacing();
+
+    char totalsText[256];
+    snprintf(totalsText, sizeof(totalsText), "%d phases, %lld encounters in total (%lld including the current phase)",
+        totals.GetPhaseCount(), (long long)totals.GetEncounters(), (long long)totals.GetEncounters() + current);
+    CenteredText(totalsText);
+
+    snprintf(totalsText, sizeof(totalsText), "Average %.0f, shortest %d, longest %d encounters per phase",
+        totals.GetAverageEncounters(), totals.GetShortestPhase(), totals.GetLongestPhase());
+    CenteredText(totalsText);
+
+    snprintf(totalsText, sizeof(totalsText), "%d shinies found where %.2f were expected; %.1f%% of hunts would find at least this many",
+        totals.GetPhaseCount(), totals.GetExpectedShinies(), totals.GetLuck() * 100.0);
+    ImGui::PushStyleColor(ImGuiCol_Text, totals.GetLuck() < 0.5 ? m_TextColorGreen : m_TextColorYellow);
+    CenteredText(totalsText);
+    ImGui::PopStyleColor();
+
+    ImGui::BeginChild("##phaseList", ImVec2(0.0f, 150.0f), ImGuiChildFlags_Border);
+    if (ImGui::BeginTable("##phaseTable", 4, ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Phase");
+        ImGui::TableSetupColumn("Shiny");
+        ImGui::TableSetupColumn("Encounters");
+        ImGui::TableSetupColumn("Days");
+        ImGui::TableHeadersRow();
+
+        // Newest first
+        ImGuiListClipper clipper;
+        clipper.Begin((int)phases.size());
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+            {
+                size_t index = phases.size() - 1 - row;
+                const HuntPhase& phase = phases[index];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", index + 1);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(phase.m_Shiny.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", phase.m_Encounters);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", (phase.m_EndTime - phase.m_StartTime) / 86400.0);
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::EndChild();
+
+    ImGui::Spacing();
+}
+
 void ImGuiApp::IncrementEncounters()
 {
     std::string resetCombos[] = {
@@ -407,7 +1069,7 @@ void ImGuiApp::IncrementEncounters()
     ImGui::Spacing();
 
     CenteredButton("Manually Increment Encounters", [this]() {
-        m_ShinyCounter.Counter();
+        m_ShinyCounter.GetEncounterPipeline().Post(EncounterSource::Manual);
         });
 
     if (m_PhysicalControllerManager->m_IsControllerConnected)
@@ -442,6 +1104,29 @@ void ImGuiApp::DisplayEncounters()
     ImGui::PopFont();
 
     ImGui::Spacing();
+    ImGui::Spacing();
+
+    const ShinyOddsEngine& odds = m_ShinyCounter.GetOddsEngine();
+
+    char oddsText[96];
+    snprintf(oddsText, sizeof(oddsText), "Odds 1/%.0f - chance of a shiny by now: %.2f%%", 1.0 / odds.GetProbability(), odds.GetCumulativeProbability() * 100.0);
+    CenteredText(oddsText);
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    for (size_t i = 0; i < ShinyOddsEngine::s_MilestoneCount; ++i)
+    {
+        double milestone = ShinyOddsEngine::s_Milestones[i];
+        bool isReached = odds.GetCumulativeProbability() >= milestone;
+
+        snprintf(oddsText, sizeof(oddsText), isReached ? "%.0f%% reached" : "%.0f%% at %llu encounters", milestone * 100.0,
+            (unsigned long long)odds.GetEncountersForProbability(milestone));
+
+        ImGui::PushStyleColor(ImGuiCol_Text, isReached ? m_TextColorYellow : ImGui::GetStyleColorVec4(ImGuiCol_Text));
+        CenteredText(oddsText);
+        ImGui::PopStyleColor();
+    }
+    ImGui::PopFont();
+
     ImGui::Spacing();
 
 	if (m_ShinyCounter.GetCurrentEncounters() >= 999999)
@@ -453,333 +1138,2719 @@ void ImGuiApp::DisplayEncounters()
 	}
 }
 
-// Controller Manager GUI Functions ------------------------------------------------
-
-void ImGuiApp::DisplayControllerStates()
+void ImGuiApp::EncounterSources()
 {
-    if (m_PhysicalControllerManager != nullptr)
+    if (!ImGui::CollapsingHeader("Encounter Sources"))
     {
-        bool isPhysicalControllerConnected = m_PhysicalControllerManager->m_IsControllerConnected;
-        ImVec4 physicalColor = isPhysicalControllerConnected ? m_TextColorGreen : m_TextColorRed;
+        return;
+    }
 
-        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[5]);
-        CenteredText("Controller Status");
-        ImGui::PopFont();
+    EncounterEventPipeline& pipeline = m_ShinyCounter.GetEncounterPipeline();
 
-		ImGui::Spacing();
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Events inside the window of a counted one are the same encounter)");
+    ImGui::PopFont();
 
-        ImGui::PushStyleColor(ImGuiCol_Text, physicalColor);
-        CenteredText("Physical Controller:");
-        CenteredText(m_PhysicalControllerManager->CheckPhysicalControllerConnected());
-        ImGui::PopStyleColor();
+    CenteredText("De-duplication Window (ms)");
+    int window = (int)pipeline.GetDeduplicationWindow().count();
+    CenteredInputInt("##deduplicationWindow", &window);
+    pipeline.SetDeduplicationWindow(std::chrono::milliseconds(std::clamp(window, 0, 60000)));
 
+    if (ImGui::BeginTable("##encounterSources", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Source");
+        ImGui::TableSetupColumn("Enabled");
+        ImGui::TableSetupColumn("Received");
+        ImGui::TableSetupColumn("Counted");
+        ImGui::TableSetupColumn("Duplicates");
+        ImGui::TableHeadersRow();
+
+        for (int i = 0; i < (int)EncounterSource::Count; ++i)
+        {
+            EncounterSource source = (EncounterSource)i;
+            EncounterSourceStats stats = pipeline.GetSourceStats(source);
+            bool isEnabled = pipeline.IsSourceEnabled(source);
+
+            ImGui::PushID(i);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", EncounterEventPipeline::GetSourceName(source));
+            ImGui::TableNextColumn();
+            if (ImGui::Checkbox("##enabled", &isEnabled))
+            {
+                pipeline.SetSourceEnabled(source, isEnabled);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)stats.m_Received);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)stats.m_Accepted);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)stats.m_Duplicates);
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    CenteredButton("Reset Source Statistics", [&]() { pipeline.ResetStats(); });
+
+    if (m_ShinyCounter.IsFrozen())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
+        CenteredText("Counter frozen after a shiny detection.");
+        ImGui::PopStyleColor();
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::DisplayThroughput()
+{
+    EncounterStatsSnapshot stats = m_ShinyCounter.GetEncounterStats().GetSnapshot();
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[5]);
+    CenteredText("Throughput");
+    ImGui::PopFont();
+
+    ImGui::Spacing();
+
+    if (stats.m_TotalResets < 2)
+    {
+        CenteredText("Reset a few times to measure resets per hour.");
         ImGui::Spacing();
+        return;
+    }
 
-		bool isVirtualControllerConnected = m_ViGEmManager.m_IsVirtualControllerConnected;
-        ImVec4 virtualColor = isVirtualControllerConnected ? m_TextColorGreen : m_TextColorRed;
+    char text[128];
+    for (size_t w = 0; w < EncounterStats::s_WindowCount; ++w)
+    {
+        snprintf(text, sizeof(text), "%s: %.0f resets/h (%.2f s per reset)", EncounterStats::GetWindowName(w),
+            stats.m_ResetsPerHour[w], stats.m_AverageCycleSeconds[w]);
+        CenteredText(text);
+    }
 
-        ImGui::PushStyleColor(ImGuiCol_Text, virtualColor);
-        CenteredText("Virtual Controller:");
-        CenteredText(m_ViGEmManager.CheckVirtualControllerConnected());
+    snprintf(text, sizeof(text), "Session: %.0f resets/h, last cycle %.2f s", stats.m_SessionResetsPerHour, stats.m_LastCycleSeconds);
+    CenteredText(text);
+
+    if (stats.m_IsStalled)
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        snprintf(text, sizeof(text), "Stalled: no reset for %.0f s!", stats.m_SecondsSinceLastReset);
+        CenteredText(text);
         ImGui::PopStyleColor();
+    }
+
+    ImGui::Spacing();
+
+    // Cycle-time histogram, quarter-octave buckets
+    float histogramWidth = ImGui::GetWindowSize().x * 0.8f;
+    ImGui::SetCursorPosX((ImGui::GetWindowSize().x - histogramWidth) * 0.5f);
+    snprintf(text, sizeof(text), "%.2f s - %.0f s", EncounterStats::GetHistogramBucketSeconds(0),
+        EncounterStats::GetHistogramBucketSeconds(EncounterStats::s_HistogramBuckets));
+    ImGui::PlotHistogram("##cycleTimeHistogram", stats.m_Histogram, (int)EncounterStats::s_HistogramBuckets, 0, text, 0.0f, FLT_MAX, ImVec2(histogramWidth, 60.0f));
+
+    ImGui::Spacing();
+
+    // Projections use the last hour's rate, or the rate so far if the session is shorter
+    const ShinyOddsEngine& odds = m_ShinyCounter.GetOddsEngine();
+    double resetsPerHour = stats.m_ResetsPerHour[EncounterStats::s_WindowCount - 1];
+    const double targets[] = { 0.5, 0.9, 0.99 };
+    for (double target : targets)
+    {
+        if (odds.GetCumulativeProbability() >= target)
+        {
+            continue;
+        }
+
+        uint64_t remaining = odds.GetEncountersForProbability(target) - odds.GetEncounters();
+        double hours = EncounterStats::GetHoursForEncounters(remaining, m_ShinyCounter.m_EncountersPerReset, resetsPerHour);
+        if (hours < 0.0)
+        {
+            continue;
+        }
+
+        snprintf(text, sizeof(text), "%.0f%% chance of a shiny in %.1f h", target * 100.0, hours);
+        CenteredText(text);
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::EncounterHistoryPlot()
+{
+    if (!ImGui::CollapsingHeader("Encounter History"))
+    {
+        return;
+    }
 
+    const EncounterHistory& history = m_ShinyCounter.GetEncounterHistory();
+    if (history.GetResetCount() < 2)
+    {
+        CenteredText("Reset a few times to plot the hunt.");
         ImGui::Spacing();
+        return;
     }
+
+    const char* ranges[] = { "Whole Session", "Last Hour", "Last 10 Minutes" };
+    const float rangeSeconds[] = { 0.0f, 3600.0f, 600.0f };
+    CenteredCombo("##historyRange", &m_InputHistoryRange, ranges, IM_ARRAYSIZE(ranges));
+
+    float maxX = history.GetSessionSeconds();
+    float minX = rangeSeconds[m_InputHistoryRange] > 0.0f ? std::max(maxX - rangeSeconds[m_InputHistoryRange], 0.0f) : 0.0f;
+
+    // One point per pixel column, however many resets the hunt has
+    size_t pointCount = (size_t)std::max(ImGui::GetContentRegionAvail().x, 16.0f);
+
+    history.GetEncounterPlot(minX, maxX, pointCount, m_HistoryPoints);
+    DrawHistoryPlot("Encounters", "%.0f", minX, maxX, IM_COL32(90, 200, 120, 255));
+
+    history.GetCycleTimePlot(minX, maxX, pointCount, m_HistoryPoints);
+    DrawHistoryPlot("Cycle Time", "%.2f s", minX, maxX, IM_COL32(240, 200, 80, 255));
+
+    ImGui::Spacing();
 }
 
-void ImGuiApp::SetIsAutomaticButtonActived(bool p_IsAutomaticButtonActivated)
+void ImGuiApp::DrawHistoryPlot(const char* p_Label, const char* p_Format, float p_MinX, float p_MaxX, ImU32 p_Colour)
 {
-	m_IsAutomaticButtonActivated = p_IsAutomaticButtonActivated;
+    ImGui::Text("%s", p_Label);
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 16.0f), 90.0f);
+    ImGui::Dummy(size);
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(25, 25, 30, 255));
+
+    if (m_HistoryPoints.empty() || p_MaxX <= p_MinX)
+    {
+        return;
+    }
+
+    float minY = m_HistoryPoints[0].m_Y;
+    float maxY = m_HistoryPoints[0].m_Y;
+    for (const HistoryPoint& point : m_HistoryPoints)
+    {
+        minY = std::min(minY, point.m_Y);
+        maxY = std::max(maxY, point.m_Y);
+    }
+    if (maxY - minY < 1e-3f)
+    {
+        maxY = minY + 1.0f;
+    }
+
+    std::vector<ImVec2> line;
+    line.reserve(m_HistoryPoints.size());
+    for (const HistoryPoint& point : m_HistoryPoints)
+    {
+        float x = origin.x + (point.m_X - p_MinX) / (p_MaxX - p_MinX) * size.x;
+        float y = origin.y + size.y - 4.0f - (point.m_Y - minY) / (maxY - minY) * (size.y - 8.0f);
+        line.push_back(ImVec2(std::clamp(x, origin.x, origin.x + size.x), y));
+    }
+
+    drawList->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+    drawList->AddPolyline(line.data(), (int)line.size(), p_Colour, ImDrawFlags_None, 1.5f);
+    drawList->PopClipRect();
+
+    char text[64];
+    snprintf(text, sizeof(text), p_Format, maxY);
+    drawList->AddText(ImVec2(origin.x + 4.0f, origin.y + 2.0f), IM_COL32(200, 200, 200, 255), text);
+    snprintf(text, sizeof(text), p_Format, minY);
+    drawList->AddText(ImVec2(origin.x + 4.0f, origin.y + size.y - ImGui::GetTextLineHeight() - 2.0f), IM_COL32(200, 200, 200, 255), text);
 }
 
-void ImGuiApp::StartRepeatedButtonThread(std::function<void()> p_Function)
+void ImGuiApp::SimulateHunt()
 {
-    m_IsAutomaticButtonActivated = true;
-    m_IsRepeatedButtonThreadRunning.store(true);
-    m_RepeatedButtonThread = std::thread([this, p_Function]()
+    if (!ImGui::CollapsingHeader("Hunt Simulator"))
+    {
+        return;
+    }
+
+    int generation = m_ShinyCounter.m_Generation;
+
+    CenteredText("Trials (thousands)");
+    CenteredInputInt("##simulationTrials", &m_InputSimulationTrials);
+    CenteredText("Targets Needed");
+    CenteredInputInt("##simulationTargets", &m_InputSimulationTargets);
+    CenteredText("Chance a Shiny is a Target (%)");
+    CenteredInputInt("##simulationTargetChance", &m_InputSimulationTargetChance);
+
+    // Mixed methods: the current method for the first N encounters of each phase, then another
+    CenteredText("Encounters Before Switching Method (0 = never)");
+    CenteredInputInt("##simulationStageEncounters", &m_InputSimulationStageEncounters);
+    if (m_InputSimulationStageEncounters > 0)
+    {
+        std::vector<const char*> methods;
+        for (size_t i = 0; i < GetShinyMethodCount(generation); ++i)
         {
-			p_Function();
-        });
+            methods.push_back(GetShinyMethod(generation, i).m_Name);
+        }
+        m_InputSimulationStageMethod = std::min(m_InputSimulationStageMethod, (int)methods.size() - 1);
+        CenteredCombo("##simulationStageMethod", &m_InputSimulationStageMethod, methods.data(), (int)methods.size());
+    }
+
+    CenteredText("Compare Up To N Instances");
+    CenteredInputInt("##simulationMaxInstances", &m_InputSimulationMaxInstances);
+    CenteredText("Cycle Time Added Per Extra Instance (%)");
+    CenteredInputInt("##simulationInstanceOverhead", &m_InputSimulationInstanceOverhead);
+
+    m_InputSimulationTrials = std::clamp(m_InputSimulationTrials, 1, 100000);
+    m_InputSimulationTargets = std::clamp(m_InputSimulationTargets, 1, 100);
+    m_InputSimulationTargetChance = std::clamp(m_InputSimulationTargetChance, 1, 100);
+    m_InputSimulationStageEncounters = std::max(m_InputSimulationStageEncounters, 0);
+    m_InputSimulationMaxInstances = std::clamp(m_InputSimulationMaxInstances, 1, 16);
+    m_InputSimulationInstanceOverhead = std::clamp(m_InputSimulationInstanceOverhead, 0, 1000);
+
+    // Cycle times come from the recorded histogram once there is enough history
+    EncounterStatsSnapshot stats = m_ShinyCounter.GetEncounterStats().GetSnapshot();
+    std::vector<double> cycleSeconds;
+    std::vector<double> cycleWeights;
+    if (stats.m_TotalResets >= 10)
+    {
+        for (size_t b = 0; b < EncounterStats::s_HistogramBuckets; ++b)
+        {
+            // Geometric centre of the quarter-octave bucket
+            cycleSeconds.push_back(EncounterStats::GetHistogramBucketSeconds(b) * std::pow(2.0, 1.0 / 8.0));
+            cycleWeights.push_back(stats.m_Histogram[b]);
+        }
+    }
+    else
+    {
+        CenteredText("Seconds Per Reset (until enough resets are recorded)");
+        CenteredInputInt("##simulationCycleSeconds", &m_InputSimulationCycleSeconds);
+        m_InputSimulationCycleSeconds = std::max(m_InputSimulationCycleSeconds, 1);
+        cycleSeconds.push_back(m_InputSimulationCycleSeconds);
+        cycleWeights.push_back(1.0);
+    }
+
+    ImGui::Spacing();
+
+    if (m_HuntSimulator.IsRunning())
+    {
+        ImGui::ProgressBar((float)m_HuntSimulator.GetProgress());
+        CenteredButton("Stop Simulation", [this]() { m_HuntSimulator.Stop(); });
+    }
+    else
+    {
+        CenteredButton("Run Simulation", [&]()
+            {
+                std::vector<HuntSimulationSettings> batch;
+                for (int instances = 1; instances <= m_InputSimulationMaxInstances; ++instances)
+                {
+                    HuntSimulationSettings settings;
+                    settings.m_Trials = (uint64_t)m_InputSimulationTrials * 1000;
+                    settings.m_Seed = 1;
+                    settings.m_EncountersPerReset = instances * std::max(m_ShinyCounter.m_EncountersPerReset, 1);
+                    settings.m_Targets = m_InputSimulationTargets;
+                    settings.m_TargetChance = m_InputSimulationTargetChance / 100.0;
+                    settings.m_Stages.push_back({ m_ShinyCounter.GetShinyProbability(), (uint64_t)m_InputSimulationStageEncounters });
+                    if (m_InputSimulationStageEncounters > 0)
+                    {
+                        settings.m_Stages.push_back({ ShinyOddsEngine::GetProbability(GetShinyMethod(generation, m_InputSimulationStageMethod)), 0 });
+                    }
+
+                    double overhead = 1.0 + (instances - 1) * m_InputSimulationInstanceOverhead / 100.0;
+                    for (double seconds : cycleSeconds)
+                    {
+                        settings.m_CycleSeconds.push_back(seconds * overhead);
+                    }
+                    settings.m_CycleWeights = cycleWeights;
+
+                    batch.push_back(settings);
+                }
+
+                m_HuntSimulator.Start(batch);
+            });
+    }
+
+    std::vector<HuntSimulationResult> results = m_HuntSimulator.GetResults();
+    if (!results.empty() && ImGui::BeginTable("##simulationResults", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Instances");
+        ImGui::TableSetupColumn("Mean (h)");
+        ImGui::TableSetupColumn("Median (h)");
+        ImGui::TableSetupColumn("90% (h)");
+        ImGui::TableSetupColumn("99% (h)");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const HuntSimulationResult& result = results[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", (int)i + 1);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", result.m_MeanHours);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", result.m_PercentileHours[1]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", result.m_PercentileHours[3]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", result.m_PercentileHours[4]);
+        }
+        ImGui::EndTable();
+
+        char text[96];
+        snprintf(text, sizeof(text), "%llu trials per row, %.2f phases per hunt on average", (unsigned long long)results[0].m_Trials, results[0].m_MeanPhases);
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText(text);
+        ImGui::PopFont();
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::RngSearch()
+{
+    if (!ImGui::CollapsingHeader("RNG Search"))
+    {
+        return;
+    }
+
+    int generation = m_ShinyCounter.m_Generation;
+    if (generation < 3 || generation > 5)
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
+        CenteredText("Select generation 3, 4 or 5 to search for shiny targets.");
+        ImGui::PopStyleColor();
+        ImGui::Spacing();
+        return;
+    }
+
+    CenteredText("Trainer ID");
+    CenteredInputInt("##rngTid", &m_InputRngTid);
+    CenteredText("Secret ID");
+    CenteredInputInt("##rngSid", &m_InputRngSid);
+    m_InputRngTid = std::clamp(m_InputRngTid, 0, 65535);
+    m_InputRngSid = std::clamp(m_InputRngSid, 0, 65535);
+
+    if (generation != 3)
+    {
+        SeedSearchInput();
+        return;
+    }
+
+    const char* methods[] = { "Method 1", "Method 2", "Method 4", "Wild (H-1)", "Wild (H-2)", "Wild (H-4)" };
+
+    // Initial seeds are entered in hex, as every Gen 3 RNG tool displays them
+    CenteredText("Initial Seed Range (hex)");
+    float seedInputWidth = 90.0f;
+    ImGui::SetCursorPosX(std::max((ImGui::GetWindowSize().x - seedInputWidth * 2.0f - ImGui::GetStyle().ItemSpacing.x) * 0.5f, 0.0f));
+    ImGui::PushItemWidth(seedInputWidth);
+    ImGui::InputScalar("##rngSeedMin", ImGuiDataType_U32, &m_InputRngSeedMin, nullptr, nullptr, "%08X", ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::SameLine();
+    ImGui::InputScalar("##rngSeedMax", ImGuiDataType_U32, &m_InputRngSeedMax, nullptr, nullptr, "%08X", ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::PopItemWidth();
+
+    CenteredText("Frame Range");
+    CenteredInputInt("##rngFrameMin", &m_InputRngFrameMin);
+    CenteredInputInt("##rngFrameMax", &m_InputRngFrameMax);
+    CenteredCombo("Method##rngMethod", &m_InputRngMethod, methods, IM_ARRAYSIZE(methods));
+
+    m_InputRngFrameMin = std::max(m_InputRngFrameMin, 1);
+    m_InputRngFrameMax = std::max(m_InputRngFrameMax, m_InputRngFrameMin);
+
+    ImGui::Spacing();
+
+    if (m_Gen3RngSearch.IsRunning())
+    {
+        ImGui::ProgressBar((float)m_Gen3RngSearch.GetProgress());
+        CenteredButton("Stop Search", [this]() { m_Gen3RngSearch.Stop(); });
+    }
+    else
+    {
+        CenteredButton("Search", [this]()
+            {
+                Gen3SearchSettings settings;
+                settings.m_Tid = (uint16_t)m_InputRngTid;
+                settings.m_Sid = (uint16_t)m_InputRngSid;
+                settings.m_SeedMin = std::min(m_InputRngSeedMin, m_InputRngSeedMax);
+                settings.m_SeedMax = std::max(m_InputRngSeedMin, m_InputRngSeedMax);
+                settings.m_FrameMin = (uint32_t)m_InputRngFrameMin;
+                settings.m_FrameMax = (uint32_t)m_InputRngFrameMax;
+                settings.m_Method = (Gen3Method)m_InputRngMethod;
+
+                m_RngSearchResult.clear();
+                m_Gen3RngSearch.Start(settings);
+            });
+    }
+
+    std::vector<Gen3SearchHit> hits = m_Gen3RngSearch.GetResults();
+    if (hits.empty())
+    {
+        ImGui::Spacing();
+        return;
+    }
+
+    CenteredText("Calibration Offset (frames)");
+    CenteredInputInt("##rngFrameOffset", &m_InputRngFrameOffset);
+
+    bool canLoadMacro = !m_PhysicalControllerManager->m_IsMacroThreadRunning.load() && !m_PhysicalControllerManager->m_WaitingForUserInputSequence.load();
+
+    ImGui::BeginChild("##rngResults", ImVec2(0.0f, 200.0f), ImGuiChildFlags_Border);
+    if (ImGui::BeginTable("##rngResultsTable", 6, ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Seed");
+        ImGui::TableSetupColumn("Frame");
+        ImGui::TableSetupColumn("PID");
+        ImGui::TableSetupColumn("Nature");
+        ImGui::TableSetupColumn("IVs");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)hits.size());
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+            {
+                const Gen3SearchHit& hit = hits[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%04X", hit.m_Seed);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", hit.m_Frame);
+                ImGui::TableNextColumn();
+                ImGui::Text("%08X", hit.m_Pid);
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", Gen3RngSearch::GetNatureName(hit.m_Nature));
+                ImGui::TableNextColumn();
+                ImGui::Text("%u/%u/%u/%u/%u/%u", hit.m_Ivs[0], hit.m_Ivs[1], hit.m_Ivs[2], hit.m_Ivs[3], hit.m_Ivs[4], hit.m_Ivs[5]);
+                ImGui::TableNextColumn();
+
+                ImGui::PushID(i);
+                ImGui::BeginDisabled(!canLoadMacro);
+                if (ImGui::SmallButton("Load Macro"))
+                {
+                    // Soft reset with A + B + Start + Select, then confirm with A on the target frame
+                    m_PhysicalControllerManager->m_ButtonSequence = Gen3RngSearch::ExportHitToMacro(hit, m_InputRngFrameOffset,
+                        XUSB_GAMEPAD_A | XUSB_GAMEPAD_B | XUSB_GAMEPAD_START | XUSB_GAMEPAD_BACK, XUSB_GAMEPAD_A);
+                    m_InputMacroTimeUnit = (int)MacroTimeUnit::Frames;
+                    m_InputMacroFrameRate = 0;
+                    m_UnoptimisedMacro.Clear();
+                    m_OptimiserIdleGaps.clear();
+                    m_OptimiserResult.clear();
+
+                    char resultText[96];
+                    snprintf(resultText, sizeof(resultText), "Loaded seed %04X frame %u as a frame-timed macro.", hit.m_Seed, hit.m_Frame);
+                    m_RngSearchResult = resultText;
+                }
+                ImGui::EndDisabled();
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::EndChild();
+
+    char summaryText[64];
+    snprintf(summaryText, sizeof(summaryText), "%d shiny frames found", (int)hits.size());
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText(summaryText);
+    ImGui::PopFont();
+
+    if (!m_RngSearchResult.empty())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText(m_RngSearchResult);
+        ImGui::PopFont();
+        ImGui::PopStyleColor();
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::SeedSearchInput()
+{
+    int generation = m_ShinyCounter.m_Generation;
+
+    CenteredText("Date (year, month, day)");
+    CenteredInputInt("##seedYear", &m_InputSeedYear);
+    CenteredInputInt("##seedMonth", &m_InputSeedMonth);
+    CenteredInputInt("##seedDay", &m_InputSeedDay);
+    CenteredText("Hour Range");
+    CenteredInputInt("##seedHourMin", &m_InputSeedHourMin);
+    CenteredInputInt("##seedHourMax", &m_InputSeedHourMax);
+    CenteredText("Frame Range");
+    CenteredInputInt("##seedFrameMin", &m_InputSeedFrameMin);
+    CenteredInputInt("##seedFrameMax", &m_InputSeedFrameMax);
+
+    m_InputSeedYear = std::clamp(m_InputSeedYear, 2000, 2099);
+    m_InputSeedMonth = std::clamp(m_InputSeedMonth, 1, 12);
+    m_InputSeedDay = std::clamp(m_InputSeedDay, 1, 31);
+    m_InputSeedHourMin = std::clamp(m_InputSeedHourMin, 0, 23);
+    m_InputSeedHourMax = std::clamp(m_InputSeedHourMax, m_InputSeedHourMin, 23);
+    m_InputSeedFrameMin = std::max(m_InputSeedFrameMin, 1);
+    m_InputSeedFrameMax = std::max(m_InputSeedFrameMax, m_InputSeedFrameMin);
+
+    if (generation == 4)
+    {
+        const char* methods[] = { "Egg PID (MT)", "Method 1" };
+        CenteredCombo("Method##seedGen4Method", &m_InputSeedGen4Method, methods, IM_ARRAYSIZE(methods));
+        CenteredText("Delay Range");
+        CenteredInputInt("##seedDelayMin", &m_InputSeedDelayMin);
+        CenteredInputInt("##seedDelayMax", &m_InputSeedDelayMax);
+        CenteredText("Preferred Delay");
+        CenteredInputInt("##seedPreferredDelay", &m_InputSeedPreferredDelay);
+
+        m_InputSeedDelayMin = std::max(m_InputSeedDelayMin, 0);
+        m_InputSeedDelayMax = std::max(m_InputSeedDelayMax, m_InputSeedDelayMin);
+
+        if (m_InputSeedGen4Method == (int)Gen4SeedMethod::EggPid && m_InputSeedFrameMax > (int)SeedSearch::s_MaxGen4EggFrame)
+        {
+            m_InputSeedFrameMax = (int)SeedSearch::s_MaxGen4EggFrame;
+        }
+    }
+    else
+    {
+        std::vector<const char*> profiles;
+        for (const Gen5Profile& profile : s_Gen5Profiles)
+        {
+            profiles.push_back(profile.m_Name);
+        }
+
+        int previousProfile = m_InputSeedProfile;
+        CenteredCombo("Profile##seedProfile", &m_InputSeedProfile, profiles.data(), (int)profiles.size());
+        if (m_InputSeedProfile != previousProfile)
+        {
+            m_InputSeedGen5Profile = s_Gen5Profiles[m_InputSeedProfile];
+        }
+
+        // Presets are a starting point; every value can be tuned to the user's console
+        if (ImGui::TreeNode("Profile Values"))
+        {
+            for (int i = 0; i < 5; ++i)
+            {
+                ImGui::PushID(i);
+                ImGui::InputScalar("Nazo", ImGuiDataType_U32, &m_InputSeedGen5Profile.m_Nazo[i], nullptr, nullptr, "%08X", ImGuiInputTextFlags_CharsHexadecimal);
+                ImGui::PopID();
+            }
+            ImGui::InputScalar("VCount", ImGuiDataType_U16, &m_InputSeedGen5Profile.m_VCount, nullptr, nullptr, "%X", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("Timer0 Min", ImGuiDataType_U16, &m_InputSeedGen5Profile.m_Timer0Min, nullptr, nullptr, "%X", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("Timer0 Max", ImGuiDataType_U16, &m_InputSeedGen5Profile.m_Timer0Max, nullptr, nullptr, "%X", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("VFrame", ImGuiDataType_U8, &m_InputSeedGen5Profile.m_VFrame, nullptr, nullptr, "%X", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("GxStat", ImGuiDataType_U32, &m_InputSeedGen5Profile.m_GxStat, nullptr, nullptr, "%X", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("MAC Address", ImGuiDataType_U64, &m_InputSeedMac, nullptr, nullptr, "%012llX", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::Checkbox("3DS", &m_InputSeedGen5Profile.m_Is3ds);
+            ImGui::TreePop();
+        }
+
+        // Keys held at boot widen the search; each allowed key multiplies the space
+        if (ImGui::TreeNode("Key Presses"))
+        {
+            static const char* keyNames[12] = { "A", "B", "Select", "Start", "Right", "Left", "Up", "Down", "R", "L", "X", "Y" };
+            for (int i = 0; i < 12; ++i)
+            {
+                if (i % 4 != 0)
+                {
+                    ImGui::SameLine();
+                }
+                ImGui::Checkbox(keyNames[i], &m_InputSeedKeys[i]);
+            }
+            CenteredText("Maximum Keys Held");
+            CenteredInputInt("##seedMaxKeys", &m_InputSeedMaxKeys);
+            m_InputSeedMaxKeys = std::clamp(m_InputSeedMaxKeys, 0, 3);
+            ImGui::TreePop();
+        }
+    }
+
+    ImGui::Spacing();
+
+    if (m_SeedSearch.IsRunning())
+    {
+        ImGui::ProgressBar((float)m_SeedSearch.GetProgress());
+        CenteredButton("Stop Search##seedSearch", [this]() { m_SeedSearch.Stop(); });
+    }
+    else
+    {
+        CenteredButton("Search##seedSearch", [&]()
+            {
+                SeedSearchSettings settings;
+                settings.m_Generation = generation;
+                settings.m_Tid = (uint16_t)m_InputRngTid;
+                settings.m_Sid = (uint16_t)m_InputRngSid;
+                settings.m_Year = m_InputSeedYear;
+                settings.m_Month = m_InputSeedMonth;
+                settings.m_Day = m_InputSeedDay;
+                settings.m_HourMin = m_InputSeedHourMin;
+                settings.m_HourMax = m_InputSeedHourMax;
+                settings.m_FrameMin = (uint32_t)m_InputSeedFrameMin;
+                settings.m_FrameMax = (uint32_t)m_InputSeedFrameMax;
+                settings.m_Gen4Method = (Gen4SeedMethod)m_InputSeedGen4Method;
+                settings.m_DelayMin = (uint32_t)m_InputSeedDelayMin;
+                settings.m_DelayMax = (uint32_t)m_InputSeedDelayMax;
+                settings.m_PreferredDelay = (uint32_t)std::max(m_InputSeedPreferredDelay, 0);
+                settings.m_Profile = m_InputSeedGen5Profile;
+                settings.m_Mac = m_InputSeedMac;
+                settings.m_MaxKeys = m_InputSeedMaxKeys;
+                for (int i = 0; i < 12; ++i)
+                {
+                    settings.m_AllowedKeys |= m_InputSeedKeys[i] ? (uint16_t)(1 << i) : 0;
+                }
+
+                m_SeedSearchGeneration = generation;
+                m_RngSearchResult.clear();
+                m_SeedSearch.Start(settings);
+            });
+    }
+
+    std::vector<SeedSearchTarget> targets = m_SeedSearch.GetResults();
+    if (targets.empty() || m_SeedSearchGeneration != generation)
+    {
+        ImGui::Spacing();
+        return;
+    }
+
+    CenteredText(generation == 4 ? "Calibration Offset (frames)" : "Hold Keys For (frames)");
+    CenteredInputInt("##seedFrameOffset", &m_InputSeedFrameOffset);
+
+    bool canLoadMacro = !m_PhysicalControllerManager->m_IsMacroThreadRunning.load() && !m_PhysicalControllerManager->m_WaitingForUserInputSequence.load();
+
+    ImGui::BeginChild("##seedResults", ImVec2(0.0f, 200.0f), ImGuiChildFlags_Border);
+    if (ImGui::BeginTable("##seedResultsTable", 6, ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Time");
+        ImGui::TableSetupColumn(generation == 4 ? "Delay" : "Timer0 / Keys");
+        ImGui::TableSetupColumn("Frame");
+        ImGui::TableSetupColumn("PID");
+        ImGui::TableSetupColumn("Seed");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)targets.size());
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+            {
+                const SeedSearchTarget& target = targets[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%02d:%02d:%02d", target.m_Hour, target.m_Minute, target.m_Second);
+                ImGui::TableNextColumn();
+                if (generation == 4)
+                {
+                    ImGui::Text("%u", target.m_Delay);
+                }
+                else
+                {
+                    ImGui::Text("%X / %s", target.m_Timer0, SeedSearch::GetGen5KeyName(target.m_Keys).c_str());
+                }
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", target.m_Frame);
+                ImGui::TableNextColumn();
+                ImGui::Text("%08X", target.m_Pid);
+                ImGui::TableNextColumn();
+                ImGui::Text(generation == 4 ? "%08llX" : "%016llX", (unsigned long long)target.m_Seed);
+                ImGui::TableNextColumn();
+
+                ImGui::PushID(i);
+                ImGui::BeginDisabled(!canLoadMacro);
+                if (ImGui::SmallButton("Load Macro"))
+                {
+                    m_PhysicalControllerManager->m_ButtonSequence = SeedSearch::ExportTargetToMacro(target, generation, m_InputSeedFrameOffset);
+                    m_InputMacroTimeUnit = (int)MacroTimeUnit::Frames;
+                    m_InputMacroFrameRate = 1;
+                    m_UnoptimisedMacro.Clear();
+                    m_OptimiserIdleGaps.clear();
+                    m_OptimiserResult.clear();
+
+                    // The macro cannot see the DS clock, so the user times the start
+                    char resultText[160];
+                    snprintf(resultText, sizeof(resultText), generation == 4 ? "Loaded the %02d:%02d:%02d target as a frame-timed macro." :
+                        "Loaded the %02d:%02d:%02d target. Start playback so the reset lands on that second of the DS clock; it plays once.",
+                        target.m_Hour, target.m_Minute, target.m_Second);
+                    m_RngSearchResult = resultText;
+                }
+                ImGui::EndDisabled();
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::EndChild();
+
+    char summaryText[64];
+    snprintf(summaryText, sizeof(summaryText), generation == 4 ? "%d targets, earliest frame first" : "%d targets, earliest frame and fewest keys first",
+        (int)targets.size());
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText(summaryText);
+    ImGui::PopFont();
+
+    if (!m_RngSearchResult.empty())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText(m_RngSearchResult);
+        ImGui::PopFont();
+        ImGui::PopStyleColor();
+    }
+
+    ImGui::Spacing();
+}
+
+// Controller Manager GUI Functions ------------------------------------------------
+
+void ImGuiApp::ShinyDetection()
+{
+    if (!ImGui::CollapsingHeader("Shiny Detection"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Watches screen regions for shiny colours, then stops the macro and freezes the counter)");
+    ImGui::PopFont();
+
+    bool isRunning = m_ShinyDetector.IsRunning();
+
+    // Pull back histogram references captured by the detector thread
+    if (isRunning)
+    {
+        m_DetectionRegions = m_ShinyDetector.GetRegions();
+    }
+
+    const char* sources[] = { "Window Capture", "Image Sequence" };
+    ImGui::BeginDisabled(isRunning);
+    CenteredCombo("##detectionSource", &m_InputDetectionSource, sources, IM_ARRAYSIZE(sources));
+
+    if (m_InputDetectionSource == 0)
+    {
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText("Window title (leave empty to capture the whole screen)");
+        ImGui::PopFont();
+        ImGui::InputText("##detectionWindow", m_InputDetectionWindowTitle, sizeof(m_InputDetectionWindowTitle));
+    }
+    else
+    {
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText("File pattern, e.g. frames/frame_%05d.bmp (BMP or PPM)");
+        ImGui::PopFont();
+        ImGui::InputText("##detectionPattern", m_InputDetectionPattern, sizeof(m_InputDetectionPattern));
+    }
+
+    CenteredText("Max Frames Per Second");
+    CenteredInputInt("##detectionMaxFps", &m_InputDetectionMaxFps);
+    m_InputDetectionMaxFps = std::clamp(m_InputDetectionMaxFps, 1, 240);
+
+    const char* modes[] = { "Palette", "Histogram" };
+    int removeRegion = -1;
+
+    for (size_t i = 0; i < m_DetectionRegions.size(); ++i)
+    {
+        DetectionRegion& region = m_DetectionRegions[i];
+        ImGui::PushID((int)i);
+
+        std::string header = region.m_Name + "###region";
+        if (ImGui::TreeNode(header.c_str()))
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "%s", region.m_Name.c_str());
+            if (ImGui::InputText("Name", name, sizeof(name)))
+            {
+                region.m_Name = name;
+            }
+
+            int position[2] = { region.m_X, region.m_Y };
+            int size[2] = { region.m_Width, region.m_Height };
+            ImGui::InputInt2("Position", position);
+            ImGui::InputInt2("Size", size);
+            region.m_X = position[0];
+            region.m_Y = position[1];
+            region.m_Width = std::max(size[0], 1);
+            region.m_Height = std::max(size[1], 1);
+
+            int mode = (int)region.m_Mode;
+            ImGui::Combo("Mode", &mode, modes, IM_ARRAYSIZE(modes));
+            region.m_Mode = (DetectionMode)mode;
+
+            if (region.m_Mode == DetectionMode::Palette)
+            {
+                int removeColour = -1;
+                for (size_t j = 0; j < region.m_Palette.size(); ++j)
+                {
+                    uint32_t colour = region.m_Palette[j];
+                    float rgb[3] = { ((colour >> 16) & 0xFF) / 255.0f, ((colour >> 8) & 0xFF) / 255.0f, (colour & 0xFF) / 255.0f };
+
+                    ImGui::PushID((int)j);
+                    if (ImGui::ColorEdit3("##colour", rgb, ImGuiColorEditFlags_DisplayHex))
+                    {
+                        region.m_Palette[j] = ((uint32_t)(rgb[0] * 255.0f + 0.5f) << 16) | ((uint32_t)(rgb[1] * 255.0f + 0.5f) << 8) | (uint32_t)(rgb[2] * 255.0f + 0.5f);
+                    }
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("Remove"))
+                    {
+                        removeColour = (int)j;
+                    }
+                    ImGui::PopID();
+                }
+
+                if (removeColour >= 0)
+                {
+                    region.m_Palette.erase(region.m_Palette.begin() + removeColour);
+                }
+                if (ImGui::SmallButton("Add Colour"))
+                {
+                    region.m_Palette.push_back(0xFFFFFF);
+                }
+
+                ImGui::SliderInt("Tolerance", &region.m_Tolerance, 0, 128);
+                ImGui::SliderFloat("Min Fraction", &region.m_Threshold, 0.0f, 1.0f, "%.3f");
+            }
+            else
+            {
+                ImGui::SliderFloat("Similarity", &region.m_Threshold, 0.0f, 1.0f, "%.3f");
+                ImGui::Checkbox("Match When Different", &region.m_MatchWhenDifferent);
+                ImGui::Text("%s", region.m_Reference.empty() ? "No reference captured" : "Reference captured");
+            }
+
+            ImGui::SliderInt("Consecutive Frames", &region.m_ConsecutiveFrames, 1, 30);
+            ImGui::Checkbox("Counts Encounters (battle start)", &region.m_CountsEncounters);
+
+            if (ImGui::SmallButton("Remove Region"))
+            {
+                removeRegion = (int)i;
+            }
+
+            ImGui::TreePop();
+        }
+
+        ImGui::PopID();
+    }
+
+    if (removeRegion >= 0)
+    {
+        m_DetectionRegions.erase(m_DetectionRegions.begin() + removeRegion);
+    }
+
+    CenteredButton("Add Region", [&]()
+        {
+            m_DetectionRegions.push_back(DetectionRegion());
+        });
+    ImGui::EndDisabled();
+
+    ImGui::Spacing();
+
+    if (isRunning)
+    {
+        CenteredButton("Stop Detection", [&]()
+            {
+                m_ShinyDetector.Stop();
+                m_DetectionRegions = m_ShinyDetector.GetRegions();
+            });
+    }
+    else
+    {
+        CenteredButton("Start Detection", [&]()
+            {
+                std::unique_ptr<FrameSource> source;
+                if (m_InputDetectionSource == 0)
+                {
+                    source = std::make_unique<ScreenCaptureFrameSource>(m_InputDetectionWindowTitle);
+                }
+                else
+                {
+                    source = std::make_unique<ImageSequenceFrameSource>(m_InputDetectionPattern);
+                }
+
+                m_ShinyDetector.SetRegions(m_DetectionRegions);
+                m_ShinyDetector.Start(std::move(source), m_InputDetectionMaxFps, [this](const DetectionRegion& p_Region)
+                    {
+                        if (p_Region.m_CountsEncounters)
+                        {
+                            m_ShinyCounter.GetEncounterPipeline().Post(EncounterSource::ImageDetector);
+                            return;
+                        }
+
+                        m_ShinyCounter.SetFrozen(true);
+                        m_PhysicalControllerManager->RequestMacroStop();
+                        Logger::Info("Shiny detected in region: {}", p_Region.m_Name);
+                    });
+            });
+    }
+
+    std::string sourceError = m_ShinyDetector.GetSourceError();
+    if (!sourceError.empty())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText(sourceError);
+        ImGui::PopStyleColor();
+    }
+
+    ShinyDetectorStats stats = m_ShinyDetector.GetStats();
+
+    if (m_ShinyDetector.IsTriggered())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+        CenteredText("Shiny detected in " + stats.m_MatchedRegion + "!");
+        ImGui::PopStyleColor();
+
+        CenteredButton("Rearm", [&]()
+            {
+                m_ShinyDetector.Rearm();
+                m_ShinyCounter.SetFrozen(false);
+            });
+    }
+
+    if (stats.m_FramesAnalysed == 0)
+    {
+        ImGui::Spacing();
+        return;
+    }
+
+    char statsText[128];
+    snprintf(statsText, sizeof(statsText), "%.1f fps | capture %.0f us | analysis %.0f us | %llu battle starts", stats.m_FramesPerSecond, stats.m_CaptureMicroseconds, stats.m_AnalysisMicroseconds, (unsigned long long)stats.m_EncountersDetected);
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText(statsText);
+    ImGui::PopFont();
+
+    if (ImGui::BeginTable("##detectionScores", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Region");
+        ImGui::TableSetupColumn("Score");
+        ImGui::TableSetupColumn("Reference");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < stats.m_Scores.size() && i < m_DetectionRegions.size(); ++i)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", m_DetectionRegions[i].m_Name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextColored(stats.m_Scores[i].m_IsMatch ? m_TextColorGreen : ImGui::GetStyleColorVec4(ImGuiCol_Text), "%.3f", stats.m_Scores[i].m_Score);
+            ImGui::TableNextColumn();
+            if (m_DetectionRegions[i].m_Mode == DetectionMode::Histogram)
+            {
+                ImGui::PushID((int)i);
+                if (ImGui::SmallButton("Capture"))
+                {
+                    m_ShinyDetector.RequestReference(i);
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::AudioDetection()
+{
+    if (!ImGui::CollapsingHeader("Audio Detection"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Listens for fingerprinted sounds: count encounters or stop on a shiny sparkle)");
+    ImGui::PopFont();
+
+    bool isRunning = m_AudioDetector.IsRunning();
+    if (isRunning)
+    {
+        m_AudioFingerprints = m_AudioDetector.GetFingerprints();
+    }
+
+    const char* sources[] = { "Recording Device", "Audio File" };
+    const char* actions[] = { "Increment Counter", "Stop Macro" };
+
+    ImGui::BeginDisabled(isRunning);
+    CenteredCombo("##audioSource", &m_InputAudioSource, sources, IM_ARRAYSIZE(sources));
+    if (m_InputAudioSource == 1)
+    {
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText("WAV file to replay");
+        ImGui::PopFont();
+        ImGui::InputText("##audioPath", m_InputAudioPath, sizeof(m_InputAudioPath));
+    }
+
+    CenteredText("Minimum Level (dB)");
+    CenteredInputInt("##audioMinimumLevel", &m_InputAudioMinimumLevel);
+    m_InputAudioMinimumLevel = std::clamp(m_InputAudioMinimumLevel, -120, 0);
+    ImGui::EndDisabled();
+
+    // New fingerprints come from a clip on disk, or from the loudest recent sound while listening
+    ImGui::InputText("Name##audioFingerprint", m_InputAudioFingerprintName, sizeof(m_InputAudioFingerprintName));
+    ImGui::Combo("On Match##audioAction", &m_InputAudioAction, actions, IM_ARRAYSIZE(actions));
+
+    if (isRunning)
+    {
+        CenteredButton("Capture Last Sound", [&]()
+            {
+                m_AudioDetector.RequestFingerprint(m_InputAudioFingerprintName, (AudioMatchAction)m_InputAudioAction);
+            });
+    }
+    else
+    {
+        ImGui::InputText("Clip##audioClip", m_InputAudioClipPath, sizeof(m_InputAudioClipPath));
+        CenteredButton("Add Fingerprint From Clip", [&]()
+            {
+                AudioFileSource clip(m_InputAudioClipPath);
+                AudioFingerprint fingerprint;
+                fingerprint.m_Action = (AudioMatchAction)m_InputAudioAction;
+                if (AudioDetector::CreateFingerprint(clip, m_InputAudioFingerprintName, fingerprint))
+                {
+                    m_AudioFingerprints.push_back(fingerprint);
+                    m_AudioDetectionResult.clear();
+                }
+                else
+                {
+                    m_AudioDetectionResult = "Could not fingerprint the clip. It must be a WAV file at least 100 ms long.";
+                }
+            });
+    }
+
+    AudioDetectorStats stats = m_AudioDetector.GetStats();
+    int removeFingerprint = -1;
+
+    if (!m_AudioFingerprints.empty() && ImGui::BeginTable("##audioFingerprints", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Sound");
+        ImGui::TableSetupColumn("On Match");
+        ImGui::TableSetupColumn("Threshold");
+        ImGui::TableSetupColumn("Score");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < m_AudioFingerprints.size(); ++i)
+        {
+            AudioFingerprint& fingerprint = m_AudioFingerprints[i];
+            float score = i < stats.m_Scores.size() ? stats.m_Scores[i] : 0.0f;
+
+            ImGui::PushID((int)i);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", fingerprint.m_Name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", actions[(int)fingerprint.m_Action]);
+            ImGui::TableNextColumn();
+            ImGui::BeginDisabled(isRunning);
+            ImGui::SetNextItemWidth(-FLT_MIN);
+            ImGui::SliderFloat("##threshold", &fingerprint.m_Threshold, 0.0f, 1.0f, "%.2f");
+            ImGui::EndDisabled();
+            ImGui::TableNextColumn();
+            ImGui::TextColored(isRunning && score >= fingerprint.m_Threshold ? m_TextColorGreen : ImGui::GetStyleColorVec4(ImGuiCol_Text), "%.2f", score);
+            ImGui::TableNextColumn();
+            ImGui::BeginDisabled(isRunning);
+            if (ImGui::SmallButton("Remove"))
+            {
+                removeFingerprint = (int)i;
+            }
+            ImGui::EndDisabled();
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    if (removeFingerprint >= 0)
+    {
+        m_AudioFingerprints.erase(m_AudioFingerprints.begin() + removeFingerprint);
+    }
+
+    ImGui::Spacing();
+
+    if (isRunning)
+    {
+        CenteredButton("Stop Listening", [&]()
+            {
+                m_AudioDetector.Stop();
+                m_AudioFingerprints = m_AudioDetector.GetFingerprints();
+            });
+    }
+    else
+    {
+        CenteredButton("Start Listening", [&]()
+            {
+                std::unique_ptr<AudioSource> source;
+                if (m_InputAudioSource == 0)
+                {
+                    source = std::make_unique<WaveInAudioSource>();
+                }
+                else
+                {
+                    source = std::make_unique<AudioFileSource>(m_InputAudioPath);
+                }
+
+                m_AudioDetector.SetFingerprints(m_AudioFingerprints);
+                m_AudioDetector.SetMinimumLevel((float)m_InputAudioMinimumLevel);
+                m_AudioDetector.Start(std::move(source), [this](const AudioFingerprint& p_Fingerprint)
+                    {
+                        if (p_Fingerprint.m_Action == AudioMatchAction::IncrementCounter)
+                        {
+                            m_ShinyCounter.GetEncounterPipeline().Post(EncounterSource::AudioDetector);
+                        }
+                        else
+                        {
+                            m_ShinyCounter.SetFrozen(true);
+                            m_PhysicalControllerManager->RequestMacroStop();
+                            Logger::Info("Shiny sound detected: {}", p_Fingerprint.m_Name);
+                        }
+                    });
+            });
+    }
+
+    std::string sourceError = m_AudioDetector.GetSourceError();
+    if (!sourceError.empty() || !m_AudioDetectionResult.empty())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText(sourceError.empty() ? m_AudioDetectionResult : sourceError);
+        ImGui::PopStyleColor();
+    }
+
+    if (stats.m_FramesAnalysed > 0)
+    {
+        char statsText[128];
+        snprintf(statsText, sizeof(statsText), "Level %.0f dB | FFT + match %.0f us per hop | %llu matches", stats.m_LevelDb, stats.m_AnalysisMicroseconds, (unsigned long long)stats.m_MatchCount);
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText(statsText);
+        ImGui::PopFont();
+
+        if (!stats.m_LastMatch.empty())
+        {
+            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+            CenteredText("Last match: " + stats.m_LastMatch);
+            ImGui::PopStyleColor();
+        }
+    }
+
+    if (m_ShinyCounter.IsFrozen())
+    {
+        CenteredButton("Unfreeze Counter", [&]() { m_ShinyCounter.SetFrozen(false); });
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::DisplayControllerStates()
+{
+    if (m_PhysicalControllerManager != nullptr)
+    {
+        bool isPhysicalControllerConnected = m_PhysicalControllerManager->m_IsControllerConnected;
+        ImVec4 physicalColor = isPhysicalControllerConnected ? m_TextColorGreen : m_TextColorRed;
+
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[5]);
+        CenteredText("Controller Status");
+        ImGui::PopFont();
+
+		ImGui::Spacing();
+
+        ImGui::PushStyleColor(ImGuiCol_Text, physicalColor);
+        CenteredText("Physical Controller:");
+        CenteredText(m_PhysicalControllerManager->CheckPhysicalControllerConnected());
+        ImGui::PopStyleColor();
+
+        ImGui::Spacing();
+
+		bool isVirtualControllerConnected = m_ViGEmManager.m_IsVirtualControllerConnected;
+        ImVec4 virtualColor = isVirtualControllerConnected ? m_TextColorGreen : m_TextColorRed;
+
+        ImGui::PushStyleColor(ImGuiCol_Text, virtualColor);
+        CenteredText("Virtual Controller:");
+        CenteredText(m_ViGEmManager.CheckVirtualControllerConnected());
+        ImGui::PopStyleColor();
+
+        ImGui::Spacing();
+    }
+}
+
+void ImGuiApp::SetIsAutomaticButtonActived(bool p_IsAutomaticButtonActivated)
+{
+	m_IsAutomaticButtonActivated = p_IsAutomaticButtonActivated;
+}
+
+void ImGuiApp::StartRepeatedButtonThread(std::function<void()> p_Function)
+{
+    m_IsAutomaticButtonActivated = true;
+    m_IsRepeatedButtonThreadRunning.store(true);
+    m_RepeatedButtonThread = std::thread([this, p_Function]()
+        {
+			p_Function();
+        });
+
+	Logger::Log(LogLevel::Debug, "Started repeated button thread");
+}
+
+void ImGuiApp::StopRepeatedButtonThread()
+{
+    m_IsAutomaticButtonActivated = false;
+    m_IsRepeatedButtonThreadRunning.store(false);
+    if (m_RepeatedButtonThread.joinable())
+    {
+        m_RepeatedButtonThread.join();
+        Logger::Log(LogLevel::Debug, "Stopped repeated button thread");
+    }
+}
+
+void ImGuiApp::HandleImGuiRepeatedThreadStop()
+{
+    if (m_IsRepeatedButtonThreadRunning.load())
+    {
+        StopRepeatedButtonThread();
+    }
+    else
+    {
+        SetIsAutomaticButtonActived(false);
+    }
+}
+
+void ImGuiApp::RepeatedButtonPress()
+{
+    const char* buttonLabel = m_IsAutomaticButtonActivated ? "Disengage Automatic Button Press" : "Engage Automatic Button Press";
+
+    bool canDisplayTriggersMessage = true;
+    bool isDisplayingTriggersMessage = false;
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[5]);
+    CenteredText("Automatic Button Press");
+    ImGui::PopFont();
+
+    ImGui::Spacing();
+
+    if (m_PhysicalControllerManager->m_IsControllerConnected)
+    {
+        CenteredButton(buttonLabel, [this]()
+            {
+                if (m_PhysicalControllerManager == nullptr) {
+                    throw std::runtime_error("PhysicalControllerManager is not initialized");
+                }
+
+                // stop when activated by controller
+                if (!m_IsRepeatedButtonThreadRunning.load() && m_PhysicalControllerManager->m_IsRepeatedThreadRunning.load())
+                {
+                    m_PhysicalControllerManager->StopRepeatedButtonPress();
+                    SetIsAutomaticButtonActived(false);
+                }
+                // stop when activated by ImGui Button
+                else if (m_IsRepeatedButtonThreadRunning.load() || m_PhysicalControllerManager->m_WaitingForUserInput.load())
+                {
+                    m_PhysicalControllerManager->StopRepeatedButtonPress();
+                    StopRepeatedButtonThread();
+                }
+                // start when activated by ImGui Button
+                else if (!m_IsRepeatedButtonThreadRunning.load() && !m_PhysicalControllerManager->m_IsRepeatedThreadRunning.load())
+                {
+                    StartRepeatedButtonThread([this]()
+                        {
+                            m_PhysicalControllerManager->HandleRepeatedThread();
+                        });
+                }
+            });
+    }
+
+    ImGui::Spacing();
+
+    if (!m_PhysicalControllerManager->IsControllerConnected())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText("Please connect a controller to use this feature.");
+        ImGui::PopStyleColor();
+        return;
+    }
+    else if (!m_PhysicalControllerManager->m_IsRepeatedThreadRunning.load())
+    {
+        if (m_PhysicalControllerManager->m_WaitingForUserInput.load())
+        {
+            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
+            CenteredText("Press any button to start automatic button presses.");
+            ImGui::PopStyleColor();
+        }
+        else
+        {
+            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+            CenteredText("automatic button press disengaged.");
+            ImGui::PopStyleColor();
+        }
+    }
+    else
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+        CenteredText("automatic button press engaged!");
+        ImGui::PopStyleColor();
+
+        char rateText[64];
+        snprintf(rateText, sizeof(rateText), "Achieved rate: %.1f presses/s", m_ViGEmManager.GetTurboEngine().GetAchievedRate());
+        CenteredText(rateText);
+    }
+
+    ImGui::Spacing();
+
+    TurboSettingsInput();
+}
+
+void ImGuiApp::TurboSettingsInput()
+{
+    const char* alternateButtons[] = { "None", "A", "B", "X", "Y", "DPAD_UP", "DPAD_DOWN", "DPAD_LEFT", "DPAD_RIGHT" };
+    const WORD alternateButtonMasks[] = { 0, XUSB_GAMEPAD_A, XUSB_GAMEPAD_B, XUSB_GAMEPAD_X, XUSB_GAMEPAD_Y,
+        XUSB_GAMEPAD_DPAD_UP, XUSB_GAMEPAD_DPAD_DOWN, XUSB_GAMEPAD_DPAD_LEFT, XUSB_GAMEPAD_DPAD_RIGHT };
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Hold several buttons together to repeat them as a chord!)");
+    ImGui::PopFont();
+
+    ImGui::Spacing();
+
+    CenteredSliderFloat("Game FPS##turboFrameRate", &m_InputTurboFrameRate, (float)TurboEngine::s_MinFrameRate, 240.0f, "%.2f");
+    m_InputTurboFrameRate = std::max(m_InputTurboFrameRate, (float)TurboEngine::s_MinFrameRate);    // Ctrl+click can type below the slider
+
+    // A tap needs one frame down and one frame up, so the game frame rate caps the press rate
+    float maxFrequency = (float)TurboEngine::GetMaxFrequency(m_InputTurboFrameRate);
+    if (m_InputTurboFrequency > maxFrequency)
+    {
+        m_InputTurboFrequency = maxFrequency;
+    }
+
+    CenteredSliderFloat("Presses/s##turboFrequency", &m_InputTurboFrequency, 1.0f, maxFrequency, "%.1f");
+    CenteredSliderFloat("Held %##turboDutyCycle", &m_InputTurboDutyCycle, 5.0f, 95.0f, "%.0f");
+    CenteredCombo("Alternate##turboAlternate", &m_InputTurboAlternateButton, alternateButtons, IM_ARRAYSIZE(alternateButtons));
+
+    TurboSettings settings;
+    settings.m_FrequencyHz = m_InputTurboFrequency;
+    settings.m_DutyCycle = m_InputTurboDutyCycle / 100.0f;
+    settings.m_FrameRate = m_InputTurboFrameRate;
+    settings.m_AlternateButtons = alternateButtonMasks[m_InputTurboAlternateButton];
+    m_ViGEmManager.GetTurboEngine().SetSettings(settings);
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::SetIsRecordMacroButtonActived(bool p_IsRecordMacroButtonActived)
+{
+    m_IsRecordMacroButtonActivated = p_IsRecordMacroButtonActived;
+}
+
+void ImGuiApp::SetIsPlaybackMacroButtonActived(bool p_IsPlaybackMacroButtonActived)
+{
+    m_IsPlaybackMacroButtonActivated = p_IsPlaybackMacroButtonActived;
+}
+
+void ImGuiApp::StartPlaybackButtonThread(std::function<void()> p_Function)
+{
+    m_IsPlaybackMacroButtonActivated = true;
+    m_IsPlaybackButtonThreadRunning.store(true);
+    m_PlaybackButtonThread = std::thread([this, p_Function]()
+        {
+            p_Function();
+        });
+
+    Logger::Log(LogLevel::Debug, "Started repeated button thread");
+}
+
+void ImGuiApp::StopPlaybackButtonThread()
+{
+    m_IsPlaybackMacroButtonActivated = false;
+    m_IsPlaybackButtonThreadRunning.store(false);
+    if (m_PlaybackButtonThread.joinable())
+    {
+
+        m_PlaybackButtonThread.join();
+    }
+}
+
+void ImGuiApp::HandleImGuiPlaybackThreadStop()
+{
+    if (m_IsPlaybackButtonThreadRunning.load())
+    {
+        StopPlaybackButtonThread();
+    }
+    else
+    {
+        SetIsPlaybackMacroButtonActived(false);
+    }
+}
+
+// Playback also starts and stops on other threads (controller combo, detectors, IPC), so the
+// button follows the macro thread here instead of being set from those threads
+void ImGuiApp::SyncMacroPlayback()
+{
+    bool isMacroRunning = m_PhysicalControllerManager->m_IsMacroThreadRunning.load();
+    uint32_t stopCount = m_PhysicalControllerManager->m_MacroStopCount.load();
+
+    if (stopCount != m_SeenMacroStopCount)
+    {
+        m_SeenMacroStopCount = stopCount;
+        if (!isMacroRunning)
+        {
+            HandleImGuiPlaybackThreadStop();
+        }
+    }
+    else if (isMacroRunning && !m_IsPlaybackMacroButtonActivated)
+    {
+        SetIsPlaybackMacroButtonActived(true);
+    }
+}
+
+void ImGuiApp::Macros()
+{
+    const char* recordButtonLabel = m_IsRecordMacroButtonActivated ? "Stop Recording Macro" : "Start Recording Macro";
+    const char* playbackButtonLabel = m_IsPlaybackMacroButtonActivated ? "Stop Macro Playback" : "Start Macro Playback";
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[5]);
+    CenteredText("Macros");
+    ImGui::PopFont();
+
+    ImGui::Spacing();
+
+	// record macro
+
+    if (m_PhysicalControllerManager->m_IsControllerConnected && !m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
+    {
+        CenteredButton(recordButtonLabel, [this]()
+            {
+                m_PhysicalControllerManager->HandleRecordMacroThread();
+            });
+
+        if (!m_IsRecordMacroButtonActivated)
+        {
+            ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+            CenteredText("(Or hold both triggers for 1 second begin recording!)");
+            ImGui::PopFont();
+        }
+        else
+        {
+            ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+            CenteredText("(Or hold both triggers for 1 second to stop recording!)");
+            ImGui::PopFont();
+        }
+
+        ImGui::Spacing();
+    }
+
+    if (!m_PhysicalControllerManager->IsControllerConnected())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText("Please connect a controller to use this feature.");
+        ImGui::PopStyleColor();
+        return;
+    }
+	else if (!m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
+    {
+        if (m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
+        {
+            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
+            CenteredText("Recording macro...");
+            ImGui::PopStyleColor();
+
+            // A new recording replaces whatever the optimiser could revert to
+            m_UnoptimisedMacro.Clear();
+            m_OptimiserIdleGaps.clear();
+            m_OptimiserResult.clear();
+        }
+		else if (m_PhysicalControllerManager->m_ButtonSequence.IsEmpty())
+		{
+			ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+			CenteredText("No macro recorded.");
+			ImGui::PopStyleColor();
+		}
+		else
+        {
+            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+            CenteredText("Macro ready for playback.");
+            ImGui::PopStyleColor();
+        }
+
+        ImGui::Spacing();
+    }
+
+    MacroTimebaseInput();
+    InstantReplayInput();
+    MacroFileInput();
+
+    std::string macroError = m_ViGEmManager.GetMacroError();
+    if (!macroError.empty() && !m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText("Macro stopped: " + macroError);
+        ImGui::PopStyleColor();
+    }
+
+    if (!m_PhysicalControllerManager->m_WaitingForUserInputSequence.load() && !m_PhysicalControllerManager->m_ButtonSequence.m_Events.empty())
+    {
+        CenteredButton(m_IsMacroTimelineOpen ? "Close Timeline Editor" : "Open Timeline Editor", [this]()
+            {
+                m_IsMacroTimelineOpen = !m_IsMacroTimelineOpen;
+            });
+    }
+
+    // Recorded macros only; scripts carry their own loops and checks
+    if (!m_PhysicalControllerManager->m_IsMacroThreadRunning.load() && !m_PhysicalControllerManager->m_WaitingForUserInputSequence.load() &&
+        !m_PhysicalControllerManager->m_ButtonSequence.m_Events.empty())
+    {
+        ImGui::Checkbox("Count an encounter each loop", &m_PhysicalControllerManager->m_ButtonSequence.m_MarksEncounters);
+        ImGui::Checkbox("Stop after the loop that finds a shiny", &m_PhysicalControllerManager->m_ButtonSequence.m_StopsOnShiny);
+        ImGui::Checkbox("Play once instead of looping", &m_PhysicalControllerManager->m_ButtonSequence.m_PlaysOnce);
+        MacroOptimiserInput();
+        TimedResetInput();
+    }
+
+    if (!m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
+    {
+        MacroScriptInput();
+    }
+
+	// playback macro
+
+    if (m_PhysicalControllerManager->m_IsControllerConnected && !m_PhysicalControllerManager->m_ButtonSequence.IsEmpty() && !m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
+    {
+        CenteredButton(playbackButtonLabel, [this]()
+            {
+                // Stop when disengaged by controller
+                if (!m_IsPlaybackButtonThreadRunning.load() && m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
+                {
+                    m_PhysicalControllerManager->StopMacroButtonSequence();
+					SetIsPlaybackMacroButtonActived(false);
+                }
+				// Stop when disengaged by ImGui Button
+				else if (m_IsPlaybackButtonThreadRunning.load() || m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
+				{
+					m_PhysicalControllerManager->StopMacroButtonSequence();
+					HandleImGuiPlaybackThreadStop();
+				}
+				// start when activated by ImGui Button
+                else
+                {
+                    StartPlaybackButtonThread([this]()
+                        {
+                            m_PhysicalControllerManager->HandlePlaybackMacroThread();
+                        });
+                }
+            });
+
+        if (!m_IsPlaybackMacroButtonActivated)
+        {
+            ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+            CenteredText("(Or press L3 + R3 to begin playback!)");
+            ImGui::PopFont();
+        }
+        else
+        {
+            ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+            CenteredText("(Or press L3 + R3 to stop playback!)");
+            ImGui::PopFont();
+        }
+
+        ImGui::Spacing();
+
+        if (!m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
+        {
+            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+            CenteredText("Macro disengaged.");
+            ImGui::PopStyleColor();
+        }
+        else
+        {
+            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+            CenteredText("Macro engaged!");
+            ImGui::PopStyleColor();
+        }
+    }
+
+}
+
+void ImGuiApp::MacroTimebaseInput()
+{
+    const char* timeUnits[] = { "Milliseconds", "Frames" };
+    const char* frameRates[] = { "GB/GBA (59.7275 fps)", "NDS (59.8261 fps)", "60 fps" };
+    const double frameRateValues[] = { 59.7275, 59.8261, 60.0 };
+
+    CenteredCombo("Timebase##macroTimeUnit", &m_InputMacroTimeUnit, timeUnits, IM_ARRAYSIZE(timeUnits));
+
+    if (m_InputMacroTimeUnit == (int)MacroTimeUnit::Frames)
+    {
+        CenteredCombo("Console##macroFrameRate", &m_InputMacroFrameRate, frameRates, IM_ARRAYSIZE(frameRates));
+        CenteredSliderFloat("Emulator Speed##macroSpeed", &m_InputMacroSpeedMultiplier, 0.25f, 8.0f, "x%.2f");
+    }
+
+    MacroTimebase timebase;
+    timebase.m_Unit = (MacroTimeUnit)m_InputMacroTimeUnit;
+    timebase.m_FrameRate = frameRateValues[m_InputMacroFrameRate];
+    timebase.m_SpeedMultiplier = m_InputMacroSpeedMultiplier;
+    m_ViGEmManager.SetMacroTimebase(timebase);
+
+    const Macro& macro = m_PhysicalControllerManager->m_ButtonSequence;
+    if (!macro.IsEmpty() && !m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
+    {
+        uint64_t lengthTicks = macro.GetLengthTicks();
+        double lengthSeconds = std::chrono::duration<double>(timebase.ToDuration(macro.m_Unit, lengthTicks)).count();
+
+        char lengthText[96];
+        snprintf(lengthText, sizeof(lengthText), "Macro length: %llu %s (%.2f s)", (unsigned long long)lengthTicks,
+            macro.m_Unit == MacroTimeUnit::Frames ? "frames" : "ms", lengthSeconds);
+
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        CenteredText(lengthText);
+        ImGui::PopFont();
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::MacroOptimiserInput()
+{
+    Macro& macro = m_PhysicalControllerManager->m_ButtonSequence;
+    const char* unitName = macro.m_Unit == MacroTimeUnit::Frames ? "frames" : "ms";
+    MacroTimebase timebase = m_ViGEmManager.GetMacroTimebase();
+
+    // Always work from the recording, so the check compares against what was really pressed
+    const Macro& recording = m_UnoptimisedMacro.IsEmpty() ? macro : m_UnoptimisedMacro;
+
+    if (!ImGui::CollapsingHeader("Optimise Macro"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText(std::string("(Minimum safe delays, in ") + unitName + ")");
+    ImGui::PopFont();
+
+    CenteredText("Minimum Hold");
+    CenteredInputInt("##optimiserMinHold", &m_InputOptimiserMinHold);
+    CenteredText("Minimum Release");
+    CenteredInputInt("##optimiserMinRelease", &m_InputOptimiserMinRelease);
+    CenteredText("Minimum Idle");
+    CenteredInputInt("##optimiserMinIdle", &m_InputOptimiserMinIdle);
+
+    m_InputOptimiserMinHold = std::max(m_InputOptimiserMinHold, 0);
+    m_InputOptimiserMinRelease = std::max(m_InputOptimiserMinRelease, 0);
+    m_InputOptimiserMinIdle = std::max(m_InputOptimiserMinIdle, 0);
+
+    MacroOptimiserSettings settings;
+    settings.m_MinHoldTicks = m_InputOptimiserMinHold;
+    settings.m_MinReleaseTicks = m_InputOptimiserMinRelease;
+    settings.m_MinIdleTicks = m_InputOptimiserMinIdle;
+
+    ImGui::Spacing();
+
+    CenteredButton("Find Idle Gaps", [&]()
+        {
+            m_OptimiserIdleGaps = MacroOptimiser::FindIdleGaps(MacroOptimiser::Clean(recording, settings));
+            m_InputOptimiserSafeIdle.assign(m_OptimiserIdleGaps.size(), m_InputOptimiserMinIdle);
+        });
+
+    // Per gap safe delays, e.g. to keep the wait for a loading screen while cutting hesitations
+    if (!m_OptimiserIdleGaps.empty())
+    {
+        ImGui::BeginChild("##optimiserIdleGaps", ImVec2(0.0f, 150.0f), ImGuiChildFlags_Border);
+        if (ImGui::BeginTable("##optimiserIdleGapsTable", 3, ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Gap");
+            ImGui::TableSetupColumn("Recorded");
+            ImGui::TableSetupColumn("Safe Minimum");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < m_OptimiserIdleGaps.size(); ++i)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", (int)i + 1);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u %s", m_OptimiserIdleGaps[i].m_Ticks, unitName);
+                ImGui::TableNextColumn();
+                ImGui::PushID((int)i);
+                ImGui::SetNextItemWidth(-FLT_MIN);
+                ImGui::InputInt("##safeIdle", &m_InputOptimiserSafeIdle[i], 0);
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+        ImGui::EndChild();
+
+        for (int safeIdle : m_InputOptimiserSafeIdle)
+        {
+            settings.m_SafeIdleTicks.push_back((uint32_t)std::max(safeIdle, 0));
+        }
+    }
+
+    ImGui::Spacing();
+
+    CenteredButton("Optimise Macro", [&]()
+        {
+            MacroOptimiserReport report;
+            Macro optimised = MacroOptimiser::Optimise(recording, settings, report);
+            std::string verifyResult = MacroOptimiser::Verify(optimised, recording, settings, report);
+
+            if (!verifyResult.empty())
+            {
+                m_OptimiserResult = "Optimisation rejected: " + verifyResult;
+                m_OptimiserResultColour = m_TextColorRed;
+                return;
+            }
+
+            double before = std::chrono::duration<double>(timebase.ToDuration(macro.m_Unit, report.m_CycleTicksBefore)).count();
+            double after = std::chrono::duration<double>(timebase.ToDuration(macro.m_Unit, report.m_CycleTicksAfter)).count();
+
+            char resultText[160];
+            snprintf(resultText, sizeof(resultText), "Cycle time %.2f s -> %.2f s (%.1f%% faster). %d dropped, %d merged, %d gaps shrunk.",
+                before, after, before > 0.0 ? (before - after) * 100.0 / before : 0.0,
+                (int)report.m_DroppedEvents, (int)report.m_MergedPairs.size(), (int)report.m_ShrunkGaps);
+
+            if (m_UnoptimisedMacro.IsEmpty())
+            {
+                m_UnoptimisedMacro = macro;
+            }
+            macro = optimised;
+            m_OptimiserIdleGaps.clear();
+            m_InputOptimiserSafeIdle.clear();
+            m_OptimiserResult = resultText;
+            m_OptimiserResultColour = m_TextColorGreen;
+        });
+
+    if (!m_UnoptimisedMacro.IsEmpty())
+    {
+        CenteredButton("Revert Optimisation", [&]()
+            {
+                macro = m_UnoptimisedMacro;
+                m_UnoptimisedMacro.Clear();
+                m_OptimiserResult = "Restored the recorded macro.";
+                m_OptimiserResultColour = m_TextColorYellow;
+            });
+    }
+
+    ImGui::PushStyleColor(ImGuiCol_Text, m_OptimiserResultColour);
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText(m_OptimiserResult);
+    ImGui::PopFont();
+    ImGui::PopStyleColor();
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::TimedResetInput()
+{
+    TimedResetExecutor& executor = m_ViGEmManager.GetTimedResetExecutor();
+    MacroTimebase timebase = m_ViGEmManager.GetMacroTimebase();
+    double frameMs = 1000.0 / (timebase.m_FrameRate * timebase.m_SpeedMultiplier);
+
+    if (!ImGui::CollapsingHeader("Timed Reset"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Plays the critical presses once at exact offsets from the reset)");
+    ImGui::PopFont();
+
+    CenteredButton("Load Presses From Macro", [&]()
+        {
+            m_TimedPresses = TimedResetExecutor::GetPressesFromMacro(m_PhysicalControllerManager->m_ButtonSequence, timebase);
+        });
+
+    if (m_TimedPresses.empty())
+    {
+        ImGui::Spacing();
+        return;
+    }
+
+    // Offsets stay editable so a single press can be moved without re-recording
+    if (ImGui::BeginTable("##timedPresses", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Press");
+        ImGui::TableSetupColumn("Buttons");
+        ImGui::TableSetupColumn("Offset (ms)");
+        ImGui::TableSetupColumn("Hold (ms)");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < m_TimedPresses.size(); ++i)
+        {
+            TimedPress& press = m_TimedPresses[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", press.m_Name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", m_ViGEmManager.GetChordName(press.m_Buttons).c_str());
+            ImGui::PushID((int)i);
+            ImGui::TableNextColumn();
+            ImGui::SetNextItemWidth(-FLT_MIN);
+            ImGui::InputDouble("##offset", &press.m_OffsetMs, 0.0, 0.0, "%.2f");
+            ImGui::TableNextColumn();
+            ImGui::SetNextItemWidth(-FLT_MIN);
+            ImGui::InputDouble("##hold", &press.m_HoldMs, 0.0, 0.0, "%.2f");
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    char calibrationText[64];
+    snprintf(calibrationText, sizeof(calibrationText), "Calibration: %+.2f ms (%+.2f frames)", executor.GetCalibration(), executor.GetCalibration() / frameMs);
+    CenteredText(calibrationText);
+
+    // After a miss: hit a later frame than the target -> press earlier, and vice versa
+    if (ImGui::Button("-1 Frame"))
+    {
+        executor.NudgeCalibration(-frameMs);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("+1 Frame"))
+    {
+        executor.NudgeCalibration(frameMs);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("-1 ms"))
+    {
+        executor.NudgeCalibration(-1.0);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("+1 ms"))
+    {
+        executor.NudgeCalibration(1.0);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset##calibration"))
+    {
+        executor.SetCalibration(0.0);
+    }
+
+    ImGui::Spacing();
+
+    if (executor.IsRunning())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
+        CenteredText("Executing timed reset...");
+        ImGui::PopStyleColor();
+        CenteredButton("Stop Timed Reset", [&]() { executor.Stop(); });
+    }
+    else
+    {
+        CenteredButton("Execute Timed Reset", [&]() { executor.Start(m_TimedPresses); });
+    }
+
+    std::vector<TimedPressResult> log = executor.GetLog();
+    if (!log.empty() && ImGui::BeginTable("##timedResetLog", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Press");
+        ImGui::TableSetupColumn("Target (ms)");
+        ImGui::TableSetupColumn("Achieved (ms)");
+        ImGui::TableSetupColumn("Error (ms)");
+        ImGui::TableHeadersRow();
+
+        for (const TimedPressResult& result : log)
+        {
+            // Green inside a millisecond, yellow inside half a frame, red beyond
+            double error = std::abs(result.m_ErrorMs);
+            ImVec4 colour = error < 1.0 ? m_TextColorGreen : (error < frameMs * 0.5 ? m_TextColorYellow : m_TextColorRed);
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", result.m_Name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", result.m_TargetMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", result.m_AchievedMs);
+            ImGui::TableNextColumn();
+            ImGui::TextColored(colour, "%+.3f", result.m_ErrorMs);
+        }
+        ImGui::EndTable();
+
+        if (!executor.IsRunning())
+        {
+            CenteredButton("Compensate Mean Error", [&]() { executor.NudgeCalibration(-executor.GetMeanError()); });
+        }
+    }
+
+    ImGui::Spacing();
+}
+
+// ImGui Render/Clean Functions ------------------------------------------------
+
+void ImGuiApp::CompileMacroScript()
+{
+    auto start = std::chrono::steady_clock::now();
+    m_IsMacroScriptCompiled = m_MacroCompiler.Compile(m_InputMacroScript.data(), m_InputMacroScriptPath, m_MacroScriptProgram);
+    m_MacroScriptCompileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool ImGuiApp::LoadMacroScript()
+{
+    std::ifstream stream(m_InputMacroScriptPath, std::ios::binary);
+    if (!stream)
+    {
+        m_MacroScriptResult = "Could not open the script.";
+        return false;
+    }
+
+    // The editor buffer keeps its size; anything past it is cut off
+    stream.read(m_InputMacroScript.data(), m_InputMacroScript.size() - 1);
+    m_InputMacroScript[(size_t)stream.gcount()] = '\0';
+
+    std::error_code error;
+    m_MacroScriptWriteTime = std::filesystem::last_write_time(m_InputMacroScriptPath, error);
+    m_MacroScriptResult.clear();
+    return true;
+}
+
+void ImGuiApp::MacroFileInput()
+{
+    MacroFileWriter& writer = m_PhysicalControllerManager->m_RecordingWriter;
+    bool isRecording = m_PhysicalControllerManager->m_WaitingForUserInputSequence.load();
+
+    if (!isRecording)
+    {
+        m_PhysicalControllerManager->SetRecordingPath(m_IsMacroRecordingStreamed ? m_InputMacroFilePath : "");
+    }
+
+    if (writer.IsOpen())
+    {
+        char streamText[128];
+        snprintf(streamText, sizeof(streamText), "Streaming to disk: %llu events, %.1f KB written",
+            (unsigned long long)writer.GetEventCount(), writer.GetBytesWritten() / 1024.0);
+
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
+        CenteredText(streamText);
+        ImGui::PopStyleColor();
+        ImGui::PopFont();
+    }
+
+    if (!ImGui::CollapsingHeader("Macro Files"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Stream long recordings to disk; interrupted files load up to the last saved block)");
+    ImGui::PopFont();
+
+    ImGui::BeginDisabled(isRecording);
+    ImGui::InputText("File##macroFilePath", m_InputMacroFilePath, sizeof(m_InputMacroFilePath));
+    ImGui::Checkbox("Record straight to file", &m_IsMacroRecordingStreamed);
+    ImGui::EndDisabled();
+
+    std::string writerError = writer.GetError();
+    if (!writerError.empty())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText(writerError);
+        ImGui::PopStyleColor();
+    }
+
+    if (!isRecording)
+    {
+        CenteredButton("Load Macro File", [this]()
+            {
+                Macro macro;
+                MacroFileInfo info;
+                if (!MacroFile::Load(m_InputMacroFilePath, macro, info))
+                {
+                    m_MacroFileResult = info.m_Status;
+                    m_MacroFileResultColour = m_TextColorRed;
+                    return;
+                }
+
+                m_PhysicalControllerManager->m_ButtonSequence = macro;
+                m_UnoptimisedMacro.Clear();
+                m_OptimiserIdleGaps.clear();
+                m_OptimiserResult.clear();
+
+                m_MacroFileResult = info.m_Status + " " + std::to_string(info.m_EventCount) + " events in " + std::to_string(info.m_BlockCount) + " blocks.";
+                m_MacroFileResultColour = info.m_IsComplete ? m_TextColorGreen : m_TextColorYellow;
+            });
+    }
+
+    if (!m_MacroFileResult.empty())
+    {
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        ImGui::PushStyleColor(ImGuiCol_Text, m_MacroFileResultColour);
+        CenteredText(m_MacroFileResult);
+        ImGui::PopStyleColor();
+        ImGui::PopFont();
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::CutReplayToMacro(WORD p_TrimButtons)
+{
+    if (m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
+    {
+        m_ReplayResult = "Finish the current recording first.";
+        m_ReplayResultColour = m_TextColorRed;
+        return;
+    }
+
+    // Playback keeps its own copy of the macro, so a cut never has to stop anything
+    Macro macro;
+    if (!m_PhysicalControllerManager->m_ReplayBuffer.CutToMacro(std::chrono::seconds(m_InputReplaySeconds), p_TrimButtons, m_ViGEmManager.GetMacroTimebase(), macro))
+    {
+        m_ReplayResult = "No button presses in the last " + std::to_string(m_InputReplaySeconds) + " seconds.";
+        m_ReplayResultColour = m_TextColorRed;
+        return;
+    }
+
+    m_PhysicalControllerManager->m_ButtonSequence = macro;
+    m_UnoptimisedMacro.Clear();
+    m_OptimiserIdleGaps.clear();
+    m_OptimiserResult.clear();
+
+    m_ReplayResult = "Saved " + std::to_string(macro.m_Events.size()) + " events as the macro.";
+    m_ReplayResultColour = m_TextColorGreen;
+}
+
+void ImGuiApp::InstantReplayInput()
+{
+    // The gesture is handled even while the header is collapsed
+    if (m_PhysicalControllerManager->m_IsReplayCutRequested.exchange(false))
+    {
+        CutReplayToMacro(PhysicalControllerManager::s_ReplayCombo);
+    }
+
+    if (!ImGui::CollapsingHeader("Instant Replay"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Every input is kept for a few minutes: save a good run after the fact)");
+    ImGui::PopFont();
+
+    double coveredSeconds = std::chrono::duration<double>(m_PhysicalControllerManager->m_ReplayBuffer.GetCoveredDuration()).count();
+    char coveredText[64];
+    snprintf(coveredText, sizeof(coveredText), "Buffered: %.1f s", coveredSeconds);
+    CenteredText(coveredText);
+
+    CenteredText("Seconds To Save");
+    CenteredInputInt("##replaySeconds", &m_InputReplaySeconds);
+    m_InputReplaySeconds = std::clamp(m_InputReplaySeconds, 1, 240);
+
+    CenteredButton("Save As Macro##replay", [this]()
+        {
+            CutReplayToMacro(0);
+        });
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Or press BACK + R3 to save!)");
+    ImGui::PopFont();
+
+    if (!m_ReplayResult.empty())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_ReplayResultColour);
+        CenteredText(m_ReplayResult);
+        ImGui::PopStyleColor();
+    }
+
+    ImGui::Spacing();
+}
+
+void ImGuiApp::MacroScriptInput()
+{
+    if (!ImGui::CollapsingHeader("Macro Script"))
+    {
+        return;
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Write a macro as text: hold A 8f, wait 2s, repeat 10 ... end, if shiny goto done)");
+    ImGui::PopFont();
+
+    bool isPlaying = m_PhysicalControllerManager->m_IsMacroThreadRunning.load();
+    Macro& macro = m_PhysicalControllerManager->m_ButtonSequence;
+    bool isScriptLoaded = macro.m_Program != nullptr && macro.m_Events.empty();
+
+    ImGui::InputText("File##macroScriptPath", m_InputMacroScriptPath, sizeof(m_InputMacroScriptPath));
+    CenteredButton("Open Script", [&]()
+        {
+            if (LoadMacroScript())
+            {
+                CompileMacroScript();
+            }
+        });
+    ImGui::Checkbox("Reload when the file changes", &m_IsMacroScriptWatched);
+
+    // Polled a few times a second; a reload only replaces the playback program while stopped
+    static double lastWatchTime = 0.0;
+    if (m_IsMacroScriptWatched && m_InputMacroScriptPath[0] != '\0' && ImGui::GetTime() - lastWatchTime > 0.5)
+    {
+        lastWatchTime = ImGui::GetTime();
+
+        std::error_code error;
+        std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(m_InputMacroScriptPath, error);
+        if (!error && writeTime != m_MacroScriptWriteTime && LoadMacroScript())
+        {
+            CompileMacroScript();
+            if (m_IsMacroScriptCompiled && isScriptLoaded && !isPlaying)
+            {
+                macro.m_Program = std::make_shared<MacroProgram>(m_MacroScriptProgram);
+            }
+        }
+    }
+
+    if (ImGui::InputTextMultiline("##macroScript", m_InputMacroScript.data(), m_InputMacroScript.size(),
+        ImVec2(-FLT_MIN, ImGui::GetTextLineHeight() * 14), ImGuiInputTextFlags_AllowTabInput))
+    {
+        CompileMacroScript();
+    }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    if (m_IsMacroScriptCompiled)
+    {
+        char compileText[128];
+        snprintf(compileText, sizeof(compileText), "Compiled to %zu instructions in %.2f ms (%zu simplified)",
+            m_MacroScriptProgram.m_Code.size(), m_MacroScriptCompileMs, m_MacroCompiler.GetFoldedCount());
+
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
+        CenteredText(compileText);
+        ImGui::PopStyleColor();
+    }
+    else
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        for (const MacroCompileError& error : m_MacroCompiler.GetErrors())
+        {
+            ImGui::TextWrapped("%s", error.ToString().c_str());
+        }
+        ImGui::PopStyleColor();
+    }
+
+    if (!m_MacroScriptResult.empty())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText(m_MacroScriptResult);
+        ImGui::PopStyleColor();
+    }
+    ImGui::PopFont();
+
+    if (m_IsMacroScriptCompiled && !m_MacroScriptProgram.IsEmpty() && !isPlaying)
+    {
+        CenteredButton("Load Script For Playback", [&]()
+            {
+                // Replaces the recorded macro; the optimiser has nothing to work on for scripts
+                macro.Clear();
+                macro.m_Program = std::make_shared<MacroProgram>(m_MacroScriptProgram);
+                m_UnoptimisedMacro.Clear();
+                m_OptimiserIdleGaps.clear();
+                m_OptimiserResult.clear();
+            });
+    }
+
+    ImGui::Checkbox("Show compiled program", &m_IsMacroScriptDisassemblyShown);
+    if (m_IsMacroScriptDisassemblyShown && m_IsMacroScriptCompiled)
+    {
+        ImGui::BeginChild("##macroScriptDisassembly", ImVec2(-FLT_MIN, ImGui::GetTextLineHeight() * 10), ImGuiChildFlags_Borders);
+        ImGui::TextUnformatted(m_MacroScriptProgram.Disassemble().c_str());
+        ImGui::EndChild();
+    }
+}
+
+// Macro Timeline ---------------------------------------------------------------
+
+struct TimelineLane
+{
+    const char* m_Name;
+    WORD m_Mask;
+};
+
+static const TimelineLane s_TimelineLanes[] =
+{
+    { "A", XUSB_GAMEPAD_A }, { "B", XUSB_GAMEPAD_B }, { "X", XUSB_GAMEPAD_X }, { "Y", XUSB_GAMEPAD_Y },
+    { "Up", XUSB_GAMEPAD_DPAD_UP }, { "Down", XUSB_GAMEPAD_DPAD_DOWN }, { "Left", XUSB_GAMEPAD_DPAD_LEFT }, { "Right", XUSB_GAMEPAD_DPAD_RIGHT },
+    { "Start", XUSB_GAMEPAD_START }, { "Back", XUSB_GAMEPAD_BACK }, { "LB", XUSB_GAMEPAD_LEFT_SHOULDER }, { "RB", XUSB_GAMEPAD_RIGHT_SHOULDER },
+    { "L3", XUSB_GAMEPAD_LEFT_THUMB }, { "R3", XUSB_GAMEPAD_RIGHT_THUMB }
+};
+
+void ImGuiApp::MacroTimelineWindow()
+{
+    if (!m_IsMacroTimelineOpen)
+    {
+        return;
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(900.0f, 600.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Macro Timeline", &m_IsMacroTimelineOpen))
+    {
+        ImGui::End();
+        return;
+    }
+
+    // Playback runs on its own copy, so only a live recording locks the editor
+    Macro& macro = m_PhysicalControllerManager->m_ButtonSequence;
+    if (m_PhysicalControllerManager->m_WaitingForUserInputSequence.load() || macro.m_Events.empty())
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
+        CenteredText("No recorded events to edit.");
+        ImGui::PopStyleColor();
+        ImGui::End();
+        return;
+    }
+
+    if (!m_MacroTimeline.IsBuiltFor(macro))
+    {
+        m_MacroTimeline.Build(macro);
+        m_TimelineViewStart = 0.0;
+        m_TimelineViewSpan = (double)m_MacroTimeline.GetLength();
+        m_TimelineSelectFirst = -1;
+        m_TimelineSelectLast = -1;
+    }
+
+    MacroTimelineCanvas(macro);
+
+    const char* unitName = macro.m_Unit == MacroTimeUnit::Frames ? "frames" : "ms";
+    bool hasSelection = m_TimelineSelectFirst >= 0;
+    bool isEdited = false;
+
+    if (hasSelection)
+    {
+        uint64_t selectedTicks = m_MacroTimeline.GetEventEnd(m_TimelineSelectLast) - m_MacroTimeline.GetEventTime(m_TimelineSelectFirst);
+        ImGui::Text("Events %d - %d selected (%llu %s)", m_TimelineSelectFirst, m_TimelineSelectLast, (unsigned long long)selectedTicks, unitName);
+    }
+    else
+    {
+        ImGui::Text("%zu events, %llu %s. Drag on the timeline or click rows to select.", m_MacroTimeline.GetEventCount(), (unsigned long long)m_MacroTimeline.GetLength(), unitName);
+    }
+
+    if (ImGui::Button("Select All"))
+    {
+        m_TimelineSelectFirst = 0;
+        m_TimelineSelectLast = (int)m_MacroTimeline.GetEventCount() - 1;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Fit View"))
+    {
+        m_TimelineViewStart = 0.0;
+        m_TimelineViewSpan = (double)m_MacroTimeline.GetLength();
+    }
+
+    ImGui::BeginDisabled(!hasSelection);
+    ImGui::SameLine();
+    if (ImGui::Button("Cut"))
+    {
+        MacroTimeline::Cut(macro, m_TimelineSelectFirst, m_TimelineSelectLast);
+        m_TimelineSelectFirst = -1;
+        m_TimelineSelectLast = -1;
+        isEdited = true;
+    }
+
+    ImGui::SetNextItemWidth(100.0f);
+    ImGui::InputInt("##timelineNudge", &m_InputTimelineNudge);
+    m_InputTimelineNudge = std::max(m_InputTimelineNudge, 1);
+    ImGui::SameLine();
+    if (ImGui::Button("Nudge Earlier"))
+    {
+        isEdited = MacroTimeline::Nudge(macro, m_TimelineSelectFirst, m_TimelineSelectLast, -m_InputTimelineNudge) != 0;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Nudge Later"))
+    {
+        isEdited = MacroTimeline::Nudge(macro, m_TimelineSelectFirst, m_TimelineSelectLast, m_InputTimelineNudge) != 0;
+    }
+
+    ImGui::SetNextItemWidth(100.0f);
+    ImGui::InputFloat("##timelineScale", &m_InputTimelineScale, 0.0f, 0.0f, "%.1f%%");
+    m_InputTimelineScale = std::clamp(m_InputTimelineScale, 1.0f, 1000.0f);
+    ImGui::SameLine();
+    if (ImGui::Button("Scale"))
+    {
+        MacroTimeline::Scale(macro, m_TimelineSelectFirst, m_TimelineSelectLast, m_InputTimelineScale / 100.0);
+        isEdited = true;
+    }
+    ImGui::EndDisabled();
+
+    if (isEdited)
+    {
+        // Edits invalidate anything the optimiser could revert to
+        m_MacroTimeline.Build(macro);
+        m_UnoptimisedMacro.Clear();
+        m_OptimiserIdleGaps.clear();
+        m_OptimiserResult.clear();
+
+        if (macro.m_Events.empty())
+        {
+            m_IsMacroTimelineOpen = false;
+            ImGui::End();
+            return;
+        }
+        m_TimelineViewSpan = std::min(m_TimelineViewSpan, (double)m_MacroTimeline.GetLength());
+    }
+
+    MacroTimelineEventList(macro);
+
+    ImGui::End();
+}
+
+void ImGuiApp::MacroTimelineCanvas(const Macro& p_Macro)
+{
+    const int laneCount = IM_ARRAYSIZE(s_TimelineLanes);
+    const float laneHeight = 16.0f;
+    const float labelWidth = 50.0f;
+    const float analogHeight = m_MacroTimeline.HasAnalog() ? 90.0f : 0.0f;
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float width = std::max(ImGui::GetContentRegionAvail().x, labelWidth + 100.0f);
+    float height = laneCount * laneHeight + analogHeight;
+    ImGui::InvisibleButton("##timelineCanvas", ImVec2(width, height), ImGuiButtonFlags_MouseButtonLeft | ImGuiButtonFlags_MouseButtonRight);
+
+    float plotX = origin.x + labelWidth;
+    float plotWidth = width - labelWidth;
+    double length = (double)std::max<uint64_t>(m_MacroTimeline.GetLength(), 1);
+    ImGuiIO& io = ImGui::GetIO();
+
+    // Wheel zooms around the cursor, right-drag pans, left-drag selects
+    double ticksPerPixel = m_TimelineViewSpan / plotWidth;
+    double mouseTick = m_TimelineViewStart + (io.MousePos.x - plotX) * ticksPerPixel;
+
+    if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f)
+    {
+        double span = std::clamp(m_TimelineViewSpan * std::pow(0.8, io.MouseWheel), std::min(10.0, length), length);
+        m_TimelineViewStart = mouseTick - (mouseTick - m_TimelineViewStart) * span / m_TimelineViewSpan;
+        m_TimelineViewSpan = span;
+    }
+    if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Right))
+    {
+        m_TimelineViewStart -= io.MouseDelta.x * ticksPerPixel;
+    }
+    m_TimelineViewSpan = std::clamp(m_TimelineViewSpan, std::min(10.0, length), length);
+    m_TimelineViewStart = std::clamp(m_TimelineViewStart, 0.0, length - m_TimelineViewSpan);
+
+    ticksPerPixel = m_TimelineViewSpan / plotWidth;
+    mouseTick = std::clamp(m_TimelineViewStart + (io.MousePos.x - plotX) * ticksPerPixel, 0.0, length);
+
+    if (ImGui::IsItemClicked(ImGuiMouseButton_Left))
+    {
+        m_IsTimelineSelecting = true;
+        m_TimelineSelectAnchor = mouseTick;
+    }
+    if (m_IsTimelineSelecting)
+    {
+        double low = std::min(m_TimelineSelectAnchor, mouseTick);
+        double high = std::max(m_TimelineSelectAnchor, mouseTick);
+
+        // A click selects the event under the cursor, a drag every event starting inside it
+        size_t first = m_MacroTimeline.FindEvent((uint64_t)low);
+        size_t last = first;
+        if (high - low > ticksPerPixel * 3.0)
+        {
+            first = m_MacroTimeline.FindEventAfter((uint64_t)std::ceil(low));
+            last = m_MacroTimeline.FindEventAfter((uint64_t)high + 1);
+            last = last == 0 ? 0 : last - 1;
+        }
+
+        if (first <= last && first < m_MacroTimeline.GetEventCount())
+        {
+            m_TimelineSelectFirst = (int)first;
+            m_TimelineSelectLast = (int)last;
+        }
+
+        if (!ImGui::IsMouseDown(ImGuiMouseButton_Left))
+        {
+            m_IsTimelineSelecting = false;
+            m_IsTimelineListScrollPending = true;
+        }
+    }
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), IM_COL32(25, 25, 30, 255));
+
+    uint64_t viewStart = (uint64_t)m_TimelineViewStart;
+    uint64_t viewEnd = (uint64_t)(m_TimelineViewStart + m_TimelineViewSpan);
+    int columns = std::max((int)plotWidth, 1);
+    const std::vector<MacroTimelineSample>& samples = m_MacroTimeline.Sample(viewStart, viewEnd, columns);
+
+    // Button lanes as runs of columns where the button was held
+    for (int lane = 0; lane < laneCount; ++lane)
+    {
+        float top = origin.y + lane * laneHeight;
+        drawList->AddText(ImVec2(origin.x + 4.0f, top + 1.0f), IM_COL32(200, 200, 200, 255), s_TimelineLanes[lane].m_Name);
+        if (lane % 2 == 1)
+        {
+            drawList->AddRectFilled(ImVec2(plotX, top), ImVec2(origin.x + width, top + laneHeight), IM_COL32(255, 255, 255, 10));
+        }
+
+        int runStart = -1;
+        for (int column = 0; column <= columns; ++column)
+        {
+            bool isHeld = column < columns && (samples[column].m_Buttons & s_TimelineLanes[lane].m_Mask) != 0;
+            if (isHeld && runStart < 0)
+            {
+                runStart = column;
+            }
+            else if (!isHeld && runStart >= 0)
+            {
+                drawList->AddRectFilled(ImVec2(plotX + runStart, top + 3.0f), ImVec2(plotX + column, top + laneHeight - 3.0f), IM_COL32(90, 200, 120, 255));
+                runStart = -1;
+            }
+        }
+    }
+
+    // Analog axes as min/max bands per column
+    if (analogHeight > 0.0f)
+    {
+        const ImU32 axisColours[6] = { IM_COL32(240, 200, 80, 200), IM_COL32(240, 120, 80, 200), IM_COL32(90, 160, 250, 200),
+            IM_COL32(160, 110, 250, 200), IM_COL32(80, 220, 220, 200), IM_COL32(230, 100, 200, 200) };
+        float top = origin.y + laneCount * laneHeight;
+        float middle = top + analogHeight * 0.5f;
+        drawList->AddText(ImVec2(origin.x + 4.0f, top + 1.0f), IM_COL32(200, 200, 200, 255), "Analog");
+        drawList->AddLine(ImVec2(plotX, middle), ImVec2(origin.x + width, middle), IM_COL32(255, 255, 255, 30));
+
+        for (int column = 0; column < columns; ++column)
+        {
+            const MacroTimelineSample& sample = samples[column];
+            if (sample.IsEmpty())
+            {
+                continue;
+            }
 
-	std::cout << "Started repeated button thread\n";
-}
+            float x = plotX + column + 0.5f;
+            for (int trigger = 0; trigger < 2; ++trigger)
+            {
+                float low = top + analogHeight - sample.m_TriggerMin[trigger] / 255.0f * analogHeight;
+                float high = top + analogHeight - sample.m_TriggerMax[trigger] / 255.0f * analogHeight;
+                drawList->AddLine(ImVec2(x, low), ImVec2(x, high - 1.0f), axisColours[trigger]);
+            }
+            for (int axis = 0; axis < 4; ++axis)
+            {
+                float low = middle - sample.m_ThumbMin[axis] / 128.0f * analogHeight * 0.5f;
+                float high = middle - sample.m_ThumbMax[axis] / 128.0f * analogHeight * 0.5f;
+                drawList->AddLine(ImVec2(x, low), ImVec2(x, high - 1.0f), axisColours[2 + axis]);
+            }
+        }
+    }
 
-void ImGuiApp::StopRepeatedButtonThread()
-{
-    m_IsAutomaticButtonActivated = false;
-    m_IsRepeatedButtonThreadRunning.store(false);
-    if (m_RepeatedButtonThread.joinable())
+    if (m_TimelineSelectFirst >= 0)
     {
-        m_RepeatedButtonThread.join();
-        std::cout << "Stopped repeated button thread\n";
+        float selectStart = plotX + (float)((m_MacroTimeline.GetEventTime(m_TimelineSelectFirst) - m_TimelineViewStart) / ticksPerPixel);
+        float selectEnd = plotX + (float)((m_MacroTimeline.GetEventEnd(m_TimelineSelectLast) - m_TimelineViewStart) / ticksPerPixel);
+        selectStart = std::clamp(selectStart, plotX, origin.x + width);
+        selectEnd = std::clamp(std::max(selectEnd, selectStart + 1.0f), plotX, origin.x + width);
+        drawList->AddRectFilled(ImVec2(selectStart, origin.y), ImVec2(selectEnd, origin.y + height), IM_COL32(100, 150, 255, 50));
+        drawList->AddRect(ImVec2(selectStart, origin.y), ImVec2(selectEnd, origin.y + height), IM_COL32(100, 150, 255, 160));
     }
+
+    char viewText[96];
+    snprintf(viewText, sizeof(viewText), "%llu - %llu %s", (unsigned long long)viewStart, (unsigned long long)viewEnd,
+        p_Macro.m_Unit == MacroTimeUnit::Frames ? "frames" : "ms");
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    ImGui::TextUnformatted(viewText);
+    ImGui::PopFont();
 }
 
-void ImGuiApp::HandleImGuiRepeatedThreadStop()
+void ImGuiApp::MacroTimelineEventList(const Macro& p_Macro)
 {
-    if (m_IsRepeatedButtonThreadRunning.load())
+    if (!ImGui::BeginTable("##timelineEvents", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY, ImVec2(0.0f, ImGui::GetContentRegionAvail().y)))
     {
-        StopRepeatedButtonThread();
+        return;
     }
-    else
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("#");
+    ImGui::TableSetupColumn("Time");
+    ImGui::TableSetupColumn("Delay");
+    ImGui::TableSetupColumn("Buttons");
+    ImGui::TableSetupColumn("Analog (LT RT LX LY RX RY)");
+    ImGui::TableHeadersRow();
+
+    // Only the rows on screen are submitted, whatever the event count
+    ImGuiListClipper clipper;
+    clipper.Begin((int)p_Macro.m_Events.size());
+    if (m_IsTimelineListScrollPending && m_TimelineSelectFirst >= 0)
     {
-        SetIsAutomaticButtonActived(false);
+        clipper.IncludeItemByIndex(m_TimelineSelectFirst);
     }
-}
-
-void ImGuiApp::RepeatedButtonPress()
-{
-    const char* buttonLabel = m_IsAutomaticButtonActivated ? "Disengage Automatic Button Press" : "Engage Automatic Button Press";
-
-    bool canDisplayTriggersMessage = true;
-    bool isDisplayingTriggersMessage = false;
 
-    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[5]);
-    CenteredText("Automatic Button Press");
-    ImGui::PopFont();
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+        {
+            const MacroEvent& event = p_Macro.m_Events[row];
+            bool isSelected = m_TimelineSelectFirst >= 0 && row >= m_TimelineSelectFirst && row <= m_TimelineSelectLast;
 
-    ImGui::Spacing();
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
 
-    if (m_PhysicalControllerManager->m_IsControllerConnected)
-    {
-        CenteredButton(buttonLabel, [this]()
+            char label[32];
+            snprintf(label, sizeof(label), "%d", row);
+            if (ImGui::Selectable(label, isSelected, ImGuiSelectableFlags_SpanAllColumns))
             {
-                if (m_PhysicalControllerManager == nullptr) {
-                    throw std::runtime_error("PhysicalControllerManager is not initialized");
-                }
-
-                // stop when activated by controller
-                if (!m_IsRepeatedButtonThreadRunning.load() && m_PhysicalControllerManager->m_IsRepeatedThreadRunning.load())
+                if (ImGui::GetIO().KeyShift && m_TimelineSelectFirst >= 0)
                 {
-                    m_PhysicalControllerManager->StopRepeatedButtonPress();
-                    SetIsAutomaticButtonActived(false);
+                    m_TimelineSelectFirst = std::min(m_TimelineSelectFirst, row);
+                    m_TimelineSelectLast = std::max(m_TimelineSelectLast, row);
                 }
-                // stop when activated by ImGui Button
-                else if (m_IsRepeatedButtonThreadRunning.load() || m_PhysicalControllerManager->m_WaitingForUserInput.load())
+                else
                 {
-                    m_PhysicalControllerManager->StopRepeatedButtonPress();
-                    StopRepeatedButtonThread();
+                    m_TimelineSelectFirst = row;
+                    m_TimelineSelectLast = row;
                 }
-                // start when activated by ImGui Button
-                else if (!m_IsRepeatedButtonThreadRunning.load() && !m_PhysicalControllerManager->m_IsRepeatedThreadRunning.load())
+
+                // Bring the row into view on the timeline
+                double eventTime = (double)m_MacroTimeline.GetEventTime(row);
+                if (eventTime < m_TimelineViewStart || eventTime > m_TimelineViewStart + m_TimelineViewSpan)
                 {
-                    StartRepeatedButtonThread([this]()
-                        {
-                            m_PhysicalControllerManager->HandleRepeatedThread();
-                        });
+                    m_TimelineViewStart = eventTime - m_TimelineViewSpan * 0.5;
                 }
-            });
+            }
+
+            if (m_IsTimelineListScrollPending && row == m_TimelineSelectFirst)
+            {
+                ImGui::SetScrollHereY(0.25f);
+                m_IsTimelineListScrollPending = false;
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)m_MacroTimeline.GetEventTime(row));
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", event.m_Ticks);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(event.m_Report.wButtons == 0 ? "-" : m_ViGEmManager.GetChordName(event.m_Report.wButtons).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%u %u %d %d %d %d", event.m_Report.bLeftTrigger, event.m_Report.bRightTrigger,
+                event.m_Report.sThumbLX, event.m_Report.sThumbLY, event.m_Report.sThumbRX, event.m_Report.sThumbRY);
+        }
     }
 
-    ImGui::Spacing();
+    m_IsTimelineListScrollPending = false;
+    ImGui::EndTable();
+}
 
-    if (!m_PhysicalControllerManager->IsControllerConnected())
+void ImGuiApp::AutomationSocket()
+{
+    if (!ImGui::CollapsingHeader("Automation Socket"))
     {
-        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
-        CenteredText("Please connect a controller to use this feature.");
-        ImGui::PopStyleColor();
         return;
     }
-    else if (!m_PhysicalControllerManager->m_IsRepeatedThreadRunning.load())
-    {
-        if (m_PhysicalControllerManager->m_WaitingForUserInput.load())
-        {
-            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
-            CenteredText("Press any button to start automatic button presses.");
-            ImGui::PopStyleColor();
-        }
-        else
-        {
-            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
-            CenteredText("automatic button press disengaged.");
-            ImGui::PopStyleColor();
-        }
-    }
-    else
-    {
-        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
-        CenteredText("automatic button press engaged!");
-        ImGui::PopStyleColor();
-    }
 
-    ImGui::Spacing();
-}
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Lets scripts count, control playback and watch this instance over a local socket)");
+    ImGui::PopFont();
 
-void ImGuiApp::SetIsRecordMacroButtonActived(bool p_IsRecordMacroButtonActived)
-{
-    m_IsRecordMacroButtonActivated = p_IsRecordMacroButtonActived;
-}
+    bool isRunning = m_IpcServer.IsRunning();
 
-void ImGuiApp::SetIsPlaybackMacroButtonActived(bool p_IsPlaybackMacroButtonActived)
-{
-    m_IsPlaybackMacroButtonActivated = p_IsPlaybackMacroButtonActived;
-}
+    ImGui::BeginDisabled(isRunning);
+    ImGui::InputText("Path##ipcPath", m_InputIpcPath, sizeof(m_InputIpcPath));
+    ImGui::EndDisabled();
 
-void ImGuiApp::StartPlaybackButtonThread(std::function<void()> p_Function)
-{
-    m_IsPlaybackMacroButtonActivated = true;
-    m_IsPlaybackButtonThreadRunning.store(true);
-    m_PlaybackButtonThread = std::thread([this, p_Function]()
+    CenteredButton(isRunning ? "Stop Socket" : "Start Socket", [&]()
         {
-            p_Function();
+            if (isRunning)
+            {
+                m_IpcServer.Stop();
+            }
+            else
+            {
+                m_IpcServer.Start(m_InputIpcPath);
+            }
         });
 
-    std::cout << "Started repeated button thread\n";
-}
+    if (isRunning)
+    {
+        char stats[128];
+        snprintf(stats, sizeof(stats), "%zu client(s), %llu command(s), %.1f us per command", m_IpcServer.GetClientCount(),
+            (unsigned long long)m_IpcServer.GetCommandCount(), m_IpcServer.GetAverageHandleMicroseconds());
+        ImGui::TextColored(m_TextColorGreen, "Listening on %s", m_IpcServer.GetPath().c_str());
+        ImGui::Text("%s", stats);
+    }
 
-void ImGuiApp::StopPlaybackButtonThread()
-{
-    m_IsPlaybackMacroButtonActivated = false;
-    m_IsPlaybackButtonThreadRunning.store(false);
-    if (m_PlaybackButtonThread.joinable())
+    std::string error = m_IpcServer.GetError();
+    if (!error.empty())
     {
+        ImGui::TextColored(m_TextColorRed, "%s", error.c_str());
+    }
 
-        m_PlaybackButtonThread.join();
+    if (m_SharedStatusWriter.IsOpen())
+    {
+        ImGui::Text("Status block: %s (%llu updates)", m_SharedStatusWriter.GetName().c_str(), (unsigned long long)m_SharedStatusWriter.GetPublishCount());
     }
+
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    ImGui::TextWrapped("Frames are a u16 length, an opcode and a tag, then the payload. Opcodes: 1 Ping, 2 Status, 3 Count, "
+        "4 Start Playback, 5 Stop Playback, 6 Undo, 7 Redo, 8 Subscribe, 9 Unsubscribe. Start with SHTK_IPC_SOCKET set to open it automatically.");
+    ImGui::PopFont();
 }
 
-void ImGuiApp::HandleImGuiPlaybackThreadStop()
+void ImGuiApp::PublishSharedStatus()
 {
-    if (m_IsPlaybackButtonThreadRunning.load())
-    {
-        StopPlaybackButtonThread();
-    }
-    else
+    // Rates drift every frame, so they are refreshed once a second rather than republished constantly
+    double now = ImGui::GetTime();
+    if (now - m_SharedStatusRateTime >= 1.0)
     {
-        SetIsPlaybackMacroButtonActived(false);
+        EncounterStatsSnapshot stats = m_ShinyCounter.GetEncounterStats().GetSnapshot();
+        m_SharedStatus.m_ResetsPerHour = stats.m_ResetsPerHour[1];
+        m_SharedStatus.m_SessionResetsPerHour = stats.m_SessionResetsPerHour;
+        m_SharedStatus.m_LastCycleSeconds = stats.m_LastCycleSeconds;
+        m_SharedStatus.m_Flags = stats.m_IsStalled ? SharedStatusStalled : 0;
+        m_SharedStatusRateTime = now;
+        m_SharedStatusWriter.Heartbeat();
     }
+
+    const ShinyOddsEngine& odds = m_ShinyCounter.GetOddsEngine();
+    m_SharedStatus.m_TotalAccepted = m_ShinyCounter.GetEncounterPipeline().GetTotalAccepted();
+    m_SharedStatus.m_Encounters = (uint32_t)m_ShinyCounter.GetCurrentEncounters();
+    m_SharedStatus.m_EncountersPerReset = (uint32_t)m_ShinyCounter.m_EncountersPerReset;
+    m_SharedStatus.m_Generation = (uint32_t)m_ShinyCounter.m_Generation;
+    m_SharedStatus.m_Method = (uint32_t)m_ShinyCounter.m_Method;
+    m_SharedStatus.m_Flags = (m_SharedStatus.m_Flags & SharedStatusStalled) |
+        (m_ShinyCounter.IsFrozen() ? SharedStatusFrozen : 0) |
+        (m_PhysicalControllerManager->m_IsMacroThreadRunning.load() ? SharedStatusMacroRunning : 0) |
+        (m_PhysicalControllerManager->m_WaitingForUserInputSequence.load() ? SharedStatusRecording : 0) |
+        (m_PhysicalControllerManager->m_IsControllerConnected ? SharedStatusControllerConnected : 0);
+    m_SharedStatus.m_PhaseCount = (uint32_t)m_ShinyCounter.GetPhaseTotals().GetPhaseCount();
+    m_SharedStatus.m_HuntId = m_ActiveHunt.m_Id;
+    m_SharedStatus.m_EncountersFor90 = (uint32_t)std::min<uint64_t>(odds.GetEncountersForProbability(0.9), UINT32_MAX);
+    m_SharedStatus.m_Probability = odds.GetProbability();
+    m_SharedStatus.m_CumulativeProbability = odds.GetCumulativeProbability();
+    snprintf(m_SharedStatus.m_HuntName, sizeof(m_SharedStatus.m_HuntName), "%s", m_ActiveHunt.m_Name.c_str());
+    snprintf(m_SharedStatus.m_Target, sizeof(m_SharedStatus.m_Target), "%s", m_ActiveHunt.m_Target.c_str());
+    snprintf(m_SharedStatus.m_MethodName, sizeof(m_SharedStatus.m_MethodName), "%s", m_ShinyCounter.GetMethod().m_Name);
+
+    m_SharedStatusWriter.Publish(m_SharedStatus);
+    m_OverlayServer.Update(m_SharedStatus);
 }
 
-void ImGuiApp::Macros()
+void ImGuiApp::StreamOverlay()
 {
-    const char* recordButtonLabel = m_IsRecordMacroButtonActivated ? "Stop Recording Macro" : "Start Recording Macro";
-    const char* playbackButtonLabel = m_IsPlaybackMacroButtonActivated ? "Stop Macro Playback" : "Start Macro Playback";
+    if (!ImGui::CollapsingHeader("Stream Overlay"))
+    {
+        return;
+    }
 
-    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[5]);
-    CenteredText("Macros");
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+    CenteredText("(Serves the counter and odds to OBS browser sources on this PC, pushed as they change)");
     ImGui::PopFont();
 
-    ImGui::Spacing();
-
-	// record macro
+    bool isRunning = m_OverlayServer.IsRunning();
 
-    if (m_PhysicalControllerManager->m_IsControllerConnected && !m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
-    {
-        CenteredButton(recordButtonLabel, [this]()
-            {
-                m_PhysicalControllerManager->HandleRecordMacroThread();
-            });
+    ImGui::BeginDisabled(isRunning);
+    CenteredInputInt("##overlayPort", &m_InputOverlayPort);
+    m_InputOverlayPort = std::clamp(m_InputOverlayPort, 1, 65535);
+    ImGui::EndDisabled();
 
-        if (!m_IsRecordMacroButtonActivated)
-        {
-            ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
-            CenteredText("(Or hold both triggers for 1 second begin recording!)");
-            ImGui::PopFont();
-        }
-        else
+    CenteredButton(isRunning ? "Stop Overlay Server" : "Start Overlay Server", [&]()
         {
-            ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
-            CenteredText("(Or hold both triggers for 1 second to stop recording!)");
-            ImGui::PopFont();
-        }
-
-        ImGui::Spacing();
-    }
+            if (isRunning)
+            {
+                m_OverlayServer.Stop();
+            }
+            else
+            {
+                m_OverlayServer.Start(m_InputOverlayPort);
+            }
+        });
 
-    if (!m_PhysicalControllerManager->IsControllerConnected())
-    {
-        ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
-        CenteredText("Please connect a controller to use this feature.");
-        ImGui::PopStyleColor();
-        return;
-    }
-	else if (!m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
+    if (isRunning)
     {
-        if (m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
-        {
-            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorYellow);
-            CenteredText("Recording macro...");
-            ImGui::PopStyleColor();
-        }
-		else if (m_PhysicalControllerManager->m_ButtonSequence.empty())
-		{
-			ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
-			CenteredText("No macro recorded.");
-			ImGui::PopStyleColor();
-		}
-		else
+        std::string url = "http://127.0.0.1:" + std::to_string(m_OverlayServer.GetPort()) + "/";
+        ImGui::TextColored(m_TextColorGreen, "Browser source: %s", url.c_str());
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Copy##overlayUrl"))
         {
-            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
-            CenteredText("Macro ready for playback.");
-            ImGui::PopStyleColor();
+            ImGui::SetClipboardText(url.c_str());
         }
+        ImGui::Text("%zu connection(s), %zu live, %llu update(s) pushed", m_OverlayServer.GetClientCount(),
+            m_OverlayServer.GetSocketClientCount(), (unsigned long long)m_OverlayServer.GetDeltaCount());
 
-        ImGui::Spacing();
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
+        ImGui::TextWrapped("Custom overlays can read /status.json or connect a WebSocket to /ws: the first message has every field, later ones only what changed.");
+        ImGui::PopFont();
     }
 
-	// playback macro
-
-    if (m_PhysicalControllerManager->m_IsControllerConnected && !m_PhysicalControllerManager->m_ButtonSequence.empty() && !m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
+    std::string error = m_OverlayServer.GetError();
+    if (!error.empty())
     {
-        CenteredButton(playbackButtonLabel, [this]()
-            {
-                // Stop when disengaged by controller
-                if (!m_IsPlaybackButtonThreadRunning.load() && m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
-                {
-                    m_PhysicalControllerManager->StopMacroButtonSequence();
-					SetIsPlaybackMacroButtonActived(false);
-                }
-				// Stop when disengaged by ImGui Button
-				else if (m_IsPlaybackButtonThreadRunning.load() || m_PhysicalControllerManager->m_WaitingForUserInputSequence.load())
-				{
-					m_PhysicalControllerManager->StopMacroButtonSequence();
-					HandleImGuiPlaybackThreadStop();
-				}
-				// start when activated by ImGui Button
-                else
-                {
-                    StartPlaybackButtonThread([this]()
-                        {
-                            m_PhysicalControllerManager->HandlePlaybackMacroThread();
-                        });
-                }
-            });
-
-        if (!m_IsPlaybackMacroButtonActivated)
-        {
-            ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
-            CenteredText("(Or press L3 + R3 to begin playback!)");
-            ImGui::PopFont();
-        }
-        else
-        {
-            ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[1]);
-            CenteredText("(Or press L3 + R3 to stop playback!)");
-            ImGui::PopFont();
-        }
-
-        ImGui::Spacing();
-
-        if (!m_PhysicalControllerManager->m_IsMacroThreadRunning.load())
-        {
-            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorRed);
-            CenteredText("Macro disengaged.");
-            ImGui::PopStyleColor();
-        }
-        else
-        {
-            ImGui::PushStyleColor(ImGuiCol_Text, m_TextColorGreen);
-            CenteredText("Macro engaged!");
-            ImGui::PopStyleColor();
-        }
+        ImGui::TextColored(m_TextColorRed, "%s", error.c_str());
     }
-
 }
 
-// ImGui Render/Clean Functions ------------------------------------------------
-
 void ImGuiApp::Render()
 {
+    SyncMacroPlayback();
+    PublishSharedStatus();
+
     // Get the size of the GLFW window
     int display_w, display_h;
     glfwGetFramebufferSize(m_Window, &display_w, &display_h);
@@ -799,7 +3870,7 @@ void ImGuiApp::Render()
     // Shiny Counter window
     ImGui::SetNextWindowPos(ImVec2(0, titleWindow_h));
     ImGui::SetNextWindowSize(ImVec2((float)display_w * 0.5f, (float)display_h - titleWindow_h));
-    ImGui::Begin("Shiny Counter", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+    ImGui::Begin("Shiny Counter", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
 
     ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[4]);
     CenteredText("Shiny Counter");
@@ -807,6 +3878,9 @@ void ImGuiApp::Render()
     ImGui::Spacing();
     ImGui::Separator();
 
+    HuntProfiles();
+    ImGui::Separator();
+
     GetGenerationInput();
     ImGui::Separator();
 
@@ -818,6 +3892,17 @@ void ImGuiApp::Render()
 
     IncrementEncounters();
     DisplayEncounters();
+    ImGui::Separator();
+
+    Phases();
+    EncounterSources();
+
+    DisplayThroughput();
+    EncounterHistoryPlot();
+    SimulateHunt();
+    RngSearch();
+    ShinyDetection();
+    AudioDetection();
 
     ImGui::End();
 
@@ -839,12 +3924,27 @@ void ImGuiApp::Render()
     ImGui::Separator();
 
 	Macros();
+    ImGui::Separator();
+
+    AutomationSocket();
+    StreamOverlay();
 
     ImGui::End();
+
+    MacroTimelineWindow();
 }
 
 void ImGuiApp::Clean()
 {
+    m_IpcServer.Stop();
+    m_OverlayServer.Stop();
+    m_SharedStatusWriter.Close();
+    SaveActiveHunt();
+    m_ShinyCounter.GetHuntJournal().Close();
+
+    m_ShinyDetector.Stop();
+    m_AudioDetector.Stop();
+
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include "../include/InputReplayBuffer.h"
+
+InputReplayBuffer::InputReplayBuffer()
+    : m_Ring(s_Capacity),
+    m_Head(0)
+{
+}
+
+std::chrono::nanoseconds InputReplayBuffer::GetCoveredDuration() const
+{
+    uint64_t head = m_Head.load(std::memory_order_acquire);
+    if (head < 2)
+    {
+        return std::chrono::nanoseconds(0);
+    }
+
+    // The slot after the oldest may be mid-write, so measure from the one after it
+    uint64_t oldest = head > s_Capacity ? head - s_Capacity + 1 : 0;
+    int64_t newestTime = m_Ring[(head - 1) & (s_Capacity - 1)].m_Time;
+    int64_t oldestTime = m_Ring[oldest & (s_Capacity - 1)].m_Time;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::duration(std::max<int64_t>(newestTime - oldestTime, 0)));
+}
+
+std::vector<InputSnapshot> InputReplayBuffer::CopyLast(std::chrono::nanoseconds p_Duration) const
+{
+    std::vector<InputSnapshot> snapshots;
+
+    uint64_t head = m_Head.load(std::memory_order_acquire);
+    if (head == 0)
+    {
+        return snapshots;
+    }
+
+    uint64_t oldest = head > s_Capacity ? head - s_Capacity : 0;
+    int64_t newestTime = m_Ring[(head - 1) & (s_Capacity - 1)].m_Time;
+    int64_t cutoff = newestTime - std::chrono::duration_cast<std::chrono::steady_clock::duration>(p_Duration).count();
+
+    uint64_t index = head;
+    while (index > oldest)
+    {
+        const InputSnapshot& snapshot = m_Ring[(index - 1) & (s_Capacity - 1)];
+        if (snapshot.m_Time < cutoff)
+        {
+            break;
+        }
+        snapshots.push_back(snapshot);
+        --index;
+    }
+
+    // Everything the writer reached while we copied, plus the slot it may be writing now, is suspect
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t newHead = m_Head.load(std::memory_order_relaxed);
+    uint64_t firstValid = newHead >= s_Capacity ? newHead - s_Capacity + 1 : 0;
+    if (firstValid >= head)
+    {
+        snapshots.clear();
+    }
+    else if (index < firstValid)
+    {
+        snapshots.resize((size_t)std::min<uint64_t>(snapshots.size(), head - firstValid));
+    }
+
+    std::reverse(snapshots.begin(), snapshots.end());
+    return snapshots;
+}
+
+bool InputReplayBuffer::CutToMacro(std::chrono::nanoseconds p_Duration, WORD p_TrimButtons, const MacroTimebase& p_Timebase, Macro& p_Macro) const
+{
+    std::vector<InputSnapshot> snapshots = CopyLast(p_Duration);
+
+    size_t end = snapshots.size();
+    while (p_TrimButtons != 0 && end > 0 && (snapshots[end - 1].m_Report.wButtons & p_TrimButtons) != 0)
+    {
+        --end;
+    }
+    while (end > 0 && snapshots[end - 1].m_Report.wButtons == 0)
+    {
+        --end;
+    }
+
+    size_t begin = 0;
+    while (begin < end && snapshots[begin].m_Report.wButtons == 0)
+    {
+        ++begin;
+    }
+
+    if (begin >= end)
+    {
+        return false;
+    }
+
+    Macro macro;
+    macro.m_Unit = p_Timebase.m_Unit;
+    macro.m_LoopGapTicks = (uint32_t)p_Timebase.ToTicks(macro.m_Unit, std::chrono::milliseconds(200));
+
+    // Same quantisation as a live recording: ticks since the first press, so rounding never accumulates
+    int64_t startTime = snapshots[begin].m_Time;
+    uint64_t lastEventTicks = 0;
+    WORD lastButtons = 0;
+
+    auto addEvent = [&](int64_t p_Time, WORD p_Buttons)
+        {
+            uint64_t eventTicks = p_Timebase.ToTicks(macro.m_Unit, std::chrono::steady_clock::duration(p_Time - startTime));
+
+            MacroEvent event = {};
+            event.m_Ticks = (uint32_t)(eventTicks - lastEventTicks);
+            event.m_Report.wButtons = p_Buttons;
+            macro.m_Events.push_back(event);
+
+            lastEventTicks = eventTicks;
+            lastButtons = p_Buttons;
+        };
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (snapshots[i].m_Report.wButtons != lastButtons)
+        {
+            addEvent(snapshots[i].m_Time, snapshots[i].m_Report.wButtons);
+        }
+    }
+
+    // Release at the first idle snapshot, or straight after the last one if the cut ends mid-press
+    addEvent(end < snapshots.size() ? snapshots[end].m_Time : snapshots[end - 1].m_Time, 0);
+
+    p_Macro = macro;
+    return true;
+}
@@ -0,0 +1,588 @@
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include "../include/IpcServer.h"
+
+#pragma comment(lib, "ws2_32.lib")
+
+static const size_t s_FrameHeaderSize = 4;
+
+// Encoding --------------------------------------------------------------------
+
+static void PutU32(uint8_t*& p_Data, uint32_t p_Value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        *p_Data++ = (uint8_t)(p_Value >> (i * 8));
+    }
+}
+
+static void PutU64(uint8_t*& p_Data, uint64_t p_Value)
+{
+    PutU32(p_Data, (uint32_t)p_Value);
+    PutU32(p_Data, (uint32_t)(p_Value >> 32));
+}
+
+static void PutDouble(uint8_t*& p_Data, double p_Value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &p_Value, sizeof(bits));
+    PutU64(p_Data, bits);
+}
+
+static void EncodeStatus(const IpcStatus& p_Status, uint8_t* p_Data)
+{
+    PutU32(p_Data, p_Status.m_Encounters);
+    PutU32(p_Data, p_Status.m_EncountersPerReset);
+    *p_Data++ = p_Status.m_Generation;
+    *p_Data++ = p_Status.m_Method;
+    *p_Data++ = p_Status.m_Flags;
+    PutU32(p_Data, p_Status.m_PhaseCount);
+    PutU32(p_Data, p_Status.m_UndoCount);
+    PutU32(p_Data, p_Status.m_HuntId);
+    PutU64(p_Data, p_Status.m_TotalAccepted);
+    PutDouble(p_Data, p_Status.m_Probability);
+    PutDouble(p_Data, p_Status.m_CumulativeProbability);
+}
+
+static bool IsWouldBlock()
+{
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+// Server ----------------------------------------------------------------------
+
+IpcServer::IpcServer()
+    : m_ListenSocket(s_InvalidSocket),
+    m_Status(),
+    m_PushedStatus(),
+    m_IsRunning(false),
+    m_ClientCount(0),
+    m_CommandCount(0),
+    m_HandleNanoseconds(0)
+{
+}
+
+IpcServer::~IpcServer()
+{
+    Stop();
+}
+
+void IpcServer::SetCommandHandler(std::function<IpcResult(IpcCommand)> p_Handler)
+{
+    m_CommandHandler = p_Handler;
+}
+
+void IpcServer::SetStatusProvider(std::function<void(IpcStatus&)> p_Provider)
+{
+    m_StatusProvider = p_Provider;
+}
+
+std::string IpcServer::GetDefaultPath()
+{
+    // One socket per process, so scripts find every running instance in the temp folder
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+    return (directory / ("shtk-" + std::to_string(GetCurrentProcessId()) + ".sock")).string();
+}
+
+std::string IpcServer::GetPath() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Path;
+}
+
+std::string IpcServer::GetError() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Error;
+}
+
+void IpcServer::SetError(const std::string& p_Error)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Error = p_Error;
+}
+
+double IpcServer::GetAverageHandleMicroseconds() const
+{
+    uint64_t count = m_CommandCount.load();
+    return count > 0 ? m_HandleNanoseconds.load() / 1000.0 / count : 0.0;
+}
+
+// Windows reports AF_UNIX socket files as reparse points the standard library
+// may not classify, so anything that is not a regular file or directory counts
+static bool IsSocketFile(const std::string& p_Path)
+{
+    std::error_code error;
+    std::filesystem::file_type type = std::filesystem::symlink_status(p_Path, error).type();
+    return !error && (type == std::filesystem::file_type::socket || type == std::filesystem::file_type::unknown);
+}
+
+// A socket file is stale when connecting to it is refused
+static bool IsStaleSocket(const sockaddr_un& p_Address)
+{
+    SOCKET probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe == INVALID_SOCKET)
+    {
+        return false;
+    }
+    bool isRefused = connect(probe, (const sockaddr*)&p_Address, sizeof(p_Address)) == SOCKET_ERROR && WSAGetLastError() == WSAECONNREFUSED;
+    closesocket(probe);
+    return isRefused;
+}
+
+bool IpcServer::Start(const std::string& p_Path)
+{
+    if (m_IsRunning.load())
+    {
+        return false;
+    }
+
+    SetError("");
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (p_Path.empty() || p_Path.size() >= sizeof(address.sun_path))
+    {
+        SetError("Socket path must be 1 to " + std::to_string(sizeof(address.sun_path) - 1) + " characters.");
+        return false;
+    }
+    std::memcpy(address.sun_path, p_Path.c_str(), p_Path.size());
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        SetError("Failed to initialise Winsock.");
+        return false;
+    }
+
+    SOCKET listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket == INVALID_SOCKET)
+    {
+        SetError("Unix-domain sockets are not available (Windows 10 1803 or later is needed).");
+        WSACleanup();
+        return false;
+    }
+
+    // A socket file left by a crashed instance would make bind fail. Only a socket
+    // nobody is listening on is removed; any other file at the path is left alone.
+    std::error_code error;
+    if (std::filesystem::exists(std::filesystem::symlink_status(p_Path, error)))
+    {
+        std::string staleError;
+        if (!IsSocketFile(p_Path))
+        {
+            staleError = p_Path + " already exists and is not a socket.";
+        }
+        else if (!IsStaleSocket(address))
+        {
+            staleError = "Another server is already listening on " + p_Path + ".";
+        }
+        else if (!std::filesystem::remove(p_Path, error))
+        {
+            staleError = "Failed to remove the stale socket " + p_Path + ".";
+        }
+
+        if (!staleError.empty())
+        {
+            SetError(staleError);
+            closesocket(listenSocket);
+            WSACleanup();
+            return false;
+        }
+    }
+
+    u_long isNonBlocking = 1;
+    if (bind(listenSocket, (const sockaddr*)&address, sizeof(address)) == SOCKET_ERROR ||
+        listen(listenSocket, (int)s_MaxClients) == SOCKET_ERROR ||
+        ioctlsocket(listenSocket, FIONBIO, &isNonBlocking) == SOCKET_ERROR)
+    {
+        SetError("Failed to listen on " + p_Path + " (error " + std::to_string(WSAGetLastError()) + ").");
+        closesocket(listenSocket);
+        WSACleanup();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Path = p_Path;
+    }
+
+    m_ListenSocket = (uintptr_t)listenSocket;
+    m_Clients.assign(s_MaxClients, Client());
+    std::memset(m_PushedStatus, 0, sizeof(m_PushedStatus));
+    m_ClientCount.store(0);
+    m_CommandCount.store(0);
+    m_HandleNanoseconds.store(0);
+
+    m_IsRunning.store(true);
+    m_Thread = std::thread(&IpcServer::Run, this);
+    return true;
+}
+
+void IpcServer::Stop()
+{
+    if (!m_IsRunning.exchange(false))
+    {
+        return;
+    }
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    for (Client& client : m_Clients)
+    {
+        if (client.m_Socket != s_InvalidSocket)
+        {
+            Disconnect(client);
+        }
+    }
+
+    closesocket((SOCKET)m_ListenSocket);
+    m_ListenSocket = s_InvalidSocket;
+    WSACleanup();
+
+    // Only the socket this server bound; a file put there since is not ours to delete
+    std::string path = GetPath();
+    if (IsSocketFile(path))
+    {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+}
+
+void IpcServer::Run()
+{
+    WSAPOLLFD fds[s_MaxClients + 1];
+    Client* polled[s_MaxClients + 1];
+
+    while (m_IsRunning.load())
+    {
+        size_t count = 0;
+        fds[count] = { (SOCKET)m_ListenSocket, POLLRDNORM, 0 };
+        polled[count++] = nullptr;
+
+        for (Client& client : m_Clients)
+        {
+            if (client.m_Socket == s_InvalidSocket)
+            {
+                continue;
+            }
+
+            // A full receive buffer waits until replies have drained
+            SHORT events = 0;
+            if (client.m_ReceiveSize < s_BufferSize)
+            {
+                events |= POLLRDNORM;
+            }
+            if (client.m_SendSize > 0)
+            {
+                events |= POLLWRNORM;
+            }
+            fds[count] = { (SOCKET)client.m_Socket, events, 0 };
+            polled[count++] = &client;
+        }
+
+        if (WSAPoll(fds, (ULONG)count, s_PollMs) == SOCKET_ERROR)
+        {
+            SetError("Polling failed (error " + std::to_string(WSAGetLastError()) + ").");
+            break;
+        }
+
+        if (fds[0].revents & POLLRDNORM)
+        {
+            Accept();
+        }
+
+        for (size_t i = 1; i < count; ++i)
+        {
+            Client& client = *polled[i];
+            SHORT revents = fds[i].revents;
+
+            if (revents & POLLRDNORM)
+            {
+                Receive(client);
+            }
+            else if (revents & (POLLERR | POLLHUP | POLLNVAL))
+            {
+                Disconnect(client);
+                continue;
+            }
+
+            if (client.m_Socket != s_InvalidSocket && (revents & POLLWRNORM))
+            {
+                Pump(client);
+            }
+        }
+
+        // Subscribers get the status whenever it differs from what was last pushed
+        bool hasSubscribers = false;
+        for (const Client& client : m_Clients)
+        {
+            hasSubscribers = hasSubscribers || (client.m_Socket != s_InvalidSocket && client.m_IsSubscribed);
+        }
+        if (!hasSubscribers || !m_StatusProvider)
+        {
+            continue;
+        }
+
+        IpcStatus status = {};
+        m_StatusProvider(status);
+        EncodeStatus(status, m_Status);
+        bool hasChanged = std::memcmp(m_Status, m_PushedStatus, sizeof(m_Status)) != 0;
+        std::memcpy(m_PushedStatus, m_Status, sizeof(m_Status));
+
+        for (Client& client : m_Clients)
+        {
+            if (client.m_Socket == s_InvalidSocket || !client.m_IsSubscribed)
+            {
+                continue;
+            }
+
+            // A slow reader skips intermediate states and gets the newest one once it has room
+            client.m_IsPushPending = client.m_IsPushPending || hasChanged;
+            if (client.m_IsPushPending && QueueStatus(client, (uint8_t)IpcCommand::StatusPush, 0, IpcResult::Ok, m_PushedStatus))
+            {
+                client.m_IsPushPending = false;
+                Pump(client);
+            }
+        }
+    }
+}
+
+void IpcServer::Accept()
+{
+    while (true)
+    {
+        SOCKET socket = accept((SOCKET)m_ListenSocket, nullptr, nullptr);
+        if (socket == INVALID_SOCKET)
+        {
+            return;
+        }
+
+        Client* slot = nullptr;
+        for (Client& client : m_Clients)
+        {
+            if (client.m_Socket == s_InvalidSocket)
+            {
+                slot = &client;
+                break;
+            }
+        }
+
+        u_long isNonBlocking = 1;
+        if (slot == nullptr || ioctlsocket(socket, FIONBIO, &isNonBlocking) == SOCKET_ERROR)
+        {
+            closesocket(socket);
+            continue;
+        }
+
+        slot->m_Socket = (uintptr_t)socket;
+        slot->m_ReceiveSize = 0;
+        slot->m_SendSize = 0;
+        slot->m_IsSubscribed = false;
+        slot->m_IsPushPending = false;
+        m_ClientCount++;
+    }
+}
+
+void IpcServer::Receive(Client& p_Client)
+{
+    int received = recv((SOCKET)p_Client.m_Socket, (char*)p_Client.m_Receive + p_Client.m_ReceiveSize,
+        (int)(s_BufferSize - p_Client.m_ReceiveSize), 0);
+    if (received == 0 || (received == SOCKET_ERROR && !IsWouldBlock()))
+    {
+        Disconnect(p_Client);
+        return;
+    }
+    if (received > 0)
+    {
+        p_Client.m_ReceiveSize += received;
+    }
+
+    Pump(p_Client);
+}
+
+// Sending makes room for the replies of requests left queued, and handling those queues
+// more to send, so alternate until neither moves. Without this a client that sent more
+// requests than its replies fit and then waited would never hear back.
+void IpcServer::Pump(Client& p_Client)
+{
+    while (p_Client.m_Socket != s_InvalidSocket)
+    {
+        size_t receiveSize = p_Client.m_ReceiveSize;
+        size_t sendSize = p_Client.m_SendSize;
+
+        ProcessFrames(p_Client);
+        if (p_Client.m_Socket == s_InvalidSocket)
+        {
+            return;
+        }
+        Flush(p_Client);
+
+        if (p_Client.m_ReceiveSize == receiveSize && p_Client.m_SendSize == sendSize)
+        {
+            return;
+        }
+    }
+}
+
+void IpcServer::ProcessFrames(Client& p_Client)
+{
+    size_t offset = 0;
+    while (p_Client.m_ReceiveSize - offset >= s_FrameHeaderSize)
+    {
+        const uint8_t* frame = p_Client.m_Receive + offset;
+        size_t length = frame[0] | (frame[1] << 8);
+
+        // A frame that could never fit the buffer cannot be resynchronised
+        if (s_FrameHeaderSize + length > s_BufferSize)
+        {
+            QueueStatus(p_Client, (uint8_t)(frame[2] | 0x80), frame[3], IpcResult::BadLength, nullptr);
+            Flush(p_Client);
+
+            // Flush already disconnects on a send error
+            if (p_Client.m_Socket != s_InvalidSocket)
+            {
+                Disconnect(p_Client);
+            }
+            return;
+        }
+        if (p_Client.m_ReceiveSize - offset < s_FrameHeaderSize + length)
+        {
+            break;
+        }
+
+        // Leave the rest queued until the reply fits
+        if (s_BufferSize - p_Client.m_SendSize < s_FrameHeaderSize + 1 + IpcStatus::s_StatusSize)
+        {
+            break;
+        }
+
+        HandleFrame(p_Client, frame[2], frame[3], length);
+        offset += s_FrameHeaderSize + length;
+    }
+
+    if (offset > 0)
+    {
+        std::memmove(p_Client.m_Receive, p_Client.m_Receive + offset, p_Client.m_ReceiveSize - offset);
+        p_Client.m_ReceiveSize -= offset;
+    }
+}
+
+void IpcServer::HandleFrame(Client& p_Client, uint8_t p_Opcode, uint8_t p_Tag, size_t p_Length)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    IpcResult result = IpcResult::Ok;
+    bool isStatusReply = false;
+    IpcCommand command = (IpcCommand)p_Opcode;
+
+    if (p_Length != 0)
+    {
+        result = IpcResult::BadLength;
+    }
+    else
+    {
+        switch (command)
+        {
+        case IpcCommand::Ping:
+            break;
+        case IpcCommand::GetStatus:
+            isStatusReply = true;
+            break;
+        case IpcCommand::Subscribe:
+            p_Client.m_IsSubscribed = true;
+            p_Client.m_IsPushPending = true;
+            break;
+        case IpcCommand::Unsubscribe:
+            p_Client.m_IsSubscribed = false;
+            p_Client.m_IsPushPending = false;
+            break;
+        case IpcCommand::Count:
+        case IpcCommand::StartPlayback:
+        case IpcCommand::StopPlayback:
+        case IpcCommand::Undo:
+        case IpcCommand::Redo:
+            result = m_CommandHandler ? m_CommandHandler(command) : IpcResult::Rejected;
+            isStatusReply = true;
+            break;
+        default:
+            result = IpcResult::UnknownCommand;
+            break;
+        }
+    }
+
+    if (isStatusReply && m_StatusProvider)
+    {
+        IpcStatus status = {};
+        m_StatusProvider(status);
+        EncodeStatus(status, m_Status);
+    }
+
+    QueueStatus(p_Client, (uint8_t)(p_Opcode | 0x80), p_Tag, result, isStatusReply && m_StatusProvider ? m_Status : nullptr);
+
+    m_CommandCount++;
+    m_HandleNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool IpcServer::QueueStatus(Client& p_Client, uint8_t p_Opcode, uint8_t p_Tag, IpcResult p_Result, const uint8_t* p_Status)
+{
+    size_t length = 1 + (p_Status != nullptr ? IpcStatus::s_StatusSize : 0);
+    if (s_BufferSize - p_Client.m_SendSize < s_FrameHeaderSize + length)
+    {
+        return false;
+    }
+
+    uint8_t* data = p_Client.m_Send + p_Client.m_SendSize;
+    data[0] = (uint8_t)length;
+    data[1] = (uint8_t)(length >> 8);
+    data[2] = p_Opcode;
+    data[3] = p_Tag;
+    data[4] = (uint8_t)p_Result;
+    if (p_Status != nullptr)
+    {
+        std::memcpy(data + 5, p_Status, IpcStatus::s_StatusSize);
+    }
+
+    p_Client.m_SendSize += s_FrameHeaderSize + length;
+    return true;
+}
+
+void IpcServer::Flush(Client& p_Client)
+{
+    if (p_Client.m_SendSize == 0)
+    {
+        return;
+    }
+
+    int sent = send((SOCKET)p_Client.m_Socket, (const char*)p_Client.m_Send, (int)p_Client.m_SendSize, 0);
+    if (sent == SOCKET_ERROR)
+    {
+        if (!IsWouldBlock())
+        {
+            Disconnect(p_Client);
+        }
+        return;
+    }
+
+    std::memmove(p_Client.m_Send, p_Client.m_Send + sent, p_Client.m_SendSize - sent);
+    p_Client.m_SendSize -= sent;
+}
+
+void IpcServer::Disconnect(Client& p_Client)
+{
+    closesocket((SOCKET)p_Client.m_Socket);
+    p_Client.m_Socket = s_InvalidSocket;
+    p_Client.m_ReceiveSize = 0;
+    p_Client.m_SendSize = 0;
+    p_Client.m_IsSubscribed = false;
+    p_Client.m_IsPushPending = false;
+    m_ClientCount--;
+}
@@ -0,0 +1,452 @@
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../include/Logger.h"
+
+enum class LogArgType : uint8_t
+{
+    Integer,
+    Unsigned,
+    Double,
+    String
+};
+
+// Single producer (the owning thread) and single consumer (the logger thread). A ring
+// outlives its thread and is handed to the next new thread, so short-lived macro
+// threads do not each leave one behind.
+struct LogRing
+{
+    std::atomic<bool> m_IsOwned{ true };
+    std::atomic<uint64_t> m_Dropped{ 0 };
+    alignas(64) std::atomic<uint64_t> m_Head{ 0 };
+    alignas(64) std::atomic<uint64_t> m_Tail{ 0 };
+    LogRecord m_Records[Logger::s_RingCapacity];
+};
+
+struct LogRateState
+{
+    int64_t m_WindowStart = 0;
+    int m_Count = 0;
+    uint64_t m_Suppressed = 0;
+    LogLevel m_Level = LogLevel::Info;
+};
+
+struct LogRingHandle
+{
+    LogRing* m_Ring = nullptr;
+
+    ~LogRingHandle()
+    {
+        if (m_Ring != nullptr)
+        {
+            m_Ring->m_IsOwned.store(false, std::memory_order_release);
+        }
+    }
+};
+
+static thread_local LogRingHandle s_ThreadRing;
+
+static std::mutex s_RingsMutex;
+static std::vector<std::unique_ptr<LogRing>> s_Rings;
+
+static std::thread s_Thread;
+static std::atomic<bool> s_IsRunning(false);
+static std::mutex s_WakeMutex;
+static std::condition_variable s_WakeCondition;
+static std::atomic<uint64_t> s_DroppedCount(0);
+static std::atomic<uint64_t> s_SuppressedCount(0);
+
+// Logger thread only
+static std::ofstream s_File;
+static std::string s_Path;
+static uint64_t s_FileSize = 0;
+static std::vector<LogRecord> s_Batch;
+static std::vector<LogRing*> s_DrainRings;
+static std::unordered_map<const char*, LogRateState> s_RateStates;
+static std::string s_Line;
+
+static const char* const s_LevelNames[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+// Producer side -----------------------------------------------------------------
+
+static LogRing* ClaimRing()
+{
+    std::lock_guard<std::mutex> lock(s_RingsMutex);
+    for (std::unique_ptr<LogRing>& ring : s_Rings)
+    {
+        bool isOwned = false;
+        if (ring->m_IsOwned.compare_exchange_strong(isOwned, true, std::memory_order_acquire))
+        {
+            return ring.get();
+        }
+    }
+
+    s_Rings.push_back(std::make_unique<LogRing>());
+    return s_Rings.back().get();
+}
+
+LogRecord* Logger::BeginRecord(LogLevel p_Level, const char* p_Format)
+{
+    if (s_ThreadRing.m_Ring == nullptr)
+    {
+        s_ThreadRing.m_Ring = ClaimRing();
+    }
+
+    LogRing& ring = *s_ThreadRing.m_Ring;
+    uint64_t head = ring.m_Head.load(std::memory_order_relaxed);
+    if (head - ring.m_Tail.load(std::memory_order_acquire) >= s_RingCapacity)
+    {
+        ring.m_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    LogRecord& record = ring.m_Records[head % s_RingCapacity];
+    record.m_Time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    record.m_Format = p_Format;
+    record.m_ThreadId = (uint32_t)GetCurrentThreadId();
+    record.m_Level = p_Level;
+    record.m_ArgCount = 0;
+    record.m_ArgSize = 0;
+    return &record;
+}
+
+void Logger::CommitRecord()
+{
+    LogRing& ring = *s_ThreadRing.m_Ring;
+    ring.m_Head.store(ring.m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// An argument that does not fit closes the record, so it and every later one print as "?"
+static void EncodeValue(LogRecord& p_Record, LogArgType p_Type, const void* p_Value, size_t p_Size)
+{
+    if (p_Record.m_ArgSize + 1 + p_Size > LogRecord::s_ArgBytes)
+    {
+        p_Record.m_ArgSize = LogRecord::s_ArgBytes;
+        return;
+    }
+
+    p_Record.m_Args[p_Record.m_ArgSize] = (uint8_t)p_Type;
+    std::memcpy(p_Record.m_Args + p_Record.m_ArgSize + 1, p_Value, p_Size);
+    p_Record.m_ArgSize += (uint8_t)(1 + p_Size);
+    p_Record.m_ArgCount++;
+}
+
+void Logger::EncodeInteger(LogRecord& p_Record, int64_t p_Value)
+{
+    EncodeValue(p_Record, LogArgType::Integer, &p_Value, sizeof(p_Value));
+}
+
+void Logger::EncodeUnsigned(LogRecord& p_Record, uint64_t p_Value)
+{
+    EncodeValue(p_Record, LogArgType::Unsigned, &p_Value, sizeof(p_Value));
+}
+
+void Logger::EncodeDouble(LogRecord& p_Record, double p_Value)
+{
+    EncodeValue(p_Record, LogArgType::Double, &p_Value, sizeof(p_Value));
+}
+
+void Logger::EncodeString(LogRecord& p_Record, std::string_view p_Value)
+{
+    if (p_Record.m_ArgSize + 2u > LogRecord::s_ArgBytes)
+    {
+        p_Record.m_ArgSize = LogRecord::s_ArgBytes;
+        return;
+    }
+
+    // Type and length byte, then as much of the string as there is room for
+    size_t length = std::min({ p_Value.size(), LogRecord::s_ArgBytes - p_Record.m_ArgSize - 2, (size_t)255 });
+
+    uint8_t* data = p_Record.m_Args + p_Record.m_ArgSize;
+    data[0] = (uint8_t)LogArgType::String;
+    data[1] = (uint8_t)length;
+    std::memcpy(data + 2, p_Value.data(), length);
+    p_Record.m_ArgSize += (uint8_t)(2 + length);
+    p_Record.m_ArgCount++;
+}
+
+// Logger thread -------------------------------------------------------------------
+
+static void AppendArg(const LogRecord& p_Record, size_t& p_Offset)
+{
+    char text[32];
+    const uint8_t* data = p_Record.m_Args + p_Offset;
+
+    switch ((LogArgType)data[0])
+    {
+    case LogArgType::Integer:
+    {
+        int64_t value;
+        std::memcpy(&value, data + 1, sizeof(value));
+        std::snprintf(text, sizeof(text), "%lld", (long long)value);
+        s_Line += text;
+        p_Offset += 1 + sizeof(value);
+        break;
+    }
+    case LogArgType::Unsigned:
+    {
+        uint64_t value;
+        std::memcpy(&value, data + 1, sizeof(value));
+        std::snprintf(text, sizeof(text), "%llu", (unsigned long long)value);
+        s_Line += text;
+        p_Offset += 1 + sizeof(value);
+        break;
+    }
+    case LogArgType::Double:
+    {
+        double value;
+        std::memcpy(&value, data + 1, sizeof(value));
+        std::snprintf(text, sizeof(text), "%g", value);
+        s_Line += text;
+        p_Offset += 1 + sizeof(value);
+        break;
+    }
+    case LogArgType::String:
+        s_Line.append((const char*)data + 2, data[1]);
+        p_Offset += 2 + data[1];
+        break;
+    }
+}
+
+static void FormatRecord(const LogRecord& p_Record)
+{
+    size_t offset = 0;
+    int argIndex = 0;
+
+    for (const char* c = p_Record.m_Format; *c != '\0'; ++c)
+    {
+        if (c[0] == '{' && c[1] == '}')
+        {
+            if (argIndex++ < p_Record.m_ArgCount)
+            {
+                AppendArg(p_Record, offset);
+            }
+            else
+            {
+                s_Line += '?';
+            }
+            ++c;
+        }
+        else
+        {
+            s_Line += *c;
+        }
+    }
+}
+
+static void RotateFile()
+{
+    s_File.close();
+
+    std::error_code error;
+    for (int i = Logger::s_FileCount; i > 0; --i)
+    {
+        std::string from = (i == 1) ? s_Path : s_Path + "." + std::to_string(i - 1);
+        std::filesystem::rename(from, s_Path + "." + std::to_string(i), error);
+    }
+
+    s_File.open(s_Path, std::ios::binary | std::ios::trunc);
+    s_FileSize = 0;
+}
+
+static void WriteLine(LogLevel p_Level, int64_t p_Time, uint32_t p_ThreadId)
+{
+    // The console gets the bare message, as it did before there was a logger
+    std::ostream& console = (p_Level >= LogLevel::Warning) ? std::cerr : std::cout;
+    console.write(s_Line.data(), s_Line.size());
+    console.put('\n');
+
+    if (!s_File.is_open())
+    {
+        return;
+    }
+
+    std::time_t seconds = (std::time_t)(p_Time / 1000000);
+    std::tm local = {};
+    localtime_s(&local, &seconds);
+
+    char prefix[64];
+    int prefixSize = std::snprintf(prefix, sizeof(prefix), "%04d-%02d-%02d %02d:%02d:%02d.%03d %-5s [%u] ",
+        local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec,
+        (int)(p_Time / 1000 % 1000), s_LevelNames[(int)p_Level], p_ThreadId);
+
+    s_File.write(prefix, prefixSize);
+    s_File.write(s_Line.data(), s_Line.size());
+    s_File.put('\n');
+    s_FileSize += prefixSize + s_Line.size() + 1;
+
+    if (s_FileSize >= Logger::s_MaxFileSize)
+    {
+        RotateFile();
+    }
+}
+
+static void WriteSuppressed(const char* p_Format, LogRateState& p_State, int64_t p_Time)
+{
+    s_Line.clear();
+    s_Line += "(suppressed " + std::to_string(p_State.m_Suppressed) + " more of: ";
+    s_Line += p_Format;
+    s_Line += ')';
+    WriteLine(p_State.m_Level, p_Time, 0);
+    p_State.m_Suppressed = 0;
+}
+
+static void WriteRecord(const LogRecord& p_Record)
+{
+    static const int64_t windowMicroseconds = (int64_t)Logger::s_RateWindowSeconds * 1000000;
+
+    LogRateState& state = s_RateStates[p_Record.m_Format];
+    if (p_Record.m_Time - state.m_WindowStart >= windowMicroseconds)
+    {
+        if (state.m_Suppressed > 0)
+        {
+            WriteSuppressed(p_Record.m_Format, state, p_Record.m_Time);
+        }
+        state.m_WindowStart = p_Record.m_Time;
+        state.m_Count = 0;
+    }
+
+    state.m_Level = p_Record.m_Level;
+    if (++state.m_Count > Logger::s_RateBurst)
+    {
+        state.m_Suppressed++;
+        s_SuppressedCount++;
+        return;
+    }
+
+    s_Line.clear();
+    FormatRecord(p_Record);
+    WriteLine(p_Record.m_Level, p_Record.m_Time, p_Record.m_ThreadId);
+}
+
+static void Drain(bool p_IsFinal)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_RingsMutex);
+        s_DrainRings.clear();
+        for (std::unique_ptr<LogRing>& ring : s_Rings)
+        {
+            s_DrainRings.push_back(ring.get());
+        }
+    }
+
+    s_Batch.clear();
+    uint64_t dropped = 0;
+    for (LogRing* ring : s_DrainRings)
+    {
+        uint64_t tail = ring->m_Tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->m_Head.load(std::memory_order_acquire);
+        for (uint64_t i = tail; i < head; ++i)
+        {
+            s_Batch.push_back(ring->m_Records[i % Logger::s_RingCapacity]);
+        }
+        ring->m_Tail.store(head, std::memory_order_release);
+        dropped += ring->m_Dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    // Each ring is already in order; merging them by time interleaves threads correctly
+    std::stable_sort(s_Batch.begin(), s_Batch.end(), [](const LogRecord& a, const LogRecord& b) { return a.m_Time < b.m_Time; });
+    for (const LogRecord& record : s_Batch)
+    {
+        WriteRecord(record);
+    }
+
+    int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    if (dropped > 0)
+    {
+        s_DroppedCount += dropped;
+        s_Line = std::to_string(dropped) + " log messages were dropped because a thread logged faster than they could be written";
+        WriteLine(LogLevel::Warning, now, 0);
+    }
+
+    // A burst that stopped still reports how much it hid, once its window has passed
+    for (auto& [format, state] : s_RateStates)
+    {
+        if (state.m_Suppressed > 0 && (p_IsFinal || now - state.m_WindowStart >= (int64_t)Logger::s_RateWindowSeconds * 1000000))
+        {
+            WriteSuppressed(format, state, now);
+        }
+    }
+
+    std::cout.flush();
+    s_File.flush();
+}
+
+static void Run()
+{
+    while (s_IsRunning.load())
+    {
+        {
+            std::unique_lock<std::mutex> lock(s_WakeMutex);
+            s_WakeCondition.wait_for(lock, std::chrono::milliseconds(Logger::s_FlushMs), [] { return !s_IsRunning.load(); });
+        }
+        Drain(false);
+    }
+    Drain(true);
+}
+
+// Control -------------------------------------------------------------------------
+
+bool Logger::Start(const std::string& p_Path)
+{
+    if (s_IsRunning.load())
+    {
+        return false;
+    }
+
+    s_Path = p_Path;
+    s_File.open(s_Path, std::ios::binary | std::ios::app);
+    std::error_code error;
+    s_FileSize = std::filesystem::file_size(s_Path, error);
+    if (error)
+    {
+        s_FileSize = 0;
+    }
+
+    s_Batch.reserve(s_RingCapacity * 4);
+    s_IsRunning.store(true);
+    s_Thread = std::thread(Run);
+    return s_File.is_open();
+}
+
+void Logger::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_WakeMutex);
+        if (!s_IsRunning.exchange(false))
+        {
+            return;
+        }
+    }
+    s_WakeCondition.notify_one();
+
+    if (s_Thread.joinable())
+    {
+        s_Thread.join();
+    }
+    s_File.close();
+}
+
+uint64_t Logger::GetDroppedCount()
+{
+    return s_DroppedCount.load();
+}
+
+uint64_t Logger::GetSuppressedCount()
+{
+    return s_SuppressedCount.load();
+}
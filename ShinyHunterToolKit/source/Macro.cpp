@@ -0,0 +1,44 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "../include/Macro.h"
+
+uint64_t MacroRevision::Next()
+{
+    static std::atomic<uint64_t> s_Revision(0);
+    return ++s_Revision;
+}
+
+uint64_t MacroTimebase::ToTicks(MacroTimeUnit p_Unit, std::chrono::nanoseconds p_Elapsed) const
+{
+    double seconds = std::chrono::duration<double>(p_Elapsed).count();
+
+    if (p_Unit == MacroTimeUnit::Frames)
+    {
+        // Frames elapsed in the emulated game, which runs m_SpeedMultiplier times faster than real time
+        return (uint64_t)std::llround(std::max(seconds, 0.0) * m_FrameRate * m_SpeedMultiplier);
+    }
+
+    return (uint64_t)std::llround(std::max(seconds, 0.0) * 1000.0);
+}
+
+std::chrono::nanoseconds MacroTimebase::ToDuration(MacroTimeUnit p_Unit, uint64_t p_Ticks) const
+{
+    if (p_Unit == MacroTimeUnit::Frames)
+    {
+        double framesPerSecond = std::max(m_FrameRate * m_SpeedMultiplier, 1.0);
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(p_Ticks / framesPerSecond));
+    }
+
+    return std::chrono::milliseconds(p_Ticks);
+}
+
+uint64_t Macro::GetLengthTicks() const
+{
+    uint64_t ticks = 0;
+    for (const MacroEvent& event : m_Events)
+    {
+        ticks += event.m_Ticks;
+    }
+    return ticks;
+}
@@ -0,0 +1,963 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "../include/MacroCompiler.h"
+
+static const int64_t s_MaxValue = 0xFFFFFFFFll;
+
+// The same file reached through different relative paths must give the same key
+static std::string GetIncludeKey(const std::string& p_Path)
+{
+    if (p_Path.empty())
+    {
+        return p_Path;
+    }
+
+    std::error_code error;
+    std::filesystem::path path = std::filesystem::weakly_canonical(p_Path, error);
+    return error ? p_Path : path.string();
+}
+
+struct MacroButtonName
+{
+    const char* m_Name;
+    WORD m_Mask;
+};
+
+// Same names as ViGEmManager::GetButtonName
+static const MacroButtonName s_ButtonNames[] =
+{
+    { "A", XUSB_GAMEPAD_A },
+    { "B", XUSB_GAMEPAD_B },
+    { "X", XUSB_GAMEPAD_X },
+    { "Y", XUSB_GAMEPAD_Y },
+    { "DPAD_UP", XUSB_GAMEPAD_DPAD_UP },
+    { "DPAD_DOWN", XUSB_GAMEPAD_DPAD_DOWN },
+    { "DPAD_LEFT", XUSB_GAMEPAD_DPAD_LEFT },
+    { "DPAD_RIGHT", XUSB_GAMEPAD_DPAD_RIGHT },
+    { "START", XUSB_GAMEPAD_START },
+    { "BACK", XUSB_GAMEPAD_BACK },
+    { "LEFT_SHOULDER", XUSB_GAMEPAD_LEFT_SHOULDER },
+    { "RIGHT_SHOULDER", XUSB_GAMEPAD_RIGHT_SHOULDER }
+};
+
+std::string MacroCompileError::ToString() const
+{
+    std::string location = std::to_string(m_Line) + ":" + std::to_string(m_Column);
+    return (m_File.empty() ? location : m_File + ":" + location) + ": " + m_Message;
+}
+
+WORD MacroCompiler::GetButtonMask(const std::string& p_Name)
+{
+    std::string name = p_Name;
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+
+    for (const MacroButtonName& button : s_ButtonNames)
+    {
+        if (name == button.m_Name)
+        {
+            return button.m_Mask;
+        }
+    }
+    return 0;
+}
+
+// Errors -----------------------------------------------------------------------
+
+bool MacroCompiler::AddError(const std::string& p_File, int p_Line, int p_Column, const std::string& p_Message)
+{
+    if (m_Errors.size() < s_MaxErrors)
+    {
+        m_Errors.push_back({ p_File, p_Line, p_Column, p_Message });
+    }
+    return false;
+}
+
+bool MacroCompiler::AddError(const FileState& p_File, const Token& p_Token, const std::string& p_Message)
+{
+    return AddError(p_File.m_Path, p_Token.m_Line, p_Token.m_Column, p_Message);
+}
+
+// Lexer ------------------------------------------------------------------------
+
+bool MacroCompiler::Tokenize(const std::string& p_Source, FileState& p_File)
+{
+    size_t errorCount = m_Errors.size();
+    int line = 1;
+    size_t lineStart = 0;
+    size_t i = 0;
+
+    while (i < p_Source.size())
+    {
+        char c = p_Source[i];
+        int column = (int)(i - lineStart) + 1;
+
+        if (c == '\n')
+        {
+            p_File.m_Tokens.push_back({ TokenType::Newline, "", 0, line, column });
+            ++line;
+            lineStart = ++i;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r')
+        {
+            ++i;
+        }
+        else if (c == '#' || (c == '/' && i + 1 < p_Source.size() && p_Source[i + 1] == '/'))
+        {
+            while (i < p_Source.size() && p_Source[i] != '\n')
+            {
+                ++i;
+            }
+        }
+        else if (std::isdigit((unsigned char)c))
+        {
+            int64_t value = 0;
+            size_t start = i;
+            while (i < p_Source.size() && std::isdigit((unsigned char)p_Source[i]))
+            {
+                value = std::min<int64_t>(value * 10 + (p_Source[i] - '0'), s_MaxValue + 1);
+                ++i;
+            }
+            if (value > s_MaxValue)
+            {
+                AddError(p_File.m_Path, line, column, "number is too large");
+            }
+            p_File.m_Tokens.push_back({ TokenType::Number, p_Source.substr(start, i - start), value, line, column });
+        }
+        else if (std::isalpha((unsigned char)c) || c == '_')
+        {
+            size_t start = i;
+            while (i < p_Source.size() && (std::isalnum((unsigned char)p_Source[i]) || p_Source[i] == '_'))
+            {
+                ++i;
+            }
+            p_File.m_Tokens.push_back({ TokenType::Identifier, p_Source.substr(start, i - start), 0, line, column });
+        }
+        else if (c == '"')
+        {
+            size_t start = ++i;
+            while (i < p_Source.size() && p_Source[i] != '"' && p_Source[i] != '\n')
+            {
+                ++i;
+            }
+            if (i >= p_Source.size() || p_Source[i] != '"')
+            {
+                AddError(p_File.m_Path, line, column, "unterminated string");
+                continue;
+            }
+            p_File.m_Tokens.push_back({ TokenType::String, p_Source.substr(start, i - start), 0, line, column });
+            ++i;
+        }
+        else if (strchr("+-*/():=", c) != nullptr)
+        {
+            p_File.m_Tokens.push_back({ TokenType::Symbol, std::string(1, c), 0, line, column });
+            ++i;
+        }
+        else
+        {
+            AddError(p_File.m_Path, line, column, std::string("unexpected character '") + c + "'");
+            ++i;
+        }
+    }
+
+    int column = (int)(p_Source.size() - lineStart) + 1;
+    p_File.m_Tokens.push_back({ TokenType::Newline, "", 0, line, column });
+    p_File.m_Tokens.push_back({ TokenType::End, "", 0, line, column });
+    return m_Errors.size() == errorCount;
+}
+
+// Parser -----------------------------------------------------------------------
+
+const MacroCompiler::Token& MacroCompiler::Next(FileState& p_File)
+{
+    const Token& token = p_File.m_Tokens[p_File.m_Position];
+    if (token.m_Type != TokenType::End)
+    {
+        ++p_File.m_Position;
+    }
+    return token;
+}
+
+bool MacroCompiler::IsSymbol(const FileState& p_File, char p_Symbol) const
+{
+    const Token& token = Peek(p_File);
+    return token.m_Type == TokenType::Symbol && token.m_Text[0] == p_Symbol;
+}
+
+bool MacroCompiler::IsKeyword(const FileState& p_File, const char* p_Keyword) const
+{
+    const Token& token = Peek(p_File);
+    return token.m_Type == TokenType::Identifier && token.m_Text == p_Keyword;
+}
+
+bool MacroCompiler::ExpectEndOfLine(FileState& p_File)
+{
+    const Token& token = Peek(p_File);
+    if (token.m_Type == TokenType::Newline || token.m_Type == TokenType::End)
+    {
+        return true;
+    }
+    return AddError(p_File, token, "unexpected '" + token.m_Text + "' at the end of the statement");
+}
+
+void MacroCompiler::SkipLine(FileState& p_File)
+{
+    while (Peek(p_File).m_Type != TokenType::Newline && Peek(p_File).m_Type != TokenType::End)
+    {
+        Next(p_File);
+    }
+}
+
+bool MacroCompiler::ParseFile(const std::string& p_Source, const std::string& p_Path, std::vector<MacroStatement>& p_Statements, bool p_IsTopLevel)
+{
+    FileState file;
+    file.m_Path = p_Path;
+
+    if (!Tokenize(p_Source, file))
+    {
+        return false;
+    }
+
+    std::string key = GetIncludeKey(p_Path);
+    m_IncludeStack.insert(key);
+    bool isOk = ParseBlock(file, p_Statements, false, p_IsTopLevel);
+    m_IncludeStack.erase(key);
+    return isOk;
+}
+
+bool MacroCompiler::ParseBlock(FileState& p_File, std::vector<MacroStatement>& p_Statements, bool p_IsNested, bool p_IsTopLevel)
+{
+    while (m_Errors.size() < s_MaxErrors)
+    {
+        const Token& token = Peek(p_File);
+
+        if (token.m_Type == TokenType::Newline)
+        {
+            Next(p_File);
+        }
+        else if (token.m_Type == TokenType::End)
+        {
+            return !p_IsNested;
+        }
+        else if (token.m_Type == TokenType::Identifier && token.m_Text == "end")
+        {
+            Next(p_File);
+            if (p_IsNested)
+            {
+                return ExpectEndOfLine(p_File);
+            }
+            AddError(p_File, token, "'end' without a 'repeat' or 'sub'");
+        }
+        else if (!ParseStatement(p_File, p_Statements, p_IsTopLevel))
+        {
+            SkipLine(p_File);
+        }
+    }
+
+    return false;
+}
+
+bool MacroCompiler::ParseStatement(FileState& p_File, std::vector<MacroStatement>& p_Statements, bool p_IsTopLevel)
+{
+    const Token& token = Next(p_File);
+    if (token.m_Type != TokenType::Identifier)
+    {
+        return AddError(p_File, token, "expected a statement");
+    }
+
+    MacroStatement statement;
+    statement.m_File = p_File.m_Path;
+    statement.m_Line = token.m_Line;
+    statement.m_Column = token.m_Column;
+    const std::string& keyword = token.m_Text;
+
+    if (IsSymbol(p_File, ':'))
+    {
+        Next(p_File);
+        statement.m_Type = MacroStatementType::Label;
+        statement.m_Name = keyword;
+    }
+    else if (keyword == "unit")
+    {
+        const Token& unit = Next(p_File);
+        if (unit.m_Text == "ms")
+        {
+            p_File.m_Unit = MacroTimeUnit::Milliseconds;
+        }
+        else if (unit.m_Text == "frames" || unit.m_Text == "f")
+        {
+            p_File.m_Unit = MacroTimeUnit::Frames;
+        }
+        else
+        {
+            return AddError(p_File, unit, "expected 'ms' or 'frames'");
+        }
+        return ExpectEndOfLine(p_File);
+    }
+    else if (keyword == "const")
+    {
+        const Token& name = Next(p_File);
+        if (name.m_Type != TokenType::Identifier)
+        {
+            return AddError(p_File, name, "expected a constant name");
+        }
+        if (m_Constants.count(name.m_Text) != 0)
+        {
+            return AddError(p_File, name, "constant '" + name.m_Text + "' is already defined");
+        }
+        if (!IsSymbol(p_File, '='))
+        {
+            return AddError(p_File, Peek(p_File), "expected '='");
+        }
+        Next(p_File);
+
+        int64_t value;
+        if (!ParseExpression(p_File, value))
+        {
+            return false;
+        }
+        m_Constants[name.m_Text] = value;
+        return ExpectEndOfLine(p_File);
+    }
+    else if (keyword == "press" || keyword == "release")
+    {
+        if (keyword == "release" && IsKeyword(p_File, "all"))
+        {
+            Next(p_File);
+            statement.m_Type = MacroStatementType::ReleaseAll;
+        }
+        else
+        {
+            statement.m_Type = keyword == "press" ? MacroStatementType::Press : MacroStatementType::Release;
+            if (!ParseButtons(p_File, statement.m_Buttons))
+            {
+                return false;
+            }
+        }
+    }
+    else if (keyword == "hold")
+    {
+        statement.m_Type = MacroStatementType::Hold;
+        if (!ParseButtons(p_File, statement.m_Buttons) || !ParseDuration(p_File, statement.m_Value, statement.m_Unit))
+        {
+            return false;
+        }
+    }
+    else if (keyword == "wait")
+    {
+        statement.m_Type = MacroStatementType::Wait;
+        if (!ParseDuration(p_File, statement.m_Value, statement.m_Unit))
+        {
+            return false;
+        }
+    }
+    else if (keyword == "repeat" || keyword == "sub")
+    {
+        if (keyword == "repeat")
+        {
+            statement.m_Type = MacroStatementType::Repeat;
+            if (IsKeyword(p_File, "forever"))
+            {
+                Next(p_File);
+                statement.m_IsForever = true;
+            }
+            else
+            {
+                const Token& countToken = Peek(p_File);
+                int64_t count;
+                if (!ParseExpression(p_File, count))
+                {
+                    return false;
+                }
+                if (count < 0 || count > s_MaxValue)
+                {
+                    return AddError(p_File, countToken, "repeat count must be between 0 and 4294967295");
+                }
+                statement.m_Value = (uint32_t)count;
+            }
+        }
+        else
+        {
+            statement.m_Type = MacroStatementType::Sub;
+            if (!p_IsTopLevel)
+            {
+                return AddError(p_File, token, "'sub' can only be defined at the top level");
+            }
+
+            const Token& name = Next(p_File);
+            if (name.m_Type != TokenType::Identifier)
+            {
+                return AddError(p_File, name, "expected a sub-macro name");
+            }
+            statement.m_Name = name.m_Text;
+        }
+
+        if (!ExpectEndOfLine(p_File))
+        {
+            return false;
+        }
+
+        if (!ParseBlock(p_File, statement.m_Body, true, false))
+        {
+            if (m_Errors.size() < s_MaxErrors)
+            {
+                AddError(p_File, token, "'" + keyword + "' has no matching 'end'");
+            }
+            return false;
+        }
+
+        p_Statements.push_back(statement);
+        return true;
+    }
+    else if (keyword == "call" || keyword == "goto")
+    {
+        statement.m_Type = keyword == "call" ? MacroStatementType::Call : MacroStatementType::Goto;
+        const Token& name = Next(p_File);
+        if (name.m_Type != TokenType::Identifier)
+        {
+            return AddError(p_File, name, keyword == "call" ? "expected a sub-macro name" : "expected a label");
+        }
+        statement.m_Name = name.m_Text;
+    }
+    else if (keyword == "if")
+    {
+        statement.m_Type = MacroStatementType::If;
+        if (IsKeyword(p_File, "not"))
+        {
+            Next(p_File);
+            statement.m_IsNegated = true;
+        }
+
+        const Token& condition = Next(p_File);
+        if (condition.m_Text == "shiny")
+        {
+            statement.m_Condition = MacroCondition::ShinyDetected;
+        }
+        else if (condition.m_Text == "frozen")
+        {
+            statement.m_Condition = MacroCondition::CounterFrozen;
+        }
+        else if (condition.m_Text == "encounter")
+        {
+            statement.m_Condition = MacroCondition::EncounterCounted;
+        }
+        else
+        {
+            return AddError(p_File, condition, "expected 'shiny', 'frozen' or 'encounter'");
+        }
+
+        if (!IsKeyword(p_File, "goto"))
+        {
+            return AddError(p_File, Peek(p_File), "expected 'goto'");
+        }
+        Next(p_File);
+
+        const Token& name = Next(p_File);
+        if (name.m_Type != TokenType::Identifier)
+        {
+            return AddError(p_File, name, "expected a label");
+        }
+        statement.m_Name = name.m_Text;
+    }
+    else if (keyword == "encounter")
+    {
+        statement.m_Type = MacroStatementType::Encounter;
+    }
+    else if (keyword == "halt")
+    {
+        statement.m_Type = MacroStatementType::Halt;
+    }
+    else if (keyword == "include")
+    {
+        const Token& path = Next(p_File);
+        if (path.m_Type != TokenType::String)
+        {
+            return AddError(p_File, path, "expected a quoted file name");
+        }
+        if (!ExpectEndOfLine(p_File))
+        {
+            return false;
+        }
+
+        // Relative to the including file unless absolute
+        std::string includePath = path.m_Text;
+        bool isAbsolute = !includePath.empty() && (includePath[0] == '/' || includePath[0] == '\\' || (includePath.size() > 1 && includePath[1] == ':'));
+        size_t directoryEnd = p_File.m_Path.find_last_of("/\\");
+        if (!isAbsolute && directoryEnd != std::string::npos)
+        {
+            includePath = p_File.m_Path.substr(0, directoryEnd + 1) + includePath;
+        }
+
+        if (m_IncludeStack.count(GetIncludeKey(includePath)) != 0)
+        {
+            return AddError(p_File, path, "'" + path.m_Text + "' includes itself");
+        }
+        if (m_IncludeStack.size() >= s_MaxIncludeDepth)
+        {
+            return AddError(p_File, path, "includes are nested more than " + std::to_string(s_MaxIncludeDepth) + " deep");
+        }
+
+        std::ifstream stream(includePath, std::ios::binary);
+        if (!stream)
+        {
+            return AddError(p_File, path, "cannot open '" + includePath + "'");
+        }
+        std::stringstream source;
+        source << stream.rdbuf();
+
+        ParseFile(source.str(), includePath, p_Statements, p_IsTopLevel);
+        return true;
+    }
+    else
+    {
+        return AddError(p_File, token, "unknown statement '" + keyword + "'");
+    }
+
+    if (!ExpectEndOfLine(p_File))
+    {
+        return false;
+    }
+
+    p_Statements.push_back(statement);
+    return true;
+}
+
+bool MacroCompiler::ParseButtons(FileState& p_File, WORD& p_Buttons)
+{
+    p_Buttons = 0;
+    do
+    {
+        if (p_Buttons != 0)
+        {
+            Next(p_File);
+        }
+
+        const Token& name = Next(p_File);
+        WORD mask = name.m_Type == TokenType::Identifier ? GetButtonMask(name.m_Text) : 0;
+        if (mask == 0)
+        {
+            return AddError(p_File, name, "unknown button '" + name.m_Text + "'");
+        }
+        p_Buttons |= mask;
+    } while (IsSymbol(p_File, '+'));
+
+    return true;
+}
+
+bool MacroCompiler::ParseDuration(FileState& p_File, uint32_t& p_Ticks, MacroTimeUnit& p_Unit)
+{
+    const Token& start = Peek(p_File);
+    int64_t value;
+    if (!ParseExpression(p_File, value))
+    {
+        return false;
+    }
+
+    p_Unit = p_File.m_Unit;
+    const Token& suffix = Peek(p_File);
+    if (suffix.m_Type == TokenType::Identifier)
+    {
+        if (suffix.m_Text == "ms")
+        {
+            p_Unit = MacroTimeUnit::Milliseconds;
+        }
+        else if (suffix.m_Text == "f" || suffix.m_Text == "frames")
+        {
+            p_Unit = MacroTimeUnit::Frames;
+        }
+        else if (suffix.m_Text == "s")
+        {
+            p_Unit = MacroTimeUnit::Milliseconds;
+            value *= 1000;
+        }
+        else
+        {
+            return AddError(p_File, suffix, "unknown duration unit '" + suffix.m_Text + "'");
+        }
+        Next(p_File);
+    }
+
+    if (value < 0 || value > s_MaxValue)
+    {
+        return AddError(p_File, start, "duration must be between 0 and 4294967295");
+    }
+
+    p_Ticks = (uint32_t)value;
+    return true;
+}
+
+bool MacroCompiler::ParseExpression(FileState& p_File, int64_t& p_Value)
+{
+    if (!ParseTerm(p_File, p_Value))
+    {
+        return false;
+    }
+
+    while (IsSymbol(p_File, '+') || IsSymbol(p_File, '-'))
+    {
+        char op = Next(p_File).m_Text[0];
+        int64_t right;
+        if (!ParseTerm(p_File, right))
+        {
+            return false;
+        }
+        p_Value = op == '+' ? p_Value + right : p_Value - right;
+    }
+    return true;
+}
+
+bool MacroCompiler::ParseTerm(FileState& p_File, int64_t& p_Value)
+{
+    if (!ParseFactor(p_File, p_Value))
+    {
+        return false;
+    }
+
+    while (IsSymbol(p_File, '*') || IsSymbol(p_File, '/'))
+    {
+        const Token& op = Next(p_File);
+        int64_t right;
+        if (!ParseFactor(p_File, right))
+        {
+            return false;
+        }
+
+        if (op.m_Text[0] == '/')
+        {
+            if (right == 0)
+            {
+                return AddError(p_File, op, "division by zero");
+            }
+            p_Value /= right;
+        }
+        else
+        {
+            // Values stay far below the int64 range so intermediate products cannot overflow
+            p_Value = std::clamp<int64_t>(p_Value * right, -(s_MaxValue + 1), s_MaxValue + 1);
+        }
+    }
+    return true;
+}
+
+bool MacroCompiler::ParseFactor(FileState& p_File, int64_t& p_Value)
+{
+    const Token& token = Next(p_File);
+
+    if (token.m_Type == TokenType::Number)
+    {
+        p_Value = token.m_Number;
+        return true;
+    }
+
+    if (token.m_Type == TokenType::Identifier)
+    {
+        auto constant = m_Constants.find(token.m_Text);
+        if (constant == m_Constants.end())
+        {
+            return AddError(p_File, token, "unknown constant '" + token.m_Text + "'");
+        }
+        p_Value = constant->second;
+        return true;
+    }
+
+    if (token.m_Type == TokenType::Symbol && token.m_Text[0] == '-')
+    {
+        if (!ParseFactor(p_File, p_Value))
+        {
+            return false;
+        }
+        p_Value = -p_Value;
+        return true;
+    }
+
+    if (token.m_Type == TokenType::Symbol && token.m_Text[0] == '(')
+    {
+        if (!ParseExpression(p_File, p_Value))
+        {
+            return false;
+        }
+        if (!IsSymbol(p_File, ')'))
+        {
+            return AddError(p_File, Peek(p_File), "expected ')'");
+        }
+        Next(p_File);
+        return true;
+    }
+
+    return AddError(p_File, token, token.m_Type == TokenType::Newline ? "expected a value" : "unexpected '" + token.m_Text + "'");
+}
+
+// Validation -------------------------------------------------------------------
+
+bool MacroCompiler::HasWait(const std::vector<MacroStatement>& p_Statements)
+{
+    for (const MacroStatement& statement : p_Statements)
+    {
+        if ((statement.m_Type == MacroStatementType::Wait || statement.m_Type == MacroStatementType::Hold) && statement.m_Value > 0)
+        {
+            return true;
+        }
+        if (statement.m_Type == MacroStatementType::Call || (statement.m_Type == MacroStatementType::Repeat && HasWait(statement.m_Body)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MacroCompiler::CollectNames(const std::vector<MacroStatement>& p_Statements, const MacroStatement* p_Scope, ScopeMap& p_Labels, ScopeMap& p_Subs)
+{
+    for (const MacroStatement& statement : p_Statements)
+    {
+        if (statement.m_Type == MacroStatementType::Label)
+        {
+            if (!p_Labels.emplace(statement.m_Name, p_Scope).second)
+            {
+                AddError(statement.m_File, statement.m_Line, statement.m_Column, "label '" + statement.m_Name + "' is defined twice");
+            }
+        }
+        else if (statement.m_Type == MacroStatementType::Sub)
+        {
+            if (!p_Subs.emplace(statement.m_Name, &statement).second)
+            {
+                AddError(statement.m_File, statement.m_Line, statement.m_Column, "sub-macro '" + statement.m_Name + "' is defined twice");
+            }
+            CollectNames(statement.m_Body, &statement, p_Labels, p_Subs);
+        }
+        else if (statement.m_Type == MacroStatementType::Repeat)
+        {
+            if (statement.m_IsForever && !HasWait(statement.m_Body))
+            {
+                AddError(statement.m_File, statement.m_Line, statement.m_Column, "'repeat forever' needs a wait or hold inside it");
+            }
+            CollectNames(statement.m_Body, &statement, p_Labels, p_Subs);
+        }
+    }
+}
+
+void MacroCompiler::CheckReferences(const std::vector<MacroStatement>& p_Statements, std::vector<const MacroStatement*>& p_Scopes, const ScopeMap& p_Labels, const ScopeMap& p_Subs)
+{
+    for (const MacroStatement& statement : p_Statements)
+    {
+        if (statement.m_Type == MacroStatementType::Goto || statement.m_Type == MacroStatementType::If)
+        {
+            auto label = p_Labels.find(statement.m_Name);
+            if (label == p_Labels.end())
+            {
+                AddError(statement.m_File, statement.m_Line, statement.m_Column, "unknown label '" + statement.m_Name + "'");
+            }
+            else if (std::find(p_Scopes.begin(), p_Scopes.end(), label->second) == p_Scopes.end())
+            {
+                AddError(statement.m_File, statement.m_Line, statement.m_Column, "cannot jump into another repeat or sub-macro ('" + statement.m_Name + "')");
+            }
+        }
+        else if (statement.m_Type == MacroStatementType::Call && p_Subs.count(statement.m_Name) == 0)
+        {
+            AddError(statement.m_File, statement.m_Line, statement.m_Column, "unknown sub-macro '" + statement.m_Name + "'");
+        }
+        else if (statement.m_Type == MacroStatementType::Sub)
+        {
+            // A sub-macro is only left through its end, so the top level is not in its scope
+            std::vector<const MacroStatement*> scopes = { &statement };
+            CheckReferences(statement.m_Body, scopes, p_Labels, p_Subs);
+        }
+        else if (statement.m_Type == MacroStatementType::Repeat)
+        {
+            p_Scopes.push_back(&statement);
+            CheckReferences(statement.m_Body, p_Scopes, p_Labels, p_Subs);
+            p_Scopes.pop_back();
+        }
+    }
+}
+
+bool MacroCompiler::Validate(const std::vector<MacroStatement>& p_Statements)
+{
+    ScopeMap labels;
+    ScopeMap subs;
+    CollectNames(p_Statements, nullptr, labels, subs);
+
+    std::vector<const MacroStatement*> scopes = { nullptr };
+    CheckReferences(p_Statements, scopes, labels, subs);
+    return m_Errors.empty();
+}
+
+// Folding ----------------------------------------------------------------------
+
+void MacroCompiler::Fold(std::vector<MacroStatement>& p_Statements)
+{
+    std::vector<MacroStatement> folded;
+    folded.reserve(p_Statements.size());
+
+    for (MacroStatement& statement : p_Statements)
+    {
+        if (statement.m_Type == MacroStatementType::Repeat || statement.m_Type == MacroStatementType::Sub)
+        {
+            Fold(statement.m_Body);
+        }
+
+        if (statement.m_Type == MacroStatementType::Repeat && !statement.m_IsForever)
+        {
+            // repeat 0 and empty repeats vanish, repeat 1 is just its body
+            if (statement.m_Value == 0 || statement.m_Body.empty())
+            {
+                ++m_FoldedCount;
+                continue;
+            }
+            if (statement.m_Value == 1)
+            {
+                ++m_FoldedCount;
+                for (MacroStatement& inner : statement.m_Body)
+                {
+                    folded.push_back(std::move(inner));
+                }
+                continue;
+            }
+
+            // repeat 3 { repeat 4 { body } } is repeat 12 { body }
+            while (statement.m_Body.size() == 1 && statement.m_Body[0].m_Type == MacroStatementType::Repeat && !statement.m_Body[0].m_IsForever &&
+                (uint64_t)statement.m_Value * statement.m_Body[0].m_Value <= (uint64_t)s_MaxValue)
+            {
+                ++m_FoldedCount;
+                statement.m_Value *= statement.m_Body[0].m_Value;
+                std::vector<MacroStatement> body = std::move(statement.m_Body[0].m_Body);
+                statement.m_Body = std::move(body);
+            }
+        }
+
+        if (statement.m_Type == MacroStatementType::Wait)
+        {
+            if (statement.m_Value == 0)
+            {
+                ++m_FoldedCount;
+                continue;
+            }
+
+            // Back-to-back waits in the same unit are one wait
+            if (!folded.empty() && folded.back().m_Type == MacroStatementType::Wait && folded.back().m_Unit == statement.m_Unit &&
+                (uint64_t)folded.back().m_Value + statement.m_Value <= (uint64_t)s_MaxValue)
+            {
+                ++m_FoldedCount;
+                folded.back().m_Value += statement.m_Value;
+                continue;
+            }
+        }
+
+        folded.push_back(std::move(statement));
+    }
+
+    p_Statements = std::move(folded);
+}
+
+// Code Generation --------------------------------------------------------------
+
+void MacroCompiler::Generate(const std::vector<MacroStatement>& p_Statements, MacroProgramBuilder& p_Builder)
+{
+    for (const MacroStatement& statement : p_Statements)
+    {
+        switch (statement.m_Type)
+        {
+        case MacroStatementType::Press:
+            p_Builder.Press(statement.m_Buttons);
+            break;
+        case MacroStatementType::Release:
+            p_Builder.Release(statement.m_Buttons);
+            break;
+        case MacroStatementType::ReleaseAll:
+            p_Builder.ReleaseAll();
+            break;
+        case MacroStatementType::Hold:
+            p_Builder.Hold(statement.m_Buttons, statement.m_Value, statement.m_Unit);
+            break;
+        case MacroStatementType::Wait:
+            p_Builder.Wait(statement.m_Value, statement.m_Unit);
+            break;
+        case MacroStatementType::Repeat:
+            p_Builder.Loop(statement.m_IsForever ? 0 : statement.m_Value);
+            Generate(statement.m_Body, p_Builder);
+            p_Builder.EndLoop();
+            break;
+        case MacroStatementType::Call:
+            p_Builder.Call("sub " + statement.m_Name);
+            break;
+        case MacroStatementType::Label:
+            p_Builder.Label(statement.m_Name);
+            break;
+        case MacroStatementType::Goto:
+            p_Builder.Jump(statement.m_Name);
+            break;
+        case MacroStatementType::If:
+            p_Builder.JumpIf(statement.m_Condition, statement.m_Name, statement.m_IsNegated);
+            break;
+        case MacroStatementType::Encounter:
+            p_Builder.Encounter();
+            break;
+        case MacroStatementType::Halt:
+            p_Builder.Halt();
+            break;
+        case MacroStatementType::Sub:
+            // Emitted after the main program
+            break;
+        }
+    }
+}
+
+bool MacroCompiler::Compile(const std::string& p_Source, const std::string& p_Path, MacroProgram& p_Program)
+{
+    m_Errors.clear();
+    m_Constants.clear();
+    m_IncludeStack.clear();
+    m_FoldedCount = 0;
+
+    std::vector<MacroStatement> statements;
+    ParseFile(p_Source, p_Path, statements, true);
+    if (!m_Errors.empty() || !Validate(statements))
+    {
+        return false;
+    }
+
+    Fold(statements);
+
+    MacroProgramBuilder builder;
+    Generate(statements, builder);
+
+    bool hasSubs = false;
+    for (const MacroStatement& statement : statements)
+    {
+        if (statement.m_Type != MacroStatementType::Sub)
+        {
+            continue;
+        }
+
+        if (!hasSubs)
+        {
+            builder.Halt();
+            hasSubs = true;
+        }
+        builder.Label("sub " + statement.m_Name);
+        Generate(statement.m_Body, builder);
+        builder.Return();
+    }
+
+    if (!builder.Build(p_Program))
+    {
+        return AddError(p_Path, 0, 0, builder.GetError());
+    }
+    return true;
+}
+
+bool MacroCompiler::CompileFile(const std::string& p_Path, MacroProgram& p_Program)
+{
+    std::ifstream stream(p_Path, std::ios::binary);
+    if (!stream)
+    {
+        m_Errors.clear();
+        return AddError(p_Path, 0, 0, "cannot open '" + p_Path + "'");
+    }
+
+    std::stringstream source;
+    source << stream.rdbuf();
+    return Compile(source.str(), p_Path, p_Program);
+}
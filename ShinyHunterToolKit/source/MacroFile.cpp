@@ -0,0 +1,450 @@
+#include <cstring>
+#include "../include/MacroFile.h"
+#include "../include/Logger.h"
+
+static const char s_FileMagic[8] = { 'S', 'H', 'T', 'K', 'M', 'A', 'C', 'R' };
+static const uint32_t s_BlockMagic = 0x314B4C42;   // "BLK1"
+static const uint32_t s_FooterMagic = 0x31444E45;  // "END1"
+static const size_t s_HeaderSize = 8 + 4 * 4;
+static const size_t s_BlockHeaderSize = 4 * 4;
+static const size_t s_FooterSize = 4 * 3 + 8 + 4;
+
+// Encoding --------------------------------------------------------------------
+
+static void PutU32(std::vector<uint8_t>& p_Buffer, uint32_t p_Value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        p_Buffer.push_back((uint8_t)(p_Value >> (i * 8)));
+    }
+}
+
+static void PutU64(std::vector<uint8_t>& p_Buffer, uint64_t p_Value)
+{
+    PutU32(p_Buffer, (uint32_t)p_Value);
+    PutU32(p_Buffer, (uint32_t)(p_Value >> 32));
+}
+
+static uint32_t GetU32(const uint8_t* p_Data)
+{
+    return (uint32_t)p_Data[0] | ((uint32_t)p_Data[1] << 8) | ((uint32_t)p_Data[2] << 16) | ((uint32_t)p_Data[3] << 24);
+}
+
+static uint64_t GetU64(const uint8_t* p_Data)
+{
+    return GetU32(p_Data) | ((uint64_t)GetU32(p_Data + 4) << 32);
+}
+
+// Ticks as a LEB128 varint (one byte for most gaps), then the 16 button bits
+static void EncodeEvent(std::vector<uint8_t>& p_Buffer, const MacroEvent& p_Event)
+{
+    uint32_t ticks = p_Event.m_Ticks;
+    while (ticks >= 0x80)
+    {
+        p_Buffer.push_back((uint8_t)(ticks | 0x80));
+        ticks >>= 7;
+    }
+    p_Buffer.push_back((uint8_t)ticks);
+    p_Buffer.push_back((uint8_t)p_Event.m_Report.wButtons);
+    p_Buffer.push_back((uint8_t)(p_Event.m_Report.wButtons >> 8));
+}
+
+static bool DecodeEvent(const uint8_t*& p_Data, const uint8_t* p_End, MacroEvent& p_Event)
+{
+    uint32_t ticks = 0;
+    for (int shift = 0; ; shift += 7)
+    {
+        if (p_Data >= p_End || shift > 28)
+        {
+            return false;
+        }
+
+        uint8_t byte = *p_Data++;
+        ticks |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            break;
+        }
+    }
+
+    if (p_End - p_Data < 2)
+    {
+        return false;
+    }
+
+    p_Event = {};
+    p_Event.m_Ticks = ticks;
+    p_Event.m_Report.wButtons = (WORD)(p_Data[0] | (p_Data[1] << 8));
+    p_Data += 2;
+    return true;
+}
+
+uint32_t MacroFile::Crc32(uint32_t p_Crc, const uint8_t* p_Data, size_t p_Size)
+{
+    static const auto s_Table = []()
+        {
+            std::vector<uint32_t> table(256);
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+                }
+                table[i] = value;
+            }
+            return table;
+        }();
+
+    uint32_t crc = ~p_Crc;
+    for (size_t i = 0; i < p_Size; ++i)
+    {
+        crc = s_Table[(crc ^ p_Data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Reading ---------------------------------------------------------------------
+
+bool MacroFile::Load(const std::string& p_Path, Macro& p_Macro, MacroFileInfo& p_Info)
+{
+    p_Info = MacroFileInfo();
+
+    std::ifstream file(p_Path, std::ios::binary);
+    if (!file)
+    {
+        p_Info.m_Status = "Could not open the file.";
+        return false;
+    }
+
+    uint8_t header[s_HeaderSize];
+    if (!file.read((char*)header, sizeof(header)) || memcmp(header, s_FileMagic, sizeof(s_FileMagic)) != 0 || GetU32(header + 8) != s_Version)
+    {
+        p_Info.m_Status = "Not a macro file.";
+        return false;
+    }
+
+    Macro macro;
+    macro.m_Unit = GetU32(header + 12) == (uint32_t)MacroTimeUnit::Frames ? MacroTimeUnit::Frames : MacroTimeUnit::Milliseconds;
+    macro.m_LoopGapTicks = GetU32(header + 16);
+
+    uint32_t fileCrc = 0;
+    std::vector<uint8_t> payload;
+
+    while (true)
+    {
+        uint8_t blockHeader[s_BlockHeaderSize];
+        if (!file.read((char*)blockHeader, 4))
+        {
+            p_Info.m_Status = "Recording was interrupted; recovered every complete block.";
+            break;
+        }
+
+        if (GetU32(blockHeader) == s_FooterMagic)
+        {
+            uint8_t footer[s_FooterSize];
+            memcpy(footer, blockHeader, 4);
+            if (file.read((char*)footer + 4, s_FooterSize - 4) &&
+                GetU32(footer + s_FooterSize - 4) == Crc32(0, footer, s_FooterSize - 4) &&
+                GetU32(footer + 4) == p_Info.m_BlockCount && GetU64(footer + 8) == p_Info.m_EventCount && GetU32(footer + 16) == fileCrc)
+            {
+                p_Info.m_IsComplete = true;
+                p_Info.m_Status = "Loaded.";
+            }
+            else
+            {
+                p_Info.m_Status = "Footer does not match the blocks; recovered every complete block.";
+            }
+            break;
+        }
+
+        if (GetU32(blockHeader) != s_BlockMagic || !file.read((char*)blockHeader + 4, s_BlockHeaderSize - 4))
+        {
+            p_Info.m_Status = "Recording was interrupted; recovered every complete block.";
+            break;
+        }
+
+        uint32_t payloadSize = GetU32(blockHeader + 4);
+        uint32_t eventCount = GetU32(blockHeader + 8);
+        uint32_t blockCrc = GetU32(blockHeader + 12);
+
+        // Bound the size before allocating; a damaged header can claim up to 4 GiB
+        if (payloadSize > MacroFileWriter::s_BlockSize * 2)
+        {
+            p_Info.m_Status = "Last block is incomplete or damaged; recovered every block before it.";
+            break;
+        }
+
+        payload.resize(payloadSize);
+        if (!file.read((char*)payload.data(), payloadSize) || Crc32(0, payload.data(), payloadSize) != blockCrc)
+        {
+            p_Info.m_Status = "Last block is incomplete or damaged; recovered every block before it.";
+            break;
+        }
+
+        const uint8_t* data = payload.data();
+        const uint8_t* end = data + payload.size();
+        size_t eventsBefore = macro.m_Events.size();
+        MacroEvent event;
+        while (data < end && DecodeEvent(data, end, event))
+        {
+            macro.m_Events.push_back(event);
+        }
+
+        if (data != end || macro.m_Events.size() - eventsBefore != eventCount)
+        {
+            macro.m_Events.resize(eventsBefore);
+            p_Info.m_Status = "A block could not be decoded; recovered every block before it.";
+            break;
+        }
+
+        fileCrc = Crc32(fileCrc, payload.data(), payload.size());
+        ++p_Info.m_BlockCount;
+        p_Info.m_EventCount += eventCount;
+    }
+
+    if (macro.m_Events.empty())
+    {
+        if (p_Info.m_IsComplete)
+        {
+            p_Info.m_Status = "The recording has no events.";
+        }
+        return false;
+    }
+
+    p_Macro = macro;
+    return true;
+}
+
+// Writing ---------------------------------------------------------------------
+
+MacroFileWriter::MacroFileWriter()
+    : m_IsOpen(false),
+    m_ActiveEvents(0),
+    m_PendingEvents(0),
+    m_HasPendingBlock(false),
+    m_IsFinishing(false),
+    m_BlockCount(0),
+    m_FileCrc(0),
+    m_EventCount(0),
+    m_BytesWritten(0)
+{
+}
+
+MacroFileWriter::~MacroFileWriter()
+{
+    Finish();
+}
+
+bool MacroFileWriter::Open(const std::string& p_Path, MacroTimeUnit p_Unit, uint32_t p_LoopGapTicks)
+{
+    Finish();
+
+    m_File.open(p_Path, std::ios::binary | std::ios::trunc);
+    if (!m_File)
+    {
+        SetError("Could not create " + p_Path);
+        return false;
+    }
+
+    std::vector<uint8_t> header(s_FileMagic, s_FileMagic + sizeof(s_FileMagic));
+    PutU32(header, MacroFile::s_Version);
+    PutU32(header, (uint32_t)p_Unit);
+    PutU32(header, p_LoopGapTicks);
+    PutU32(header, 0);
+    m_File.write((const char*)header.data(), header.size());
+    m_File.flush();
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Path = p_Path;
+        m_Error.clear();
+        m_ActiveBlock.clear();
+        m_PendingBlock.clear();
+        m_ActiveBlock.reserve(s_BlockSize + 16);
+        m_PendingBlock.reserve(s_BlockSize + 16);
+        m_ActiveEvents = 0;
+        m_PendingEvents = 0;
+        m_HasPendingBlock = false;
+        m_IsFinishing = false;
+    }
+
+    m_BlockCount = 0;
+    m_FileCrc = 0;
+    m_EventCount.store(0);
+    m_BytesWritten.store(header.size());
+
+    m_IsOpen.store(true);
+    m_Thread = std::thread(&MacroFileWriter::RunFlush, this);
+    return true;
+}
+
+void MacroFileWriter::Append(const MacroEvent& p_Event)
+{
+    if (!m_IsOpen.load())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    if (m_ActiveBlock.empty())
+    {
+        m_ActiveBlockStart = std::chrono::steady_clock::now();
+    }
+    EncodeEvent(m_ActiveBlock, p_Event);
+    ++m_ActiveEvents;
+    m_EventCount.fetch_add(1);
+
+    if (m_ActiveBlock.size() < s_BlockSize)
+    {
+        return;
+    }
+
+    // Both blocks full: wait for the disk rather than growing
+    m_Condition.wait(lock, [this] { return !m_HasPendingBlock || !m_Error.empty(); });
+    if (!m_Error.empty())
+    {
+        m_ActiveBlock.clear();
+        m_ActiveEvents = 0;
+        return;
+    }
+
+    std::swap(m_ActiveBlock, m_PendingBlock);
+    m_PendingEvents = m_ActiveEvents;
+    m_ActiveEvents = 0;
+    m_HasPendingBlock = true;
+    m_Condition.notify_all();
+}
+
+void MacroFileWriter::RunFlush()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true)
+    {
+        m_Condition.wait_for(lock, std::chrono::milliseconds(250), [this] { return m_HasPendingBlock || m_IsFinishing; });
+
+        // Hand off a partly filled block once it is old enough, or at the end
+        if (!m_HasPendingBlock && !m_ActiveBlock.empty() &&
+            (m_IsFinishing || std::chrono::steady_clock::now() - m_ActiveBlockStart >= std::chrono::milliseconds(s_MaxBlockAgeMs)))
+        {
+            std::swap(m_ActiveBlock, m_PendingBlock);
+            m_PendingEvents = m_ActiveEvents;
+            m_ActiveEvents = 0;
+            m_HasPendingBlock = true;
+        }
+
+        if (m_HasPendingBlock)
+        {
+            // The recorder never touches the pending block while it is flagged, so write it unlocked
+            lock.unlock();
+            bool isWritten = WriteBlock(m_PendingBlock, m_PendingEvents);
+            lock.lock();
+
+            if (!isWritten && m_Error.empty())
+            {
+                m_Error = "Could not write to " + m_Path;
+            }
+            m_PendingBlock.clear();
+            m_HasPendingBlock = false;
+            m_Condition.notify_all();
+            continue;
+        }
+
+        if (m_IsFinishing && m_ActiveBlock.empty())
+        {
+            break;
+        }
+    }
+}
+
+bool MacroFileWriter::WriteBlock(const std::vector<uint8_t>& p_Payload, uint32_t p_EventCount)
+{
+    uint32_t blockCrc = MacroFile::Crc32(0, p_Payload.data(), p_Payload.size());
+
+    std::vector<uint8_t> blockHeader;
+    PutU32(blockHeader, s_BlockMagic);
+    PutU32(blockHeader, (uint32_t)p_Payload.size());
+    PutU32(blockHeader, p_EventCount);
+    PutU32(blockHeader, blockCrc);
+
+    m_File.write((const char*)blockHeader.data(), blockHeader.size());
+    m_File.write((const char*)p_Payload.data(), p_Payload.size());
+    m_File.flush();
+    if (!m_File)
+    {
+        return false;
+    }
+
+    m_FileCrc = MacroFile::Crc32(m_FileCrc, p_Payload.data(), p_Payload.size());
+    ++m_BlockCount;
+    m_BytesWritten.fetch_add(blockHeader.size() + p_Payload.size());
+    return true;
+}
+
+bool MacroFileWriter::Finish()
+{
+    if (!m_IsOpen.load())
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_IsFinishing = true;
+    }
+    m_Condition.notify_all();
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    // The footer only goes on once every block is on disk
+    bool isOk = GetError().empty();
+    if (isOk)
+    {
+        std::vector<uint8_t> footer;
+        PutU32(footer, s_FooterMagic);
+        PutU32(footer, m_BlockCount);
+        PutU64(footer, m_EventCount.load());
+        PutU32(footer, m_FileCrc);
+        PutU32(footer, MacroFile::Crc32(0, footer.data(), footer.size()));
+
+        m_File.write((const char*)footer.data(), footer.size());
+        m_File.flush();
+        isOk = (bool)m_File;
+        if (isOk)
+        {
+            m_BytesWritten.fetch_add(footer.size());
+        }
+        else
+        {
+            SetError("Could not write to " + GetPath());
+        }
+    }
+
+    m_File.close();
+    m_IsOpen.store(false);
+    return isOk;
+}
+
+std::string MacroFileWriter::GetPath() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Path;
+}
+
+std::string MacroFileWriter::GetError() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Error;
+}
+
+void MacroFileWriter::SetError(const std::string& p_Error)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Error = p_Error;
+    Logger::Error("{}", p_Error);
+}
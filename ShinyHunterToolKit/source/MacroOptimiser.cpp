@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cstdint>
+#include "../include/MacroOptimiser.h"
+
+bool MacroOptimiser::IsSameReport(const XUSB_REPORT& p_A, const XUSB_REPORT& p_B)
+{
+    return p_A.wButtons == p_B.wButtons &&
+        p_A.bLeftTrigger == p_B.bLeftTrigger &&
+        p_A.bRightTrigger == p_B.bRightTrigger &&
+        p_A.sThumbLX == p_B.sThumbLX &&
+        p_A.sThumbLY == p_B.sThumbLY &&
+        p_A.sThumbRX == p_B.sThumbRX &&
+        p_A.sThumbRY == p_B.sThumbRY;
+}
+
+std::vector<MacroOptimiser::MacroState> MacroOptimiser::GetStateSequence(const Macro& p_Macro)
+{
+    std::vector<MacroState> states;
+    XUSB_REPORT state = {};
+    uint64_t time = 0;
+
+    for (const MacroEvent& event : p_Macro.m_Events)
+    {
+        time += event.m_Ticks;
+        if (!IsSameReport(event.m_Report, state))
+        {
+            states.push_back({ event.m_Report, time });
+            state = event.m_Report;
+        }
+    }
+
+    return states;
+}
+
+Macro MacroOptimiser::Clean(const Macro& p_Macro, const MacroOptimiserSettings& p_Settings, MacroOptimiserReport* p_Report)
+{
+    Macro result;
+    result.m_Unit = p_Macro.m_Unit;
+    result.m_LoopGapTicks = p_Macro.m_LoopGapTicks;
+    result.m_MarksEncounters = p_Macro.m_MarksEncounters;
+    result.m_StopsOnShiny = p_Macro.m_StopsOnShiny;
+    result.m_PlaysOnce = p_Macro.m_PlaysOnce;
+    result.m_Events.reserve(p_Macro.m_Events.size());
+
+    const XUSB_REPORT neutral = {};
+    XUSB_REPORT state = {};
+    uint64_t carriedTicks = 0;
+
+    // Every event that is not a no-op is a state change of the input as well, so this
+    // counts through the input's state sequence alongside the kept events
+    size_t stateIndex = 0;
+    std::vector<size_t> keptStates;
+
+    for (const MacroEvent& event : p_Macro.m_Events)
+    {
+        // No-op: the pad is already in this state, only the time it took matters
+        if (IsSameReport(event.m_Report, state))
+        {
+            carriedTicks += event.m_Ticks;
+            if (p_Report) ++p_Report->m_DroppedEvents;
+            continue;
+        }
+        ++stateIndex;
+
+        MacroEvent merged = event;
+        merged.m_Ticks = (uint32_t)std::min<uint64_t>(merged.m_Ticks + carriedTicks, UINT32_MAX);
+        carriedTicks = 0;
+
+        // Redundant pair: the previous event left a state and this one returns to it
+        // before the game could register the intermediate state, so drop both
+        if (!result.m_Events.empty())
+        {
+            const MacroEvent& intermediate = result.m_Events.back();
+            const XUSB_REPORT& before = result.m_Events.size() >= 2 ? result.m_Events[result.m_Events.size() - 2].m_Report : neutral;
+
+            bool isRelease = (intermediate.m_Report.wButtons & ~before.wButtons) == 0;
+            uint32_t minTicks = isRelease ? p_Settings.m_MinReleaseTicks : p_Settings.m_MinHoldTicks;
+
+            if (IsSameReport(merged.m_Report, before) && merged.m_Ticks < minTicks)
+            {
+                carriedTicks = (uint64_t)intermediate.m_Ticks + merged.m_Ticks;
+                result.m_Events.pop_back();
+                state = before;
+                if (p_Report) p_Report->m_MergedPairs.push_back({ keptStates.back(), stateIndex - 1 });
+                keptStates.pop_back();
+                continue;
+            }
+        }
+
+        result.m_Events.push_back(merged);
+        keptStates.push_back(stateIndex - 1);
+        state = merged.m_Report;
+    }
+
+    // Time after the last state change still passes before the next loop
+    result.m_LoopGapTicks = (uint32_t)std::min<uint64_t>(result.m_LoopGapTicks + carriedTicks, UINT32_MAX);
+
+    return result;
+}
+
+std::vector<MacroIdleGap> MacroOptimiser::FindIdleGaps(const Macro& p_Macro)
+{
+    std::vector<MacroIdleGap> gaps;
+    const XUSB_REPORT neutral = {};
+
+    for (size_t i = 0; i < p_Macro.m_Events.size(); ++i)
+    {
+        const XUSB_REPORT& before = (i == 0) ? neutral : p_Macro.m_Events[i - 1].m_Report;
+        if (IsSameReport(before, neutral) && p_Macro.m_Events[i].m_Ticks > 0)
+        {
+            gaps.push_back({ i, p_Macro.m_Events[i].m_Ticks });
+        }
+    }
+
+    return gaps;
+}
+
+Macro MacroOptimiser::Optimise(const Macro& p_Macro, const MacroOptimiserSettings& p_Settings, MacroOptimiserReport& p_Report)
+{
+    p_Report = MacroOptimiserReport();
+    p_Report.m_CycleTicksBefore = GetCycleTicks(p_Macro);
+
+    Macro result = Clean(p_Macro, p_Settings, &p_Report);
+
+    std::vector<MacroIdleGap> gaps = FindIdleGaps(result);
+    for (size_t i = 0; i < gaps.size(); ++i)
+    {
+        uint32_t safeTicks = (i < p_Settings.m_SafeIdleTicks.size()) ? p_Settings.m_SafeIdleTicks[i] : p_Settings.m_MinIdleTicks;
+        safeTicks = std::max(safeTicks, p_Settings.m_MinReleaseTicks);
+        MacroEvent& event = result.m_Events[gaps[i].m_EventIndex];
+
+        if (event.m_Ticks > safeTicks)
+        {
+            event.m_Ticks = safeTicks;
+            ++p_Report.m_ShrunkGaps;
+        }
+    }
+
+    // The player releases everything at the end of a loop, so the loop gap is an idle gap too
+    uint32_t safeLoopGap = std::max(p_Settings.m_MinIdleTicks, p_Settings.m_MinReleaseTicks);
+    if (result.m_LoopGapTicks > safeLoopGap)
+    {
+        result.m_LoopGapTicks = safeLoopGap;
+        ++p_Report.m_ShrunkGaps;
+    }
+
+    p_Report.m_CycleTicksAfter = GetCycleTicks(result);
+    return result;
+}
+
+std::string MacroOptimiser::Verify(const Macro& p_Optimised, const Macro& p_Trace, const MacroOptimiserSettings& p_Settings,
+    const MacroOptimiserReport& p_Report)
+{
+    const XUSB_REPORT neutral = {};
+    std::vector<MacroState> trace = GetStateSequence(p_Trace);
+    std::vector<MacroState> actual = GetStateSequence(p_Optimised);
+
+    // For each merged state, the index of the change that ended its pair
+    std::vector<size_t> pairEnd(trace.size(), SIZE_MAX);
+    for (const MacroMergedPair& pair : p_Report.m_MergedPairs)
+    {
+        if (pair.m_FirstState >= pair.m_SecondState || pair.m_SecondState >= trace.size() ||
+            pairEnd[pair.m_FirstState] != SIZE_MAX || pairEnd[pair.m_SecondState] != SIZE_MAX)
+        {
+            return "Merged pair at state change " + std::to_string(pair.m_FirstState + 1) + " does not match the trace.";
+        }
+        pairEnd[pair.m_FirstState] = pair.m_SecondState;
+        pairEnd[pair.m_SecondState] = pair.m_SecondState;
+    }
+
+    // Each merge must be one the recording allows: shorter than the minimum, and back to the
+    // state in force before it (pairs merged earlier no longer count, enclosing ones still do)
+    for (const MacroMergedPair& pair : p_Report.m_MergedPairs)
+    {
+        const MacroState& first = trace[pair.m_FirstState];
+        const MacroState& second = trace[pair.m_SecondState];
+
+        size_t previous = pair.m_FirstState;
+        while (previous > 0 && pairEnd[previous - 1] < pair.m_FirstState)
+        {
+            --previous;
+        }
+        const XUSB_REPORT& before = previous == 0 ? neutral : trace[previous - 1].m_Report;
+
+        bool isRelease = (first.m_Report.wButtons & ~before.wButtons) == 0;
+        uint32_t minTicks = isRelease ? p_Settings.m_MinReleaseTicks : p_Settings.m_MinHoldTicks;
+        uint64_t duration = second.m_Time - first.m_Time;
+
+        if (!IsSameReport(second.m_Report, before))
+        {
+            return "Merged pair at state change " + std::to_string(pair.m_FirstState + 1) + " does not return to the state before it.";
+        }
+        if (duration >= minTicks)
+        {
+            return std::string(isRelease ? "Release" : "Press") + " at state change " + std::to_string(pair.m_FirstState + 1) +
+                " was merged but lasts " + std::to_string(duration) + " ticks in the trace.";
+        }
+    }
+
+    // Everything else in the recording must come out in the same order
+    size_t next = 0;
+    for (size_t i = 0; i < trace.size(); ++i)
+    {
+        if (pairEnd[i] != SIZE_MAX)
+        {
+            continue;
+        }
+        if (next >= actual.size() || !IsSameReport(trace[i].m_Report, actual[next].m_Report))
+        {
+            return "State change " + std::to_string(i + 1) + " of the trace is missing or differs in the optimised macro.";
+        }
+        ++next;
+    }
+    if (next != actual.size())
+    {
+        return "Optimised macro has " + std::to_string(actual.size() - next) + " state changes the trace does not.";
+    }
+
+    const std::vector<MacroEvent>& events = p_Optimised.m_Events;
+
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const XUSB_REPORT& before = (i == 0) ? neutral : events[i - 1].m_Report;
+        uint64_t duration = (i + 1 < events.size()) ? events[i + 1].m_Ticks : p_Optimised.m_LoopGapTicks;
+
+        bool isRelease = (events[i].m_Report.wButtons & ~before.wButtons) == 0;
+        uint32_t minTicks = isRelease ? p_Settings.m_MinReleaseTicks : p_Settings.m_MinHoldTicks;
+
+        if (duration < minTicks)
+        {
+            return std::string(isRelease ? "Release" : "Press") + " at event " + std::to_string(i + 1) + " lasts " + std::to_string(duration) +
+                " ticks, below the minimum of " + std::to_string(minTicks) + ".";
+        }
+    }
+
+    return "";
+}
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/MacroTimeline.h"
+
+MacroTimelineSample MacroTimelineSample::Empty()
+{
+    MacroTimelineSample sample;
+    sample.m_Buttons = 0;
+    for (int i = 0; i < 2; ++i)
+    {
+        sample.m_TriggerMin[i] = 255;
+        sample.m_TriggerMax[i] = 0;
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        sample.m_ThumbMin[i] = 127;
+        sample.m_ThumbMax[i] = -128;
+    }
+    return sample;
+}
+
+void MacroTimelineSample::Merge(const MacroTimelineSample& p_Other)
+{
+    m_Buttons |= p_Other.m_Buttons;
+    for (int i = 0; i < 2; ++i)
+    {
+        m_TriggerMin[i] = std::min(m_TriggerMin[i], p_Other.m_TriggerMin[i]);
+        m_TriggerMax[i] = std::max(m_TriggerMax[i], p_Other.m_TriggerMax[i]);
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        m_ThumbMin[i] = std::min(m_ThumbMin[i], p_Other.m_ThumbMin[i]);
+        m_ThumbMax[i] = std::max(m_ThumbMax[i], p_Other.m_ThumbMax[i]);
+    }
+}
+
+MacroTimeline::MacroTimeline()
+    : m_SourceRevision(0),
+    m_SourceSize(0),
+    m_Length(0),
+    m_HasAnalog(false),
+    m_SampleStart(0),
+    m_SampleEnd(0),
+    m_SampleColumns(0)
+{
+}
+
+void MacroTimeline::Build(const Macro& p_Macro)
+{
+    const std::vector<MacroEvent>& events = p_Macro.m_Events;
+    m_SourceRevision = p_Macro.m_Revision.m_Value;
+    m_SourceSize = events.size();
+
+    m_Times.resize(events.size());
+    m_Levels.clear();
+    m_Levels.emplace_back(events.size());
+    m_HasAnalog = false;
+
+    uint64_t time = 0;
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const XUSB_REPORT& report = events[i].m_Report;
+        time += events[i].m_Ticks;
+        m_Times[i] = time;
+
+        MacroTimelineSample& sample = m_Levels[0][i];
+        sample.m_Buttons = report.wButtons;
+        sample.m_TriggerMin[0] = sample.m_TriggerMax[0] = report.bLeftTrigger;
+        sample.m_TriggerMin[1] = sample.m_TriggerMax[1] = report.bRightTrigger;
+        SHORT thumbs[4] = { report.sThumbLX, report.sThumbLY, report.sThumbRX, report.sThumbRY };
+        for (int axis = 0; axis < 4; ++axis)
+        {
+            sample.m_ThumbMin[axis] = sample.m_ThumbMax[axis] = (int8_t)(thumbs[axis] >> 8);
+        }
+
+        m_HasAnalog = m_HasAnalog || report.bLeftTrigger != 0 || report.bRightTrigger != 0 ||
+            report.sThumbLX != 0 || report.sThumbLY != 0 || report.sThumbRX != 0 || report.sThumbRY != 0;
+    }
+
+    // The last event holds for the loop gap, as it does in playback
+    m_Length = time + p_Macro.m_LoopGapTicks;
+
+    while (m_Levels.back().size() > 1)
+    {
+        const std::vector<MacroTimelineSample>& below = m_Levels.back();
+        std::vector<MacroTimelineSample> level((below.size() + 1) / 2);
+        for (size_t i = 0; i < level.size(); ++i)
+        {
+            level[i] = below[i * 2];
+            if (i * 2 + 1 < below.size())
+            {
+                level[i].Merge(below[i * 2 + 1]);
+            }
+        }
+        m_Levels.push_back(std::move(level));
+    }
+
+    m_SampleColumns = 0;
+}
+
+bool MacroTimeline::IsBuiltFor(const Macro& p_Macro) const
+{
+    // The size catches events appended in place by a live recording
+    return m_SourceRevision == p_Macro.m_Revision.m_Value && m_SourceSize == p_Macro.m_Events.size();
+}
+
+size_t MacroTimeline::FindEvent(uint64_t p_Ticks) const
+{
+    auto next = std::upper_bound(m_Times.begin(), m_Times.end(), p_Ticks);
+    return next == m_Times.begin() ? 0 : (size_t)(next - m_Times.begin()) - 1;
+}
+
+size_t MacroTimeline::FindEventAfter(uint64_t p_Ticks) const
+{
+    return (size_t)(std::lower_bound(m_Times.begin(), m_Times.end(), p_Ticks) - m_Times.begin());
+}
+
+MacroTimelineSample MacroTimeline::Query(size_t p_First, size_t p_Last) const
+{
+    // Bottom-up over the pyramid: at most two nodes per level
+    MacroTimelineSample result = MacroTimelineSample::Empty();
+    size_t low = p_First;
+    size_t high = p_Last + 1;
+
+    for (size_t level = 0; low < high; ++level)
+    {
+        if (low & 1)
+        {
+            result.Merge(m_Levels[level][low++]);
+        }
+        if (high & 1)
+        {
+            result.Merge(m_Levels[level][--high]);
+        }
+        low >>= 1;
+        high >>= 1;
+    }
+    return result;
+}
+
+const std::vector<MacroTimelineSample>& MacroTimeline::Sample(uint64_t p_Start, uint64_t p_End, int p_Columns)
+{
+    if (p_Columns == m_SampleColumns && p_Start == m_SampleStart && p_End == m_SampleEnd)
+    {
+        return m_Samples;
+    }
+
+    m_SampleStart = p_Start;
+    m_SampleEnd = p_End;
+    m_SampleColumns = p_Columns;
+    m_Samples.assign(std::max(p_Columns, 0), MacroTimelineSample::Empty());
+
+    if (m_Times.empty() || p_End <= p_Start)
+    {
+        return m_Samples;
+    }
+
+    double ticksPerColumn = (double)(p_End - p_Start) / p_Columns;
+    for (int column = 0; column < p_Columns; ++column)
+    {
+        uint64_t columnStart = p_Start + (uint64_t)(column * ticksPerColumn);
+        uint64_t columnEnd = std::max(p_Start + (uint64_t)((column + 1) * ticksPerColumn), columnStart + 1);
+        if (columnStart >= m_Length || columnEnd <= m_Times.front())
+        {
+            continue;
+        }
+
+        // Every event in effect at some point of the column
+        size_t first = FindEvent(columnStart);
+        size_t last = FindEventAfter(columnEnd);
+        last = last == 0 ? 0 : last - 1;
+        m_Samples[column] = Query(first, std::max(first, last));
+    }
+
+    return m_Samples;
+}
+
+// Editing ---------------------------------------------------------------------
+
+void MacroTimeline::Cut(Macro& p_Macro, size_t p_First, size_t p_Last)
+{
+    std::vector<MacroEvent>& events = p_Macro.m_Events;
+    if (p_First > p_Last || p_Last >= events.size())
+    {
+        return;
+    }
+
+    // Ripple delete: later events keep their own delays, so the cut time disappears
+    events.erase(events.begin() + p_First, events.begin() + p_Last + 1);
+    p_Macro.m_Revision.Bump();
+}
+
+int64_t MacroTimeline::Nudge(Macro& p_Macro, size_t p_First, size_t p_Last, int64_t p_Ticks)
+{
+    std::vector<MacroEvent>& events = p_Macro.m_Events;
+    if (p_First > p_Last || p_Last >= events.size())
+    {
+        return 0;
+    }
+
+    // The block moves between its neighbours without shifting anything after it
+    int64_t earliest = -(int64_t)events[p_First].m_Ticks;
+    int64_t latest = p_Last + 1 < events.size() ? (int64_t)events[p_Last + 1].m_Ticks : (int64_t)UINT32_MAX - events[p_First].m_Ticks;
+    int64_t ticks = std::clamp(p_Ticks, earliest, latest);
+
+    events[p_First].m_Ticks = (uint32_t)(events[p_First].m_Ticks + ticks);
+    if (p_Last + 1 < events.size())
+    {
+        events[p_Last + 1].m_Ticks = (uint32_t)(events[p_Last + 1].m_Ticks - ticks);
+    }
+    p_Macro.m_Revision.Bump();
+    return ticks;
+}
+
+void MacroTimeline::Scale(Macro& p_Macro, size_t p_First, size_t p_Last, double p_Factor)
+{
+    std::vector<MacroEvent>& events = p_Macro.m_Events;
+    if (p_First > p_Last || p_Last >= events.size() || p_Factor <= 0.0)
+    {
+        return;
+    }
+
+    // Gaps inside the range, plus how long the last selected state is held
+    size_t end = std::min(p_Last + 1, events.size() - 1);
+    for (size_t i = p_First + 1; i <= end; ++i)
+    {
+        double ticks = std::round(events[i].m_Ticks * p_Factor);
+        events[i].m_Ticks = (uint32_t)std::min(ticks, (double)UINT32_MAX);
+    }
+    p_Macro.m_Revision.Bump();
+}
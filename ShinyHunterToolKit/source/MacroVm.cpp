@@ -0,0 +1,511 @@
+#include <algorithm>
+#include <cstdio>
+#include "../include/MacroVm.h"
+#include "../include/ViGEmManager.h"
+#include "../include/PreciseTimer.h"
+
+// Program ----------------------------------------------------------------------
+
+MacroProgram MacroProgram::FromMacro(const Macro& p_Macro)
+{
+    MacroProgramBuilder builder;
+    builder.Loop(p_Macro.m_PlaysOnce ? 1 : 0);
+    for (const MacroEvent& event : p_Macro.m_Events)
+    {
+        builder.Wait(event.m_Ticks, p_Macro.m_Unit);
+        builder.SetReport(event.m_Report);
+    }
+
+    if (p_Macro.m_MarksEncounters)
+    {
+        builder.Encounter();
+    }
+
+    // Release everything and add a delay between the end and the start of the sequence
+    builder.ReleaseAll();
+    builder.Wait(p_Macro.m_LoopGapTicks, p_Macro.m_Unit);
+
+    // Reset, check, and only go round again if no shiny showed up
+    if (p_Macro.m_StopsOnShiny)
+    {
+        builder.JumpIf(MacroCondition::ShinyDetected, "shiny");
+    }
+    builder.EndLoop();
+
+    if (p_Macro.m_StopsOnShiny)
+    {
+        builder.Label("shiny");
+        builder.Halt();
+    }
+
+    MacroProgram program;
+    builder.Build(program);
+    return program;
+}
+
+const char* MacroProgram::GetOpcodeName(MacroOpcode p_Opcode)
+{
+    switch (p_Opcode)
+    {
+    case MacroOpcode::Halt: return "halt";
+    case MacroOpcode::Press: return "press";
+    case MacroOpcode::Release: return "release";
+    case MacroOpcode::ReleaseAll: return "release all";
+    case MacroOpcode::SetReport: return "set";
+    case MacroOpcode::Hold: return "hold";
+    case MacroOpcode::Wait: return "wait";
+    case MacroOpcode::Loop: return "loop";
+    case MacroOpcode::EndLoop: return "end loop";
+    case MacroOpcode::Jump: return "jump";
+    case MacroOpcode::JumpIf: return "jump if";
+    case MacroOpcode::JumpIfNot: return "jump if not";
+    case MacroOpcode::Call: return "call";
+    case MacroOpcode::Return: return "return";
+    case MacroOpcode::Encounter: return "encounter";
+    default: return "?";
+    }
+}
+
+const char* MacroProgram::GetConditionName(MacroCondition p_Condition)
+{
+    switch (p_Condition)
+    {
+    case MacroCondition::ShinyDetected: return "shiny";
+    case MacroCondition::CounterFrozen: return "frozen";
+    case MacroCondition::EncounterCounted: return "encounter";
+    default: return "?";
+    }
+}
+
+std::string MacroProgram::Disassemble() const
+{
+    std::string text;
+    char line[128];
+
+    for (uint32_t pc = 0; pc < m_Code.size(); ++pc)
+    {
+        for (const auto& label : m_Labels)
+        {
+            if (label.second == pc)
+            {
+                text += label.first + ":\n";
+            }
+        }
+
+        const MacroInstruction& instruction = m_Code[pc];
+        const char* unit = (MacroTimeUnit)instruction.m_Mode == MacroTimeUnit::Frames ? "f" : "ms";
+
+        switch (instruction.m_Opcode)
+        {
+        case MacroOpcode::Press:
+        case MacroOpcode::Release:
+            snprintf(line, sizeof(line), "%04u  %s 0x%04X\n", pc, GetOpcodeName(instruction.m_Opcode), instruction.m_Buttons);
+            break;
+        case MacroOpcode::SetReport:
+            snprintf(line, sizeof(line), "%04u  set report %u\n", pc, instruction.m_Operand);
+            break;
+        case MacroOpcode::Hold:
+            snprintf(line, sizeof(line), "%04u  hold 0x%04X %u%s\n", pc, instruction.m_Buttons, instruction.m_Operand, unit);
+            break;
+        case MacroOpcode::Wait:
+            snprintf(line, sizeof(line), "%04u  wait %u%s\n", pc, instruction.m_Operand, unit);
+            break;
+        case MacroOpcode::Loop:
+            snprintf(line, sizeof(line), "%04u  loop %u (end %04u)\n", pc, instruction.m_Operand, instruction.m_Target);
+            break;
+        case MacroOpcode::EndLoop:
+        case MacroOpcode::Jump:
+        case MacroOpcode::Call:
+            snprintf(line, sizeof(line), "%04u  %s %04u\n", pc, GetOpcodeName(instruction.m_Opcode), instruction.m_Target);
+            break;
+        case MacroOpcode::JumpIf:
+        case MacroOpcode::JumpIfNot:
+            snprintf(line, sizeof(line), "%04u  %s %s %04u\n", pc, GetOpcodeName(instruction.m_Opcode), GetConditionName((MacroCondition)instruction.m_Mode), instruction.m_Target);
+            break;
+        default:
+            snprintf(line, sizeof(line), "%04u  %s\n", pc, GetOpcodeName(instruction.m_Opcode));
+            break;
+        }
+        text += line;
+    }
+
+    return text;
+}
+
+// Builder ----------------------------------------------------------------------
+
+void MacroProgramBuilder::Emit(MacroOpcode p_Opcode, uint8_t p_Mode, WORD p_Buttons, uint32_t p_Operand, uint32_t p_Target)
+{
+    m_Program.m_Code.push_back({ p_Opcode, p_Mode, p_Buttons, p_Operand, p_Target });
+}
+
+void MacroProgramBuilder::Press(WORD p_Buttons)
+{
+    Emit(MacroOpcode::Press, 0, p_Buttons);
+}
+
+void MacroProgramBuilder::Release(WORD p_Buttons)
+{
+    Emit(MacroOpcode::Release, 0, p_Buttons);
+}
+
+void MacroProgramBuilder::ReleaseAll()
+{
+    Emit(MacroOpcode::ReleaseAll);
+}
+
+void MacroProgramBuilder::SetReport(const XUSB_REPORT& p_Report)
+{
+    Emit(MacroOpcode::SetReport, 0, 0, (uint32_t)m_Program.m_Reports.size());
+    m_Program.m_Reports.push_back(p_Report);
+}
+
+void MacroProgramBuilder::Hold(WORD p_Buttons, uint32_t p_Ticks, MacroTimeUnit p_Unit)
+{
+    Emit(MacroOpcode::Hold, (uint8_t)p_Unit, p_Buttons, p_Ticks);
+}
+
+void MacroProgramBuilder::Wait(uint32_t p_Ticks, MacroTimeUnit p_Unit)
+{
+    Emit(MacroOpcode::Wait, (uint8_t)p_Unit, 0, p_Ticks);
+}
+
+void MacroProgramBuilder::Loop(uint32_t p_Count)
+{
+    m_OpenLoops.push_back((uint32_t)m_Program.m_Code.size());
+    Emit(MacroOpcode::Loop, 0, 0, p_Count);
+}
+
+bool MacroProgramBuilder::EndLoop()
+{
+    if (m_OpenLoops.empty())
+    {
+        if (m_Error.empty()) m_Error = "end of loop without a matching loop";
+        return false;
+    }
+
+    uint32_t start = m_OpenLoops.back();
+    m_OpenLoops.pop_back();
+    m_Program.m_Code[start].m_Target = (uint32_t)m_Program.m_Code.size();
+    Emit(MacroOpcode::EndLoop, 0, 0, 0, start + 1);
+    return true;
+}
+
+bool MacroProgramBuilder::HasLabel(const std::string& p_Name) const
+{
+    for (const auto& label : m_Program.m_Labels)
+    {
+        if (label.first == p_Name)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MacroProgramBuilder::Label(const std::string& p_Name)
+{
+    if (HasLabel(p_Name))
+    {
+        if (m_Error.empty()) m_Error = "label '" + p_Name + "' is defined twice";
+        return false;
+    }
+
+    m_Program.m_Labels.push_back({ p_Name, (uint32_t)m_Program.m_Code.size() });
+    return true;
+}
+
+void MacroProgramBuilder::Jump(const std::string& p_Label)
+{
+    m_Fixups.push_back({ m_Program.m_Code.size(), p_Label });
+    Emit(MacroOpcode::Jump);
+}
+
+void MacroProgramBuilder::JumpIf(MacroCondition p_Condition, const std::string& p_Label, bool p_IsNegated)
+{
+    m_Fixups.push_back({ m_Program.m_Code.size(), p_Label });
+    Emit(p_IsNegated ? MacroOpcode::JumpIfNot : MacroOpcode::JumpIf, (uint8_t)p_Condition);
+}
+
+void MacroProgramBuilder::Call(const std::string& p_Label)
+{
+    m_Fixups.push_back({ m_Program.m_Code.size(), p_Label });
+    Emit(MacroOpcode::Call);
+}
+
+void MacroProgramBuilder::Return()
+{
+    Emit(MacroOpcode::Return);
+}
+
+void MacroProgramBuilder::Encounter()
+{
+    Emit(MacroOpcode::Encounter);
+}
+
+void MacroProgramBuilder::Halt()
+{
+    Emit(MacroOpcode::Halt);
+}
+
+bool MacroProgramBuilder::Build(MacroProgram& p_Program)
+{
+    if (!m_OpenLoops.empty() && m_Error.empty())
+    {
+        m_Error = "loop without a matching end";
+    }
+
+    for (const Fixup& fixup : m_Fixups)
+    {
+        auto label = std::find_if(m_Program.m_Labels.begin(), m_Program.m_Labels.end(),
+            [&](const std::pair<std::string, uint32_t>& p_Label) { return p_Label.first == fixup.m_Label; });
+
+        if (label == m_Program.m_Labels.end())
+        {
+            if (m_Error.empty()) m_Error = "unknown label '" + fixup.m_Label + "'";
+            continue;
+        }
+        m_Program.m_Code[fixup.m_Instruction].m_Target = label->second;
+    }
+
+    if (!m_Error.empty())
+    {
+        return false;
+    }
+
+    p_Program = m_Program;
+    return true;
+}
+
+// Interpreter ------------------------------------------------------------------
+
+MacroVm::MacroVm(ViGEmManager& p_ViGEmManager)
+    : m_ViGEmManager(p_ViGEmManager), m_Stack(), m_StackSize(0), m_LastEncounterCount(0)
+{
+}
+
+bool MacroVm::CheckCondition(MacroCondition p_Condition)
+{
+    if (!m_ConditionHandler)
+    {
+        return false;
+    }
+
+    uint64_t value = m_ConditionHandler(p_Condition);
+    if (p_Condition == MacroCondition::EncounterCounted)
+    {
+        bool isNew = value != m_LastEncounterCount;
+        m_LastEncounterCount = value;
+        return isNew;
+    }
+    return value != 0;
+}
+
+bool MacroVm::Fail(const char* p_Error, uint32_t p_Pc)
+{
+    char error[128];
+    snprintf(error, sizeof(error), "%s at instruction %u", p_Error, p_Pc);
+    m_Error = error;
+    return false;
+}
+
+void MacroVm::Unwind(uint32_t p_Target)
+{
+    // Jumping out of a loop drops its frame; calls are only left through Return
+    while (m_StackSize > 0 && !m_Stack[m_StackSize - 1].m_IsCall &&
+        (p_Target < m_Stack[m_StackSize - 1].m_Start || p_Target > m_Stack[m_StackSize - 1].m_End))
+    {
+        --m_StackSize;
+    }
+}
+
+bool MacroVm::Run(const MacroProgram& p_Program, const std::atomic<bool>& p_Stop)
+{
+    PreciseTimer timer;
+
+    const std::vector<MacroInstruction>& code = p_Program.m_Code;
+    const uint32_t end = (uint32_t)code.size();
+
+    m_Error.clear();
+    m_StackSize = 0;
+    m_LastEncounterCount = m_ConditionHandler ? m_ConditionHandler(MacroCondition::EncounterCounted) : 0;
+
+    XUSB_REPORT report = {};
+    auto deadline = std::chrono::steady_clock::now();
+    uint32_t pc = 0;
+    uint32_t steps = 0;
+    bool isOk = true;
+
+    while (isOk && pc < end && !p_Stop)
+    {
+        const MacroInstruction& instruction = code[pc];
+
+        if (++steps > s_MaxStepsWithoutWait)
+        {
+            isOk = Fail("no wait inside a loop", pc);
+            break;
+        }
+
+        switch (instruction.m_Opcode)
+        {
+        case MacroOpcode::Halt:
+            pc = end;
+            break;
+
+        case MacroOpcode::Press:
+            report.wButtons |= instruction.m_Buttons;
+            m_ViGEmManager.ReceiveInput(report);
+            ++pc;
+            break;
+
+        case MacroOpcode::Release:
+            report.wButtons &= ~instruction.m_Buttons;
+            m_ViGEmManager.ReceiveInput(report);
+            ++pc;
+            break;
+
+        case MacroOpcode::ReleaseAll:
+            report = XUSB_REPORT();
+            m_ViGEmManager.ReceiveInput(report);
+            ++pc;
+            break;
+
+        case MacroOpcode::SetReport:
+            if (instruction.m_Operand >= p_Program.m_Reports.size())
+            {
+                isOk = Fail("missing report", pc);
+                break;
+            }
+            report = p_Program.m_Reports[instruction.m_Operand];
+            m_ViGEmManager.ReceiveInput(report);
+            ++pc;
+            break;
+
+        case MacroOpcode::Hold:
+        case MacroOpcode::Wait:
+        {
+            // Re-read every wait so frame rate and speed changes apply without restarting playback
+            MacroTimebase timebase = m_ViGEmManager.GetMacroTimebase();
+
+            if (instruction.m_Opcode == MacroOpcode::Hold)
+            {
+                report.wButtons |= instruction.m_Buttons;
+                m_ViGEmManager.ReceiveInput(report);
+            }
+
+            deadline += timebase.ToDuration((MacroTimeUnit)instruction.m_Mode, instruction.m_Operand);
+            if (!PreciseTimer::SleepUntil(deadline, p_Stop))
+            {
+                break;
+            }
+
+            if (instruction.m_Opcode == MacroOpcode::Hold)
+            {
+                report.wButtons &= ~instruction.m_Buttons;
+                m_ViGEmManager.ReceiveInput(report);
+            }
+
+            steps = 0;
+            ++pc;
+            break;
+        }
+
+        case MacroOpcode::Loop:
+            if (m_StackSize == s_StackDepth)
+            {
+                isOk = Fail("stack overflow", pc);
+                break;
+            }
+            m_Stack[m_StackSize++] = { pc + 1, instruction.m_Target, instruction.m_Operand, false };
+            ++pc;
+            break;
+
+        case MacroOpcode::EndLoop:
+        {
+            if (m_StackSize == 0 || m_Stack[m_StackSize - 1].m_IsCall)
+            {
+                isOk = Fail("end of loop outside a loop", pc);
+                break;
+            }
+
+            Frame& frame = m_Stack[m_StackSize - 1];
+            if (frame.m_Remaining == 0 || --frame.m_Remaining > 0)
+            {
+                pc = frame.m_Start;
+
+                // If the thread fell behind, start the next iteration from now rather than rushing through it
+                auto now = std::chrono::steady_clock::now();
+                if (deadline < now)
+                {
+                    deadline = now;
+                }
+            }
+            else
+            {
+                --m_StackSize;
+                ++pc;
+            }
+            break;
+        }
+
+        case MacroOpcode::Jump:
+            Unwind(instruction.m_Target);
+            pc = instruction.m_Target;
+            break;
+
+        case MacroOpcode::JumpIf:
+        case MacroOpcode::JumpIfNot:
+            if (CheckCondition((MacroCondition)instruction.m_Mode) == (instruction.m_Opcode == MacroOpcode::JumpIf))
+            {
+                Unwind(instruction.m_Target);
+                pc = instruction.m_Target;
+            }
+            else
+            {
+                ++pc;
+            }
+            break;
+
+        case MacroOpcode::Call:
+            if (m_StackSize == s_StackDepth)
+            {
+                isOk = Fail("stack overflow", pc);
+                break;
+            }
+            m_Stack[m_StackSize++] = { pc + 1, 0, 0, true };
+            pc = instruction.m_Target;
+            break;
+
+        case MacroOpcode::Return:
+            while (m_StackSize > 0 && !m_Stack[m_StackSize - 1].m_IsCall)
+            {
+                --m_StackSize;
+            }
+
+            // Returning from the top level ends the program
+            if (m_StackSize == 0)
+            {
+                pc = end;
+            }
+            else
+            {
+                pc = m_Stack[--m_StackSize].m_Start;
+            }
+            break;
+
+        case MacroOpcode::Encounter:
+            m_ViGEmManager.PostEncounterMarker();
+            ++pc;
+            break;
+
+        default:
+            isOk = Fail("invalid instruction", pc);
+            break;
+        }
+    }
+
+    // Ensure all buttons are released when stopping
+    report = XUSB_REPORT();
+    m_ViGEmManager.ReceiveInput(report);
+    return isOk;
+}
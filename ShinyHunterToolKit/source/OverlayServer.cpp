@@ -0,0 +1,768 @@
+#include <winsock2.h>
+#include <windows.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include "../include/OverlayServer.h"
+#include "../include/Sha1.h"
+
+#pragma comment(lib, "ws2_32.lib")
+
+static const char* const s_WebSocketGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static const char* const s_FieldNames[] =
+{
+    "encounters", "encountersPerReset", "generation", "method", "hunt", "target", "huntId",
+    "probability", "cumulative", "encountersFor90", "resetsPerHour", "sessionResetsPerHour",
+    "lastCycleSeconds", "phaseCount", "totalAccepted", "frozen", "macroRunning", "recording",
+    "controllerConnected", "stalled"
+};
+
+static_assert(sizeof(s_FieldNames) / sizeof(s_FieldNames[0]) == 20, "one name per overlay field");
+
+// Keeps the last state it was sent and applies each delta on top, so the page never polls
+static const char s_OverlayPage[] = R"(<!DOCTYPE html>
+<html><head><meta charset="utf-8"><title>Shiny Hunter Tool Kit</title>
+<style>
+body{margin:0;background:transparent;color:#fff;font:600 28px sans-serif;text-shadow:0 0 4px #000,0 0 2px #000}
+#count{font-size:72px}.dim{opacity:.75;font-size:20px}.off{display:none}
+</style></head><body>
+<div id="hunt" class="dim"></div>
+<div id="count">-</div>
+<div id="odds"></div>
+<div id="rate" class="dim"></div>
+<div id="state" class="dim"></div>
+<script>
+const s = {};
+const byId = id => document.getElementById(id);
+function render() {
+  byId('hunt').textContent = [s.hunt, s.target].filter(x => x).join(' - ');
+  byId('count').textContent = s.encounters ?? '-';
+  byId('odds').textContent = s.probability ? '1/' + Math.round(1 / s.probability) + ' - ' + (s.cumulative * 100).toFixed(1) + '%' : '';
+  byId('rate').textContent = s.resetsPerHour ? Math.round(s.resetsPerHour) + ' resets/h' : '';
+  byId('state').textContent = s.frozen ? 'Shiny found!' : s.macroRunning ? 'Macro running' : s.stalled ? 'Stalled' : '';
+}
+function connect() {
+  const ws = new WebSocket('ws://' + location.host + '/ws');
+  ws.onmessage = e => { Object.assign(s, JSON.parse(e.data)); render(); };
+  ws.onclose = () => setTimeout(connect, 2000);
+}
+connect();
+</script></body></html>
+)";
+
+// Helpers ---------------------------------------------------------------------
+
+static void EncodeBase64(const uint8_t* p_Data, size_t p_Size, char* p_Output)
+{
+    static const char* const s_Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t o = 0;
+    for (size_t i = 0; i < p_Size; i += 3)
+    {
+        uint32_t value = (uint32_t)p_Data[i] << 16;
+        if (i + 1 < p_Size) value |= (uint32_t)p_Data[i + 1] << 8;
+        if (i + 2 < p_Size) value |= p_Data[i + 2];
+
+        p_Output[o++] = s_Alphabet[(value >> 18) & 63];
+        p_Output[o++] = s_Alphabet[(value >> 12) & 63];
+        p_Output[o++] = (i + 1 < p_Size) ? s_Alphabet[(value >> 6) & 63] : '=';
+        p_Output[o++] = (i + 2 < p_Size) ? s_Alphabet[value & 63] : '=';
+    }
+    p_Output[o] = '\0';
+}
+
+// Case-insensitive header lookup within the request head; the value is trimmed
+static bool FindHeader(const char* p_Request, size_t p_Size, const char* p_Name, char* p_Value, size_t p_ValueSize)
+{
+    size_t nameLength = std::strlen(p_Name);
+    for (size_t i = 0; i + 2 + nameLength < p_Size; ++i)
+    {
+        if (p_Request[i] != '\n')
+        {
+            continue;
+        }
+
+        const char* line = p_Request + i + 1;
+        bool isMatch = line[nameLength] == ':';
+        for (size_t c = 0; isMatch && c < nameLength; ++c)
+        {
+            isMatch = std::tolower((unsigned char)line[c]) == p_Name[c];
+        }
+        if (!isMatch)
+        {
+            continue;
+        }
+
+        const char* value = line + nameLength + 1;
+        const char* end = p_Request + p_Size;
+        while (value < end && *value == ' ')
+        {
+            ++value;
+        }
+        size_t length = 0;
+        while (value + length < end && value[length] != '\r' && value[length] != '\n')
+        {
+            ++length;
+        }
+        if (length >= p_ValueSize)
+        {
+            return false;
+        }
+        std::memcpy(p_Value, value, length);
+        p_Value[length] = '\0';
+        return true;
+    }
+    return false;
+}
+
+// Browsers send the page's origin with every WebSocket upgrade; only pages served from
+// this machine may read the feed. Clients that are not browsers send no origin at all.
+static bool IsLocalOrigin(std::string_view p_Origin)
+{
+    for (std::string_view scheme : { "http://", "https://" })
+    {
+        if (p_Origin.size() < scheme.size() || p_Origin.substr(0, scheme.size()) != scheme)
+        {
+            continue;
+        }
+
+        std::string_view host = p_Origin.substr(scheme.size());
+        if (host.empty())
+        {
+            return false;
+        }
+        size_t hostEnd = host[0] == '[' ? host.find(']') + 1 : host.find_first_of(":/");
+        host = host.substr(0, hostEnd);
+        return host == "127.0.0.1" || host == "[::1]" || (host.size() == 9 && _strnicmp(host.data(), "localhost", 9) == 0);
+    }
+    return false;
+}
+
+static void FormatString(char* p_Field, size_t p_Size, const char* p_Value)
+{
+    size_t o = 0;
+    p_Field[o++] = '"';
+    for (const char* c = p_Value; *c != '\0' && o + 3 < p_Size; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            p_Field[o++] = '\\';
+        }
+        p_Field[o++] = ((unsigned char)*c < 0x20) ? ' ' : *c;
+    }
+    p_Field[o++] = '"';
+    p_Field[o] = '\0';
+}
+
+static bool IsWouldBlock()
+{
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+// Server ----------------------------------------------------------------------
+
+OverlayServer::OverlayServer()
+    : m_ListenSocket(s_InvalidSocket),
+    m_Port(s_DefaultPort),
+    m_Status(),
+    m_StatusVersion(0),
+    m_SentVersion(0),
+    m_Fields(),
+    m_SentFields(),
+    m_IsRunning(false),
+    m_ClientCount(0),
+    m_SocketClientCount(0),
+    m_DeltaCount(0)
+{
+}
+
+OverlayServer::~OverlayServer()
+{
+    Stop();
+}
+
+std::string OverlayServer::GetError() const
+{
+    std::lock_guard<std::mutex> lock(m_ErrorMutex);
+    return m_Error;
+}
+
+void OverlayServer::SetError(const std::string& p_Error)
+{
+    std::lock_guard<std::mutex> lock(m_ErrorMutex);
+    m_Error = p_Error;
+}
+
+void OverlayServer::Update(const SharedStatusData& p_Status)
+{
+    std::lock_guard<std::mutex> lock(m_StatusMutex);
+    if (std::memcmp(&m_Status, &p_Status, sizeof(m_Status)) != 0)
+    {
+        m_Status = p_Status;
+        m_StatusVersion++;
+    }
+}
+
+bool OverlayServer::Start(int p_Port)
+{
+    if (m_IsRunning.load())
+    {
+        return false;
+    }
+
+    SetError("");
+
+    if (p_Port < 1 || p_Port > 65535)
+    {
+        SetError("The port must be between 1 and 65535.");
+        return false;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        SetError("Failed to initialise Winsock.");
+        return false;
+    }
+
+    SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket == INVALID_SOCKET)
+    {
+        SetError("Failed to create the listening socket.");
+        WSACleanup();
+        return false;
+    }
+
+    // Loopback only, and no other process may share the port
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((u_short)p_Port);
+
+    int isExclusive = 1;
+    u_long isNonBlocking = 1;
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, (const char*)&isExclusive, sizeof(isExclusive)) == SOCKET_ERROR ||
+        bind(listenSocket, (const sockaddr*)&address, sizeof(address)) == SOCKET_ERROR ||
+        listen(listenSocket, SOMAXCONN) == SOCKET_ERROR ||
+        ioctlsocket(listenSocket, FIONBIO, &isNonBlocking) == SOCKET_ERROR)
+    {
+        SetError("Failed to listen on port " + std::to_string(p_Port) + " (error " + std::to_string(WSAGetLastError()) + ").");
+        closesocket(listenSocket);
+        WSACleanup();
+        return false;
+    }
+
+    m_ListenSocket = (uintptr_t)listenSocket;
+    m_Port = p_Port;
+    m_Clients.assign(s_MaxClients, Client());
+    std::memset(m_Fields, 0, sizeof(m_Fields));
+    std::memset(m_SentFields, 0, sizeof(m_SentFields));
+    m_SentVersion = m_StatusVersion.load() - 1;     // the first loop formats whatever Update last gave
+    m_ClientCount.store(0);
+    m_SocketClientCount.store(0);
+    m_DeltaCount.store(0);
+
+    m_IsRunning.store(true);
+    m_Thread = std::thread(&OverlayServer::Run, this);
+    return true;
+}
+
+void OverlayServer::Stop()
+{
+    if (!m_IsRunning.exchange(false))
+    {
+        return;
+    }
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    for (Client& client : m_Clients)
+    {
+        if (client.m_Socket != s_InvalidSocket)
+        {
+            Disconnect(client);
+        }
+    }
+
+    closesocket((SOCKET)m_ListenSocket);
+    m_ListenSocket = s_InvalidSocket;
+    WSACleanup();
+}
+
+void OverlayServer::Run()
+{
+    WSAPOLLFD fds[s_MaxClients + 1];
+    Client* polled[s_MaxClients + 1];
+
+    while (m_IsRunning.load())
+    {
+        size_t count = 0;
+        fds[count] = { (SOCKET)m_ListenSocket, POLLRDNORM, 0 };
+        polled[count++] = nullptr;
+
+        for (Client& client : m_Clients)
+        {
+            if (client.m_Socket == s_InvalidSocket)
+            {
+                continue;
+            }
+
+            SHORT events = 0;
+            if (client.m_State != ClientState::Closing && client.m_ReceiveSize < s_ReceiveSize)
+            {
+                events |= POLLRDNORM;
+            }
+            if (client.m_SendSize > 0)
+            {
+                events |= POLLWRNORM;
+            }
+            fds[count] = { (SOCKET)client.m_Socket, events, 0 };
+            polled[count++] = &client;
+        }
+
+        if (WSAPoll(fds, (ULONG)count, s_PollMs) == SOCKET_ERROR)
+        {
+            SetError("Polling failed (error " + std::to_string(WSAGetLastError()) + ").");
+            break;
+        }
+
+        if (fds[0].revents & POLLRDNORM)
+        {
+            Accept();
+        }
+
+        for (size_t i = 1; i < count; ++i)
+        {
+            Client& client = *polled[i];
+            SHORT revents = fds[i].revents;
+
+            if (revents & POLLRDNORM)
+            {
+                Receive(client);
+            }
+            else if (revents & (POLLERR | POLLHUP | POLLNVAL))
+            {
+                Disconnect(client);
+                continue;
+            }
+
+            if (client.m_Socket != s_InvalidSocket && (revents & POLLWRNORM))
+            {
+                Flush(client);
+            }
+        }
+
+        Broadcast();
+    }
+}
+
+void OverlayServer::Accept()
+{
+    while (true)
+    {
+        SOCKET socket = accept((SOCKET)m_ListenSocket, nullptr, nullptr);
+        if (socket == INVALID_SOCKET)
+        {
+            return;
+        }
+
+        Client* slot = nullptr;
+        for (Client& client : m_Clients)
+        {
+            if (client.m_Socket == s_InvalidSocket)
+            {
+                slot = &client;
+                break;
+            }
+        }
+
+        int isNoDelay = 1;
+        u_long isNonBlocking = 1;
+        if (slot == nullptr || ioctlsocket(socket, FIONBIO, &isNonBlocking) == SOCKET_ERROR)
+        {
+            closesocket(socket);
+            continue;
+        }
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&isNoDelay, sizeof(isNoDelay));
+
+        slot->m_Socket = (uintptr_t)socket;
+        slot->m_State = ClientState::Http;
+        slot->m_ReceiveSize = 0;
+        slot->m_SendSize = 0;
+        slot->m_IsSnapshotPending = false;
+        m_ClientCount++;
+    }
+}
+
+void OverlayServer::Receive(Client& p_Client)
+{
+    int received = recv((SOCKET)p_Client.m_Socket, p_Client.m_Receive + p_Client.m_ReceiveSize,
+        (int)(s_ReceiveSize - p_Client.m_ReceiveSize), 0);
+    if (received == 0 || (received == SOCKET_ERROR && !IsWouldBlock()))
+    {
+        Disconnect(p_Client);
+        return;
+    }
+    if (received > 0)
+    {
+        p_Client.m_ReceiveSize += received;
+    }
+
+    if (p_Client.m_State == ClientState::Http)
+    {
+        const char* end = std::search(p_Client.m_Receive, p_Client.m_Receive + p_Client.m_ReceiveSize, "\r\n\r\n", "\r\n\r\n" + 4);
+        if (end != p_Client.m_Receive + p_Client.m_ReceiveSize)
+        {
+            HandleRequest(p_Client, end + 4 - p_Client.m_Receive);
+        }
+        else if (p_Client.m_ReceiveSize == s_ReceiveSize)
+        {
+            SendResponse(p_Client, "431 Request Header Fields Too Large", "text/plain", "", 0);
+        }
+    }
+    else if (p_Client.m_State == ClientState::WebSocket)
+    {
+        HandleFrames(p_Client);
+    }
+
+    if (p_Client.m_Socket != s_InvalidSocket)
+    {
+        Flush(p_Client);
+    }
+}
+
+void OverlayServer::HandleRequest(Client& p_Client, size_t p_HeaderSize)
+{
+    const char* request = p_Client.m_Receive;
+
+    // The receive buffer is not NUL-terminated, so the request line is parsed within the head
+    std::string_view head(request, p_HeaderSize);
+    std::string_view line = head.substr(0, head.find("\r\n"));
+    size_t pathEnd = line.find(' ', 4);
+    if (line.substr(0, 4) != "GET " || pathEnd == std::string_view::npos || line.substr(pathEnd + 1, 7) != "HTTP/1.")
+    {
+        SendResponse(p_Client, "405 Method Not Allowed", "text/plain", "", 0);
+        return;
+    }
+    std::string_view path = line.substr(4, pathEnd - 4);
+    path = path.substr(0, path.find('?'));
+
+    if (path == "/" || path == "/overlay")
+    {
+        SendResponse(p_Client, "200 OK", "text/html; charset=utf-8", s_OverlayPage, sizeof(s_OverlayPage) - 1);
+        return;
+    }
+
+    if (path == "/status.json")
+    {
+        size_t size = BuildJson(m_Snapshot, sizeof(m_Snapshot), false);
+        SendResponse(p_Client, "200 OK", "application/json", m_Snapshot, size);
+        return;
+    }
+
+    if (path != "/ws")
+    {
+        SendResponse(p_Client, "404 Not Found", "text/plain", "", 0);
+        return;
+    }
+
+    char key[64];
+    char upgrade[32];
+    if (!FindHeader(request, p_HeaderSize, "sec-websocket-key", key, sizeof(key)) ||
+        !FindHeader(request, p_HeaderSize, "upgrade", upgrade, sizeof(upgrade)) || _stricmp(upgrade, "websocket") != 0)
+    {
+        SendResponse(p_Client, "400 Bad Request", "text/plain", "", 0);
+        return;
+    }
+
+    // Sized to the whole head, so a present origin is always found
+    char origin[s_ReceiveSize];
+    if (FindHeader(request, p_HeaderSize, "origin", origin, sizeof(origin)) && !IsLocalOrigin(origin))
+    {
+        SendResponse(p_Client, "403 Forbidden", "text/plain", "", 0);
+        return;
+    }
+
+    // Sec-WebSocket-Accept is base64(SHA-1(key + GUID))
+    char handshake[128];
+    int handshakeSize = std::snprintf(handshake, sizeof(handshake), "%s%s", key, s_WebSocketGuid);
+    uint8_t digest[20];
+    Sha1::Hash((const uint8_t*)handshake, (size_t)handshakeSize, digest);
+    char accept[32];
+    EncodeBase64(digest, sizeof(digest), accept);
+
+    int responseSize = std::snprintf(p_Client.m_Send + p_Client.m_SendSize, s_SendSize - p_Client.m_SendSize,
+        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n", accept);
+    p_Client.m_SendSize += responseSize;
+
+    // Anything after the head is already the first frame
+    std::memmove(p_Client.m_Receive, p_Client.m_Receive + p_HeaderSize, p_Client.m_ReceiveSize - p_HeaderSize);
+    p_Client.m_ReceiveSize -= p_HeaderSize;
+    p_Client.m_State = ClientState::WebSocket;
+    p_Client.m_IsSnapshotPending = true;
+    m_SocketClientCount++;
+
+    HandleFrames(p_Client);
+}
+
+void OverlayServer::HandleFrames(Client& p_Client)
+{
+    size_t offset = 0;
+    while (p_Client.m_State == ClientState::WebSocket && p_Client.m_ReceiveSize - offset >= 2)
+    {
+        const uint8_t* frame = (const uint8_t*)p_Client.m_Receive + offset;
+        uint8_t opcode = frame[0] & 0x0F;
+        bool isMasked = (frame[1] & 0x80) != 0;
+        uint64_t length = frame[1] & 0x7F;
+        size_t headerSize = 2;
+
+        if (length == 126)
+        {
+            if (p_Client.m_ReceiveSize - offset < 4) break;
+            length = (uint64_t)frame[2] << 8 | frame[3];
+            headerSize = 4;
+        }
+        else if (length == 127)
+        {
+            // Overlays only ever send control frames, so a 64-bit length is never legitimate
+            length = s_ReceiveSize;
+        }
+
+        // Browsers must mask, and a frame that could never fit cannot be resynchronised
+        if (!isMasked || headerSize + 4 + length > s_ReceiveSize)
+        {
+            QueueFrame(p_Client, 0x8, "\x03\xF0", 2);   // 1008 policy violation
+            p_Client.m_State = ClientState::Closing;
+            break;
+        }
+        if (p_Client.m_ReceiveSize - offset < headerSize + 4 + length)
+        {
+            break;
+        }
+
+        char* payload = p_Client.m_Receive + offset + headerSize + 4;
+        const uint8_t* mask = frame + headerSize;
+        for (size_t i = 0; i < length; ++i)
+        {
+            payload[i] ^= mask[i & 3];
+        }
+
+        if (opcode == 0x8)
+        {
+            QueueFrame(p_Client, 0x8, payload, std::min<size_t>((size_t)length, 2));
+            p_Client.m_State = ClientState::Closing;
+        }
+        else if (opcode == 0x9)
+        {
+            QueueFrame(p_Client, 0xA, payload, (size_t)length);
+        }
+
+        offset += headerSize + 4 + (size_t)length;
+    }
+
+    if (p_Client.m_State == ClientState::Closing)
+    {
+        m_SocketClientCount--;
+        p_Client.m_ReceiveSize = 0;
+        return;
+    }
+
+    std::memmove(p_Client.m_Receive, p_Client.m_Receive + offset, p_Client.m_ReceiveSize - offset);
+    p_Client.m_ReceiveSize -= offset;
+}
+
+void OverlayServer::SendResponse(Client& p_Client, const char* p_Status, const char* p_ContentType, const char* p_Body, size_t p_BodySize)
+{
+    int headerSize = std::snprintf(p_Client.m_Send, s_SendSize,
+        "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nCache-Control: no-store\r\nConnection: close\r\n\r\n",
+        p_Status, p_ContentType, p_BodySize);
+
+    size_t bodySize = std::min(p_BodySize, s_SendSize - (size_t)headerSize);
+    std::memcpy(p_Client.m_Send + headerSize, p_Body, bodySize);
+    p_Client.m_SendSize = headerSize + bodySize;
+    p_Client.m_ReceiveSize = 0;
+    p_Client.m_State = ClientState::Closing;
+}
+
+bool OverlayServer::QueueFrame(Client& p_Client, uint8_t p_Opcode, const char* p_Data, size_t p_Size)
+{
+    size_t headerSize = (p_Size < 126) ? 2 : 4;
+    if (p_Size > 0xFFFF || s_SendSize - p_Client.m_SendSize < headerSize + p_Size)
+    {
+        return false;
+    }
+
+    uint8_t* data = (uint8_t*)p_Client.m_Send + p_Client.m_SendSize;
+    data[0] = 0x80 | p_Opcode;
+    if (p_Size < 126)
+    {
+        data[1] = (uint8_t)p_Size;
+    }
+    else
+    {
+        data[1] = 126;
+        data[2] = (uint8_t)(p_Size >> 8);
+        data[3] = (uint8_t)p_Size;
+    }
+    std::memcpy(data + headerSize, p_Data, p_Size);
+
+    p_Client.m_SendSize += headerSize + p_Size;
+    return true;
+}
+
+void OverlayServer::Broadcast()
+{
+    uint64_t version = m_StatusVersion.load();
+    bool hasChanged = version != m_SentVersion;
+    size_t deltaSize = 0;
+
+    if (hasChanged)
+    {
+        SharedStatusData status;
+        {
+            std::lock_guard<std::mutex> lock(m_StatusMutex);
+            status = m_Status;
+            version = m_StatusVersion.load();
+        }
+        m_SentVersion = version;
+
+        FormatFields(status);
+        deltaSize = BuildJson(m_Delta, sizeof(m_Delta), true);
+        hasChanged = deltaSize > 2;
+    }
+
+    // Formatted once, sent as the same bytes to every client
+    size_t snapshotSize = 0;
+    for (Client& client : m_Clients)
+    {
+        if (client.m_Socket == s_InvalidSocket || client.m_State != ClientState::WebSocket)
+        {
+            continue;
+        }
+
+        bool isQueued = false;
+        if (client.m_IsSnapshotPending)
+        {
+            if (snapshotSize == 0)
+            {
+                snapshotSize = BuildJson(m_Snapshot, sizeof(m_Snapshot), false);
+            }
+            isQueued = snapshotSize <= 2 || QueueFrame(client, 0x1, m_Snapshot, snapshotSize);
+            client.m_IsSnapshotPending = !isQueued;
+        }
+        else if (hasChanged)
+        {
+            // A delta this client cannot take now is folded into a full snapshot later
+            isQueued = QueueFrame(client, 0x1, m_Delta, deltaSize);
+            client.m_IsSnapshotPending = !isQueued;
+        }
+
+        if (isQueued)
+        {
+            Flush(client);
+        }
+    }
+
+    if (hasChanged)
+    {
+        std::memcpy(m_SentFields, m_Fields, sizeof(m_Fields));
+        m_DeltaCount++;
+    }
+}
+
+void OverlayServer::FormatFields(const SharedStatusData& p_Status)
+{
+    const char* const booleans[] = { "false", "true" };
+
+    std::snprintf(m_Fields[0], s_FieldSize, "%u", p_Status.m_Encounters);
+    std::snprintf(m_Fields[1], s_FieldSize, "%u", p_Status.m_EncountersPerReset);
+    std::snprintf(m_Fields[2], s_FieldSize, "%u", p_Status.m_Generation);
+    FormatString(m_Fields[3], s_FieldSize, p_Status.m_MethodName);
+    FormatString(m_Fields[4], s_FieldSize, p_Status.m_HuntName);
+    FormatString(m_Fields[5], s_FieldSize, p_Status.m_Target);
+    std::snprintf(m_Fields[6], s_FieldSize, "%u", p_Status.m_HuntId);
+    std::snprintf(m_Fields[7], s_FieldSize, "%.9g", p_Status.m_Probability);
+    std::snprintf(m_Fields[8], s_FieldSize, "%.6f", p_Status.m_CumulativeProbability);
+    std::snprintf(m_Fields[9], s_FieldSize, "%u", p_Status.m_EncountersFor90);
+    std::snprintf(m_Fields[10], s_FieldSize, "%.1f", p_Status.m_ResetsPerHour);
+    std::snprintf(m_Fields[11], s_FieldSize, "%.1f", p_Status.m_SessionResetsPerHour);
+    std::snprintf(m_Fields[12], s_FieldSize, "%.2f", p_Status.m_LastCycleSeconds);
+    std::snprintf(m_Fields[13], s_FieldSize, "%u", p_Status.m_PhaseCount);
+    std::snprintf(m_Fields[14], s_FieldSize, "%llu", (unsigned long long)p_Status.m_TotalAccepted);
+    std::snprintf(m_Fields[15], s_FieldSize, "%s", booleans[(p_Status.m_Flags & SharedStatusFrozen) != 0]);
+    std::snprintf(m_Fields[16], s_FieldSize, "%s", booleans[(p_Status.m_Flags & SharedStatusMacroRunning) != 0]);
+    std::snprintf(m_Fields[17], s_FieldSize, "%s", booleans[(p_Status.m_Flags & SharedStatusRecording) != 0]);
+    std::snprintf(m_Fields[18], s_FieldSize, "%s", booleans[(p_Status.m_Flags & SharedStatusControllerConnected) != 0]);
+    std::snprintf(m_Fields[19], s_FieldSize, "%s", booleans[(p_Status.m_Flags & SharedStatusStalled) != 0]);
+}
+
+size_t OverlayServer::BuildJson(char* p_Buffer, size_t p_Size, bool p_IsDelta)
+{
+    size_t size = 0;
+    p_Buffer[size++] = '{';
+
+    for (size_t i = 0; i < s_FieldCount; ++i)
+    {
+        if (m_Fields[i][0] == '\0' || (p_IsDelta && std::strcmp(m_Fields[i], m_SentFields[i]) == 0))
+        {
+            continue;
+        }
+
+        int written = std::snprintf(p_Buffer + size, p_Size - size, "%s\"%s\":%s", size > 1 ? "," : "", s_FieldNames[i], m_Fields[i]);
+        if (written < 0 || (size_t)written >= p_Size - size - 1)
+        {
+            break;
+        }
+        size += written;
+    }
+
+    p_Buffer[size++] = '}';
+    p_Buffer[size] = '\0';
+    return size;
+}
+
+void OverlayServer::Flush(Client& p_Client)
+{
+    if (p_Client.m_SendSize > 0)
+    {
+        int sent = send((SOCKET)p_Client.m_Socket, p_Client.m_Send, (int)p_Client.m_SendSize, 0);
+        if (sent == SOCKET_ERROR)
+        {
+            if (!IsWouldBlock())
+            {
+                Disconnect(p_Client);
+            }
+            return;
+        }
+
+        std::memmove(p_Client.m_Send, p_Client.m_Send + sent, p_Client.m_SendSize - sent);
+        p_Client.m_SendSize -= sent;
+    }
+
+    if (p_Client.m_SendSize == 0 && p_Client.m_State == ClientState::Closing)
+    {
+        Disconnect(p_Client);
+    }
+}
+
+void OverlayServer::Disconnect(Client& p_Client)
+{
+    if (p_Client.m_State == ClientState::WebSocket)
+    {
+        m_SocketClientCount--;
+    }
+
+    closesocket((SOCKET)p_Client.m_Socket);
+    p_Client.m_Socket = s_InvalidSocket;
+    p_Client.m_State = ClientState::Http;
+    p_Client.m_ReceiveSize = 0;
+    p_Client.m_SendSize = 0;
+    p_Client.m_IsSnapshotPending = false;
+    m_ClientCount--;
+}
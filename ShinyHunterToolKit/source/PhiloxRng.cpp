@@ -0,0 +1,88 @@
+#include <cmath>
+#include "../include/PhiloxRng.h"
+
+static const uint32_t s_PhiloxM0 = 0xD2511F53u;
+static const uint32_t s_PhiloxM1 = 0xCD9E8D57u;
+static const uint32_t s_PhiloxW0 = 0x9E3779B9u;
+static const uint32_t s_PhiloxW1 = 0xBB67AE85u;
+
+PhiloxRng::PhiloxRng(uint64_t p_Seed, uint64_t p_Stream)
+    : m_NextBlock(0), m_Used(4 * s_Lanes)
+{
+    m_Key[0] = (uint32_t)p_Seed;
+    m_Key[1] = (uint32_t)(p_Seed >> 32);
+    m_Stream[0] = (uint32_t)p_Stream;
+    m_Stream[1] = (uint32_t)(p_Stream >> 32);
+}
+
+void PhiloxRng::Refill()
+{
+    // Counter per lane: (block, 0, stream low, stream high)
+    uint32_t c0[s_Lanes], c1[s_Lanes], c2[s_Lanes], c3[s_Lanes];
+    for (size_t lane = 0; lane < s_Lanes; ++lane)
+    {
+        c0[lane] = m_NextBlock + (uint32_t)lane;
+        c1[lane] = 0;
+        c2[lane] = m_Stream[0];
+        c3[lane] = m_Stream[1];
+    }
+
+    uint32_t k0 = m_Key[0];
+    uint32_t k1 = m_Key[1];
+
+    for (int round = 0; round < 10; ++round)
+    {
+        for (size_t lane = 0; lane < s_Lanes; ++lane)
+        {
+            uint64_t product0 = (uint64_t)s_PhiloxM0 * c0[lane];
+            uint64_t product1 = (uint64_t)s_PhiloxM1 * c2[lane];
+
+            uint32_t next0 = (uint32_t)(product1 >> 32) ^ c1[lane] ^ k0;
+            uint32_t next1 = (uint32_t)product1;
+            uint32_t next2 = (uint32_t)(product0 >> 32) ^ c3[lane] ^ k1;
+            uint32_t next3 = (uint32_t)product0;
+
+            c0[lane] = next0;
+            c1[lane] = next1;
+            c2[lane] = next2;
+            c3[lane] = next3;
+        }
+
+        k0 += s_PhiloxW0;
+        k1 += s_PhiloxW1;
+    }
+
+    for (size_t lane = 0; lane < s_Lanes; ++lane)
+    {
+        m_Buffer[lane * 4 + 0] = c0[lane];
+        m_Buffer[lane * 4 + 1] = c1[lane];
+        m_Buffer[lane * 4 + 2] = c2[lane];
+        m_Buffer[lane * 4 + 3] = c3[lane];
+    }
+
+    m_NextBlock += (uint32_t)s_Lanes;
+    m_Used = 0;
+}
+
+uint32_t PhiloxRng::NextUInt32()
+{
+    if (m_Used == 4 * s_Lanes)
+    {
+        Refill();
+    }
+
+    return m_Buffer[m_Used++];
+}
+
+double PhiloxRng::NextUniform()
+{
+    return (NextUInt32() + 0.5) * (1.0 / 4294967296.0);
+}
+
+double PhiloxRng::NextNormal()
+{
+    // Box-Muller, one of the pair is discarded to keep the stream position simple
+    double u1 = NextUniform();
+    double u2 = NextUniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+}
@@ -2,6 +2,8 @@
 #include "../include/ViGEmManager.h"
 #include "../include/ShinyCounter.h"
 #include "../include/ImGuiApp.h"
+#include "../include/PreciseTimer.h"
+#include "../include/Logger.h"
 
 PhysicalControllerManager::PhysicalControllerManager(ViGEmManager& p_viGEmManager, ShinyCounter& p_ShinyCounter, ImGuiApp& p_ImGuiApp)
     : m_ViGEmManager(p_viGEmManager), 
@@ -10,6 +12,10 @@ PhysicalControllerManager::PhysicalControllerManager(ViGEmManager& p_viGEmManage
     m_IsControllerConnected(false),
     m_WasResetComboPressed(false),
     m_WasRecordComboPressed(false),
+    m_WasReplayComboPressed(false),
+    m_WasUndoComboPressed(false),
+    m_WasRedoComboPressed(false),
+    m_LastForwardedReport(),
     m_IsRepeatedThreadRunning(false),
 	m_IsMacroThreadRunning(false)
 {
@@ -25,6 +31,7 @@ PhysicalControllerManager::~PhysicalControllerManager()
     }
 
     StopUpdateThread();
+    StopMacroButtonSequence();
 }
 
 bool PhysicalControllerManager::Init()
@@ -50,10 +57,22 @@ void PhysicalControllerManager::StopUpdateThread()
 
 void PhysicalControllerManager::RunUpdateThread()
 {
+    // 1 ms polling feeds the replay buffer; XInput is slow to query for an absent pad,
+    // so fall back to the old rate while disconnected
+    PreciseTimer timer;
+    auto nextPoll = std::chrono::steady_clock::now();
+
     while (m_IsUpdateThreadRunning)
     {
         Update();
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        nextPoll += m_IsControllerConnected ? std::chrono::milliseconds(1) : std::chrono::milliseconds(100);
+        auto now = std::chrono::steady_clock::now();
+        if (nextPoll < now)
+        {
+            nextPoll = now;
+        }
+        PreciseTimer::SleepUntil(nextPoll, std::chrono::microseconds(0));
     }
 }
 
@@ -136,7 +155,7 @@ void PhysicalControllerManager::CheckResetCombo(const XINPUT_STATE& p_Controller
 
     if (m_WasResetComboPressed && !isResetComboPressed)
     {
-        m_ShinyCounter.Counter();
+        m_ShinyCounter.GetEncounterPipeline().Post(EncounterSource::ResetCombo);
     }
 
     m_WasResetComboPressed = isResetComboPressed;
@@ -158,7 +177,7 @@ void PhysicalControllerManager::HandleRepeatedThread()
             m_ImGuiApp.SetIsAutomaticButtonActived(true);
         }
 
-        std::cout << "Please press another button on the controller to initiate repeated presses:\n";
+        Logger::Info("Please press another button on the controller to initiate repeated presses:");
         std::thread waitForUserButtonPressThread(&PhysicalControllerManager::WaitForUserButtonPress, this);
         waitForUserButtonPressThread.detach();
 
@@ -167,7 +186,11 @@ void PhysicalControllerManager::HandleRepeatedThread()
 
 void PhysicalControllerManager::WaitForUserButtonPress()
 {
-    WORD repeatedButton = 0;
+    const WORD turboButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B | XINPUT_GAMEPAD_X | XINPUT_GAMEPAD_Y |
+        XINPUT_GAMEPAD_START | XINPUT_GAMEPAD_BACK |
+        XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_DPAD_LEFT | XINPUT_GAMEPAD_DPAD_RIGHT |
+        XINPUT_GAMEPAD_LEFT_SHOULDER | XINPUT_GAMEPAD_RIGHT_SHOULDER;
+    WORD repeatedButtons = 0;
     m_WaitingForUserInput.store(true);
     bool shouldExitEarly = false;
 
@@ -177,23 +200,17 @@ void PhysicalControllerManager::WaitForUserButtonPress()
         ZeroMemory(&newState, sizeof(XINPUT_STATE));
         if (XInputGetState(0, &newState) == ERROR_SUCCESS)
         {
-            WORD newButtonState = newState.Gamepad.wButtons;
-            if (newButtonState & XINPUT_GAMEPAD_A) repeatedButton = XUSB_GAMEPAD_A;
-            else if (newButtonState & XINPUT_GAMEPAD_B) repeatedButton = XUSB_GAMEPAD_B;
-            else if (newButtonState & XINPUT_GAMEPAD_X) repeatedButton = XUSB_GAMEPAD_X;
-            else if (newButtonState & XINPUT_GAMEPAD_Y) repeatedButton = XUSB_GAMEPAD_Y;
-            else if (newButtonState & XINPUT_GAMEPAD_START) repeatedButton = XUSB_GAMEPAD_START;
-            else if (newButtonState & XINPUT_GAMEPAD_BACK) repeatedButton = XUSB_GAMEPAD_BACK;
-            else if (newButtonState & XINPUT_GAMEPAD_DPAD_UP) repeatedButton = XUSB_GAMEPAD_DPAD_UP;
-            else if (newButtonState & XINPUT_GAMEPAD_DPAD_DOWN) repeatedButton = XUSB_GAMEPAD_DPAD_DOWN;
-            else if (newButtonState & XINPUT_GAMEPAD_DPAD_LEFT) repeatedButton = XUSB_GAMEPAD_DPAD_LEFT;
-            else if (newButtonState & XINPUT_GAMEPAD_DPAD_RIGHT) repeatedButton = XUSB_GAMEPAD_DPAD_RIGHT;
-            else if (newButtonState & XINPUT_GAMEPAD_LEFT_SHOULDER) repeatedButton = XUSB_GAMEPAD_LEFT_SHOULDER;
-            else if (newButtonState & XINPUT_GAMEPAD_RIGHT_SHOULDER) repeatedButton = XUSB_GAMEPAD_RIGHT_SHOULDER;
-
-            if (repeatedButton != 0)
+            // XINPUT and XUSB button masks share the same bit layout
+            WORD newButtonState = newState.Gamepad.wButtons & turboButtons;
+
+            // Collect every button held together so chords can be repeated, start once they are released
+            if (newButtonState != 0)
             {
-                StartRepeatedButtonPress(repeatedButton);
+                repeatedButtons |= newButtonState;
+            }
+            else if (repeatedButtons != 0)
+            {
+                StartRepeatedButtonPress(repeatedButtons);
                 break;
             }
         }
@@ -215,7 +232,7 @@ void PhysicalControllerManager::WaitForUserButtonPress()
         std::unique_lock<std::mutex> lock(m_Mutex);
         if (m_ExitCondition.wait_for(lock, std::chrono::milliseconds(100), [this] { return m_ShouldExit; }))
         {
-            std::cout << "Thread exit condition met\n";
+            Logger::Log(LogLevel::Debug, "Thread exit condition met");
             shouldExitEarly = true;
             break;
         }
@@ -236,8 +253,8 @@ void PhysicalControllerManager::StartRepeatedButtonPress(WORD p_RepeatedButton)
     m_RepeatedThread = std::thread(&ViGEmManager::PressUserButtonRepeatedly, &m_ViGEmManager, p_RepeatedButton);
     m_IsRepeatedThreadRunning.store(true);
 
-    std::cout << "\nRepeated " << m_ViGEmManager.GetButtonName(p_RepeatedButton) << " button press started." << std::endl;
-    std::cout << "\nHold the left trigger and right triggers for 2 seconds to stop." << std::endl;
+    Logger::Info("Repeated {} button press started.", m_ViGEmManager.GetChordName(p_RepeatedButton));
+    Logger::Info("Hold the left trigger and right triggers for 2 seconds to stop.");
 }
 
 void PhysicalControllerManager::StopRepeatedButtonPress()
@@ -249,7 +266,7 @@ void PhysicalControllerManager::StopRepeatedButtonPress()
     }
     m_IsRepeatedThreadRunning.store(false);
 
-    std::cout << "\nRepeated button press stopped." << std::endl;
+    Logger::Info("Repeated button press stopped.");
 }
 
 // Record Macro ----------------------------------------------------------------
@@ -318,7 +335,7 @@ void PhysicalControllerManager::HandleRecordMacroThread()
                 m_ImGuiApp.SetIsRecordMacroButtonActived(true);
             }
 
-            std::cout << "Please input your button sequence and press the GUI button or record combo when sequence is complete:\n";
+            Logger::Info("Please input your button sequence and press the GUI button or record combo when sequence is complete:");
             std::thread waitForUserButtonSequenceThread(&PhysicalControllerManager::WaitForUserButtonSequence, this);
             waitForUserButtonSequenceThread.detach();
         }
@@ -328,10 +345,22 @@ void PhysicalControllerManager::HandleRecordMacroThread()
 
 void PhysicalControllerManager::WaitForUserButtonSequence()
 {
-    m_ButtonSequence.clear();
+    // 1 ms polling so frame-quantised recordings capture every frame
+    PreciseTimer timer;
+
+    MacroTimebase timebase = m_ViGEmManager.GetMacroTimebase();
+    m_ButtonSequence.Clear();
+    m_ButtonSequence.m_Unit = timebase.m_Unit;
+    m_ButtonSequence.m_LoopGapTicks = (uint32_t)timebase.ToTicks(timebase.m_Unit, std::chrono::milliseconds(200));
+    m_ButtonSequence.m_PlaysOnce = false;
+
+    // Long captures go to disk block by block so memory stays flat and a crash loses at most one block
+    std::string recordingPath = GetRecordingPath();
+    bool isStreaming = !recordingPath.empty() && m_RecordingWriter.Open(recordingPath, m_ButtonSequence.m_Unit, m_ButtonSequence.m_LoopGapTicks);
 
     m_WaitingForUserInputSequence.store(true); // Set to true while waiting for user input
     auto startTime = std::chrono::steady_clock::now();
+    uint64_t lastEventTicks = 0;
     WORD lastButtons = 0;
     bool shouldExitEarly = false;
 
@@ -346,38 +375,40 @@ void PhysicalControllerManager::WaitForUserButtonSequence()
             // End button sequence recording when GUI button is pressed
             if (!m_ImGuiApp.m_IsRecordMacroButtonActivated)
             {
-                if (m_ButtonSequence.empty())
+                if (isStreaming ? m_RecordingWriter.GetEventCount() == 0 : m_ButtonSequence.IsEmpty())
                 {
-                    std::cout << "No button sequence recorded." << std::endl;
+                    Logger::Info("No button sequence recorded.");
                     break;
                 }
                 else
                 {
-                    std::cout << "Button sequence input complete." << std::endl;
+                    Logger::Info("Button sequence input complete.");
                     m_ImGuiApp.SetIsRecordMacroButtonActived(false);
                     break;
                 }
             }
 
-            // Calculate the time elapsed since the last button press
-            auto currentTime = std::chrono::steady_clock::now();
-            auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime);
-
             // Record button press and release events
             if (buttons != lastButtons)
             {
-                // Record button press
-                if (buttons != 0)
+                // Quantise the time since recording started, not since the last event,
+                // so rounding to whole ticks never accumulates
+                auto currentTime = std::chrono::steady_clock::now();
+                uint64_t eventTicks = timebase.ToTicks(m_ButtonSequence.m_Unit, currentTime - startTime);
+
+                MacroEvent event = {};
+                event.m_Ticks = (uint32_t)(eventTicks - lastEventTicks);
+                event.m_Report.wButtons = buttons;
+                if (isStreaming)
                 {
-                    m_ButtonSequence.emplace_back(buttons, elapsedTime);
+                    m_RecordingWriter.Append(event);
                 }
-                // Record button release
-                else if (lastButtons != 0)
+                else
                 {
-                    m_ButtonSequence.emplace_back(0, elapsedTime);
+                    m_ButtonSequence.m_Events.push_back(event);
                 }
 
-                startTime = currentTime;
+                lastEventTicks = eventTicks;
                 lastButtons = buttons;
             }
 
@@ -426,14 +457,17 @@ void PhysicalControllerManager::WaitForUserButtonSequence()
 
         // Periodically check if the thread should exit
         std::unique_lock<std::mutex> lock(m_Mutex);
-        if (m_ExitCondition.wait_for(lock, std::chrono::milliseconds(100), [this] { return m_ShouldExit; }))
+        if (m_ExitCondition.wait_for(lock, std::chrono::milliseconds(1), [this] { return m_ShouldExit; }))
         {
-            std::cout << "Thread exit condition met\n";
+            Logger::Log(LogLevel::Debug, "Thread exit condition met");
             shouldExitEarly = true;
             break;
         }
+    }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (isStreaming)
+    {
+        m_RecordingWriter.Finish();
     }
 
     m_WaitingForUserInputSequence.store(false);
@@ -444,6 +478,18 @@ void PhysicalControllerManager::WaitForUserButtonSequence()
     }
 }
 
+void PhysicalControllerManager::SetRecordingPath(const std::string& p_Path)
+{
+    std::lock_guard<std::mutex> lock(m_RecordingPathMutex);
+    m_RecordingPath = p_Path;
+}
+
+std::string PhysicalControllerManager::GetRecordingPath() const
+{
+    std::lock_guard<std::mutex> lock(m_RecordingPathMutex);
+    return m_RecordingPath;
+}
+
 // Playback Macro --------------------------------------------------------------
 
 // Check if the left thumbstick (L3) and right thumbstick (R3) are pressed
@@ -470,42 +516,133 @@ void PhysicalControllerManager::HandlePlaybackMacroThread()
 {
 	if (!m_WaitingForUserInputSequence.load())
 	{
+        // The GUI picks up the change itself, see ImGuiApp::SyncMacroPlayback
         if (m_IsMacroThreadRunning.load())
         {
             StopMacroButtonSequence();
-            m_ImGuiApp.HandleImGuiPlaybackThreadStop();
         }
         else
         {
-            if (!m_ImGuiApp.m_IsPlaybackMacroButtonActivated)
-            {
-                m_ImGuiApp.SetIsPlaybackMacroButtonActived(true);
-            }
-
             StartMacroButtonSequence(m_ButtonSequence);
         }
 	}
 }
 
-void PhysicalControllerManager::StartMacroButtonSequence(const std::vector<std::pair<WORD, std::chrono::milliseconds>>& buttonSequence)
+void PhysicalControllerManager::StartMacroButtonSequence(const Macro& p_Macro)
 {
-    m_MacroThread = std::thread(&ViGEmManager::PressUserMacroRepeatedly, &m_ViGEmManager, buttonSequence);
+    std::lock_guard<std::mutex> lock(m_MacroMutex);
+    if (m_IsMacroThreadRunning.load())
+    {
+        return;
+    }
+
+    // A halt, the end of a program that does not loop or a VM error returns on its own;
+    // the polling thread sees the flag and joins it
+    m_IsMacroThreadFinished.store(false);
+    m_MacroThread = std::thread([this, p_Macro]()
+        {
+            m_ViGEmManager.PressUserMacroRepeatedly(p_Macro);
+            m_IsMacroThreadFinished.store(true);
+        });
     m_IsMacroThreadRunning.store(true);
 
-    std::cout << "\nMacro button sequence started." << std::endl;
+    Logger::Info("Macro button sequence started.");
 }
 
 void PhysicalControllerManager::StopMacroButtonSequence()
 {
-    m_ViGEmManager.StopUserMacro();
-    if (m_MacroThread.joinable())
+    std::lock_guard<std::mutex> lock(m_MacroMutex);
+    StopMacroThread();
+}
+
+void PhysicalControllerManager::StopMacroThread()
+{
+    // Re-checked under the lock: another thread may have stopped it first
+    if (!m_MacroThread.joinable())
     {
-        m_MacroThread.join();
-        std::cout << "Macro thread joined\n";
+        return;
     }
+
+    m_ViGEmManager.StopUserMacro();
+    m_MacroThread.join();
+    Logger::Log(LogLevel::Debug, "Macro thread joined");
+    m_IsMacroThreadFinished.store(false);
     m_IsMacroThreadRunning.store(false);
+    m_MacroStopCount.fetch_add(1);
+
+    Logger::Info("Macro stopped.");
+}
+
+void PhysicalControllerManager::RequestMacroStart()
+{
+    m_IsMacroStartRequested.store(true);
+}
+
+void PhysicalControllerManager::RequestMacroStop()
+{
+    m_ViGEmManager.StopUserMacro();
+    m_IsMacroStopRequested.store(true);
+}
+
+void PhysicalControllerManager::UpdateMacroPlayback()
+{
+    if (m_IsMacroThreadFinished.load())
+    {
+        std::lock_guard<std::mutex> lock(m_MacroMutex);
+        if (m_IsMacroThreadFinished.load())
+        {
+            StopMacroThread();
+        }
+    }
+
+    if (m_IsMacroStopRequested.exchange(false))
+    {
+        m_IsMacroStartRequested.store(false);
+        StopMacroButtonSequence();
+    }
+    else if (m_IsMacroStartRequested.exchange(false) && m_IsControllerConnected && !m_WaitingForUserInputSequence.load() &&
+        !m_ButtonSequence.IsEmpty())
+    {
+        StartMacroButtonSequence(m_ButtonSequence);
+    }
+}
+
+// Instant Replay --------------------------------------------------------------
+
+void PhysicalControllerManager::CheckReplayCombo(const XINPUT_STATE& p_ControllerState)
+{
+    bool isReplayComboPressed = (p_ControllerState.Gamepad.wButtons & s_ReplayCombo) == s_ReplayCombo;
 
-    std::cout << "\nMacro stopped." << std::endl;
+    if (isReplayComboPressed && !m_WasReplayComboPressed)
+    {
+        m_IsReplayCutRequested.store(true);
+    }
+
+    m_WasReplayComboPressed = isReplayComboPressed;
+}
+
+// Counter Undo ----------------------------------------------------------------
+
+void PhysicalControllerManager::CheckUndoCombo(const XINPUT_STATE& p_ControllerState)
+{
+    // R3 as well would be the playback or replay combo
+    WORD buttons = p_ControllerState.Gamepad.wButtons;
+    bool isRightThumbPressed = (buttons & XINPUT_GAMEPAD_RIGHT_THUMB) != 0;
+    bool isUndoComboPressed = (buttons & s_UndoCombo) == s_UndoCombo && !isRightThumbPressed;
+    bool isRedoComboPressed = (buttons & s_RedoCombo) == s_RedoCombo && !isRightThumbPressed && !isUndoComboPressed;
+
+    HuntJournalEntry entry;
+    if (isUndoComboPressed && !m_WasUndoComboPressed)
+    {
+        m_ShinyCounter.GetEncounterPipeline().Undo(entry);
+    }
+    if (isRedoComboPressed && !m_WasRedoComboPressed)
+    {
+        m_ShinyCounter.GetEncounterPipeline().Redo(entry);
+    }
+
+    m_WasUndoComboPressed = isUndoComboPressed;
+    m_WasRedoComboPressed = isRedoComboPressed;
 }
 
 // Controller Updates ---------------------------------------------------------
@@ -515,20 +652,35 @@ void PhysicalControllerManager::CheckControllerInput(const XINPUT_STATE& p_Contr
     CheckResetCombo(p_ControllerState);
     CheckRecordCombo(p_ControllerState);
     CheckPlayCombo(p_ControllerState);
+    CheckReplayCombo(p_ControllerState);
+    CheckUndoCombo(p_ControllerState);
 }
 
 void PhysicalControllerManager::SendInputToVirtualController()
 {
     XUSB_REPORT report = m_ViGEmManager.ConvertToXUSBReport(m_ControllerState.Gamepad);
+
+    // Changes go straight through; an unchanged pad is only refreshed at the old 100 ms rate
+    auto now = std::chrono::steady_clock::now();
+    if (memcmp(&report, &m_LastForwardedReport, sizeof(report)) == 0 && now - m_LastForwardTime < std::chrono::milliseconds(100))
+    {
+        return;
+    }
+
     m_ViGEmManager.ReceiveInput(report);
+    m_LastForwardedReport = report;
+    m_LastForwardTime = now;
 }
 
 void PhysicalControllerManager::Update()
 {
     CheckPhysicalControllerState();
+    UpdateMacroPlayback();
 
     if (m_IsControllerConnected)
     {
+        m_ReplayBuffer.Push(std::chrono::steady_clock::now(), m_ViGEmManager.ConvertToXUSBReport(m_ControllerState.Gamepad));
+
         CheckControllerInput(m_ControllerState);
         if (m_ViGEmManager.IsVirtualControllerConnected())
         {
@@ -0,0 +1,63 @@
+#include <windows.h>
+#include <timeapi.h>
+#include <thread>
+#include "../include/PreciseTimer.h"
+
+#pragma comment(lib, "winmm.lib")
+
+PreciseTimer::PreciseTimer()
+{
+    timeBeginPeriod(1);
+}
+
+PreciseTimer::~PreciseTimer()
+{
+    timeEndPeriod(1);
+}
+
+void PreciseTimer::SleepUntil(std::chrono::steady_clock::time_point p_Deadline, std::chrono::microseconds p_SpinTail)
+{
+    // Coarse sleep in 1 ms steps until we are inside the spin window
+    while (true)
+    {
+        auto remaining = p_Deadline - std::chrono::steady_clock::now();
+        if (remaining <= p_SpinTail)
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Busy-wait the tail for sub-millisecond accuracy
+    while (std::chrono::steady_clock::now() < p_Deadline)
+    {
+        YieldProcessor();
+    }
+}
+
+bool PreciseTimer::SleepUntil(std::chrono::steady_clock::time_point p_Deadline, const std::atomic<bool>& p_Cancel, std::chrono::microseconds p_SpinTail)
+{
+    while (true)
+    {
+        if (p_Cancel.load())
+        {
+            return false;
+        }
+
+        auto remaining = p_Deadline - std::chrono::steady_clock::now();
+        if (remaining <= p_SpinTail)
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    while (std::chrono::steady_clock::now() < p_Deadline)
+    {
+        YieldProcessor();
+    }
+
+    return !p_Cancel.load();
+}
@@ -0,0 +1,596 @@
+#include <algorithm>
+#include <cstdlib>
+#include "../include/SeedSearch.h"
+#include "../include/Gen3RngSearch.h"
+#include "../include/Sha1.h"
+
+static const size_t s_SeedLanes = Sha1::s_Lanes;
+static const uint32_t s_MtOffset = 397;
+static const uint64_t s_Gen5Mult = 0x5D588B656C078965ull;
+static const uint64_t s_Gen5Add = 0x0000000000269EC3ull;
+
+static inline uint32_t SwapBytes(uint32_t p_Value)
+{
+    return (p_Value >> 24) | ((p_Value >> 8) & 0xFF00u) | ((p_Value << 8) & 0xFF0000u) | (p_Value << 24);
+}
+
+static inline int CountKeys(uint16_t p_Keys)
+{
+    int count = 0;
+    for (; p_Keys != 0; p_Keys &= p_Keys - 1)
+    {
+        ++count;
+    }
+    return count;
+}
+
+static inline uint32_t ToBcd(int p_Value)
+{
+    return (uint32_t)((p_Value / 10) << 4 | (p_Value % 10));
+}
+
+static inline bool IsShiny(uint32_t p_Pid, uint32_t p_Tsv)
+{
+    return ((p_Pid >> 16) ^ (p_Pid & 0xFFFF) ^ p_Tsv) < 8;
+}
+
+static int GetDayOfWeek(int p_Year, int p_Month, int p_Day)
+{
+    // Sakamoto's method, 0 = Sunday as the DS RTC stores it
+    static const int offsets[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+    int year = p_Month < 3 ? p_Year - 1 : p_Year;
+    return (year + year / 4 - year / 100 + year / 400 + offsets[(p_Month - 1) % 12] + p_Day) % 7;
+}
+
+static uint32_t GetHourCount(const SeedSearchSettings& p_Settings)
+{
+    return p_Settings.m_HourMax >= p_Settings.m_HourMin ? (uint32_t)(p_Settings.m_HourMax - p_Settings.m_HourMin + 1) : 0;
+}
+
+// Gen 4 -----------------------------------------------------------------------
+
+uint32_t SeedSearch::GetGen4Seed(int p_Year, int p_Month, int p_Day, int p_Hour, int p_Minute, int p_Second, uint32_t p_Delay)
+{
+    // AB CD EFGH: (month * day + minute + second), hour, delay + years since 2000
+    uint32_t ab = (uint32_t)(p_Month * p_Day + p_Minute + p_Second) & 0xFF;
+    return (ab << 24) + ((uint32_t)p_Hour << 16) + p_Delay + (uint32_t)(p_Year - 2000);
+}
+
+void SeedSearch::SearchGen4(const SeedSearchSettings& p_Settings, uint64_t p_Item, std::vector<SeedSearchTarget>& p_Targets)
+{
+    uint32_t hourCount = GetHourCount(p_Settings);
+    uint32_t ab = (uint32_t)(p_Item / hourCount);
+    int hour = p_Settings.m_HourMin + (int)(p_Item % hourCount);
+
+    // The top byte must be reachable as month * day + minute + second on the chosen date
+    uint32_t minuteSecond = (ab - (uint32_t)(p_Settings.m_Month * p_Settings.m_Day)) & 0xFF;
+    if (minuteSecond > 59 + 59)
+    {
+        return;
+    }
+
+    int second = (int)std::min<uint32_t>(minuteSecond, 59);
+    int minute = (int)minuteSecond - second;
+    uint32_t tsv = (uint32_t)(p_Settings.m_Tid ^ p_Settings.m_Sid);
+    uint32_t frameMin = std::max<uint32_t>(p_Settings.m_FrameMin, 1);
+    uint32_t frameMax = p_Settings.m_FrameMax;
+    bool isEgg = p_Settings.m_Gen4Method == Gen4SeedMethod::EggPid;
+    if (isEgg)
+    {
+        frameMax = std::min(frameMax, s_MaxGen4EggFrame);
+    }
+
+    // MT state words are only initialised as far as the last frame's twist needs
+    uint32_t mtWords = frameMax + s_MtOffset;
+    std::vector<uint32_t> mt(isEgg ? (size_t)mtWords * s_SeedLanes : 0);
+
+    for (uint32_t delay = p_Settings.m_DelayMin; delay <= p_Settings.m_DelayMax; delay += (uint32_t)s_SeedLanes)
+    {
+        uint32_t seeds[s_SeedLanes];
+        for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+        {
+            seeds[lane] = GetGen4Seed(p_Settings.m_Year, p_Settings.m_Month, p_Settings.m_Day, hour, minute, second, delay + (uint32_t)lane);
+        }
+
+        uint32_t lanesUsed = std::min<uint32_t>((uint32_t)s_SeedLanes, p_Settings.m_DelayMax - delay + 1);
+        auto addTarget = [&](size_t p_Lane, uint32_t p_Frame, uint32_t p_Pid)
+            {
+                if (p_Lane >= lanesUsed)
+                {
+                    return;
+                }
+                p_Targets.push_back({ seeds[p_Lane], p_Frame, p_Pid, hour, minute, second, delay + (uint32_t)p_Lane, 0, 0 });
+            };
+
+        if (isEgg)
+        {
+            uint32_t* state = mt.data();
+            for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+            {
+                state[lane] = seeds[lane];
+            }
+            for (uint32_t i = 1; i < mtWords; ++i)
+            {
+                const uint32_t* previous = state + (size_t)(i - 1) * s_SeedLanes;
+                uint32_t* current = state + (size_t)i * s_SeedLanes;
+                for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+                {
+                    current[lane] = 1812433253u * (previous[lane] ^ (previous[lane] >> 30)) + i;
+                }
+            }
+
+            // Output k only needs words k, k + 1 and k + 397 of the untwisted state
+            for (uint32_t frame = frameMin; frame <= frameMax; ++frame)
+            {
+                const uint32_t* word = state + (size_t)(frame - 1) * s_SeedLanes;
+                const uint32_t* nextWord = word + s_SeedLanes;
+                const uint32_t* farWord = state + (size_t)(frame - 1 + s_MtOffset) * s_SeedLanes;
+
+                uint32_t shinyMask = 0;
+                uint32_t pids[s_SeedLanes];
+                for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+                {
+                    uint32_t y = (word[lane] & 0x80000000u) | (nextWord[lane] & 0x7FFFFFFFu);
+                    y = farWord[lane] ^ (y >> 1) ^ ((y & 1) ? 0x9908B0DFu : 0u);
+                    y ^= y >> 11;
+                    y ^= (y << 7) & 0x9D2C5680u;
+                    y ^= (y << 15) & 0xEFC60000u;
+                    y ^= y >> 18;
+
+                    pids[lane] = y;
+                    shinyMask |= (uint32_t)IsShiny(y, tsv) << lane;
+                }
+
+                for (size_t lane = 0; shinyMask != 0; ++lane, shinyMask >>= 1)
+                {
+                    if (shinyMask & 1)
+                    {
+                        addTarget(lane, frame, pids[lane]);
+                    }
+                }
+            }
+        }
+        else
+        {
+            uint32_t states[s_SeedLanes];
+            for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+            {
+                states[lane] = Gen3Lcrng::Jump(seeds[lane], frameMin - 1);
+            }
+
+            for (uint32_t frame = frameMin; frame <= frameMax; ++frame)
+            {
+                uint32_t shinyMask = 0;
+                uint32_t pids[s_SeedLanes];
+                for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+                {
+                    uint32_t low = Gen3Lcrng::Next(states[lane]);
+                    uint32_t high = Gen3Lcrng::Next(low);
+                    pids[lane] = (high & 0xFFFF0000u) | (low >> 16);
+                    shinyMask |= (uint32_t)IsShiny(pids[lane], tsv) << lane;
+                    states[lane] = low;
+                }
+
+                for (size_t lane = 0; shinyMask != 0; ++lane, shinyMask >>= 1)
+                {
+                    if (shinyMask & 1)
+                    {
+                        addTarget(lane, frame, pids[lane]);
+                    }
+                }
+            }
+        }
+
+        if (p_Settings.m_DelayMax - delay < s_SeedLanes)
+        {
+            break;
+        }
+    }
+}
+
+// Gen 5 -----------------------------------------------------------------------
+
+static void FillGen5Message(const SeedSearchSettings& p_Settings, uint16_t p_Timer0, uint16_t p_Keys, uint32_t p_Message[16])
+{
+    const Gen5Profile& profile = p_Settings.m_Profile;
+
+    for (int i = 0; i < 5; ++i)
+    {
+        p_Message[i] = SwapBytes(profile.m_Nazo[i]);
+    }
+    p_Message[5] = SwapBytes((uint32_t)profile.m_VCount << 16 | p_Timer0);
+    p_Message[6] = (uint32_t)(p_Settings.m_Mac & 0xFFFF);
+    p_Message[7] = (uint32_t)(p_Settings.m_Mac >> 16) ^ ((uint32_t)profile.m_VFrame << 24) ^ profile.m_GxStat;
+    p_Message[8] = ToBcd(p_Settings.m_Year % 100) << 24 | ToBcd(p_Settings.m_Month) << 16 | ToBcd(p_Settings.m_Day) << 8 |
+        (uint32_t)GetDayOfWeek(p_Settings.m_Year, p_Settings.m_Month, p_Settings.m_Day);
+    p_Message[9] = 0;
+    p_Message[10] = 0;
+    p_Message[11] = 0;
+    p_Message[12] = SwapBytes(0x2FFFu ^ p_Keys);
+    p_Message[13] = 0x80000000u;
+    p_Message[14] = 0;
+    p_Message[15] = 0x000001A0u;
+}
+
+static uint32_t GetGen5TimeWord(bool p_Is3ds, int p_Hour, int p_Minute, int p_Second)
+{
+    // DS consoles flag afternoon hours in the RTC hour byte, the 3DS does not
+    uint32_t hour = ToBcd(p_Hour) + (p_Hour >= 12 && !p_Is3ds ? 0x40u : 0u);
+    return hour << 24 | ToBcd(p_Minute) << 16 | ToBcd(p_Second) << 8;
+}
+
+static uint64_t GetGen5SeedFromDigest(uint32_t p_H0, uint32_t p_H1)
+{
+    return (uint64_t)SwapBytes(p_H1) << 32 | SwapBytes(p_H0);
+}
+
+uint64_t SeedSearch::GetGen5Seed(const SeedSearchSettings& p_Settings, uint16_t p_Timer0, uint16_t p_Keys, int p_Hour, int p_Minute, int p_Second)
+{
+    uint32_t message[16];
+    FillGen5Message(p_Settings, p_Timer0, p_Keys, message);
+    message[9] = GetGen5TimeWord(p_Settings.m_Profile.m_Is3ds, p_Hour, p_Minute, p_Second);
+
+    uint32_t words[16][Sha1::s_Lanes];
+    for (int i = 0; i < 16; ++i)
+    {
+        std::fill(words[i], words[i] + Sha1::s_Lanes, message[i]);
+    }
+
+    uint32_t digest[5][Sha1::s_Lanes];
+    Sha1::HashBlockLanes(words, digest);
+    return GetGen5SeedFromDigest(digest[0][0], digest[1][0]);
+}
+
+std::vector<uint16_t> SeedSearch::GetGen5KeyCombinations(uint16_t p_AllowedKeys, int p_MaxKeys)
+{
+    std::vector<uint16_t> combinations;
+    const uint16_t softReset = GEN5_KEY_L | GEN5_KEY_R | GEN5_KEY_START | GEN5_KEY_SELECT;
+
+    for (uint32_t keys = 0; keys < 0x1000; ++keys)
+    {
+        if ((keys & ~(uint32_t)p_AllowedKeys) != 0)
+        {
+            continue;
+        }
+
+        int count = 0;
+        for (uint32_t bits = keys; bits != 0; bits &= bits - 1)
+        {
+            ++count;
+        }
+
+        // Opposite directions cannot be held together and the reset combination reboots
+        bool isPossible = !((keys & GEN5_KEY_UP) && (keys & GEN5_KEY_DOWN)) && !((keys & GEN5_KEY_LEFT) && (keys & GEN5_KEY_RIGHT)) &&
+            (keys & softReset) != softReset;
+
+        if (count <= p_MaxKeys && isPossible)
+        {
+            combinations.push_back((uint16_t)keys);
+        }
+    }
+
+    return combinations;
+}
+
+std::string SeedSearch::GetGen5KeyName(uint16_t p_Keys)
+{
+    static const char* names[12] = { "A", "B", "Select", "Start", "Right", "Left", "Up", "Down", "R", "L", "X", "Y" };
+
+    std::string name;
+    for (int bit = 0; bit < 12; ++bit)
+    {
+        if (p_Keys & (1 << bit))
+        {
+            name += name.empty() ? names[bit] : std::string(" + ") + names[bit];
+        }
+    }
+    return name.empty() ? "None" : name;
+}
+
+void SeedSearch::SearchGen5(const SeedSearchSettings& p_Settings, const std::vector<uint16_t>& p_KeyCombinations, uint64_t p_Item, std::vector<SeedSearchTarget>& p_Targets)
+{
+    uint32_t hourCount = GetHourCount(p_Settings);
+    uint64_t keyCount = p_KeyCombinations.size();
+
+    int hour = p_Settings.m_HourMin + (int)(p_Item % hourCount);
+    uint16_t keys = p_KeyCombinations[(size_t)((p_Item / hourCount) % keyCount)];
+    uint16_t timer0 = (uint16_t)(p_Settings.m_Profile.m_Timer0Min + p_Item / hourCount / keyCount);
+
+    uint32_t tsv = (uint32_t)(p_Settings.m_Tid ^ p_Settings.m_Sid);
+    uint32_t frameMin = std::max<uint32_t>(p_Settings.m_FrameMin, 1);
+
+    uint32_t message[16];
+    FillGen5Message(p_Settings, timer0, keys, message);
+
+    uint32_t words[16][Sha1::s_Lanes];
+    for (int i = 0; i < 16; ++i)
+    {
+        std::fill(words[i], words[i] + Sha1::s_Lanes, message[i]);
+    }
+
+    // Eight consecutive seconds of the hour per SHA-1 batch; only the time word differs
+    for (int firstSecond = 0; firstSecond < 3600; firstSecond += (int)s_SeedLanes)
+    {
+        for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+        {
+            int secondOfHour = firstSecond + (int)lane;
+            words[9][lane] = GetGen5TimeWord(p_Settings.m_Profile.m_Is3ds, hour, secondOfHour / 60, secondOfHour % 60);
+        }
+
+        uint32_t digest[5][Sha1::s_Lanes];
+        Sha1::HashBlockLanes(words, digest);
+
+        uint64_t states[s_SeedLanes];
+        uint64_t seeds[s_SeedLanes];
+        for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+        {
+            seeds[lane] = GetGen5SeedFromDigest(digest[0][lane], digest[1][lane]);
+            states[lane] = seeds[lane];
+            for (uint32_t frame = 1; frame < frameMin; ++frame)
+            {
+                states[lane] = states[lane] * s_Gen5Mult + s_Gen5Add;
+            }
+        }
+
+        for (uint32_t frame = frameMin; frame <= p_Settings.m_FrameMax; ++frame)
+        {
+            uint32_t shinyMask = 0;
+            uint32_t pids[s_SeedLanes];
+            for (size_t lane = 0; lane < s_SeedLanes; ++lane)
+            {
+                states[lane] = states[lane] * s_Gen5Mult + s_Gen5Add;
+                pids[lane] = (uint32_t)(states[lane] >> 32) ^ 0x10000u;
+                shinyMask |= (uint32_t)IsShiny(pids[lane], tsv) << lane;
+            }
+
+            for (size_t lane = 0; shinyMask != 0; ++lane, shinyMask >>= 1)
+            {
+                if (shinyMask & 1)
+                {
+                    int secondOfHour = firstSecond + (int)lane;
+                    p_Targets.push_back({ seeds[lane], frame, pids[lane], hour, secondOfHour / 60, secondOfHour % 60, 0, timer0, keys });
+                }
+            }
+        }
+    }
+}
+
+// Search ----------------------------------------------------------------------
+
+uint64_t SeedSearch::GetWorkItemCount(const SeedSearchSettings& p_Settings)
+{
+    uint64_t hourCount = GetHourCount(p_Settings);
+    if (p_Settings.m_Generation == 4)
+    {
+        return p_Settings.m_DelayMax >= p_Settings.m_DelayMin ? 256 * hourCount : 0;
+    }
+
+    const Gen5Profile& profile = p_Settings.m_Profile;
+    uint64_t timer0Count = profile.m_Timer0Max >= profile.m_Timer0Min ? (uint64_t)profile.m_Timer0Max - profile.m_Timer0Min + 1 : 0;
+    return timer0Count * GetGen5KeyCombinations(p_Settings.m_AllowedKeys, p_Settings.m_MaxKeys).size() * hourCount;
+}
+
+std::vector<SeedSearchTarget> SeedSearch::Search(const SeedSearchSettings& p_Settings, unsigned p_ThreadCount, const std::atomic<bool>& p_Cancel, std::atomic<uint64_t>& p_ItemsDone)
+{
+    std::vector<SeedSearchTarget> targets;
+    uint64_t itemCount = GetWorkItemCount(p_Settings);
+    if (itemCount == 0 || p_Settings.m_FrameMax < p_Settings.m_FrameMin)
+    {
+        return targets;
+    }
+
+    std::vector<uint16_t> keyCombinations = GetGen5KeyCombinations(p_Settings.m_AllowedKeys, p_Settings.m_MaxKeys);
+    unsigned threadCount = p_ThreadCount > 0 ? p_ThreadCount : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (unsigned)std::min<uint64_t>(threadCount, itemCount);
+
+    // Work items are an hour of one (top byte) for Gen 4 or one (timer0, keys) for Gen 5
+    std::atomic<uint64_t> nextItem(0);
+    std::vector<std::vector<SeedSearchTarget>> workerTargets(threadCount);
+
+    auto worker = [&](unsigned p_Worker)
+        {
+            while (!p_Cancel.load())
+            {
+                uint64_t item = nextItem.fetch_add(1);
+                if (item >= itemCount)
+                {
+                    break;
+                }
+
+                if (p_Settings.m_Generation == 4)
+                {
+                    SearchGen4(p_Settings, item, workerTargets[p_Worker]);
+                }
+                else
+                {
+                    SearchGen5(p_Settings, keyCombinations, item, workerTargets[p_Worker]);
+                }
+                ++p_ItemsDone;
+            }
+        };
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < threadCount; ++w)
+    {
+        threads.emplace_back(worker, w);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const std::vector<SeedSearchTarget>& found : workerTargets)
+    {
+        targets.insert(targets.end(), found.begin(), found.end());
+    }
+
+    // Earliest frame first, then whatever makes the target easiest to hit: for Gen 4 the delay
+    // closest to what the user can hit reliably, for Gen 5 the fewest keys to hold through boot
+    // and then the earliest second of the day (Timer0 is up to the console, so it never ranks)
+    uint32_t preferredDelay = p_Settings.m_PreferredDelay;
+    bool isGen5 = p_Settings.m_Generation != 4;
+    std::sort(targets.begin(), targets.end(), [preferredDelay, isGen5](const SeedSearchTarget& a, const SeedSearchTarget& b)
+        {
+            if (a.m_Frame != b.m_Frame)
+            {
+                return a.m_Frame < b.m_Frame;
+            }
+
+            int64_t rankA, rankB;
+            if (isGen5)
+            {
+                int keysA = CountKeys(a.m_Keys);
+                int keysB = CountKeys(b.m_Keys);
+                if (keysA != keysB)
+                {
+                    return keysA < keysB;
+                }
+                rankA = a.m_Hour * 3600 + a.m_Minute * 60 + a.m_Second;
+                rankB = b.m_Hour * 3600 + b.m_Minute * 60 + b.m_Second;
+            }
+            else
+            {
+                rankA = std::llabs((int64_t)a.m_Delay - preferredDelay);
+                rankB = std::llabs((int64_t)b.m_Delay - preferredDelay);
+            }
+            return rankA != rankB ? rankA < rankB : a.m_Seed < b.m_Seed;
+        });
+
+    if (targets.size() > p_Settings.m_MaxResults)
+    {
+        targets.resize(p_Settings.m_MaxResults);
+    }
+
+    return targets;
+}
+
+SeedSearch::SeedSearch()
+    : m_IsRunning(false), m_StopSearch(false), m_ItemsDone(0), m_ItemsTotal(0)
+{
+}
+
+SeedSearch::~SeedSearch()
+{
+    Stop();
+}
+
+bool SeedSearch::Start(const SeedSearchSettings& p_Settings, unsigned p_ThreadCount)
+{
+    if (m_IsRunning.load())
+    {
+        return false;
+    }
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    m_ItemsTotal = GetWorkItemCount(p_Settings);
+    m_StopSearch = false;
+    m_ItemsDone = 0;
+    m_IsRunning = true;
+    m_Thread = std::thread(&SeedSearch::RunSearch, this, p_Settings, p_ThreadCount);
+    return true;
+}
+
+void SeedSearch::Stop()
+{
+    m_StopSearch = true;
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+}
+
+double SeedSearch::GetProgress() const
+{
+    return m_ItemsTotal > 0 ? (double)m_ItemsDone.load() / m_ItemsTotal : 0.0;
+}
+
+std::vector<SeedSearchTarget> SeedSearch::GetResults() const
+{
+    std::lock_guard<std::mutex> lock(m_ResultsMutex);
+    return m_Results;
+}
+
+void SeedSearch::RunSearch(SeedSearchSettings p_Settings, unsigned p_ThreadCount)
+{
+    std::vector<SeedSearchTarget> targets = Search(p_Settings, p_ThreadCount, m_StopSearch, m_ItemsDone);
+
+    if (!m_StopSearch.load())
+    {
+        std::lock_guard<std::mutex> lock(m_ResultsMutex);
+        m_Results = targets;
+    }
+
+    m_IsRunning = false;
+}
+
+// Macro export ----------------------------------------------------------------
+
+static WORD GetGen5KeyButtons(uint16_t p_Keys)
+{
+    static const WORD buttons[12] =
+    {
+        XUSB_GAMEPAD_A, XUSB_GAMEPAD_B, XUSB_GAMEPAD_BACK, XUSB_GAMEPAD_START,
+        XUSB_GAMEPAD_DPAD_RIGHT, XUSB_GAMEPAD_DPAD_LEFT, XUSB_GAMEPAD_DPAD_UP, XUSB_GAMEPAD_DPAD_DOWN,
+        XUSB_GAMEPAD_RIGHT_SHOULDER, XUSB_GAMEPAD_LEFT_SHOULDER, XUSB_GAMEPAD_X, XUSB_GAMEPAD_Y
+    };
+
+    WORD result = 0;
+    for (int bit = 0; bit < 12; ++bit)
+    {
+        if (p_Keys & (1 << bit))
+        {
+            result |= buttons[bit];
+        }
+    }
+    return result;
+}
+
+Macro SeedSearch::ExportTargetToMacro(const SeedSearchTarget& p_Target, int p_Generation, int p_FrameOffset, uint32_t p_LoopGapFrames)
+{
+    const uint32_t holdFrames = 3;
+    const WORD softReset = XUSB_GAMEPAD_LEFT_SHOULDER | XUSB_GAMEPAD_RIGHT_SHOULDER | XUSB_GAMEPAD_START | XUSB_GAMEPAD_BACK;
+
+    Macro macro;
+    macro.m_Unit = MacroTimeUnit::Frames;
+    macro.m_LoopGapTicks = p_LoopGapFrames;
+
+    MacroEvent event = {};
+    event.m_Ticks = 0;
+    event.m_Report.wButtons = softReset;
+    macro.m_Events.push_back(event);
+
+    if (p_Generation == 4)
+    {
+        event.m_Ticks = holdFrames;
+        event.m_Report.wButtons = 0;
+        macro.m_Events.push_back(event);
+
+        int64_t delay = (int64_t)p_Target.m_Delay + p_FrameOffset;
+        event.m_Ticks = (uint32_t)std::max<int64_t>(delay, 1);
+        event.m_Report.wButtons = XUSB_GAMEPAD_A;
+        macro.m_Events.push_back(event);
+
+        event.m_Ticks = holdFrames;
+    }
+    else
+    {
+        // The keys replace the reset combination as it is released and stay held through boot.
+        // The seed includes the clock's second, so there is one attempt per start.
+        event.m_Ticks = holdFrames;
+        event.m_Report.wButtons = GetGen5KeyButtons(p_Target.m_Keys);
+        macro.m_Events.push_back(event);
+
+        event.m_Ticks = (uint32_t)std::max(p_FrameOffset, 1);
+        macro.m_LoopGapTicks = 0;
+        macro.m_PlaysOnce = true;
+    }
+
+    event.m_Report.wButtons = 0;
+    macro.m_Events.push_back(event);
+
+    return macro;
+}
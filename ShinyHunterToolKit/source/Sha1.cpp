@@ -0,0 +1,193 @@
+#include <cstring>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "../include/Sha1.h"
+
+static const uint32_t s_InitialState[5] = { 0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u };
+
+static inline uint32_t RotateLeft(uint32_t p_Value, int p_Bits)
+{
+    return (p_Value << p_Bits) | (p_Value >> (32 - p_Bits));
+}
+
+static inline uint32_t RoundFunction(int p_Round, uint32_t b, uint32_t c, uint32_t d)
+{
+    if (p_Round < 20)
+    {
+        return ((b & c) | (~b & d)) + 0x5A827999u;
+    }
+    if (p_Round < 40)
+    {
+        return (b ^ c ^ d) + 0x6ED9EBA1u;
+    }
+    if (p_Round < 60)
+    {
+        return ((b & c) | (b & d) | (c & d)) + 0x8F1BBCDCu;
+    }
+    return (b ^ c ^ d) + 0xCA62C1D6u;
+}
+
+void Sha1::Compress(uint32_t p_State[5], const uint8_t p_Block[64])
+{
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i)
+    {
+        w[i] = (uint32_t)p_Block[i * 4] << 24 | (uint32_t)p_Block[i * 4 + 1] << 16 | (uint32_t)p_Block[i * 4 + 2] << 8 | p_Block[i * 4 + 3];
+    }
+    for (int i = 16; i < 80; ++i)
+    {
+        w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = p_State[0], b = p_State[1], c = p_State[2], d = p_State[3], e = p_State[4];
+    for (int i = 0; i < 80; ++i)
+    {
+        uint32_t temp = RotateLeft(a, 5) + RoundFunction(i, b, c, d) + e + w[i];
+        e = d;
+        d = c;
+        c = RotateLeft(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    p_State[0] += a;
+    p_State[1] += b;
+    p_State[2] += c;
+    p_State[3] += d;
+    p_State[4] += e;
+}
+
+void Sha1::Hash(const uint8_t* p_Data, size_t p_Size, uint8_t p_Digest[20])
+{
+    uint32_t state[5];
+    memcpy(state, s_InitialState, sizeof(state));
+
+    size_t offset = 0;
+    for (; offset + 64 <= p_Size; offset += 64)
+    {
+        Compress(state, p_Data + offset);
+    }
+
+    // Remaining bytes, the 0x80 terminator and the big-endian bit length
+    uint8_t tail[128] = {};
+    size_t remaining = p_Size - offset;
+    memcpy(tail, p_Data + offset, remaining);
+    tail[remaining] = 0x80;
+
+    size_t tailSize = remaining + 9 <= 64 ? 64 : 128;
+    uint64_t bitLength = (uint64_t)p_Size * 8;
+    for (int i = 0; i < 8; ++i)
+    {
+        tail[tailSize - 1 - i] = (uint8_t)(bitLength >> (i * 8));
+    }
+
+    for (size_t block = 0; block < tailSize; block += 64)
+    {
+        Compress(state, tail + block);
+    }
+
+    for (int i = 0; i < 5; ++i)
+    {
+        p_Digest[i * 4] = (uint8_t)(state[i] >> 24);
+        p_Digest[i * 4 + 1] = (uint8_t)(state[i] >> 16);
+        p_Digest[i * 4 + 2] = (uint8_t)(state[i] >> 8);
+        p_Digest[i * 4 + 3] = (uint8_t)state[i];
+    }
+}
+
+#if defined(_M_X64) || defined(__SSE2__)
+
+// SSE2 holds four lanes per register, so the eight lanes run as two interleaved groups
+static inline __m128i RotateLeft(__m128i p_Value, int p_Bits)
+{
+    return _mm_or_si128(_mm_slli_epi32(p_Value, p_Bits), _mm_srli_epi32(p_Value, 32 - p_Bits));
+}
+
+void Sha1::HashBlockLanes(const uint32_t p_Words[16][s_Lanes], uint32_t p_Digest[5][s_Lanes])
+{
+    const int groups = (int)(s_Lanes / 4);
+
+    for (int group = 0; group < groups; ++group)
+    {
+        __m128i w[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = _mm_loadu_si128((const __m128i*)&p_Words[i][group * 4]);
+        }
+
+        __m128i a = _mm_set1_epi32((int)s_InitialState[0]);
+        __m128i b = _mm_set1_epi32((int)s_InitialState[1]);
+        __m128i c = _mm_set1_epi32((int)s_InitialState[2]);
+        __m128i d = _mm_set1_epi32((int)s_InitialState[3]);
+        __m128i e = _mm_set1_epi32((int)s_InitialState[4]);
+
+        for (int i = 0; i < 80; ++i)
+        {
+            if (i >= 16)
+            {
+                w[i & 15] = RotateLeft(_mm_xor_si128(_mm_xor_si128(w[(i - 3) & 15], w[(i - 8) & 15]), _mm_xor_si128(w[(i - 14) & 15], w[i & 15])), 1);
+            }
+
+            __m128i function;
+            if (i < 20)
+            {
+                function = _mm_add_epi32(_mm_or_si128(_mm_and_si128(b, c), _mm_andnot_si128(b, d)), _mm_set1_epi32(0x5A827999));
+            }
+            else if (i < 40)
+            {
+                function = _mm_add_epi32(_mm_xor_si128(_mm_xor_si128(b, c), d), _mm_set1_epi32(0x6ED9EBA1));
+            }
+            else if (i < 60)
+            {
+                function = _mm_add_epi32(_mm_or_si128(_mm_and_si128(b, c), _mm_and_si128(d, _mm_or_si128(b, c))), _mm_set1_epi32((int)0x8F1BBCDC));
+            }
+            else
+            {
+                function = _mm_add_epi32(_mm_xor_si128(_mm_xor_si128(b, c), d), _mm_set1_epi32((int)0xCA62C1D6));
+            }
+
+            __m128i temp = _mm_add_epi32(_mm_add_epi32(RotateLeft(a, 5), function), _mm_add_epi32(e, w[i & 15]));
+            e = d;
+            d = c;
+            c = RotateLeft(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        __m128i result[5] = { a, b, c, d, e };
+        for (int i = 0; i < 5; ++i)
+        {
+            result[i] = _mm_add_epi32(result[i], _mm_set1_epi32((int)s_InitialState[i]));
+            _mm_storeu_si128((__m128i*)&p_Digest[i][group * 4], result[i]);
+        }
+    }
+}
+
+#else
+
+void Sha1::HashBlockLanes(const uint32_t p_Words[16][s_Lanes], uint32_t p_Digest[5][s_Lanes])
+{
+    for (size_t lane = 0; lane < s_Lanes; ++lane)
+    {
+        uint8_t block[64];
+        for (int i = 0; i < 16; ++i)
+        {
+            block[i * 4] = (uint8_t)(p_Words[i][lane] >> 24);
+            block[i * 4 + 1] = (uint8_t)(p_Words[i][lane] >> 16);
+            block[i * 4 + 2] = (uint8_t)(p_Words[i][lane] >> 8);
+            block[i * 4 + 3] = (uint8_t)p_Words[i][lane];
+        }
+
+        uint32_t state[5];
+        memcpy(state, s_InitialState, sizeof(state));
+        Compress(state, block);
+
+        for (int i = 0; i < 5; ++i)
+        {
+            p_Digest[i][lane] = state[i];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include <chrono>
+#include <new>
+#include "../include/SharedStatusWriter.h"
+
+static uint64_t GetUnixTimeMs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+SharedStatusWriter::SharedStatusWriter()
+    : m_Mapping(nullptr),
+    m_Block(nullptr),
+    m_Last(),
+    m_PublishCount(0)
+{
+}
+
+SharedStatusWriter::~SharedStatusWriter()
+{
+    Close();
+}
+
+bool SharedStatusWriter::Open()
+{
+    Close();
+
+    m_Name = s_SharedStatusName;
+    m_Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(SharedStatusBlock), m_Name.c_str());
+    if (m_Mapping != nullptr && GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle(m_Mapping);
+        m_Name += "-" + std::to_string(GetCurrentProcessId());
+        m_Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(SharedStatusBlock), m_Name.c_str());
+    }
+    if (m_Mapping == nullptr)
+    {
+        m_Name.clear();
+        return false;
+    }
+
+    void* view = MapViewOfFile(m_Mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedStatusBlock));
+    if (view == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    // The pages start zeroed, so readers see sequence 0 (nothing published) until the first Publish
+    m_Block = new (view) SharedStatusBlock();
+    m_Block->m_Magic = s_SharedStatusMagic;
+    m_Block->m_Version = s_SharedStatusVersion;
+    m_Block->m_Size = sizeof(SharedStatusBlock);
+    m_Block->m_HeartbeatTime.store(GetUnixTimeMs(), std::memory_order_relaxed);
+
+    m_Last = SharedStatusData();
+    m_PublishCount = 0;
+    return true;
+}
+
+void SharedStatusWriter::Close()
+{
+    if (m_Block != nullptr)
+    {
+        m_Block->m_HeartbeatTime.store(0, std::memory_order_relaxed);
+        UnmapViewOfFile(m_Block);
+        m_Block = nullptr;
+    }
+    if (m_Mapping != nullptr)
+    {
+        CloseHandle(m_Mapping);
+        m_Mapping = nullptr;
+    }
+}
+
+bool SharedStatusWriter::Publish(const SharedStatusData& p_Data)
+{
+    if (m_Block == nullptr)
+    {
+        return false;
+    }
+
+    SharedStatusData data = p_Data;
+    data.m_UpdatedTime = m_Last.m_UpdatedTime;
+    if (m_PublishCount > 0 && std::memcmp(&data, &m_Last, sizeof(data)) == 0)
+    {
+        return false;
+    }
+    data.m_UpdatedTime = GetUnixTimeMs();
+
+    // Single writer, so a plain load is enough to read the current sequence
+    uint32_t sequence = m_Block->m_Sequence.load(std::memory_order_relaxed);
+    uint32_t next = (sequence + 2 == 0) ? 2 : sequence + 2;     // 0 stays reserved for "never published"
+    m_Block->m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy((void*)&m_Block->m_Data, &data, sizeof(data));
+    m_Block->m_Sequence.store(next, std::memory_order_release);
+
+    m_Last = data;
+    m_PublishCount++;
+    return true;
+}
+
+void SharedStatusWriter::Heartbeat()
+{
+    if (m_Block != nullptr)
+    {
+        m_Block->m_HeartbeatTime.store(GetUnixTimeMs(), std::memory_order_relaxed);
+    }
+}
@@ -1,9 +1,14 @@
+#include <algorithm>
+#include <chrono>
 #include "../include/ShinyCounter.h"
 #include "../include/ImGuiApp.h"
+#include "../include/HuntProfileStore.h"
 
 // Constructor implementation
 ShinyCounter::ShinyCounter(ImGuiApp* p_ImGuiApp)
-    : m_ImGuiApp(p_ImGuiApp), m_Generation(0), m_EncountersPerReset(0), m_CurrentEncounters(0)
+    : m_ImGuiApp(p_ImGuiApp), m_Generation(0), m_EncountersPerReset(0), m_CurrentEncounters(0), m_Method(0), m_EncounterPipeline(*this), m_IsFrozen(false),
+    m_PhaseStartTime(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()),
+    m_HuntId(0)
 {
 }
 
@@ -26,6 +31,7 @@ std::string ShinyCounter::SetGeneration(int p_Generation)
     else
     {
         m_Generation = p_Generation;
+        SetMethod(0);
         return generationNames[p_Generation - 1] + ".";
     }
 }
@@ -51,26 +57,65 @@ std::string ShinyCounter::SetEncountersPerReset(int p_EncountersPerReset)
 
 std::string ShinyCounter::SetCurrentEncounters(int p_CurrentEncounters)
 {
+    int before = m_CurrentEncounters;
+    std::string result;
+
     if (p_CurrentEncounters < 0)
     {
 		m_CurrentEncounters = 0;
-        return "Invalid input. Please enter a non-negative whole number.";
+        m_OddsEngine.Reset(m_CurrentEncounters);
+        result = "Invalid input. Please enter a non-negative whole number.";
     }
     else if (p_CurrentEncounters >= 999999)
     {
         m_CurrentEncounters = 999999;
-        return "The shiny counter has been set to its maximum value " + std::to_string(m_CurrentEncounters) + "!";
+        m_OddsEngine.Reset(m_CurrentEncounters);
+        result = "The shiny counter has been set to its maximum value " + std::to_string(m_CurrentEncounters) + "!";
     }
     else
     {
         m_CurrentEncounters = p_CurrentEncounters;
-        return "The shiny counter has been set to " + std::to_string(m_CurrentEncounters) + ".";
+        m_OddsEngine.Reset(m_CurrentEncounters);
+        result = "The shiny counter has been set to " + std::to_string(m_CurrentEncounters) + ".";
+    }
+
+    if (m_CurrentEncounters != before)
+    {
+        m_HuntJournal.Append(HuntJournalEvent::Set, before, m_CurrentEncounters);
+    }
+    return result;
+}
+
+void ShinyCounter::RestoreCurrentEncounters(int p_CurrentEncounters)
+{
+    m_CurrentEncounters = std::clamp(p_CurrentEncounters, 0, 999999);
+    m_OddsEngine.Reset(m_CurrentEncounters);
+}
+
+std::string ShinyCounter::SetMethod(int p_Method)
+{
+    if (p_Method < 0 || (size_t)p_Method >= GetShinyMethodCount(m_Generation))
+    {
+        return "Invalid method for this generation.";
     }
 
+    // Earlier encounters keep the odds they were made at, only new ones use the new method
+    m_Method = p_Method;
+    m_OddsEngine.SetProbability(ShinyOddsEngine::GetProbability(GetMethod()));
+
+    return "Odds are now 1/" + std::to_string((int)(1.0 / m_OddsEngine.GetProbability() + 0.5)) + ".";
 }
 
 void ShinyCounter::Counter()
 {
+    if (m_IsFrozen.load())
+    {
+        return;
+    }
+
+    int before = m_CurrentEncounters;
+    m_EncounterStats.RecordReset();
+    m_OddsEngine.AddEncounters(m_EncountersPerReset);
 
     if ((m_CurrentEncounters + m_EncountersPerReset) < 999999)
     {
@@ -80,4 +125,95 @@ void ShinyCounter::Counter()
     {
 		m_CurrentEncounters = 999999;
     }
-}
\ No newline at end of file
+
+    m_EncounterHistory.RecordReset(m_CurrentEncounters);
+    m_HuntJournal.Append(HuntJournalEvent::Reset, before, m_CurrentEncounters);
+}
+
+bool ShinyCounter::Undo(HuntJournalEntry& p_Entry)
+{
+    if (!m_HuntJournal.Undo(p_Entry))
+    {
+        return false;
+    }
+
+    if (p_Entry.m_Event == HuntJournalEvent::Reset)
+    {
+        m_EncounterHistory.RemoveLastReset(p_Entry.m_After);
+    }
+    RestoreCurrentEncounters(p_Entry.m_Before);
+    return true;
+}
+
+bool ShinyCounter::Redo(HuntJournalEntry& p_Entry)
+{
+    if (!m_HuntJournal.Redo(p_Entry))
+    {
+        return false;
+    }
+
+    if (p_Entry.m_Event == HuntJournalEvent::Reset)
+    {
+        m_EncounterHistory.RecordReset(p_Entry.m_After);
+    }
+    RestoreCurrentEncounters(p_Entry.m_After);
+    return true;
+}
+
+HuntPhase ShinyCounter::EndPhase(const std::string& p_Shiny)
+{
+    HuntPhase phase;
+    phase.m_StartTime = m_PhaseStartTime;
+    phase.m_EndTime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    phase.m_Encounters = m_CurrentEncounters;
+    phase.m_ExpectedShinies = m_OddsEngine.GetExpectedShinies();
+    phase.m_Shiny = p_Shiny;
+
+    m_Phases.push_back(phase);
+    m_PhaseTotals.Add(phase);
+    m_HuntJournal.Append(HuntJournalEvent::PhaseEnd, m_CurrentEncounters, 0);
+
+    m_PhaseStartTime = phase.m_EndTime;
+    m_EncounterHistory.Reset();
+    RestoreCurrentEncounters(0);
+    return phase;
+}
+
+void ShinyCounter::SetPhases(const std::vector<HuntPhase>& p_Phases, int64_t p_PhaseStartTime)
+{
+    m_Phases = p_Phases;
+    m_PhaseStartTime = p_PhaseStartTime;
+
+    m_PhaseTotals.Clear();
+    for (const HuntPhase& phase : m_Phases)
+    {
+        m_PhaseTotals.Add(phase);
+    }
+}
+
+std::string ShinyCounter::SwitchHunt(HuntProfile& p_Profile, const std::string& p_JournalPath)
+{
+    m_HuntJournal.Open(p_JournalPath);
+    m_HuntId = p_Profile.m_Id;
+
+    // Changes made after the last save are still in the journal
+    HuntJournalEntry last;
+    if (HuntJournal::ReadLast(p_JournalPath, last) && (int64_t)last.m_Time >= p_Profile.m_UpdatedTime)
+    {
+        p_Profile.m_Encounters = last.m_After;
+    }
+
+    SetPhases(p_Profile.m_Phases, p_Profile.m_PhaseStartTime);
+
+    std::string generationResult;
+    if (p_Profile.m_Generation >= 1 && p_Profile.m_Generation <= 7)
+    {
+        generationResult = SetGeneration(p_Profile.m_Generation);
+        SetMethod(p_Profile.m_Method);
+    }
+
+    SetEncountersPerReset(std::max(p_Profile.m_EncountersPerReset, 1));
+    m_EncounterHistory.Reset();
+    RestoreCurrentEncounters(p_Profile.m_Encounters);
+    return generationResult;
+}
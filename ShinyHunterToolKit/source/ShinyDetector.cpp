@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <climits>
+#include "../include/ShinyDetector.h"
+#include "../include/PreciseTimer.h"
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SHINY_DETECTOR_SSE2
+#endif
+
+// Clips a region to the part of the frame that was captured
+static bool GetFrameRect(const VideoFrame& p_Frame, const DetectionRegion& p_Region, int& p_X0, int& p_Y0, int& p_X1, int& p_Y1)
+{
+    p_X0 = std::max(p_Region.m_X - p_Frame.m_OriginX, 0);
+    p_Y0 = std::max(p_Region.m_Y - p_Frame.m_OriginY, 0);
+    p_X1 = std::min(p_Region.m_X + p_Region.m_Width - p_Frame.m_OriginX, p_Frame.m_Width);
+    p_Y1 = std::min(p_Region.m_Y + p_Region.m_Height - p_Frame.m_OriginY, p_Frame.m_Height);
+    return p_X1 > p_X0 && p_Y1 > p_Y0;
+}
+
+static inline bool IsColourClose(uint32_t p_Pixel, uint32_t p_Colour, int p_Tolerance)
+{
+    for (int shift = 0; shift < 24; shift += 8)
+    {
+        int difference = (int)((p_Pixel >> shift) & 0xFF) - (int)((p_Colour >> shift) & 0xFF);
+        if (difference > p_Tolerance || difference < -p_Tolerance)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline int GetHistogramBin(uint32_t p_Pixel)
+{
+    // Top two bits of red, green and blue
+    return (int)(((p_Pixel >> 18) & 0x30) | ((p_Pixel >> 12) & 0x0C) | ((p_Pixel >> 6) & 0x03));
+}
+
+float ShinyDetector::GetPaletteScore(const VideoFrame& p_Frame, const DetectionRegion& p_Region)
+{
+    int x0, y0, x1, y1;
+    if (p_Region.m_Palette.empty() || !GetFrameRect(p_Frame, p_Region, x0, y0, x1, y1))
+    {
+        return 0.0f;
+    }
+
+    int tolerance = std::clamp(p_Region.m_Tolerance, 0, 255);
+    uint64_t matches = 0;
+
+#ifdef SHINY_DETECTOR_SSE2
+    // Saturating differences both ways give |pixel - colour| per byte; alpha gets a
+    // tolerance of 255 so it never rejects a pixel
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i tolerances = _mm_set1_epi32((int)(0xFF000000u | (uint32_t)tolerance * 0x010101u));
+#endif
+
+    for (int y = y0; y < y1; ++y)
+    {
+        const uint32_t* row = p_Frame.GetRow(y);
+        int x = x0;
+
+#ifdef SHINY_DETECTOR_SSE2
+        for (; x + 4 <= x1; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(row + x));
+            __m128i isMatch = zero;
+            for (uint32_t paletteColour : p_Region.m_Palette)
+            {
+                __m128i colour = _mm_set1_epi32((int)(paletteColour & 0xFFFFFF));
+                __m128i difference = _mm_or_si128(_mm_subs_epu8(pixels, colour), _mm_subs_epu8(colour, pixels));
+                isMatch = _mm_or_si128(isMatch, _mm_cmpeq_epi32(_mm_subs_epu8(difference, tolerances), zero));
+            }
+
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(isMatch));
+            matches += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+        }
+#endif
+
+        for (; x < x1; ++x)
+        {
+            for (uint32_t colour : p_Region.m_Palette)
+            {
+                if (IsColourClose(row[x], colour, tolerance))
+                {
+                    ++matches;
+                    break;
+                }
+            }
+        }
+    }
+
+    return (float)matches / ((float)(x1 - x0) * (y1 - y0));
+}
+
+void ShinyDetector::GetHistogram(const VideoFrame& p_Frame, const DetectionRegion& p_Region, float* p_Histogram)
+{
+    std::fill(p_Histogram, p_Histogram + DetectionRegion::s_HistogramBins, 0.0f);
+
+    int x0, y0, x1, y1;
+    if (!GetFrameRect(p_Frame, p_Region, x0, y0, x1, y1))
+    {
+        return;
+    }
+
+    // Four interleaved sub-histograms so runs of same-coloured pixels do not serialise
+    // on one counter
+    uint32_t counts[4][DetectionRegion::s_HistogramBins] = {};
+
+    for (int y = y0; y < y1; ++y)
+    {
+        const uint32_t* row = p_Frame.GetRow(y);
+        int x = x0;
+
+#ifdef SHINY_DETECTOR_SSE2
+        const __m128i redMask = _mm_set1_epi32(0x30);
+        const __m128i greenMask = _mm_set1_epi32(0x0C);
+        const __m128i blueMask = _mm_set1_epi32(0x03);
+        for (; x + 4 <= x1; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(row + x));
+            __m128i bins = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixels, 18), redMask),
+                _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixels, 12), greenMask), _mm_and_si128(_mm_srli_epi32(pixels, 6), blueMask)));
+
+            alignas(16) uint32_t binIndices[4];
+            _mm_store_si128((__m128i*)binIndices, bins);
+            ++counts[0][binIndices[0]];
+            ++counts[1][binIndices[1]];
+            ++counts[2][binIndices[2]];
+            ++counts[3][binIndices[3]];
+        }
+#endif
+
+        for (; x < x1; ++x)
+        {
+            ++counts[x & 3][GetHistogramBin(row[x])];
+        }
+    }
+
+    float scale = 1.0f / ((float)(x1 - x0) * (y1 - y0));
+    for (size_t bin = 0; bin < DetectionRegion::s_HistogramBins; ++bin)
+    {
+        p_Histogram[bin] = (counts[0][bin] + counts[1][bin] + counts[2][bin] + counts[3][bin]) * scale;
+    }
+}
+
+float ShinyDetector::GetHistogramSimilarity(const float* p_First, const float* p_Second)
+{
+    // Histogram intersection: 1 for identical distributions, 0 for disjoint ones
+    float similarity = 0.0f;
+    for (size_t bin = 0; bin < DetectionRegion::s_HistogramBins; ++bin)
+    {
+        similarity += std::min(p_First[bin], p_Second[bin]);
+    }
+    return similarity;
+}
+
+ShinyDetector::ShinyDetector()
+    : m_IsRunning(false), m_StopDetection(false), m_IsTriggered(false), m_ReferenceRequest(-1)
+{
+}
+
+ShinyDetector::~ShinyDetector()
+{
+    Stop();
+}
+
+void ShinyDetector::SetRegions(const std::vector<DetectionRegion>& p_Regions)
+{
+    std::lock_guard<std::mutex> lock(m_RegionsMutex);
+    m_Regions = p_Regions;
+    m_MatchStreaks.assign(m_Regions.size(), 0);
+}
+
+std::vector<DetectionRegion> ShinyDetector::GetRegions() const
+{
+    std::lock_guard<std::mutex> lock(m_RegionsMutex);
+    return m_Regions;
+}
+
+void ShinyDetector::RequestReference(size_t p_Region)
+{
+    m_ReferenceRequest = (int)p_Region;
+}
+
+void ShinyDetector::Rearm()
+{
+    std::lock_guard<std::mutex> lock(m_RegionsMutex);
+    std::fill(m_MatchStreaks.begin(), m_MatchStreaks.end(), 0);
+    m_IsTriggered = false;
+
+    std::lock_guard<std::mutex> statsLock(m_StatsMutex);
+    m_Stats.m_MatchedRegion.clear();
+}
+
+ShinyDetectorStats ShinyDetector::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    return m_Stats;
+}
+
+std::string ShinyDetector::GetSourceError() const
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    return m_SourceError;
+}
+
+bool ShinyDetector::Start(std::unique_ptr<FrameSource> p_Source, double p_MaxFps, std::function<void(const DetectionRegion&)> p_OnMatch)
+{
+    if (m_IsRunning.load() || !p_Source)
+    {
+        return false;
+    }
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    // Capture only the bounding box of the regions when the source can crop
+    std::vector<DetectionRegion> regions = GetRegions();
+    if (!regions.empty())
+    {
+        int left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+        for (const DetectionRegion& region : regions)
+        {
+            left = std::min(left, region.m_X);
+            top = std::min(top, region.m_Y);
+            right = std::max(right, region.m_X + region.m_Width);
+            bottom = std::max(bottom, region.m_Y + region.m_Height);
+        }
+        p_Source->SetRegionOfInterest(left, top, right - left, bottom - top);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_StatsMutex);
+        m_Stats = ShinyDetectorStats();
+        m_SourceError.clear();
+    }
+
+    m_StopDetection = false;
+    m_IsRunning = true;
+    m_Thread = std::thread(&ShinyDetector::RunDetection, this, std::move(p_Source), p_MaxFps, p_OnMatch);
+    return true;
+}
+
+void ShinyDetector::Stop()
+{
+    m_StopDetection = true;
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+}
+
+std::vector<RegionScore> ShinyDetector::Analyse(const VideoFrame& p_Frame)
+{
+    std::lock_guard<std::mutex> lock(m_RegionsMutex);
+    std::vector<RegionScore> scores;
+
+    int referenceRequest = m_ReferenceRequest.exchange(-1);
+    float histogram[DetectionRegion::s_HistogramBins];
+
+    for (size_t i = 0; i < m_Regions.size(); ++i)
+    {
+        DetectionRegion& region = m_Regions[i];
+        RegionScore score = { 0.0f, false, false };
+
+        if (region.m_Mode == DetectionMode::Palette)
+        {
+            score.m_Score = GetPaletteScore(p_Frame, region);
+            score.m_IsMatch = score.m_Score >= region.m_Threshold;
+        }
+        else
+        {
+            GetHistogram(p_Frame, region, histogram);
+            if (referenceRequest == (int)i)
+            {
+                region.m_Reference.assign(histogram, histogram + DetectionRegion::s_HistogramBins);
+            }
+
+            if (region.m_Reference.size() == DetectionRegion::s_HistogramBins)
+            {
+                score.m_Score = GetHistogramSimilarity(histogram, region.m_Reference.data());
+                score.m_IsMatch = region.m_MatchWhenDifferent ? score.m_Score < region.m_Threshold : score.m_Score >= region.m_Threshold;
+            }
+        }
+
+        // A match has to hold for several frames so a single flash or tearing does not trigger
+        m_MatchStreaks[i] = score.m_IsMatch ? m_MatchStreaks[i] + 1 : 0;
+        score.m_IsMatch = m_MatchStreaks[i] >= std::max(region.m_ConsecutiveFrames, 1);
+        score.m_IsNewMatch = m_MatchStreaks[i] == std::max(region.m_ConsecutiveFrames, 1);
+        scores.push_back(score);
+    }
+
+    return scores;
+}
+
+void ShinyDetector::RunDetection(std::unique_ptr<FrameSource> p_Source, double p_MaxFps, std::function<void(const DetectionRegion&)> p_OnMatch)
+{
+    using namespace std::chrono;
+
+    PreciseTimer timer;
+
+    if (!p_Source->Open())
+    {
+        std::lock_guard<std::mutex> lock(m_StatsMutex);
+        m_SourceError = "Failed to open " + p_Source->GetName() + ".";
+        m_IsRunning = false;
+        return;
+    }
+
+    auto period = duration_cast<nanoseconds>(duration<double>(1.0 / std::max(p_MaxFps, 1.0)));
+    auto nextFrame = steady_clock::now();
+    auto lastFrame = nextFrame;
+    VideoFrame frame;
+
+    while (!m_StopDetection)
+    {
+        if (!PreciseTimer::SleepUntil(nextFrame, m_StopDetection))
+        {
+            break;
+        }
+
+        auto captureStart = steady_clock::now();
+        if (!p_Source->ReadFrame(frame))
+        {
+            std::lock_guard<std::mutex> lock(m_StatsMutex);
+            m_SourceError = p_Source->GetName() + " has no more frames.";
+            break;
+        }
+
+        auto analysisStart = steady_clock::now();
+        std::vector<RegionScore> scores = Analyse(frame);
+        auto analysisEnd = steady_clock::now();
+
+        std::string matchedRegion;
+        std::vector<DetectionRegion> matches;
+        {
+            std::lock_guard<std::mutex> lock(m_RegionsMutex);
+            for (size_t i = 0; i < scores.size() && i < m_Regions.size(); ++i)
+            {
+                if (m_Regions[i].m_CountsEncounters)
+                {
+                    if (scores[i].m_IsNewMatch)
+                    {
+                        matches.push_back(m_Regions[i]);
+                    }
+                }
+                else if (scores[i].m_IsMatch && !m_IsTriggered.load())
+                {
+                    matchedRegion = m_Regions[i].m_Name;
+                    matches.push_back(m_Regions[i]);
+                    m_IsTriggered = true;
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_StatsMutex);
+            const double smoothing = 0.05;
+            double captureMicroseconds = duration<double, std::micro>(analysisStart - captureStart).count();
+            double analysisMicroseconds = duration<double, std::micro>(analysisEnd - analysisStart).count();
+            double frameSeconds = duration<double>(captureStart - lastFrame).count();
+
+            bool isFirst = m_Stats.m_FramesAnalysed == 0;
+            m_Stats.m_CaptureMicroseconds = isFirst ? captureMicroseconds : m_Stats.m_CaptureMicroseconds + (captureMicroseconds - m_Stats.m_CaptureMicroseconds) * smoothing;
+            m_Stats.m_AnalysisMicroseconds = isFirst ? analysisMicroseconds : m_Stats.m_AnalysisMicroseconds + (analysisMicroseconds - m_Stats.m_AnalysisMicroseconds) * smoothing;
+            if (!isFirst && frameSeconds > 0.0)
+            {
+                m_Stats.m_FramesPerSecond += (1.0 / frameSeconds - m_Stats.m_FramesPerSecond) * smoothing;
+            }
+            ++m_Stats.m_FramesAnalysed;
+            m_Stats.m_Scores = scores;
+            if (!matchedRegion.empty())
+            {
+                m_Stats.m_MatchedRegion = matchedRegion;
+            }
+            m_Stats.m_EncountersDetected += matches.size() - (matchedRegion.empty() ? 0 : 1);
+        }
+        lastFrame = captureStart;
+
+        for (const DetectionRegion& region : matches)
+        {
+            if (p_OnMatch)
+            {
+                p_OnMatch(region);
+            }
+        }
+
+        // Deadline pacing; when capture falls behind, run as fast as it allows
+        nextFrame += period;
+        auto now = steady_clock::now();
+        if (nextFrame < now)
+        {
+            nextFrame = now;
+        }
+    }
+
+    p_Source->Close();
+    m_IsRunning = false;
+}
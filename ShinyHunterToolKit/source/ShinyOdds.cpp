@@ -0,0 +1,48 @@
+#include <cmath>
+#include "../include/ShinyOdds.h"
+
+ShinyOddsEngine::ShinyOddsEngine()
+    : m_Probability(0.0), m_LogMissRate(0.0), m_LogNoShiny(0.0), m_Encounters(0)
+{
+    SetProbability(GetProbability(s_ShinyMethods[0]));
+}
+
+double ShinyOddsEngine::GetProbability(const ShinyMethod& p_Method)
+{
+    // 1 - (1 - 1/base)^rolls, evaluated with log1p/expm1 to keep precision for tiny odds
+    return -std::expm1(p_Method.m_Rolls * std::log1p(-1.0 / p_Method.m_BaseDenominator));
+}
+
+void ShinyOddsEngine::SetProbability(double p_Probability)
+{
+    m_Probability = p_Probability;
+    m_LogMissRate = std::log1p(-p_Probability);
+}
+
+void ShinyOddsEngine::Reset(uint64_t p_Encounters)
+{
+    m_Encounters = p_Encounters;
+    m_LogNoShiny = p_Encounters * m_LogMissRate;
+}
+
+void ShinyOddsEngine::AddEncounters(uint64_t p_Encounters)
+{
+    m_Encounters += p_Encounters;
+    m_LogNoShiny += p_Encounters * m_LogMissRate;
+}
+
+double ShinyOddsEngine::GetCumulativeProbability() const
+{
+    return -std::expm1(m_LogNoShiny);
+}
+
+uint64_t ShinyOddsEngine::GetEncountersForProbability(double p_Target) const
+{
+    double logTarget = std::log1p(-p_Target);
+    if (m_LogNoShiny <= logTarget || m_LogMissRate >= 0.0)
+    {
+        return m_Encounters;
+    }
+
+    return m_Encounters + (uint64_t)std::ceil((logTarget - m_LogNoShiny) / m_LogMissRate);
+}
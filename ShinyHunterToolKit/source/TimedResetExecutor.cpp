@@ -0,0 +1,199 @@
+#include <algorithm>
+#include "../include/TimedResetExecutor.h"
+#include "../include/ViGEmManager.h"
+#include "../include/PreciseTimer.h"
+
+static const std::chrono::milliseconds s_AnchorLead(20);
+static const std::chrono::microseconds s_SpinTail(3000);
+
+TimedResetExecutor::TimedResetExecutor(ViGEmManager& p_ViGEmManager)
+    : m_ViGEmManager(p_ViGEmManager),
+    m_IsRunning(false),
+    m_StopExecutor(false),
+    m_CalibrationMs(0.0)
+{
+}
+
+TimedResetExecutor::~TimedResetExecutor()
+{
+    Stop();
+}
+
+bool TimedResetExecutor::Start(const std::vector<TimedPress>& p_Presses)
+{
+    if (m_IsRunning.load() || p_Presses.empty())
+    {
+        return false;
+    }
+
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+
+    m_StopExecutor = false;
+    m_IsRunning = true;
+    m_Thread = std::thread(&TimedResetExecutor::Execute, this, p_Presses);
+    return true;
+}
+
+void TimedResetExecutor::Stop()
+{
+    m_StopExecutor = true;
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+}
+
+void TimedResetExecutor::NudgeCalibration(double p_Ms)
+{
+    double calibration = m_CalibrationMs.load();
+    while (!m_CalibrationMs.compare_exchange_weak(calibration, calibration + p_Ms))
+    {
+    }
+}
+
+std::vector<TimedPressResult> TimedResetExecutor::GetLog() const
+{
+    std::lock_guard<std::mutex> lock(m_LogMutex);
+    return m_Log;
+}
+
+double TimedResetExecutor::GetMeanError() const
+{
+    std::lock_guard<std::mutex> lock(m_LogMutex);
+    if (m_Log.empty())
+    {
+        return 0.0;
+    }
+
+    double total = 0.0;
+    for (const TimedPressResult& result : m_Log)
+    {
+        total += result.m_ErrorMs;
+    }
+    return total / m_Log.size();
+}
+
+std::vector<TimedPress> TimedResetExecutor::GetPressesFromMacro(const Macro& p_Macro, const MacroTimebase& p_Timebase)
+{
+    std::vector<TimedPress> presses;
+    uint64_t ticks = 0;
+
+    for (size_t i = 0; i < p_Macro.m_Events.size(); ++i)
+    {
+        const MacroEvent& event = p_Macro.m_Events[i];
+        ticks += event.m_Ticks;
+
+        if (event.m_Report.wButtons == 0)
+        {
+            continue;
+        }
+
+        uint64_t holdTicks = i + 1 < p_Macro.m_Events.size() ? p_Macro.m_Events[i + 1].m_Ticks : p_Macro.m_LoopGapTicks;
+        double offsetMs = std::chrono::duration<double, std::milli>(p_Timebase.ToDuration(p_Macro.m_Unit, ticks)).count();
+        double holdMs = std::chrono::duration<double, std::milli>(p_Timebase.ToDuration(p_Macro.m_Unit, holdTicks)).count();
+
+        presses.push_back({ "Press " + std::to_string(presses.size() + 1), event.m_Report.wButtons, offsetMs, holdMs });
+    }
+
+    return presses;
+}
+
+void TimedResetExecutor::Execute(std::vector<TimedPress> p_Presses)
+{
+    using namespace std::chrono;
+
+    PreciseTimer timer;
+    HANDLE thread = GetCurrentThread();
+
+    // Pin to the highest core the process may use, away from the GUI and driver work
+    // that usually lands on core 0, and keep the scheduler from preempting the spin
+    DWORD_PTR processMask = 0, systemMask = 0, previousMask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) && processMask != 0)
+    {
+        DWORD_PTR pinMask = processMask;
+        while (pinMask & (pinMask - 1))
+        {
+            pinMask &= pinMask - 1;
+        }
+        previousMask = SetThreadAffinityMask(thread, pinMask);
+    }
+
+    int previousPriority = GetThreadPriority(thread);
+    SetThreadPriority(thread, THREAD_PRIORITY_TIME_CRITICAL);
+
+    // The first press is the anchor; calibration shifts everything scheduled after it
+    std::sort(p_Presses.begin(), p_Presses.end(), [](const TimedPress& a, const TimedPress& b) { return a.m_OffsetMs < b.m_OffsetMs; });
+    double anchorMs = p_Presses.front().m_OffsetMs;
+    double calibrationMs = m_CalibrationMs.load();
+
+    struct Edge
+    {
+        double m_Ms;
+        size_t m_Press;
+        bool m_IsDown;
+    };
+
+    std::vector<double> targets(p_Presses.size());
+    std::vector<Edge> edges;
+    for (size_t i = 0; i < p_Presses.size(); ++i)
+    {
+        targets[i] = std::max(p_Presses[i].m_OffsetMs - anchorMs + (i > 0 ? calibrationMs : 0.0), 0.0);
+        edges.push_back({ targets[i], i, true });
+        edges.push_back({ targets[i] + std::max(p_Presses[i].m_HoldMs, 0.0), i, false });
+    }
+
+    // Releases go first on ties so back-to-back presses still change the report
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b)
+        {
+            return a.m_Ms != b.m_Ms ? a.m_Ms < b.m_Ms : (!a.m_IsDown && b.m_IsDown);
+        });
+
+    {
+        std::lock_guard<std::mutex> lock(m_LogMutex);
+        m_Log.clear();
+    }
+
+    std::vector<bool> isDown(p_Presses.size(), false);
+    XUSB_REPORT report = {};
+    auto anchor = steady_clock::now() + s_AnchorLead;
+
+    for (const Edge& edge : edges)
+    {
+        auto deadline = anchor + duration_cast<nanoseconds>(duration<double, std::milli>(edge.m_Ms));
+        if (!PreciseTimer::SleepUntil(deadline, m_StopExecutor, s_SpinTail))
+        {
+            break;
+        }
+
+        isDown[edge.m_Press] = edge.m_IsDown;
+        report.wButtons = 0;
+        for (size_t i = 0; i < p_Presses.size(); ++i)
+        {
+            report.wButtons |= isDown[i] ? p_Presses[i].m_Buttons : 0;
+        }
+        m_ViGEmManager.ReceiveInput(report);
+
+        if (edge.m_IsDown)
+        {
+            double achievedMs = duration<double, std::milli>(steady_clock::now() - anchor).count();
+
+            std::lock_guard<std::mutex> lock(m_LogMutex);
+            m_Log.push_back({ p_Presses[edge.m_Press].m_Name, targets[edge.m_Press], achievedMs, achievedMs - targets[edge.m_Press] });
+        }
+    }
+
+    // Ensure all buttons are released when stopping
+    report.wButtons = 0;
+    m_ViGEmManager.ReceiveInput(report);
+
+    SetThreadPriority(thread, previousPriority);
+    if (previousMask != 0)
+    {
+        SetThreadAffinityMask(thread, previousMask);
+    }
+
+    m_IsRunning = false;
+}
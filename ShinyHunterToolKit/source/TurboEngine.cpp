@@ -0,0 +1,110 @@
+#include <algorithm>
+#include "../include/TurboEngine.h"
+#include "../include/ViGEmManager.h"
+#include "../include/PreciseTimer.h"
+
+TurboEngine::TurboEngine(ViGEmManager& p_ViGEmManager)
+    : m_ViGEmManager(p_ViGEmManager),
+    m_StopTurbo(false),
+    m_AchievedRate(0.0),
+    m_TapCount(0)
+{
+}
+
+void TurboEngine::SetSettings(const TurboSettings& p_Settings)
+{
+    std::lock_guard<std::mutex> lock(m_SettingsMutex);
+    m_Settings = p_Settings;
+}
+
+TurboSettings TurboEngine::GetSettings() const
+{
+    std::lock_guard<std::mutex> lock(m_SettingsMutex);
+    return m_Settings;
+}
+
+void TurboEngine::Run(WORD p_Buttons)
+{
+    using namespace std::chrono;
+
+    PreciseTimer timer;
+
+    m_StopTurbo = false;
+    m_TapCount = 0;
+    m_AchievedRate = 0.0;
+
+    XUSB_REPORT report = {};
+    bool useAlternate = false;
+    auto nextTap = steady_clock::now();
+
+    while (!m_StopTurbo)
+    {
+        // Settings are re-read every tap so the GUI can tune a running turbo
+        TurboSettings settings = GetSettings();
+
+        double frameRate = std::max(settings.m_FrameRate, s_MinFrameRate);
+        double frequency = std::clamp(settings.m_FrequencyHz, 1.0, GetMaxFrequency(frameRate));
+
+        auto period = duration_cast<nanoseconds>(duration<double>(1.0 / frequency));
+        auto frame = duration_cast<nanoseconds>(duration<double>(1.0 / frameRate));
+        auto hold = duration_cast<nanoseconds>(period * std::clamp(settings.m_DutyCycle, 0.0, 1.0));
+
+        // The game must see the buttons down for a frame and up for a frame
+        hold = std::clamp(hold, frame, period - frame);
+
+        PreciseTimer::SleepUntil(nextTap);
+
+        WORD buttons = (useAlternate && settings.m_AlternateButtons != 0) ? settings.m_AlternateButtons : p_Buttons;
+        report.wButtons = buttons;
+        m_ViGEmManager.ReceiveInput(report);
+        RecordTap(steady_clock::now());
+
+        PreciseTimer::SleepUntil(nextTap + hold);
+
+        report.wButtons = 0;
+        m_ViGEmManager.ReceiveInput(report);
+
+        useAlternate = !useAlternate;
+
+        // Deadlines advance by whole periods so rounding never accumulates; if the thread
+        // was descheduled past the next deadline, resync rather than bursting to catch up
+        nextTap += period;
+        auto now = steady_clock::now();
+        if (nextTap < now)
+        {
+            nextTap = now;
+        }
+    }
+
+    // Ensure all buttons are released when stopping
+    report.wButtons = 0;
+    m_ViGEmManager.ReceiveInput(report);
+
+    m_AchievedRate = 0.0;
+}
+
+void TurboEngine::Stop()
+{
+    m_StopTurbo = true;
+}
+
+void TurboEngine::RecordTap(std::chrono::steady_clock::time_point p_TapTime)
+{
+    size_t index = m_TapCount % s_RateWindow;
+    size_t oldest = (m_TapCount < s_RateWindow) ? 0 : (m_TapCount + 1) % s_RateWindow;
+
+    m_TapTimes[index] = p_TapTime;
+    ++m_TapCount;
+
+    size_t taps = std::min(m_TapCount, s_RateWindow);
+    if (taps < 2)
+    {
+        return;
+    }
+
+    double seconds = std::chrono::duration<double>(p_TapTime - m_TapTimes[oldest]).count();
+    if (seconds > 0.0)
+    {
+        m_AchievedRate = (taps - 1) / seconds;
+    }
+}
@@ -1,10 +1,11 @@
-#include <iostream>
 #include <chrono>
 #include <thread>
 #include "../include/ViGEmManager.h"
 #include "../include/PhysicalControllerManager.h"
+#include "../include/PreciseTimer.h"
+#include "../include/Logger.h"
 
-ViGEmManager::ViGEmManager() : m_Client(nullptr), m_VirtualController(nullptr), m_IsVirtualControllerConnected(false), m_PreviousButtonState(0) {}
+ViGEmManager::ViGEmManager() : m_Client(nullptr), m_VirtualController(nullptr), m_IsVirtualControllerConnected(false), m_PreviousButtonState(0), m_TurboEngine(*this), m_TimedResetExecutor(*this), m_EncounterPipeline(nullptr) {}
 
 ViGEmManager::~ViGEmManager()
 {
@@ -16,14 +17,14 @@ bool ViGEmManager::Init()
     m_Client = vigem_alloc();
     if (m_Client == nullptr)
     {
-        std::cerr << "Failed to allocate ViGEm client." << std::endl;
+        Logger::Error("Failed to allocate ViGEm client.");
         return false;
     }
 
     const auto connectResult = vigem_connect(m_Client);
     if (!VIGEM_SUCCESS(connectResult))
     {
-        std::cerr << "Failed to connect to ViGEmBus. Error code: " << connectResult << std::endl;
+        Logger::Error("Failed to connect to ViGEmBus. Error code: {}", connectResult);
         vigem_free(m_Client);
         m_Client = nullptr;
         return false;
@@ -34,6 +35,8 @@ bool ViGEmManager::Init()
 
 void ViGEmManager::Clean()
 {
+    m_TimedResetExecutor.Stop();
+
     if (m_VirtualController)
     {
         vigem_target_remove(m_Client, m_VirtualController);
@@ -53,21 +56,21 @@ bool ViGEmManager::ConnectController()
 {
     if (m_Client == nullptr)
     {
-        std::cerr << "ViGEm client is not initialized." << std::endl;
+        Logger::Error("ViGEm client is not initialized.");
         return false;
     }
 
     m_VirtualController = vigem_target_x360_alloc();
     if (m_VirtualController == nullptr)
     {
-        std::cerr << "Failed to allocate Xbox 360 controller target." << std::endl;
+        Logger::Error("Failed to allocate Xbox 360 controller target.");
         return false;
     }
 
     const auto addResult = vigem_target_add(m_Client, m_VirtualController);
     if (!VIGEM_SUCCESS(addResult))
     {
-        std::cerr << "Failed to add target to ViGEmBus. Error code: " << addResult << std::endl;
+        Logger::Error("Failed to add target to ViGEmBus. Error code: {}", addResult);
         vigem_target_free(m_VirtualController);
         m_VirtualController = nullptr;
         return false;
@@ -109,13 +112,13 @@ bool ViGEmManager::ReceiveInput(XUSB_REPORT p_Report)
 {
     if (m_Client == nullptr || m_VirtualController == nullptr)
     {
-        std::cerr << "ViGEm client or target is not initialized." << std::endl;
+        Logger::Error("ViGEm client or target is not initialized.");
         return false;
     }
 
     if (!VIGEM_SUCCESS(vigem_target_x360_update(m_Client, m_VirtualController, p_Report)))
     {
-        std::cerr << "Failed to update Xbox 360 controller state." << std::endl;
+        Logger::Error("Failed to update Xbox 360 controller state.");
         return false;
     }
 
@@ -128,7 +131,7 @@ void ViGEmManager::PrintNewInput(XUSB_REPORT p_Report)
 {
     if (p_Report.wButtons != m_PreviousButtonState && p_Report.wButtons != 0)
     {
-        std::cout << "\nNew button input received: " << GetButtonName(p_Report.wButtons) << std::endl;
+        Logger::Log(LogLevel::Debug, "New button input received: {}", GetButtonName(p_Report.wButtons));
 
         m_PreviousButtonState = p_Report.wButtons;
     }
@@ -140,80 +143,69 @@ void ViGEmManager::PrintNewInput(XUSB_REPORT p_Report)
 
 void ViGEmManager::PressUserButtonRepeatedly(WORD p_Button)
 {
-    m_StopPressingUserButton = false; 
-
-    while (!m_StopPressingUserButton)
-    {
-        XUSB_REPORT report = {};
-        report.wButtons = p_Button;
-        ReceiveInput(report);
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-    }
-
-    XUSB_REPORT report = {};
-    report.wButtons = 0;
-    ReceiveInput(report);
+    m_TurboEngine.Run(p_Button);
 }
 
 void ViGEmManager::StopPressingUserButton()
 {
-    m_StopPressingUserButton = true;
+    m_TurboEngine.Stop();
+}
+
+void ViGEmManager::PressUserMacroRepeatedly(const Macro& p_Macro)
+{
+    if (p_Macro.m_Program)
+    {
+        RunMacroProgram(*p_Macro.m_Program);
+    }
+    else
+    {
+        RunMacroProgram(MacroProgram::FromMacro(p_Macro));
+    }
 }
 
-void ViGEmManager::PressUserMacroRepeatedly(const std::vector<std::pair<WORD, std::chrono::milliseconds>>& buttonSequence)
+void ViGEmManager::RunMacroProgram(const MacroProgram& p_Program)
 {
     m_StopUserMacro = false;
 
-    while (!m_StopUserMacro)
+    MacroVm vm(*this);
+    vm.SetConditionHandler(m_MacroConditionHandler);
+    bool isOk = vm.Run(p_Program, m_StopUserMacro);
+
+    std::lock_guard<std::mutex> lock(m_MacroErrorMutex);
+    m_MacroError = isOk ? "" : vm.GetError();
+    if (!isOk)
     {
-        for (size_t i = 0; i < buttonSequence.size(); ++i)
-        {
-            if (m_StopUserMacro) break;
-
-            WORD button = buttonSequence[i].first;
-            auto delay = buttonSequence[i].second;
-
-            // Wait for the specified delay before pressing the button
-            std::this_thread::sleep_for(delay);
-
-            XUSB_REPORT report = {};
-            report.wButtons = button;
-
-            // Send the button press input
-            ReceiveInput(report);
-
-            // If this is a press event, hold the button for the specified duration
-            if (button != 0)
-            {
-                // Calculate the hold duration by checking the next event's delay
-                auto holdDuration = (i + 1 < buttonSequence.size()) ? buttonSequence[i + 1].second : std::chrono::milliseconds(0);
-                auto start = std::chrono::steady_clock::now();
-
-                // Continuously send the button press input during the hold duration
-                while (std::chrono::steady_clock::now() - start < holdDuration)
-                {
-                    ReceiveInput(report);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(5)); // Adjust the interval as needed
-                }
-
-                // Send the button release input
-                report.wButtons = 0;
-                ReceiveInput(report);
-            }
-        }
-
-        // Add a delay between the end and the start of the sequence
-        std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Adjust the delay as needed
+        Logger::Warning("Macro stopped: {}", m_MacroError);
     }
+}
+
+std::string ViGEmManager::GetMacroError() const
+{
+    std::lock_guard<std::mutex> lock(m_MacroErrorMutex);
+    return m_MacroError;
+}
 
-    // Ensure all buttons are released when stopping
-    XUSB_REPORT report = {};
-    report.wButtons = 0;
-    ReceiveInput(report);
+void ViGEmManager::PostEncounterMarker()
+{
+    if (m_EncounterPipeline != nullptr)
+    {
+        m_EncounterPipeline->Post(EncounterSource::MacroMarker);
+    }
 }
 
 void ViGEmManager::StopUserMacro()
 {
     m_StopUserMacro = true;
+}
+
+void ViGEmManager::SetMacroTimebase(const MacroTimebase& p_Timebase)
+{
+    std::lock_guard<std::mutex> lock(m_TimebaseMutex);
+    m_MacroTimebase = p_Timebase;
+}
+
+MacroTimebase ViGEmManager::GetMacroTimebase() const
+{
+    std::lock_guard<std::mutex> lock(m_TimebaseMutex);
+    return m_MacroTimebase;
 }
\ No newline at end of file